@@ -0,0 +1,81 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MPSCRING_H
+#define MPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for multiple producers and a single consumer.
+// Each slot carries a sequence number telling whether it is free for the
+// producer of a position or filled for the consumer, so producers only
+// contend on the tail index. `Capacity` must be a power of 2.
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    MpscRing()
+        : m_slots(new Slot[Capacity])
+        , m_head(0)
+        , m_tail(0)
+    {
+        for (size_t i = 0; i < Capacity; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread. Returns false if the ring is full.
+    bool push(T&& value)
+    {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[pos & (Capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the ring is empty.
+    bool pop(T& value)
+    {
+        Slot* slot = &m_slots[m_head & (Capacity - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence != m_head + 1) {
+            return false;
+        }
+        value = std::move(slot->value);
+        slot->sequence.store(m_head + Capacity, std::memory_order_release);
+        m_head++;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif
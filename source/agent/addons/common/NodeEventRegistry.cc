@@ -3,8 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "NodeEventRegistry.h"
-#include <list>
 #include <nan.h>
+#include <string.h>
 
 using namespace v8;
 
@@ -21,6 +21,10 @@ NodeEventRegistry* NodeEventRegistry::New(const Local<Function>& f)
 NodeEventRegistry::NodeEventRegistry()
     : m_store{ Isolate::GetCurrent(), Object::New(Isolate::GetCurrent()) }
     , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_overflowing{ false }
+    , m_delivered{ 0 }
+    , m_coalescedCount{ 0 }
+    , m_batches{ 0 }
 {
     if (m_uvHandle) {
         m_uvHandle->data = this;
@@ -32,6 +36,10 @@ NodeEventRegistry::NodeEventRegistry()
 NodeEventRegistry::NodeEventRegistry(Isolate* isolate, const Local<Function>& f)
     : m_store{ Isolate::GetCurrent(), f }
     , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_overflowing{ false }
+    , m_delivered{ 0 }
+    , m_coalescedCount{ 0 }
+    , m_batches{ 0 }
 {
     if (m_uvHandle) {
         m_uvHandle->data = this;
@@ -44,23 +52,28 @@ NodeEventRegistry::~NodeEventRegistry()
 {
     std::lock_guard<std::mutex> lock(m_lock);
     m_store.Reset();
+    m_batchListener.Reset();
     if (m_uvHandle && !uv_is_closing(reinterpret_cast<uv_handle_t*>(m_uvHandle)))
         uv_close(reinterpret_cast<uv_handle_t*>(m_uvHandle), closeCallback);
     if (m_uvHandle)
         m_uvHandle->data = nullptr;
 }
 
+bool NodeEventRegistry::hasStore()
+{
+    return !m_store.IsEmpty();
+}
+
 void NodeEventRegistry::process(const Data& data)
 {
     Isolate* isolate = Isolate::GetCurrent();
-    HandleScope scope(isolate);
     auto store = Local<Object>::New(isolate, m_store);
     if (store.IsEmpty())
         return;
 
     const unsigned argc = 1;
     Local<Value> argv[argc] = {
-        Nan::New(data.message.c_str()).ToLocalChecked()
+        Nan::New(data.message).ToLocalChecked()
     };
     TryCatch try_catch(isolate);
 
@@ -75,7 +88,7 @@ void NodeEventRegistry::process(const Data& data)
         return;
     }
 
-    Local<Value> val = Nan::Get(store, Nan::New(data.event.c_str()).ToLocalChecked())
+    Local<Value> val = Nan::Get(store, Nan::New(data.event).ToLocalChecked())
                        .ToLocalChecked();
     if (!val->IsFunction())
         return;
@@ -87,41 +100,102 @@ void NodeEventRegistry::process(const Data& data)
     }
 }
 
+void NodeEventRegistry::processBatch(const std::vector<Data>& datas)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    // Messages are concatenated, offsets[i] and offsets[i + 1] bound the i-th one.
+    size_t total = 0;
+    for (const Data& data : datas) {
+        total += data.message.size();
+    }
+    Local<Array> events = Nan::New<Array>(datas.size());
+    Local<Object> payload = Nan::NewBuffer(total).ToLocalChecked();
+    Local<ArrayBuffer> offsetBuffer = ArrayBuffer::New(isolate, (datas.size() + 1) * sizeof(uint32_t));
+    Local<Uint32Array> offsets = Uint32Array::New(offsetBuffer, 0, datas.size() + 1);
+    char* dst = node::Buffer::Data(payload);
+    Nan::TypedArrayContents<uint32_t> offsetContents(offsets);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < datas.size(); i++) {
+        Nan::Set(events, i, Nan::New(datas[i].event).ToLocalChecked());
+        (*offsetContents)[i] = offset;
+        memcpy(dst + offset, datas[i].message.data(), datas[i].message.size());
+        offset += datas[i].message.size();
+    }
+    (*offsetContents)[datas.size()] = offset;
+
+    const unsigned argc = 3;
+    Local<Value> argv[argc] = { events, payload, offsets };
+    TryCatch try_catch(isolate);
+    Nan::Call(Local<Function>::New(isolate, m_batchListener),
+              isolate->GetCurrentContext()->Global(),
+              argc, argv);
+    if (try_catch.HasCaught()) {
+        node::FatalException(isolate, try_catch);
+    }
+}
+
 void NodeEventRegistry::process()
 {
-    std::list<Data> datas;
+    // Emergency events first, then the ring, then what overflowed it
+    std::vector<Data> datas;
     {
         std::lock_guard<std::mutex> lock(m_lock);
-        while (true) {
-            Data data;
-            {
-                if (!m_buffer.empty()) {
-                    data = m_buffer.front();
-                    m_buffer.pop_front();
-                } else {
-                    break;
-                }
+        for (auto& emergency : m_buffer) {
+            datas.push_back(std::move(emergency));
+        }
+        m_buffer.clear();
+        auto take = [this, &datas](Data&& data) {
+            if (data.coalesced) {
+                CoalescedEvent& pending = m_coalesced[data.event];
+                data.message.swap(pending.message);
+                pending.pending = false;
             }
-            datas.push_back(data);
+            datas.push_back(std::move(data));
+        };
+        Data data;
+        while (m_ring.pop(data)) {
+            take(std::move(data));
+        }
+        for (auto& overflowed : m_overflow) {
+            take(std::move(overflowed));
+        }
+        m_overflow.clear();
+        m_overflowing = false;
+    }
+    if (datas.empty())
+        return;
+    m_batches++;
+
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    if (!m_batchListener.IsEmpty()) {
+        processBatch(datas);
+    } else {
+        for (size_t i = 0; i < datas.size() && hasStore(); i++) {
+            process(datas[i]);
         }
     }
-    for (std::list<Data>::iterator it = datas.begin(); it != datas.end(); ++it) {
-        process(*it);
+    m_delivered += datas.size();
+}
+
+bool NodeEventRegistry::push(Data&& data)
+{
+    if (!m_uvHandle || !uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle)))
+        return false;
+    // The ring only moves from data on success
+    if (m_overflowing || !m_ring.push(std::move(data))) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_overflow.push_back(std::move(data));
+        m_overflowing = true;
     }
+    uv_async_send(m_uvHandle);
+    return true;
 }
 
 // other thread
 bool NodeEventRegistry::notifyAsyncEvent(const std::string& event, const std::string& data)
 {
-    if (m_uvHandle && uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle))) {
-        {
-            std::lock_guard<std::mutex> lock(m_lock);
-            m_buffer.push_back(Data{ event, data });
-        }
-        uv_async_send(m_uvHandle);
-        return true;
-    }
-    return false;
+    return push(Data{ event, data });
 }
 
 // other thread
@@ -138,6 +212,34 @@ bool NodeEventRegistry::notifyAsyncEventInEmergency(const std::string& event, co
     return false;
 }
 
+// other thread
+bool NodeEventRegistry::notifyAsyncEventCoalesced(const std::string& event, const std::string& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        CoalescedEvent& pending = m_coalesced[event];
+        pending.message = data;
+        if (pending.pending) {
+            m_coalescedCount++;
+            return true;
+        }
+        pending.pending = true;
+    }
+    Data marker{ event, "" };
+    marker.coalesced = true;
+    if (!push(std::move(marker))) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_coalesced[event].pending = false;
+        return false;
+    }
+    return true;
+}
+
+NodeEventRegistry::Stats NodeEventRegistry::eventStats()
+{
+    return Stats{ m_delivered.load(), m_coalescedCount.load(), m_batches.load() };
+}
+
 void NodeEventRegistry::closeCallback(uv_handle_t* handle)
 {
     free(handle);
@@ -174,3 +276,29 @@ void NodeEventedObjectWrap::addEventListener(const FunctionCallbackInfo<Value>&
     NodeEventedObjectWrap* n = ObjectWrap::Unwrap<NodeEventedObjectWrap>(args.Holder());
     Nan::Set(Local<Object>::New(isolate, n->m_store), args[0], args[1]);
 }
+
+void NodeEventedObjectWrap::addBatchEventListener(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    if (args.Length() < 1 || !args[0]->IsFunction()) {
+        isolate->ThrowException(Exception::TypeError(
+            Nan::New("Wrong arguments").ToLocalChecked()));
+        return;
+    }
+    NodeEventedObjectWrap* n = ObjectWrap::Unwrap<NodeEventedObjectWrap>(args.Holder());
+    n->m_batchListener.Reset(isolate, Local<Function>::Cast(args[0]));
+}
+
+void NodeEventedObjectWrap::eventStats(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = Isolate::GetCurrent();
+    HandleScope scope(isolate);
+    NodeEventedObjectWrap* n = ObjectWrap::Unwrap<NodeEventedObjectWrap>(args.Holder());
+    Stats stats = n->NodeEventRegistry::eventStats();
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("delivered").ToLocalChecked(), Nan::New<Number>(stats.delivered));
+    Nan::Set(result, Nan::New("coalesced").ToLocalChecked(), Nan::New<Number>(stats.coalesced));
+    Nan::Set(result, Nan::New("batches").ToLocalChecked(), Nan::New<Number>(stats.batches));
+    args.GetReturnValue().Set(result);
+}
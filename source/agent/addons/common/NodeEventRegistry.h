@@ -5,24 +5,41 @@
 #ifndef NODEEVENTREGISTRY_H
 #define NODEEVENTREGISTRY_H
 
+#include "MpscRing.h"
 #include <EventRegistry.h>
+#include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <node.h>
 #include <node_object_wrap.h>
 #include <queue>
 #include <string>
+#include <vector>
 #include <uv.h>
 
 // Implement ::EventRegistry interface
+// Events from other threads go through a lock-free ring and are handled in
+// batches on the Node main thread, one uv wakeup for all events pending.
+// When the ring is full events wait in a locked overflow queue.
+// A batch listener gets all events of a wakeup in a single call.
 class NodeEventRegistry : public ::EventRegistry {
 public:
+    struct Stats {
+        uint64_t delivered;
+        // Events replaced by a later one of the same name before delivery.
+        uint64_t coalesced;
+        uint64_t batches;
+    };
+
     static NodeEventRegistry* New(v8::Isolate*, const v8::Local<v8::Function>&);
     static NodeEventRegistry* New(const v8::Local<v8::Function>&);
 
     virtual ~NodeEventRegistry();
     bool notifyAsyncEvent(const std::string& event, const std::string& data);
     bool notifyAsyncEventInEmergency(const std::string& event, const std::string& data);
+    bool notifyAsyncEventCoalesced(const std::string& event, const std::string& data);
+    Stats eventStats();
 
 protected:
     explicit NodeEventRegistry();
@@ -30,15 +47,41 @@ protected:
 
     struct Data {
         std::string event, message;
+        // Message is kept in m_coalesced until delivery.
+        bool coalesced = false;
     };
     v8::Persistent<v8::Object> m_store;
+    // Takes (events, payload, offsets) of a whole batch instead of m_store.
+    v8::Persistent<v8::Function> m_batchListener;
 
 private:
+    static const size_t kRingCapacity = 1024;
+
+    struct CoalescedEvent {
+        std::string message;
+        bool pending = false;
+    };
+
     uv_async_t* m_uvHandle;
+    MpscRing<Data, kRingCapacity> m_ring;
     std::mutex m_lock;
+    // Emergency events, delivered before those in the ring.
     std::deque<Data> m_buffer;
+    // Events which did not fit in the ring, delivered after those in it.
+    std::deque<Data> m_overflow;
+    // Set while m_overflow has events, later ones queue behind them.
+    std::atomic<bool> m_overflowing;
+    std::map<std::string, CoalescedEvent> m_coalesced;
+    std::atomic<uint64_t> m_delivered;
+    std::atomic<uint64_t> m_coalescedCount;
+    std::atomic<uint64_t> m_batches;
+
+    bool push(Data&& data);
     void process();
     void process(const Data& data);
+    // Delivers the batch in one call to m_batchListener.
+    void processBatch(const std::vector<Data>& datas);
+    bool hasStore();
     static void closeCallback(uv_handle_t*);
     static void callback(uv_async_t*);
 };
@@ -48,12 +91,16 @@ public:
     inline static void SETUP_EVENTED_PROTOTYPE_METHODS(v8::Local<v8::FunctionTemplate> tmpl)
     {
         NODE_SET_PROTOTYPE_METHOD(tmpl, "addEventListener", addEventListener);
+        NODE_SET_PROTOTYPE_METHOD(tmpl, "addBatchEventListener", addBatchEventListener);
+        NODE_SET_PROTOTYPE_METHOD(tmpl, "eventStats", eventStats);
     }
 
 protected:
     explicit NodeEventedObjectWrap();
     virtual ~NodeEventedObjectWrap();
     static void addEventListener(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void addBatchEventListener(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void eventStats(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif
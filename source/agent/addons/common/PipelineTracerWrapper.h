@@ -0,0 +1,43 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PIPELINETRACERWRAPPER_H
+#define PIPELINETRACERWRAPPER_H
+
+#include <PipelineTracer.h>
+#include <nan.h>
+
+/*
+ * Controls owt_base::PipelineTracer of this addon:
+ *   enablePipelineTracer(enabled, sampleInterval)
+ *   pipelineTracerStats() returns the per-stage histograms as a JSON string
+ *   exportPipelineTrace() returns the sampled spans in Chrome trace format
+ */
+inline NAN_METHOD(enablePipelineTracer)
+{
+    bool enabled = Nan::To<bool>(info[0]).FromMaybe(false);
+    uint32_t sampleInterval = Nan::To<uint32_t>(info[1]).FromMaybe(0);
+    owt_base::PipelineTracer::instance().enable(enabled, sampleInterval);
+}
+
+inline NAN_METHOD(pipelineTracerStats)
+{
+    std::string stats = owt_base::PipelineTracer::instance().statsJSON();
+    info.GetReturnValue().Set(Nan::New(stats).ToLocalChecked());
+}
+
+inline NAN_METHOD(exportPipelineTrace)
+{
+    std::string trace = owt_base::PipelineTracer::instance().exportChromeTrace();
+    info.GetReturnValue().Set(Nan::New(trace).ToLocalChecked());
+}
+
+inline void InitPipelineTracer(v8::Local<v8::Object> exports)
+{
+    Nan::SetMethod(exports, "enablePipelineTracer", enablePipelineTracer);
+    Nan::SetMethod(exports, "pipelineTracerStats", pipelineTracerStats);
+    Nan::SetMethod(exports, "exportPipelineTrace", exportPipelineTrace);
+}
+
+#endif
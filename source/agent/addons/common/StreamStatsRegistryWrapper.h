@@ -0,0 +1,43 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STREAMSTATSREGISTRYWRAPPER_H
+#define STREAMSTATSREGISTRYWRAPPER_H
+
+#include <StreamStatsRegistry.h>
+#include <nan.h>
+
+/*
+ * Exposes owt_base::StreamStatsRegistry of this addon as
+ * { buffer: SharedArrayBuffer, capacity, fields: { name: index } }.
+ * Field f of slot s is at new Uint32Array(buffer)[f * capacity + s].
+ * The buffer maps the registry memory, it is not a copy.
+ */
+inline NAN_METHOD(streamStatsRegistry)
+{
+    static Nan::Persistent<v8::Object> s_registry;
+    if (s_registry.IsEmpty()) {
+        owt_base::StreamStatsRegistry& registry = owt_base::StreamStatsRegistry::instance();
+        v8::Isolate* isolate = info.GetIsolate();
+        // The registry lives as long as the process, nothing to free.
+        std::shared_ptr<v8::BackingStore> store = v8::SharedArrayBuffer::NewBackingStore(
+            registry.data(), registry.size(), [](void*, size_t, void*) {}, nullptr);
+        v8::Local<v8::Object> result = Nan::New<v8::Object>();
+        v8::Local<v8::Object> fields = Nan::New<v8::Object>();
+        for (int field = 0; field < owt_base::StreamStatsRegistry::FIELD_COUNT; field++) {
+            Nan::Set(fields,
+                Nan::New(owt_base::StreamStatsRegistry::fieldName(
+                    static_cast<owt_base::StreamStatsRegistry::Field>(field))).ToLocalChecked(),
+                Nan::New(field));
+        }
+        Nan::Set(result, Nan::New("buffer").ToLocalChecked(), v8::SharedArrayBuffer::New(isolate, store));
+        Nan::Set(result, Nan::New("capacity").ToLocalChecked(),
+            Nan::New(owt_base::StreamStatsRegistry::kCapacity));
+        Nan::Set(result, Nan::New("fields").ToLocalChecked(), fields);
+        s_registry.Reset(result);
+    }
+    info.GetReturnValue().Set(Nan::New(s_registry));
+}
+
+#endif
@@ -4,6 +4,7 @@
     'sources': [
       'addon.cc',
       'MediaFrameMulticasterWrapper.cc',
+      '../../../core/owt_base/KeyFrameArbiter.cpp',
       '../../../core/owt_base/MediaFrameMulticaster.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/common/JobTimer.cpp',
@@ -0,0 +1,40 @@
+{
+  'targets': [{
+    'target_name': 'keyFrameArbiterTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/KeyFrameArbiterTest.cpp',
+      '../../../../core/owt_base/KeyFrameArbiter.cpp',
+      '../../../../core/owt_base/MediaFrameMulticaster.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../../core/common/JobTimer.cpp',
+    ],
+    'include_dirs': [
+        "<!(node -e \"require('nan')\")",
+        '../../common',
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-lboost_exception',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  }]
+}
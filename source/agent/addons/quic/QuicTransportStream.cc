@@ -20,6 +20,8 @@ Nan::Persistent<v8::Function> QuicTransportStream::s_constructor;
 
 const int uuidSizeInBytes = 16;
 const int frameHeaderSize = 4;
+// Stop reading from a stream that JavaScript does not consume, so QUIC flow control applies.
+const size_t maxPendingReadBytes = 4 * 1024 * 1024;
 
 QuicTransportStream::QuicTransportStream()
     : QuicTransportStream(nullptr)
@@ -44,6 +46,9 @@ QuicTransportStream::QuicTransportStream(owt::quic::WebTransportStreamInterface*
     , m_currentFrameSize(0)
     , m_receivedFrameOffset(0)
     , m_audioTimeStamp(0)
+    , m_sendScheduler(new StreamSendScheduler(this))
+    , m_readChunk(nullptr)
+    , m_pendingReadBytes(0)
 {
 }
 
@@ -59,6 +64,17 @@ QuicTransportStream::~QuicTransportStream()
         uv_close(reinterpret_cast<uv_handle_t*>(&m_asyncOnData), NULL);
     }
     m_stream->SetVisitor(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        for (auto& slice : m_pendingSlices) {
+            ReadBufferPool::instance().release(slice.chunk);
+        }
+        m_pendingSlices.clear();
+        if (m_readChunk) {
+            ReadBufferPool::instance().release(m_readChunk);
+            m_readChunk = nullptr;
+        }
+    }
     delete[] m_buffer;
     m_onDataCallback.Reset();
 }
@@ -76,7 +92,7 @@ void QuicTransportStream::OnCanRead()
 
 void QuicTransportStream::OnCanWrite()
 {
-    ELOG_DEBUG("On can write.");
+    m_sendScheduler->onCanWrite();
 }
 
 void QuicTransportStream::OnFinRead()
@@ -125,6 +141,7 @@ NAN_MODULE_INIT(QuicTransportStream::init)
     Nan::SetPrototypeMethod(tpl, "write", write);
     Nan::SetPrototypeMethod(tpl, "readTrackId", readTrackId);
     Nan::SetPrototypeMethod(tpl, "addDestination", addDestination);
+    Nan::SetPrototypeMethod(tpl, "getSendStats", getSendStats);
     Nan::SetAccessor(instanceTpl, Nan::New("trackKind").ToLocalChecked(), trackKindGetter, trackKindSetter);
     Nan::SetAccessor(instanceTpl, Nan::New("ondata").ToLocalChecked(), onDataGetter, onDataSetter);
 
@@ -209,9 +226,30 @@ NAN_METHOD(QuicTransportStream::readTrackId){
     obj->ReadTrackId();
 }
 
+NAN_METHOD(QuicTransportStream::getSendStats)
+{
+    QuicTransportStream* obj = Nan::ObjectWrap::Unwrap<QuicTransportStream>(info.Holder());
+    StreamSendScheduler::Stats stats = obj->m_sendScheduler->stats();
+    v8::Local<v8::Object> result = Nan::New<v8::Object>();
+    Nan::Set(result, Nan::New("bufferedBytes").ToLocalChecked(), Nan::New<v8::Number>(stats.bufferedBytes));
+    Nan::Set(result, Nan::New("bufferedFrames").ToLocalChecked(), Nan::New<v8::Number>(stats.bufferedFrames));
+    Nan::Set(result, Nan::New("droppedFrames").ToLocalChecked(), Nan::New<v8::Number>(stats.droppedFrames));
+    Nan::Set(result, Nan::New("droppedBytes").ToLocalChecked(), Nan::New<v8::Number>(stats.droppedBytes));
+    Nan::Set(result, Nan::New("droppedNonReferenceFrames").ToLocalChecked(), Nan::New<v8::Number>(stats.droppedNonReferenceFrames));
+    Nan::Set(result, Nan::New("droppedKeyFrames").ToLocalChecked(), Nan::New<v8::Number>(stats.droppedKeyFrames));
+    Nan::Set(result, Nan::New("droppedAudioFrames").ToLocalChecked(), Nan::New<v8::Number>(stats.droppedAudioFrames));
+    Nan::Set(result, Nan::New("drainRate").ToLocalChecked(), Nan::New<v8::Number>(stats.drainRateBps));
+    info.GetReturnValue().Set(result);
+}
+
 void QuicTransportStream::CheckReadableData()
 {
-    if (m_stream->ReadableBytes() > 0) {
+    bool hasPendingData = false;
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        hasPendingData = !m_pendingSlices.empty();
+    }
+    if (hasPendingData || m_stream->ReadableBytes() > 0) {
         SignalOnData();
     }
 }
@@ -307,18 +345,68 @@ NAUV_WORK_CB(QuicTransportStream::onData)
     }
     // TODO: Check m_onDataCallback instead of reading ondata.
     Nan::MaybeLocal<v8::Value> onEvent = Nan::Get(obj->handle(), Nan::New<v8::String>("ondata").ToLocalChecked());
-    if (!onEvent.IsEmpty()) {
-        v8::Local<v8::Value> onEventLocal = onEvent.ToLocalChecked();
-        if (onEventLocal->IsFunction()) {
-            v8::Local<v8::Function> eventCallback = onEventLocal.As<Function>();
-            Nan::AsyncResource* resource = new Nan::AsyncResource(Nan::New<v8::String>("ondata").ToLocalChecked());
-            auto readableBytes = obj->m_stream->ReadableBytes();
-            uint8_t* buffer = new uint8_t[readableBytes]; // Use a shared buffer instead to reduce performance cost on new.
-            obj->m_stream->Read(buffer, readableBytes);
-            Local<Value> args[] = { Nan::NewBuffer((char*)buffer, readableBytes).ToLocalChecked() };
-            resource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
+    if (onEvent.IsEmpty() || !onEvent.ToLocalChecked()->IsFunction()) {
+        // Keep pending data until ondata is set.
+        return;
+    }
+    v8::Local<v8::Function> eventCallback = onEvent.ToLocalChecked().As<Function>();
+    std::vector<ReadBufferPool::Slice> slices;
+    {
+        std::lock_guard<std::mutex> lock(obj->m_readMutex);
+        slices.swap(obj->m_pendingSlices);
+        obj->m_pendingReadBytes = 0;
+    }
+    if (!obj->m_asyncResource) {
+        obj->m_asyncResource.reset(new Nan::AsyncResource("QuicTransportStream"));
+    }
+    for (auto& slice : slices) {
+        // The Buffer takes over the slice's reference of the chunk.
+        Local<Value> args[] = { Nan::NewBuffer(reinterpret_cast<char*>(slice.chunk->data + slice.offset),
+            slice.length, &QuicTransportStream::FreeSlice, slice.chunk)
+                                    .ToLocalChecked() };
+        obj->m_asyncResource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
+    }
+    // Reading was paused when too much data was pending.
+    if (obj->m_stream->ReadableBytes() > 0) {
+        obj->ReadToPool();
+    }
+}
+
+void QuicTransportStream::FreeSlice(char* data, void* hint)
+{
+    ReadBufferPool::instance().release(reinterpret_cast<ReadBufferPool::Chunk*>(hint));
+}
+
+void QuicTransportStream::ReadToPool()
+{
+    ReadBufferPool& pool = ReadBufferPool::instance();
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        size_t readableBytes = m_stream->ReadableBytes();
+        while (readableBytes > 0 && m_pendingReadBytes < maxPendingReadBytes) {
+            if (!m_readChunk || m_readChunk->used == ReadBufferPool::kChunkSize) {
+                if (m_readChunk) {
+                    pool.release(m_readChunk);
+                }
+                m_readChunk = pool.acquire();
+            }
+            size_t offset = m_readChunk->used;
+            size_t readSize = std::min(readableBytes, ReadBufferPool::kChunkSize - offset);
+            m_stream->Read(m_readChunk->data + offset, readSize);
+            m_readChunk->used += readSize;
+            m_pendingReadBytes += readSize;
+            readableBytes -= readSize;
+            if (!m_pendingSlices.empty() && m_pendingSlices.back().chunk == m_readChunk
+                && m_pendingSlices.back().offset + m_pendingSlices.back().length == offset) {
+                m_pendingSlices.back().length += readSize;
+            } else {
+                pool.addRef(m_readChunk);
+                m_pendingSlices.push_back({ m_readChunk, offset, readSize });
+            }
         }
     }
+    m_asyncOnData.data = this;
+    uv_async_send(&m_asyncOnData);
 }
 
 NAUV_WORK_CB(QuicTransportStream::onTrackId){
@@ -332,9 +420,11 @@ NAUV_WORK_CB(QuicTransportStream::onTrackId){
         v8::Local<v8::Value> onEventLocal = onEvent.ToLocalChecked();
         if (onEventLocal->IsFunction()) {
             v8::Local<v8::Function> eventCallback = onEventLocal.As<Function>();
-            Nan::AsyncResource* resource = new Nan::AsyncResource(Nan::New<v8::String>("ontrackid").ToLocalChecked());
+            if (!obj->m_asyncResource) {
+                obj->m_asyncResource.reset(new Nan::AsyncResource("QuicTransportStream"));
+            }
             Local<Value> args[] = { Nan::CopyBuffer((char*)obj->m_trackId.data(), uuidSizeInBytes).ToLocalChecked() };
-            resource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
+            obj->m_asyncResource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
         }
     }
 }
@@ -351,9 +441,11 @@ NAUV_WORK_CB(QuicTransportStream::onContentSessionId)
         v8::Local<v8::Value> onEventLocal = onEvent.ToLocalChecked();
         if (onEventLocal->IsFunction()) {
             v8::Local<v8::Function> eventCallback = onEventLocal.As<Function>();
-            Nan::AsyncResource* resource = new Nan::AsyncResource(Nan::New<v8::String>("oncontentsessionid").ToLocalChecked());
+            if (!obj->m_asyncResource) {
+                obj->m_asyncResource.reset(new Nan::AsyncResource("QuicTransportStream"));
+            }
             Local<Value> args[] = { Nan::CopyBuffer((char*)obj->m_contentSessionId.data(), uuidSizeInBytes).ToLocalChecked() };
-            resource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
+            obj->m_asyncResource->runInAsyncScope(Nan::GetCurrentContext()->Global(), eventCallback, 1, args);
         }
     }
 }
@@ -361,8 +453,7 @@ NAUV_WORK_CB(QuicTransportStream::onContentSessionId)
 void QuicTransportStream::SignalOnData()
 {
     if (!m_isPiped) {
-        m_asyncOnData.data = this;
-        uv_async_send(&m_asyncOnData);
+        ReadToPool();
         return;
     }
 
@@ -412,6 +503,7 @@ void QuicTransportStream::SignalOnData()
             // Complete frame.
             if (m_receivedFrameOffset == m_currentFrameSize) {
                 owt_base::Frame frame;
+                memset(&frame, 0, sizeof(frame));
                 if (m_trackKind == "audio") {
                     frame.format = owt_base::FRAME_FORMAT_OPUS;
                     frame.timeStamp = m_audioTimeStamp;
@@ -439,6 +531,7 @@ void QuicTransportStream::SignalOnData()
                 ReallocateBuffer(readableBytes);
             }
             owt_base::Frame frame;
+            memset(&frame, 0, sizeof(frame));
             frame.format = owt_base::FRAME_FORMAT_DATA;
             frame.length = readableBytes;
             frame.payload = m_buffer;
@@ -467,12 +560,17 @@ void QuicTransportStream::onFeedback(const owt_base::FeedbackMsg&)
 
 void QuicTransportStream::onFrame(const owt_base::Frame& frame)
 {
-    size_t wrote = m_stream->Write(frame.payload, frame.length);
-    if (wrote != frame.length) {
-        // TODO: Implement back pressure.
-        // https://github.com/open-webrtc-toolkit/owt-server/issues/1220
-        ELOG_WARN("Failed to write a frame. This frame is dropped.");
-    }
+    m_sendScheduler->send(frame);
+}
+
+size_t QuicTransportStream::writeToStream(const uint8_t* data, size_t length)
+{
+    return m_stream->Write(data, length);
+}
+
+void QuicTransportStream::sendFeedback(const owt_base::FeedbackMsg& msg)
+{
+    deliverFeedbackMsg(msg);
 }
 
 void QuicTransportStream::onVideoSourceChanged()
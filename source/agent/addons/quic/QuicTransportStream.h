@@ -9,13 +9,16 @@
 
 #include "../../core/owt_base/MediaFramePipeline.h"
 #include "../common/MediaFramePipelineWrapper.h"
+#include "ReadBufferPool.h"
+#include "StreamSendScheduler.h"
 #include "owt/quic/web_transport_stream_interface.h"
 #include <logger.h>
+#include <memory>
 #include <mutex>
 #include <nan.h>
 #include <string>
 
-class QuicTransportStream : public owt_base::FrameSource, public owt_base::FrameDestination, public NanFrameNode, public owt::quic::WebTransportStreamInterface::Visitor {
+class QuicTransportStream : public owt_base::FrameSource, public owt_base::FrameDestination, public NanFrameNode, public owt::quic::WebTransportStreamInterface::Visitor, public StreamSendScheduler::Visitor {
     DECLARE_LOGGER();
 
 public:
@@ -39,6 +42,8 @@ public:
     // Read 128 bits after content session ID. Only media streams have track ID. Result will be returned by onData callback.
     // TODO: Make this as an async method when it's supported.
     static NAN_METHOD(readTrackId);
+    // Returns buffered bytes and drop counters of media frames sent to this stream.
+    static NAN_METHOD(getSendStats);
 
     static NAN_GETTER(trackKindGetter);
     static NAN_SETTER(trackKindSetter);
@@ -57,6 +62,10 @@ public:
     void onFrame(const owt_base::Frame&) override;
     void onVideoSourceChanged() override;
 
+    // Overrides StreamSendScheduler::Visitor.
+    size_t writeToStream(const uint8_t* data, size_t length) override;
+    void sendFeedback(const owt_base::FeedbackMsg&) override;
+
     // Overrides NanFrameNode.
     owt_base::FrameSource* FrameSource() override { return this; }
     owt_base::FrameDestination* FrameDestination() override { return this; }
@@ -79,6 +88,9 @@ private:
     void ReadContentSessionId();
     void ReadTrackId();
     void SignalOnData();
+    // Reads data of a stream which is not piped into pooled chunks for JavaScript.
+    void ReadToPool();
+    static void FreeSlice(char* data, void* hint);
     void ReallocateBuffer(size_t size);
     // Check whether there is readable data. If so, fire ondata event.
     void CheckReadableData();
@@ -110,10 +122,19 @@ private:
     size_t m_receivedFrameOffset;
     // TODO: Using wall clock timestamps seems not working. Using an increasing sequence instead. Fix it later.
     uint32_t m_audioTimeStamp;
+    std::unique_ptr<StreamSendScheduler> m_sendScheduler;
 
     uv_async_t m_asyncOnContentSessionId;
     uv_async_t m_asyncOnTrackId;
     uv_async_t m_asyncOnData;
+    std::unique_ptr<Nan::AsyncResource> m_asyncResource;
+
+    std::mutex m_readMutex;
+    ReadBufferPool::Chunk* m_readChunk;
+    // Data read but not delivered to JavaScript yet. Multiple reads between two
+    // onData callbacks are delivered together.
+    std::vector<ReadBufferPool::Slice> m_pendingSlices;
+    size_t m_pendingReadBytes;
 };
 
 #endif
\ No newline at end of file
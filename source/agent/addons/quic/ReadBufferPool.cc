@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ReadBufferPool.h"
+
+ReadBufferPool& ReadBufferPool::instance()
+{
+    static ReadBufferPool pool;
+    return pool;
+}
+
+ReadBufferPool::~ReadBufferPool()
+{
+    for (Chunk* chunk : m_freeChunks) {
+        delete chunk;
+    }
+}
+
+ReadBufferPool::Chunk* ReadBufferPool::acquire()
+{
+    Chunk* chunk = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_freeChunks.empty()) {
+            chunk = m_freeChunks.back();
+            m_freeChunks.pop_back();
+        }
+    }
+    if (!chunk) {
+        chunk = new Chunk();
+    }
+    chunk->used = 0;
+    chunk->refs.store(1);
+    return chunk;
+}
+
+void ReadBufferPool::addRef(Chunk* chunk)
+{
+    chunk->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReadBufferPool::release(Chunk* chunk)
+{
+    if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_freeChunks.size() < kMaxFreeChunks) {
+            m_freeChunks.push_back(chunk);
+            return;
+        }
+    }
+    delete chunk;
+}
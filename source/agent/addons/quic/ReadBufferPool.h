@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef QUIC_READBUFFERPOOL_H_
+#define QUIC_READBUFFERPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Process-wide pool of fixed size chunks that stream data is read into.
+// JavaScript gets Buffers pointing into a chunk, each of them holds a
+// reference which is released by the Buffer's free callback. A chunk goes
+// back to the pool when its writer and all Buffers are done with it.
+class ReadBufferPool {
+public:
+    static const size_t kChunkSize = 64 * 1024;
+
+    struct Chunk {
+        uint8_t data[kChunkSize];
+        // Bytes filled by the writer.
+        size_t used = 0;
+        std::atomic<int> refs { 0 };
+    };
+
+    // A contiguous piece of a chunk, holds one reference of the chunk.
+    struct Slice {
+        Chunk* chunk;
+        size_t offset;
+        size_t length;
+    };
+
+    static ReadBufferPool& instance();
+
+    // Returns a chunk with one reference held by the caller.
+    Chunk* acquire();
+    void addRef(Chunk*);
+    void release(Chunk*);
+
+private:
+    ReadBufferPool() = default;
+    ~ReadBufferPool();
+
+    // Chunks retained for reuse, more are freed.
+    static const size_t kMaxFreeChunks = 64;
+
+    std::mutex m_mutex;
+    std::vector<Chunk*> m_freeChunks;
+};
+
+#endif
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "StreamSendScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+DEFINE_LOGGER(StreamSendScheduler, "StreamSendScheduler");
+
+const int StreamSendScheduler::kDefaultLatencyBudgetMs;
+const size_t StreamSendScheduler::kMaxBufferedBytes;
+
+const size_t frameHeaderSize = 4;
+// Minimal interval between two feedbacks of the same kind.
+const int64_t kKeyFrameRequestIntervalMs = 1000;
+const int64_t kBitrateFeedbackIntervalMs = 1000;
+const int64_t kDrainRateWindowMs = 500;
+
+StreamSendScheduler::StreamSendScheduler(Visitor* visitor, int latencyBudgetMs)
+    : m_visitor(visitor)
+    , m_latencyBudgetMs(latencyBudgetMs)
+    , m_bufferedBytes(0)
+    , m_waitingForKeyFrame(false)
+    , m_lastKeyFrameRequestMs(-kKeyFrameRequestIntervalMs)
+    , m_lastBitrateFeedbackMs(-kBitrateFeedbackIntervalMs)
+    , m_drainWindowStartMs(-1)
+    , m_drainedBytes(0)
+    , m_drainRateBps(0)
+    , m_congested(false)
+{
+}
+
+int64_t StreamSendScheduler::currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+StreamSendScheduler::Priority StreamSendScheduler::framePriority(const owt_base::Frame& frame)
+{
+    if (owt_base::isAudioFrame(frame)) {
+        return Priority::kAudio;
+    }
+    if (!owt_base::isVideoFrame(frame)) {
+        return Priority::kData;
+    }
+    if (frame.additionalInfo.video.isKeyFrame) {
+        return Priority::kKeyFrame;
+    }
+    if (frame.format != owt_base::FRAME_FORMAT_H264 && frame.format != owt_base::FRAME_FORMAT_H265) {
+        return Priority::kDelta;
+    }
+    // Check the first VCL NAL unit for a non-reference picture.
+    const uint8_t* data = frame.payload;
+    for (uint32_t i = 0; i + 3 < frame.length; i++) {
+        if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+            continue;
+        }
+        uint8_t header = data[i + 3];
+        if (frame.format == owt_base::FRAME_FORMAT_H264) {
+            int type = header & 0x1F;
+            if (type >= 1 && type <= 5) {
+                return ((header >> 5) & 0x03) == 0 ? Priority::kNonReference : Priority::kDelta;
+            }
+        } else {
+            int type = (header >> 1) & 0x3F;
+            if (type < 32) {
+                // Sub-layer non-reference pictures have even types below 16.
+                return (type < 16 && type % 2 == 0) ? Priority::kNonReference : Priority::kDelta;
+            }
+        }
+        i += 2;
+    }
+    return Priority::kDelta;
+}
+
+void StreamSendScheduler::send(const owt_base::Frame& frame)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t now = currentTimeMs();
+    Priority priority = framePriority(frame);
+    if (priority == Priority::kKeyFrame) {
+        m_waitingForKeyFrame = false;
+    } else if (m_waitingForKeyFrame && priority < Priority::kKeyFrame) {
+        countDrop(priority, frame.length);
+        // The request or the key frame may have been lost
+        requestKeyFrameIfNeeded(now);
+        return;
+    }
+
+    uint8_t header[frameHeaderSize];
+    size_t headerLength = 0;
+    if (priority != Priority::kData) {
+        uint32_t payloadSize(frame.length);
+        for (int i = frameHeaderSize - 1; i >= 0; i--) {
+            header[i] = payloadSize & 0xFF;
+            payloadSize >>= 8;
+        }
+        headerLength = frameHeaderSize;
+    }
+
+    flush(now);
+    if (!m_queue.empty()) {
+        enqueue(priority, header, headerLength, frame.payload, frame.length, 0, now);
+        shed(now);
+        return;
+    }
+
+    // Write directly without copying when nothing is buffered.
+    size_t wrote = headerLength ? m_visitor->writeToStream(header, headerLength) : 0;
+    if (wrote == headerLength) {
+        wrote += m_visitor->writeToStream(frame.payload, frame.length);
+    }
+    m_drainedBytes += wrote;
+    if (wrote < headerLength + frame.length) {
+        m_congested = true;
+        enqueue(priority, header, headerLength, frame.payload, frame.length, wrote, now);
+    }
+    updateDrainRate(now);
+}
+
+void StreamSendScheduler::onCanWrite()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t now = currentTimeMs();
+    flush(now);
+    updateDrainRate(now);
+}
+
+void StreamSendScheduler::setLatencyBudget(int latencyBudgetMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_latencyBudgetMs = latencyBudgetMs;
+}
+
+StreamSendScheduler::Stats StreamSendScheduler::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.bufferedBytes = m_bufferedBytes;
+    stats.bufferedFrames = m_queue.size();
+    stats.drainRateBps = m_drainRateBps;
+    return stats;
+}
+
+void StreamSendScheduler::flush(int64_t nowMs)
+{
+    while (!m_queue.empty()) {
+        QueuedFrame& frame = m_queue.front();
+        size_t remaining = frame.data.size() - frame.offset;
+        size_t wrote = m_visitor->writeToStream(frame.data.data() + frame.offset, remaining);
+        frame.offset += wrote;
+        m_bufferedBytes -= wrote;
+        m_drainedBytes += wrote;
+        if (wrote < remaining) {
+            m_congested = true;
+            break;
+        }
+        m_queue.pop_front();
+    }
+}
+
+void StreamSendScheduler::enqueue(Priority priority, const uint8_t* header, size_t headerLength,
+    const uint8_t* payload, size_t payloadLength, size_t offset, int64_t nowMs)
+{
+    m_queue.emplace_back();
+    QueuedFrame& frame = m_queue.back();
+    frame.priority = priority;
+    frame.enqueueTimeMs = nowMs;
+    frame.data.reserve(headerLength + payloadLength);
+    frame.data.insert(frame.data.end(), header, header + headerLength);
+    frame.data.insert(frame.data.end(), payload, payload + payloadLength);
+    frame.offset = offset;
+    m_bufferedBytes += frame.data.size() - offset;
+}
+
+template <typename Predicate>
+bool StreamSendScheduler::dropUntil(size_t target, Predicate shouldDrop)
+{
+    bool dropped = false;
+    for (auto it = m_queue.begin(); it != m_queue.end() && m_bufferedBytes > target;) {
+        if (it->offset == 0 && shouldDrop(*it)) {
+            m_bufferedBytes -= it->data.size();
+            countDrop(it->priority, it->data.size());
+            it = m_queue.erase(it);
+            dropped = true;
+        } else {
+            ++it;
+        }
+    }
+    return dropped;
+}
+
+void StreamSendScheduler::shed(int64_t nowMs)
+{
+    bool overBudget = nowMs - m_queue.front().enqueueTimeMs > m_latencyBudgetMs;
+    bool overCapacity = m_bufferedBytes > kMaxBufferedBytes;
+    if (!overBudget && !overCapacity) {
+        return;
+    }
+    // Keep what the stream drains within the budget, unknown rate means nothing.
+    size_t target = std::min<size_t>(
+        static_cast<uint64_t>(m_drainRateBps) * m_latencyBudgetMs / 8000, kMaxBufferedBytes);
+
+    bool dropped = dropUntil(target, [](const QueuedFrame& f) {
+        return f.priority == Priority::kNonReference;
+    });
+    if (m_bufferedBytes > target) {
+        bool droppedReference = dropUntil(0, [](const QueuedFrame& f) {
+            return f.priority == Priority::kDelta;
+        });
+        if (droppedReference) {
+            m_waitingForKeyFrame = true;
+            dropped = true;
+        }
+    }
+    if (m_bufferedBytes > kMaxBufferedBytes) {
+        ELOG_WARN("Send buffer is full, dropping key frames and audio.");
+        bool droppedKeyFrame = false;
+        dropUntil(kMaxBufferedBytes, [&droppedKeyFrame](const QueuedFrame& f) {
+            droppedKeyFrame |= (f.priority == Priority::kKeyFrame);
+            return f.priority != Priority::kData;
+        });
+        if (droppedKeyFrame) {
+            m_waitingForKeyFrame = true;
+        }
+        dropped = true;
+    }
+    if (!dropped) {
+        return;
+    }
+
+    if (nowMs - m_lastBitrateFeedbackMs >= kBitrateFeedbackIntervalMs && m_drainRateBps > 0) {
+        m_lastBitrateFeedbackMs = nowMs;
+        owt_base::FeedbackMsg msg(owt_base::VIDEO_FEEDBACK, owt_base::SET_BITRATE);
+        msg.data.kbps = std::min<uint32_t>(m_drainRateBps / 1000, UINT16_MAX);
+        ELOG_DEBUG("Congested, set bitrate to %u kbps.", msg.data.kbps);
+        m_visitor->sendFeedback(msg);
+    }
+    requestKeyFrameIfNeeded(nowMs);
+}
+
+void StreamSendScheduler::requestKeyFrameIfNeeded(int64_t nowMs)
+{
+    if (m_waitingForKeyFrame && nowMs - m_lastKeyFrameRequestMs >= kKeyFrameRequestIntervalMs) {
+        m_lastKeyFrameRequestMs = nowMs;
+        owt_base::FeedbackMsg msg(owt_base::VIDEO_FEEDBACK, owt_base::REQUEST_KEY_FRAME);
+        ELOG_DEBUG("Reference frames dropped, request key frame.");
+        m_visitor->sendFeedback(msg);
+    }
+}
+
+void StreamSendScheduler::countDrop(Priority priority, size_t bytes)
+{
+    m_stats.droppedFrames++;
+    m_stats.droppedBytes += bytes;
+    if (priority == Priority::kNonReference) {
+        m_stats.droppedNonReferenceFrames++;
+    } else if (priority == Priority::kKeyFrame) {
+        m_stats.droppedKeyFrames++;
+    } else if (priority == Priority::kAudio) {
+        m_stats.droppedAudioFrames++;
+    }
+}
+
+void StreamSendScheduler::updateDrainRate(int64_t nowMs)
+{
+    if (m_drainWindowStartMs < 0) {
+        m_drainWindowStartMs = nowMs;
+        return;
+    }
+    int64_t elapsed = nowMs - m_drainWindowStartMs;
+    if (elapsed < kDrainRateWindowMs) {
+        return;
+    }
+    uint32_t rate = m_drainedBytes * 8000 / elapsed;
+    if (m_congested) {
+        m_drainRateBps = m_drainRateBps ? (m_drainRateBps * 7 + rate * 3) / 10 : rate;
+    } else {
+        // Without backpressure the rate is limited by the sender, only a lower bound.
+        m_drainRateBps = std::max(m_drainRateBps, rate);
+    }
+    m_drainedBytes = 0;
+    m_congested = false;
+    m_drainWindowStartMs = nowMs;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef QUIC_STREAMSENDSCHEDULER_H_
+#define QUIC_STREAMSENDSCHEDULER_H_
+
+#include "../../core/owt_base/MediaFramePipeline.h"
+#include <deque>
+#include <logger.h>
+#include <mutex>
+#include <vector>
+
+// Sends frames to a WebTransport stream with backpressure. Frames the stream
+// can not take are buffered and flushed on OnCanWrite. When the oldest
+// buffered frame exceeds the latency budget, unsent video frames are dropped,
+// non-reference frames first, and the encoder is asked for a lower bitrate or
+// a key frame. Audio, key frames and data are only dropped when the buffer is
+// full. A frame partially written to the stream is never dropped, so the
+// length-prefixed framing stays intact.
+class StreamSendScheduler {
+    DECLARE_LOGGER();
+
+public:
+    class Visitor {
+    public:
+        virtual ~Visitor() = default;
+        // Writes to the stream, returns the number of bytes accepted.
+        virtual size_t writeToStream(const uint8_t* data, size_t length) = 0;
+        // Feedback for the encoder of this stream.
+        virtual void sendFeedback(const owt_base::FeedbackMsg&) = 0;
+    };
+
+    struct Stats {
+        size_t bufferedBytes = 0;
+        size_t bufferedFrames = 0;
+        uint64_t droppedFrames = 0;
+        uint64_t droppedBytes = 0;
+        uint64_t droppedNonReferenceFrames = 0;
+        uint64_t droppedKeyFrames = 0;
+        uint64_t droppedAudioFrames = 0;
+        uint32_t drainRateBps = 0;
+    };
+
+    // Droppable frames have lower values.
+    enum class Priority {
+        kNonReference = 0,
+        kDelta,
+        kKeyFrame,
+        kAudio,
+        kData,
+    };
+
+    static const int kDefaultLatencyBudgetMs = 300;
+    static const size_t kMaxBufferedBytes = 8 * 1024 * 1024;
+
+    explicit StreamSendScheduler(Visitor* visitor, int latencyBudgetMs = kDefaultLatencyBudgetMs);
+    virtual ~StreamSendScheduler() = default;
+
+    // Media frames are prefixed with a 4 bytes size header, data frames are written as is.
+    void send(const owt_base::Frame&);
+    // Flushes buffered frames, called when the stream becomes writable.
+    void onCanWrite();
+    void setLatencyBudget(int latencyBudgetMs);
+    Stats stats();
+
+    static Priority framePriority(const owt_base::Frame&);
+
+protected:
+    virtual int64_t currentTimeMs();
+
+private:
+    struct QueuedFrame {
+        Priority priority;
+        int64_t enqueueTimeMs;
+        std::vector<uint8_t> data;
+        size_t offset;
+    };
+
+    void flush(int64_t nowMs);
+    void enqueue(Priority, const uint8_t* header, size_t headerLength,
+        const uint8_t* payload, size_t payloadLength, size_t offset, int64_t nowMs);
+    void shed(int64_t nowMs);
+    // Asks for a key frame while waiting for one, at most once per interval.
+    void requestKeyFrameIfNeeded(int64_t nowMs);
+    // Drops unsent frames matching `shouldDrop` until buffered bytes are under `target`.
+    template <typename Predicate>
+    bool dropUntil(size_t target, Predicate shouldDrop);
+    void countDrop(Priority, size_t bytes);
+    void updateDrainRate(int64_t nowMs);
+
+    Visitor* m_visitor;
+    int m_latencyBudgetMs;
+
+    std::mutex m_mutex;
+    std::deque<QueuedFrame> m_queue;
+    size_t m_bufferedBytes;
+    // A reference frame was dropped, delta frames are useless until next key frame.
+    bool m_waitingForKeyFrame;
+    int64_t m_lastKeyFrameRequestMs;
+    int64_t m_lastBitrateFeedbackMs;
+
+    int64_t m_drainWindowStartMs;
+    uint64_t m_drainedBytes;
+    uint32_t m_drainRateBps;
+    // The stream did not take all the data in current window.
+    bool m_congested;
+
+    Stats m_stats;
+};
+
+#endif
@@ -53,6 +53,7 @@ void VideoRtpPacketizer::onAdapterStats(const rtc_adapter::AdapterStats& stats)
 void VideoRtpPacketizer::onAdapterData(char* data, int len)
 {
     owt_base::Frame frame;
+    memset(&frame, 0, sizeof(frame));
     frame.format = owt_base::FRAME_FORMAT_RTP;
     frame.length = len;
     frame.payload = reinterpret_cast<uint8_t*>(data);
@@ -180,6 +180,11 @@ void WebTransportFrameDestination::onVideoSourceChanged() { }
 
 void WebTransportFrameDestination::onFeedback(const owt_base::FeedbackMsg& feedback)
 {
+    // Feedbacks from stream outputs go to the encoder.
+    if (!m_isDatagram) {
+        deliverFeedbackMsg(feedback);
+        return;
+    }
     // TODO: RTCP packet could be for audio. Sending to audio packetizer when audio support is added.
     if (!m_videoRtpPacketizer) {
         ELOG_WARN("RTP packetizer is not available.");
@@ -208,18 +213,6 @@ void WebTransportFrameDestination::DispatchMediaFrame(const owt_base::Frame& fra
         ELOG_ERROR("Unknown frame type.");
         return;
     }
-    // Write header. 4 bytes for the size of the body.
-    uint32_t payloadSize(frame.length);
-    uint8_t* buffer = new uint8_t[4];
-    for (int i = 0; i < 4; i++) {
-        buffer[3 - i] = payloadSize & 0xFF;
-        payloadSize >>= 8;
-    }
-    owt_base::Frame header;
-    header.format = owt_base::FRAME_FORMAT_DATA;
-    header.length = 4;
-    header.payload = buffer;
-    dest->onFrame(header);
-    // Write body.
+    // The stream output writes the size header and schedules the frame.
     dest->onFrame(frame);
-}
\ No newline at end of file
+}
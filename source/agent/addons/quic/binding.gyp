@@ -10,13 +10,17 @@
       'QuicTransportServer.cc',
       'QuicTransportConnection.cc',
       'QuicTransportStream.cc',
+      'ReadBufferPool.cc',
+      'StreamSendScheduler.cc',
       'WebTransportFrameSource.cc',
       'WebTransportFrameDestination.cc',
       'VideoRtpPacketizer.cc',
       'RtpFactory.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/KeyFrameArbiter.cpp',
       '../../../core/owt_base/MediaFrameMulticaster.cpp',
       '../../../core/owt_base/Utils.cc',
+      '../../../core/common/JobTimer.cpp',
     ],
     'defines':[
       'OWT_ENABLE_QUIC=1',
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Measures how many messages per second the signaling/data path delivers to
+// JavaScript. Start this script, then open OnDataBenchmarkClient.html in a
+// browser with WebTransport support on the same host. The client sends
+// fixed size messages over a stream with content session ID 0, which is not
+// piped and goes through QuicTransportStream's ondata.
+//
+// node OnDataBenchmark.js -p 7700 -c cert.pfx -w password -s 256 -d 30
+
+'use strict';
+const Getopt = require('node-getopt');
+const addon = require('../build/Release/quic');
+
+const opt = new Getopt([
+  ['p', 'port=ARG', 'Listening port, default 7700.'],
+  ['c', 'cert=ARG', 'Path of the PFX certificate.'],
+  ['w', 'password=ARG', 'Password of the certificate.'],
+  ['s', 'size=ARG', 'Message size in bytes sent by the client, default 256.'],
+  ['d', 'duration=ARG', 'Seconds to measure after the first message, default 30.'],
+  ['h', 'help', 'Display this help.'],
+]).bindHelp().parseSystem();
+
+const port = parseInt(opt.options.port || '7700');
+const messageSize = parseInt(opt.options.size || '256');
+const duration = parseInt(opt.options.duration || '30') * 1000;
+
+const server = new addon.QuicTransportServer(
+    port, opt.options.cert || '', opt.options.password || '');
+const connections = [];
+const streams = [];
+
+let callbacks = 0;
+let bytes = 0;
+let startTime = 0;
+let lastCallbacks = 0;
+let lastBytes = 0;
+
+function report(final) {
+  const now = Date.now();
+  const seconds = (now - startTime) / 1000;
+  const tag = final ? 'Total' : 'Current';
+  const interval = final ? { callbacks, bytes } :
+      { callbacks: callbacks - lastCallbacks, bytes: bytes - lastBytes };
+  const intervalSeconds = final ? seconds : 1;
+  console.log(`${tag}: ${(interval.bytes / messageSize / intervalSeconds).toFixed(0)} messages/s, ` +
+      `${(interval.callbacks / intervalSeconds).toFixed(0)} ondata calls/s, ` +
+      `${(interval.bytes * 8 / intervalSeconds / 1e6).toFixed(2)} Mbps`);
+  lastCallbacks = callbacks;
+  lastBytes = bytes;
+}
+
+server.onconnection = (connection) => {
+  connections.push(connection);
+  connection.onincomingstream = (stream) => {
+    streams.push(stream);
+    stream.ondata = (data) => {
+      if (!startTime) {
+        startTime = Date.now();
+        const timer = setInterval(() => report(false), 1000);
+        setTimeout(() => {
+          clearInterval(timer);
+          report(true);
+          server.stop();
+          process.exit(0);
+        }, duration);
+      }
+      callbacks++;
+      bytes += data.length;
+    };
+  };
+};
+
+server.start();
+console.log(`Listening on ${port}, waiting for the client.`);
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE StreamSendScheduler
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include "../StreamSendScheduler.h"
+
+// Stream which accepts a limited number of bytes until more credit is given.
+class FakeStream : public StreamSendScheduler::Visitor {
+public:
+    size_t writeToStream(const uint8_t* data, size_t length) override
+    {
+        size_t wrote = std::min(length, m_credit);
+        written.insert(written.end(), data, data + wrote);
+        m_credit -= wrote;
+        return wrote;
+    }
+    void sendFeedback(const owt_base::FeedbackMsg& msg) override
+    {
+        feedbacks.push_back(msg.cmd);
+    }
+    void setCredit(size_t credit) { m_credit = credit; }
+
+    // Splits written bytes into frame bodies by the size header.
+    std::vector<std::vector<uint8_t>> frames()
+    {
+        std::vector<std::vector<uint8_t>> result;
+        size_t pos = 0;
+        while (pos + 4 <= written.size()) {
+            uint32_t size = (written[pos] << 24) | (written[pos + 1] << 16) | (written[pos + 2] << 8) | written[pos + 3];
+            pos += 4;
+            result.emplace_back(written.begin() + pos, written.begin() + pos + size);
+            pos += size;
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> written;
+    std::vector<owt_base::FeedbackCmd> feedbacks;
+
+private:
+    size_t m_credit = SIZE_MAX;
+};
+
+class TestScheduler : public StreamSendScheduler {
+public:
+    TestScheduler(Visitor* visitor)
+        : StreamSendScheduler(visitor, 100)
+    {
+    }
+    int64_t now = 0;
+
+protected:
+    int64_t currentTimeMs() override { return now; }
+};
+
+// H.264 frame with a single slice, `nalHeader` carries nal_ref_idc and type.
+static std::vector<uint8_t> h264Payload(uint8_t nalHeader, uint8_t id, size_t size)
+{
+    std::vector<uint8_t> payload(size, id);
+    payload[0] = 0;
+    payload[1] = 0;
+    payload[2] = 1;
+    payload[3] = nalHeader;
+    return payload;
+}
+
+static owt_base::Frame h264Frame(std::vector<uint8_t>& payload, bool keyFrame)
+{
+    owt_base::Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_H264;
+    frame.payload = payload.data();
+    frame.length = payload.size();
+    frame.additionalInfo.video.isKeyFrame = keyFrame;
+    return frame;
+}
+
+BOOST_AUTO_TEST_CASE(classifyFrames)
+{
+    std::vector<uint8_t> idr = h264Payload(0x65, 0, 16);
+    std::vector<uint8_t> ref = h264Payload(0x41, 0, 16);
+    std::vector<uint8_t> nonRef = h264Payload(0x01, 0, 16);
+    BOOST_CHECK(StreamSendScheduler::framePriority(h264Frame(idr, true)) == StreamSendScheduler::Priority::kKeyFrame);
+    BOOST_CHECK(StreamSendScheduler::framePriority(h264Frame(ref, false)) == StreamSendScheduler::Priority::kDelta);
+    BOOST_CHECK(StreamSendScheduler::framePriority(h264Frame(nonRef, false)) == StreamSendScheduler::Priority::kNonReference);
+}
+
+BOOST_AUTO_TEST_CASE(bufferAndResumeOnCanWrite)
+{
+    FakeStream stream;
+    TestScheduler scheduler(&stream);
+    std::vector<uint8_t> key = h264Payload(0x65, 1, 100);
+    std::vector<uint8_t> delta = h264Payload(0x41, 2, 100);
+
+    stream.setCredit(50);
+    scheduler.send(h264Frame(key, true));
+    scheduler.send(h264Frame(delta, false));
+    BOOST_CHECK_EQUAL(scheduler.stats().bufferedBytes, 2 * 104 - 50);
+    BOOST_CHECK_EQUAL(scheduler.stats().bufferedFrames, 2);
+
+    stream.setCredit(SIZE_MAX);
+    scheduler.onCanWrite();
+    BOOST_CHECK_EQUAL(scheduler.stats().bufferedBytes, 0);
+    auto frames = stream.frames();
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK(frames[0] == key);
+    BOOST_CHECK(frames[1] == delta);
+    BOOST_CHECK_EQUAL(scheduler.stats().droppedFrames, 0);
+}
+
+BOOST_AUTO_TEST_CASE(dropNonReferenceFirst)
+{
+    FakeStream stream;
+    TestScheduler scheduler(&stream);
+    std::vector<uint8_t> key = h264Payload(0x65, 1, 100);
+    std::vector<uint8_t> ref = h264Payload(0x41, 2, 100);
+    std::vector<uint8_t> nonRef = h264Payload(0x01, 3, 100);
+
+    // The key frame is partially written and must survive.
+    stream.setCredit(10);
+    scheduler.send(h264Frame(key, true));
+    scheduler.send(h264Frame(nonRef, false));
+    scheduler.send(h264Frame(ref, false));
+    BOOST_CHECK_EQUAL(scheduler.stats().droppedFrames, 0);
+
+    scheduler.now = 200;
+    scheduler.send(h264Frame(nonRef, false));
+    auto stats = scheduler.stats();
+    BOOST_CHECK_EQUAL(stats.droppedNonReferenceFrames, 2);
+    BOOST_CHECK_EQUAL(stats.droppedKeyFrames, 0);
+    // Nothing has drained, so reference frames go too and a key frame is requested.
+    BOOST_CHECK_EQUAL(stats.droppedFrames, 3);
+    BOOST_REQUIRE_EQUAL(stream.feedbacks.size(), 1);
+    BOOST_CHECK_EQUAL(stream.feedbacks[0], owt_base::REQUEST_KEY_FRAME);
+
+    // Delta frames are dropped until the next key frame.
+    scheduler.send(h264Frame(ref, false));
+    BOOST_CHECK_EQUAL(scheduler.stats().droppedFrames, 4);
+    std::vector<uint8_t> nextKey = h264Payload(0x65, 4, 100);
+    scheduler.send(h264Frame(nextKey, true));
+    BOOST_CHECK_EQUAL(scheduler.stats().droppedFrames, 4);
+
+    stream.setCredit(SIZE_MAX);
+    scheduler.onCanWrite();
+    auto frames = stream.frames();
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK(frames[0] == key);
+    BOOST_CHECK(frames[1] == nextKey);
+}
+
+BOOST_AUTO_TEST_CASE(repeatKeyFrameRequest)
+{
+    FakeStream stream;
+    TestScheduler scheduler(&stream);
+    std::vector<uint8_t> key = h264Payload(0x65, 1, 100);
+    std::vector<uint8_t> ref = h264Payload(0x41, 2, 100);
+
+    stream.setCredit(10);
+    scheduler.send(h264Frame(key, true));
+    scheduler.send(h264Frame(ref, false));
+    scheduler.now = 200;
+    scheduler.send(h264Frame(ref, false));
+    BOOST_REQUIRE_EQUAL(stream.feedbacks.size(), 1);
+
+    // No key frame comes, ask again once per interval while delta frames are dropped.
+    scheduler.now = 700;
+    scheduler.send(h264Frame(ref, false));
+    BOOST_CHECK_EQUAL(stream.feedbacks.size(), 1);
+    scheduler.now = 1200;
+    scheduler.send(h264Frame(ref, false));
+    BOOST_REQUIRE_EQUAL(stream.feedbacks.size(), 2);
+    BOOST_CHECK_EQUAL(stream.feedbacks[1], owt_base::REQUEST_KEY_FRAME);
+
+    std::vector<uint8_t> nextKey = h264Payload(0x65, 3, 100);
+    scheduler.send(h264Frame(nextKey, true));
+    stream.setCredit(SIZE_MAX);
+    scheduler.onCanWrite();
+    scheduler.now = 2400;
+    scheduler.send(h264Frame(ref, false));
+    BOOST_CHECK_EQUAL(stream.feedbacks.size(), 2);
+}
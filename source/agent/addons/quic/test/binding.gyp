@@ -0,0 +1,24 @@
+{
+  'targets': [{
+    'target_name': 'streamSendSchedulerTest',
+    'type': 'executable',
+    'sources': [
+      'StreamSendSchedulerTest.cc',
+      '../StreamSendScheduler.cc',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }]
+}
@@ -0,0 +1,94 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DatagramChannel.h"
+
+#include <arpa/inet.h>
+#include <string.h>
+
+DEFINE_LOGGER(DatagramChannel, "DatagramChannel");
+
+const size_t DatagramChannel::kMaxDatagramSize;
+const size_t DatagramChannel::kHeaderSize;
+
+static const uint8_t TDT_DATAGRAM_FRAME = 0x9D;
+
+DatagramChannel::DatagramChannel()
+    : m_writer(nullptr)
+{
+}
+
+void DatagramChannel::setWriter(Writer* writer)
+{
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    m_writer = writer;
+}
+
+bool DatagramChannel::addReceiver(uint16_t trackId, Receiver* receiver)
+{
+    std::lock_guard<std::mutex> lock(m_receiverMutex);
+    return m_receivers.emplace(trackId, receiver).second;
+}
+
+void DatagramChannel::removeReceiver(uint16_t trackId)
+{
+    std::lock_guard<std::mutex> lock(m_receiverMutex);
+    m_receivers.erase(trackId);
+}
+
+bool DatagramChannel::send(uint16_t trackId, uint16_t seq, const owt_base::Frame& frame)
+{
+    if (kHeaderSize + frame.length > kMaxDatagramSize) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    if (!m_writer) {
+        return false;
+    }
+    uint16_t netTrackId = htons(trackId);
+    uint16_t netSeq = htons(seq);
+    m_buffer[0] = TDT_DATAGRAM_FRAME;
+    memcpy(m_buffer + 1, &netTrackId, 2);
+    memcpy(m_buffer + 3, &netSeq, 2);
+    memcpy(m_buffer + 5, &frame, sizeof(owt_base::Frame));
+    memcpy(m_buffer + kHeaderSize, frame.payload, frame.length);
+    m_writer->writeDatagram(m_buffer, kHeaderSize + frame.length);
+    m_stats.sent++;
+    return true;
+}
+
+void DatagramChannel::onDatagram(const uint8_t* data, size_t length)
+{
+    if (length < kHeaderSize || data[0] != TDT_DATAGRAM_FRAME) {
+        ELOG_WARN("Invalid datagram, length %zu", length);
+        return;
+    }
+    uint16_t trackId;
+    uint16_t seq;
+    owt_base::Frame frame;
+    memcpy(&trackId, data + 1, 2);
+    memcpy(&seq, data + 3, 2);
+    memcpy(&frame, data + 5, sizeof(owt_base::Frame));
+    if (frame.length != length - kHeaderSize) {
+        ELOG_WARN("Datagram frame length %u does not match %zu", frame.length, length - kHeaderSize);
+        return;
+    }
+    frame.payload = const_cast<uint8_t*>(data + kHeaderSize);
+
+    std::lock_guard<std::mutex> lock(m_receiverMutex);
+    m_stats.received++;
+    auto it = m_receivers.find(ntohs(trackId));
+    if (it == m_receivers.end()) {
+        m_stats.unrouted++;
+        return;
+    }
+    it->second->onSequencedFrame(ntohs(seq), frame);
+}
+
+DatagramChannel::Stats DatagramChannel::stats()
+{
+    std::lock_guard<std::mutex> lock1(m_sendMutex);
+    std::lock_guard<std::mutex> lock2(m_receiverMutex);
+    return m_stats;
+}
@@ -0,0 +1,75 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef QUIC_DATAGRAM_CHANNEL_H_
+#define QUIC_DATAGRAM_CHANNEL_H_
+
+#include <logger.h>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "MediaFramePipeline.h"
+
+/*
+ * Sends frames of multiplexed tracks as QUIC datagrams of one session and
+ * routes received ones to their track. A datagram is
+ * [type][2 bytes track id][2 bytes sequence number][Frame][payload] and
+ * carries one whole frame, larger frames must go over a stream. Track ids
+ * are unique in the session. Without OWT_QUIC_DATAGRAM, set when the QUIC
+ * library supports datagrams, no writer is attached and every frame goes
+ * over the stream.
+ */
+class DatagramChannel {
+    DECLARE_LOGGER();
+
+public:
+    class Writer {
+    public:
+        virtual ~Writer() {}
+        virtual void writeDatagram(uint8_t* data, size_t length) = 0;
+    };
+
+    class Receiver {
+    public:
+        virtual ~Receiver() {}
+        // |frame| payload is valid during the call only.
+        virtual void onSequencedFrame(uint16_t seq, const owt_base::Frame& frame) = 0;
+    };
+
+    struct Stats {
+        uint64_t sent = 0;
+        uint64_t received = 0;
+        uint64_t unrouted = 0;
+    };
+
+    // Fits the QUIC datagram payload of a 1280 bytes path MTU
+    static const size_t kMaxDatagramSize = 1200;
+    static const size_t kHeaderSize = 5 + sizeof(owt_base::Frame);
+
+    DatagramChannel();
+
+    void setWriter(Writer* writer);
+    bool addReceiver(uint16_t trackId, Receiver* receiver);
+    void removeReceiver(uint16_t trackId);
+
+    // Returns false if the frame was not sent, it is too large or no
+    // session is attached.
+    bool send(uint16_t trackId, uint16_t seq, const owt_base::Frame& frame);
+    void onDatagram(const uint8_t* data, size_t length);
+
+    Stats stats();
+
+private:
+    std::mutex m_sendMutex;
+    Writer* m_writer;
+    uint8_t m_buffer[kMaxDatagramSize];
+
+    std::mutex m_receiverMutex;
+    std::unordered_map<uint16_t, Receiver*> m_receivers;
+
+    Stats m_stats;
+};
+
+#endif // QUIC_DATAGRAM_CHANNEL_H_
@@ -0,0 +1,114 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FrameReorderBuffer.h"
+
+#include <string.h>
+
+DEFINE_LOGGER(FrameReorderBuffer, "FrameReorderBuffer");
+
+const uint16_t FrameReorderBuffer::kMaxFrames;
+
+FrameReorderBuffer::FrameReorderBuffer(Visitor* visitor, int maxDelayMs)
+    : m_visitor(visitor)
+    , m_maxDelayMs(maxDelayMs)
+    , m_started(false)
+    , m_nextSeq(0)
+    , m_heldCount(0)
+{
+}
+
+void FrameReorderBuffer::insert(uint16_t seq, const owt_base::Frame& frame, int64_t nowMs)
+{
+    m_stats.received++;
+    if (!m_started) {
+        m_started = true;
+        m_nextSeq = seq;
+    }
+    int16_t ahead = static_cast<int16_t>(seq - m_nextSeq);
+    if (ahead < 0) {
+        m_stats.late++;
+        return;
+    }
+    if (ahead >= kMaxFrames) {
+        skipTo(seq - kMaxFrames + 1);
+    }
+    if (seq == m_nextSeq) {
+        deliver(frame);
+        m_nextSeq++;
+        drain();
+    } else {
+        HeldFrame& held = m_held[seq % kMaxFrames];
+        if (held.valid) {
+            // The same sequence number again
+            m_stats.late++;
+            return;
+        }
+        held.valid = true;
+        held.seq = seq;
+        held.arrivalMs = nowMs;
+        held.frame = frame;
+        held.payload.assign(frame.payload, frame.payload + frame.length);
+        held.frame.payload = held.payload.data();
+        m_heldCount++;
+        m_stats.reordered++;
+    }
+    checkTimeout(nowMs);
+}
+
+void FrameReorderBuffer::deliver(const owt_base::Frame& frame)
+{
+    m_stats.delivered++;
+    m_visitor->onOrderedFrame(frame);
+}
+
+void FrameReorderBuffer::drain()
+{
+    while (m_heldCount) {
+        HeldFrame& held = m_held[m_nextSeq % kMaxFrames];
+        if (!held.valid || held.seq != m_nextSeq) {
+            break;
+        }
+        held.valid = false;
+        m_heldCount--;
+        deliver(held.frame);
+        m_nextSeq++;
+    }
+}
+
+void FrameReorderBuffer::skipTo(uint16_t seq)
+{
+    uint32_t lost = 0;
+    while (m_nextSeq != seq) {
+        HeldFrame& held = m_held[m_nextSeq % kMaxFrames];
+        if (held.valid && held.seq == m_nextSeq) {
+            held.valid = false;
+            m_heldCount--;
+            deliver(held.frame);
+        } else {
+            lost++;
+        }
+        m_nextSeq++;
+    }
+    drain();
+    if (lost) {
+        m_stats.lost += lost;
+        m_visitor->onFramesLost(lost);
+    }
+}
+
+void FrameReorderBuffer::checkTimeout(int64_t nowMs)
+{
+    while (m_heldCount) {
+        // The first held frame is the one waiting on the gap
+        uint16_t seq = m_nextSeq;
+        while (!m_held[seq % kMaxFrames].valid) {
+            seq++;
+        }
+        if (nowMs - m_held[seq % kMaxFrames].arrivalMs < m_maxDelayMs) {
+            break;
+        }
+        skipTo(seq);
+    }
+}
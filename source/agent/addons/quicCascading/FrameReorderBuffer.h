@@ -0,0 +1,76 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef QUIC_FRAME_REORDER_BUFFER_H_
+#define QUIC_FRAME_REORDER_BUFFER_H_
+
+#include <logger.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MediaFramePipeline.h"
+
+/*
+ * Puts the frames of one track back in sequence order. Frames arrive from
+ * datagrams, which may be lost or reordered, and from the reliable stream.
+ * The next expected frame is delivered without copying, a frame ahead of a
+ * gap is copied and held. A gap is given up, and its frames counted lost,
+ * when a held frame waited longer than the maximum delay or when a frame
+ * arrives more than kMaxFrames ahead. Frames behind the delivered sequence
+ * are dropped as late, key frames included since later frames are already
+ * delivered. The caller serializes calls and runs checkTimeout
+ * periodically, so a gap is given up even if no more frames arrive.
+ */
+class FrameReorderBuffer {
+    DECLARE_LOGGER();
+
+public:
+    class Visitor {
+    public:
+        virtual ~Visitor() {}
+        virtual void onOrderedFrame(const owt_base::Frame&) = 0;
+        virtual void onFramesLost(uint32_t count) = 0;
+    };
+
+    struct Stats {
+        uint64_t received = 0;
+        uint64_t delivered = 0;
+        uint64_t reordered = 0;
+        uint64_t lost = 0;
+        uint64_t late = 0;
+    };
+
+    static const uint16_t kMaxFrames = 64;
+
+    FrameReorderBuffer(Visitor* visitor, int maxDelayMs);
+
+    void insert(uint16_t seq, const owt_base::Frame& frame, int64_t nowMs);
+    void checkTimeout(int64_t nowMs);
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct HeldFrame {
+        bool valid = false;
+        uint16_t seq = 0;
+        int64_t arrivalMs = 0;
+        owt_base::Frame frame;
+        std::vector<uint8_t> payload;
+    };
+
+    void deliver(const owt_base::Frame& frame);
+    // Delivers held frames from the next expected one until a gap
+    void drain();
+    // Gives up the frames before |seq|
+    void skipTo(uint16_t seq);
+
+    Visitor* m_visitor;
+    int m_maxDelayMs;
+    bool m_started;
+    uint16_t m_nextSeq;
+    uint16_t m_heldCount;
+    HeldFrame m_held[kMaxFrames];
+    Stats m_stats;
+};
+
+#endif // QUIC_FRAME_REORDER_BUFFER_H_
@@ -0,0 +1,137 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MessageFraming.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <string.h>
+
+const size_t MessageSendArena::kCoalesceLimit;
+const size_t MessageSendArena::kHeaderSize;
+
+MessageSendArena::MessageSendArena(Writer* writer)
+    : m_writer(writer)
+{
+}
+
+void MessageSendArena::send(char type, const char* head, size_t headLength, const char* body, size_t bodyLength)
+{
+    uint32_t length = htonl(1 + headLength + bodyLength);
+    size_t total = kHeaderSize + headLength + bodyLength;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memcpy(m_arena, &length, 4);
+    m_arena[4] = type;
+    if (kHeaderSize + headLength > kCoalesceLimit) {
+        // Only for oversized heads, which none of the message types have
+        m_writer->write(m_arena, kHeaderSize);
+        m_writer->write(head, headLength);
+        if (bodyLength) {
+            m_writer->write(body, bodyLength);
+        }
+        return;
+    }
+    if (headLength) {
+        memcpy(m_arena + kHeaderSize, head, headLength);
+    }
+    if (total <= kCoalesceLimit) {
+        if (bodyLength) {
+            memcpy(m_arena + kHeaderSize + headLength, body, bodyLength);
+        }
+        m_writer->write(m_arena, total);
+    } else {
+        m_writer->write(m_arena, kHeaderSize + headLength);
+        m_writer->write(body, bodyLength);
+    }
+}
+
+DEFINE_LOGGER(MessageParser, "MessageParser");
+
+const uint32_t MessageParser::kMaxMessageSize;
+
+MessageParser::MessageParser(Visitor* visitor)
+    : m_visitor(visitor)
+    , m_capacity(0)
+    , m_pendingBytes(0)
+{
+}
+
+void MessageParser::reserve(size_t size)
+{
+    if (size <= m_capacity) {
+        return;
+    }
+    size_t capacity = m_capacity ? m_capacity : 4096;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    std::unique_ptr<char[]> buffer(new char[capacity]);
+    if (m_pendingBytes) {
+        memcpy(buffer.get(), m_pending.get(), m_pendingBytes);
+    }
+    m_pending = std::move(buffer);
+    m_capacity = capacity;
+}
+
+size_t MessageParser::fillPending(const char* data, size_t length)
+{
+    size_t taken = 0;
+    if (m_pendingBytes < 4) {
+        taken = std::min(4 - m_pendingBytes, length);
+        reserve(4);
+        memcpy(m_pending.get() + m_pendingBytes, data, taken);
+        m_pendingBytes += taken;
+        if (m_pendingBytes < 4) {
+            return taken;
+        }
+    }
+    uint32_t messageLength;
+    memcpy(&messageLength, m_pending.get(), 4);
+    messageLength = ntohl(messageLength);
+    if (messageLength == 0 || messageLength > kMaxMessageSize) {
+        ELOG_ERROR("Invalid message length %u, drop buffered data", messageLength);
+        m_pendingBytes = 0;
+        return length;
+    }
+    size_t needed = 4 + messageLength - m_pendingBytes;
+    size_t copy = std::min(needed, length - taken);
+    reserve(4 + messageLength);
+    memcpy(m_pending.get() + m_pendingBytes, data + taken, copy);
+    m_pendingBytes += copy;
+    taken += copy;
+    if (m_pendingBytes == 4 + messageLength) {
+        m_pendingBytes = 0;
+        m_visitor->onMessage(m_pending[4], m_pending.get() + 5, messageLength - 1);
+    }
+    return taken;
+}
+
+void MessageParser::feed(char* data, size_t length)
+{
+    // Complete the message left over from the previous chunk.
+    while (m_pendingBytes && length) {
+        size_t taken = fillPending(data, length);
+        data += taken;
+        length -= taken;
+    }
+    while (length >= 4) {
+        uint32_t messageLength;
+        memcpy(&messageLength, data, 4);
+        messageLength = ntohl(messageLength);
+        if (messageLength == 0 || messageLength > kMaxMessageSize) {
+            ELOG_ERROR("Invalid message length %u, drop received data", messageLength);
+            return;
+        }
+        if (length < 4 + static_cast<size_t>(messageLength)) {
+            break;
+        }
+        m_visitor->onMessage(data[4], data + 5, messageLength - 1);
+        data += 4 + messageLength;
+        length -= 4 + messageLength;
+    }
+    if (length) {
+        fillPending(data, length);
+    }
+}
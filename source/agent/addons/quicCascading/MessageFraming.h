@@ -0,0 +1,86 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef QUIC_MESSAGE_FRAMING_H_
+#define QUIC_MESSAGE_FRAMING_H_
+
+#include <logger.h>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Messages on a cascading stream are [4-byte big endian length][type][body],
+ * the length counts the type byte and the body.
+ */
+
+/*
+ * Writes messages to a stream without allocating. Small messages are
+ * gathered into a reused arena and written at once, larger ones are written
+ * as header and body without copying the body. The writer must consume the
+ * data before write() returns. Safe to call from multiple threads, the
+ * writes of one message are never interleaved with another.
+ */
+class MessageSendArena {
+public:
+    class Writer {
+    public:
+        virtual ~Writer() {}
+        virtual void write(const char* data, size_t length) = 0;
+    };
+
+    static const size_t kCoalesceLimit = 4096;
+    static const size_t kHeaderSize = 5;
+
+    explicit MessageSendArena(Writer* writer);
+
+    // Sends [length][type][head][body], |head| and |body| may be empty.
+    void send(char type, const char* head, size_t headLength, const char* body, size_t bodyLength);
+
+private:
+    Writer* m_writer;
+    std::mutex m_mutex;
+    char m_arena[kCoalesceLimit];
+};
+
+/*
+ * Splits the received byte stream into messages. Messages complete in the
+ * received chunk are handed out in place, only a message split across
+ * chunks is copied, into a buffer sized to that message. Unconsumed bytes
+ * are never moved.
+ */
+class MessageParser {
+    DECLARE_LOGGER();
+
+public:
+    class Visitor {
+    public:
+        virtual ~Visitor() {}
+        // |body| is valid during the call only and may be modified.
+        virtual void onMessage(char type, char* body, uint32_t length) = 0;
+    };
+
+    // A length above this is taken as a corrupted stream
+    static const uint32_t kMaxMessageSize = 64 * 1024 * 1024;
+
+    explicit MessageParser(Visitor* visitor);
+
+    void feed(char* data, size_t length);
+
+    size_t pendingBytes() const { return m_pendingBytes; }
+    size_t capacity() const { return m_capacity; }
+
+private:
+    // Returns bytes taken from |data| towards the pending message
+    size_t fillPending(const char* data, size_t length);
+    void reserve(size_t size);
+
+    Visitor* m_visitor;
+    std::unique_ptr<char[]> m_pending;
+    size_t m_capacity;
+    size_t m_pendingBytes;
+};
+
+#endif // QUIC_MESSAGE_FRAMING_H_
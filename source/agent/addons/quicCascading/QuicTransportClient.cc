@@ -27,8 +27,13 @@ DEFINE_LOGGER(QuicTransportClient, "QuicTransportClient");
 
 // QUIC Outgoing
 QuicTransportClient::QuicTransportClient(const char* dest_ip, int dest_port)
-        : m_quicClient(QuicFactory::getQuicTransportFactory()->CreateQuicTransportClient(dest_ip, dest_port)) {
+        : m_quicClient(QuicFactory::getQuicTransportFactory()->CreateQuicTransportClient(dest_ip, dest_port))
+        , m_streamStats(std::make_shared<QuicSessionStreamStats>())
+        , m_datagramChannel(std::make_shared<DatagramChannel>()) {
     m_quicClient->SetVisitor(this);
+#ifdef OWT_QUIC_DATAGRAM
+    m_datagramChannel->setWriter(this);
+#endif
 }
 
 QuicTransportClient::~QuicTransportClient() {
@@ -36,6 +41,7 @@ QuicTransportClient::~QuicTransportClient() {
     if (m_quicClient) {
         m_quicClient->Stop();
         m_quicClient->SetVisitor(nullptr);
+        m_datagramChannel->setWriter(nullptr);
         m_quicClient.reset();
     }
 
@@ -83,6 +89,7 @@ NAN_MODULE_INIT(QuicTransportClient::init)
     Nan::SetPrototypeMethod(tpl, "createBidirectionalStream", createBidirectionalStream);
     Nan::SetPrototypeMethod(tpl, "getId", getId);
     Nan::SetPrototypeMethod(tpl, "closeStream", closeStream);
+    Nan::SetPrototypeMethod(tpl, "getStats", getStats);
 
     s_constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
     Nan::Set(target, Nan::New("QuicTransportClient").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
@@ -131,6 +138,7 @@ NAN_METHOD(QuicTransportClient::close) {
   QuicTransportClient* obj = Nan::ObjectWrap::Unwrap<QuicTransportClient>(info.Holder());
   obj->m_quicClient->Stop();
   obj->m_quicClient->SetVisitor(nullptr);
+  obj->m_datagramChannel->setWriter(nullptr);
 
   delete obj->stream_callback_;
   delete obj->connected_callback_;
@@ -181,7 +189,7 @@ NAN_METHOD(QuicTransportClient::createBidirectionalStream) {
   ELOG_DEBUG("QuicTransportClient::createBidirectionalStream");
   QuicTransportClient* obj = Nan::ObjectWrap::Unwrap<QuicTransportClient>(info.Holder());
   auto stream=obj->m_quicClient->CreateBidirectionalStream();
-  v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(stream);
+  v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(stream, obj->m_streamStats, obj->m_datagramChannel);
   QuicTransportStream* clientStream = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
   stream->SetVisitor(clientStream);
   info.GetReturnValue().Set(streamObject);
@@ -198,6 +206,11 @@ NAN_METHOD(QuicTransportClient::closeStream) {
   obj->m_quicClient->CloseStream(streamId);
 }
 
+NAN_METHOD(QuicTransportClient::getStats) {
+  QuicTransportClient* obj = Nan::ObjectWrap::Unwrap<QuicTransportClient>(info.Holder());
+  info.GetReturnValue().Set(QuicTransportStream::sessionStatsObject(*obj->m_streamStats));
+}
+
 NAUV_WORK_CB(QuicTransportClient::onConnectedCallback){
     ELOG_DEBUG("QuicTransportClient::onConnectedCallback");
     //std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -265,7 +278,7 @@ NAUV_WORK_CB(QuicTransportClient::onNewStreamCallback){
       while (!obj->stream_messages.empty()) {
           ELOG_INFO("stream_messages is not empty");
           auto quicStream=obj->stream_messages.front();
-          v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(quicStream);
+          v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(quicStream, obj->m_streamStats, obj->m_datagramChannel);
           QuicTransportStream* stream = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
           quicStream->SetVisitor(stream);
           Local<Value> args[] = { streamObject };
@@ -340,3 +353,15 @@ void QuicTransportClient::OnStreamClosed(uint32_t id) {
     uv_async_send(&m_asyncOnStreamClosed); 
 }
 
+
+#ifdef OWT_QUIC_DATAGRAM
+void QuicTransportClient::OnDatagramReceived(const uint8_t* data, size_t length) {
+    m_datagramChannel->onDatagram(data, length);
+}
+#endif
+
+void QuicTransportClient::writeDatagram(uint8_t* data, size_t length) {
+#ifdef OWT_QUIC_DATAGRAM
+    m_quicClient->SendOrQueueDatagram(data, length);
+#endif
+}
@@ -22,7 +22,7 @@
  *
  * Sends media to server
  */
-class QuicTransportClient : public owt::quic::QuicTransportClientInterface::Visitor, public Nan::ObjectWrap {
+class QuicTransportClient : public owt::quic::QuicTransportClientInterface::Visitor, public Nan::ObjectWrap, public DatagramChannel::Writer {
     DECLARE_LOGGER();
 public:
 
@@ -40,6 +40,8 @@ public:
     static NAN_METHOD(createBidirectionalStream);
     static NAN_METHOD(getId);
     static NAN_METHOD(closeStream);
+    // Returns {streams, multiplexedTracks, memoryBytes} of this connection
+    static NAN_METHOD(getStats);
 
     static NAUV_WORK_CB(onConnectedCallback);
     static NAUV_WORK_CB(onConnectionFailedCallback);
@@ -57,6 +59,12 @@ protected:
     void OnConnectionClosed(char* sessionId, size_t len) override;
     void OnIncomingStream(owt::quic::QuicTransportStreamInterface*) override;
     void OnStreamClosed(uint32_t id) override;
+#ifdef OWT_QUIC_DATAGRAM
+    void OnDatagramReceived(const uint8_t* data, size_t length) override;
+#endif
+
+    // Implements DatagramChannel::Writer.
+    void writeDatagram(uint8_t* data, size_t length) override;
 
 private:
 
@@ -92,6 +100,8 @@ private:
     Nan::Callback *streamClosed_callback_;
 
     boost::mutex mutex;
+    std::shared_ptr<QuicSessionStreamStats> m_streamStats;
+    std::shared_ptr<DatagramChannel> m_datagramChannel;
     static Nan::Persistent<v8::Function> s_constructor;
 };
 
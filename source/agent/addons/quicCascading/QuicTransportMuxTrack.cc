@@ -0,0 +1,296 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "QuicTransportMuxTrack.h"
+
+#include <chrono>
+
+using namespace owt_base;
+using v8::Function;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Object;
+using v8::ObjectTemplate;
+using v8::Value;
+
+DEFINE_LOGGER(QuicTransportMuxTrack, "QuicTransportMuxTrack");
+
+Nan::Persistent<v8::Function> QuicTransportMuxTrack::s_constructor;
+
+// Checks for reorder gaps to give up every 10ms
+static const unsigned int kReorderTimerFrequency = 100;
+
+static int64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QuicTransportMuxTrack::QuicTransportMuxTrack(QuicTransportStream* stream, uint16_t trackId, bool isVideo, const Options& options)
+    : m_stream(stream)
+    , m_trackId(trackId)
+    , m_isVideo(isVideo)
+    , m_needKeyFrame(true)
+    , m_attached(false)
+    , m_options(options)
+    , m_sendSeq(0)
+    , m_sentDatagrams(0)
+    , m_sentReliable(0)
+{
+    if (m_options.datagram) {
+        m_datagramChannel = stream->datagramChannel();
+        m_reorderBuffer.reset(new FrameReorderBuffer(this, m_options.reorderDelayMs));
+        m_reorderTimer = SharedJobTimer::GetSharedFrequencyTimer(kReorderTimerFrequency);
+        m_reorderTimer->addListener(this);
+    }
+}
+
+QuicTransportMuxTrack::~QuicTransportMuxTrack()
+{
+    ELOG_DEBUG("QuicTransportMuxTrack::~QuicTransportMuxTrack");
+    if (m_reorderTimer) {
+        m_reorderTimer->removeListener(this);
+    }
+    detach();
+    m_streamObject.Reset();
+}
+
+void QuicTransportMuxTrack::detach()
+{
+    if (!m_attached) {
+        return;
+    }
+    m_stream->detachTrack(m_trackId);
+    if (m_datagramChannel) {
+        m_datagramChannel->removeReceiver(m_trackId);
+    }
+    m_attached = false;
+}
+
+NAN_MODULE_INIT(QuicTransportMuxTrack::init)
+{
+    Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(newInstance);
+    tpl->SetClassName(Nan::New("QuicTransportMuxTrack").ToLocalChecked());
+    Local<ObjectTemplate> instanceTpl = tpl->InstanceTemplate();
+    instanceTpl->SetInternalFieldCount(1);
+
+    Nan::SetPrototypeMethod(tpl, "addDestination", addDestination);
+    Nan::SetPrototypeMethod(tpl, "removeDestination", removeDestination);
+    Nan::SetPrototypeMethod(tpl, "close", close);
+    Nan::SetPrototypeMethod(tpl, "getId", getId);
+    Nan::SetPrototypeMethod(tpl, "getStats", getStats);
+
+    s_constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+    Nan::Set(target, Nan::New("QuicTransportMuxTrack").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+NAN_METHOD(QuicTransportMuxTrack::newInstance)
+{
+    if (!info.IsConstructCall()) {
+        ELOG_DEBUG("Not construct call.");
+        return;
+    }
+    if (info.Length() < 3) {
+        Nan::ThrowTypeError("Invalid argument length for QuicTransportMuxTrack.");
+        return;
+    }
+    Local<Object> streamObject = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+    QuicTransportStream* stream = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
+    uint32_t trackId = Nan::To<uint32_t>(info[1]).FromJust();
+    if (trackId > 0xFFFF) {
+        Nan::ThrowRangeError("Track id must fit in 16 bits.");
+        return;
+    }
+    Nan::Utf8String kind(Nan::To<v8::String>(info[2]).ToLocalChecked());
+    Options options;
+    if (info.Length() > 3 && info[3]->IsObject()) {
+        Local<Object> optionsObject = Nan::To<v8::Object>(info[3]).ToLocalChecked();
+        Local<Value> datagram = Nan::Get(optionsObject, Nan::New("datagram").ToLocalChecked()).ToLocalChecked();
+        Local<Value> videoDatagram = Nan::Get(optionsObject, Nan::New("videoDatagram").ToLocalChecked()).ToLocalChecked();
+        Local<Value> reorderDelayMs = Nan::Get(optionsObject, Nan::New("reorderDelayMs").ToLocalChecked()).ToLocalChecked();
+        options.datagram = Nan::To<bool>(datagram).FromJust();
+        options.videoDatagram = Nan::To<bool>(videoDatagram).FromJust();
+        if (reorderDelayMs->IsNumber()) {
+            options.reorderDelayMs = Nan::To<int32_t>(reorderDelayMs).FromJust();
+        }
+    }
+    if (options.datagram && !stream->datagramChannel()) {
+        Nan::ThrowError("Stream does not support datagrams.");
+        return;
+    }
+
+    QuicTransportMuxTrack* obj = new QuicTransportMuxTrack(stream, trackId, std::string(*kind) == "video", options);
+    obj->m_streamObject.Reset(streamObject);
+    obj->Wrap(info.This());
+    if (!stream->attachTrack(trackId, obj)) {
+        Nan::ThrowError("Track id is already used on this stream.");
+        return;
+    }
+    obj->m_attached = true;
+    if (obj->m_datagramChannel && !obj->m_datagramChannel->addReceiver(trackId, obj)) {
+        obj->detach();
+        Nan::ThrowError("Track id is already used by datagrams of this session.");
+        return;
+    }
+    info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(QuicTransportMuxTrack::addDestination)
+{
+    QuicTransportMuxTrack* obj = Nan::ObjectWrap::Unwrap<QuicTransportMuxTrack>(info.Holder());
+    if (info.Length() > 3) {
+        Nan::ThrowTypeError("Invalid argument length for addDestination.");
+        return;
+    }
+    Nan::Utf8String param0(Nan::To<v8::String>(info[0]).ToLocalChecked());
+    std::string track = std::string(*param0);
+    bool isNanDestination(false);
+    if (info.Length() == 3) {
+        isNanDestination = Nan::To<bool>(info[2]).FromJust();
+    }
+    owt_base::FrameDestination* dest(nullptr);
+    if (isNanDestination) {
+        NanFrameNode* param = Nan::ObjectWrap::Unwrap<NanFrameNode>(
+            Nan::To<v8::Object>(info[1]).ToLocalChecked());
+        dest = param->FrameDestination();
+    } else {
+        ::FrameDestination* param = node::ObjectWrap::Unwrap<::FrameDestination>(
+            Nan::To<v8::Object>(info[1]).ToLocalChecked());
+        dest = param->dest;
+    }
+
+    if (track == "audio") {
+        obj->addAudioDestination(dest);
+    } else if (track == "video") {
+        obj->addVideoDestination(dest);
+    } else if (track == "data") {
+        obj->addDataDestination(dest);
+    }
+}
+
+NAN_METHOD(QuicTransportMuxTrack::removeDestination)
+{
+    QuicTransportMuxTrack* obj = Nan::ObjectWrap::Unwrap<QuicTransportMuxTrack>(info.Holder());
+    Nan::Utf8String param0(Nan::To<v8::String>(info[0]).ToLocalChecked());
+    std::string track = std::string(*param0);
+    NanFrameNode* param = Nan::ObjectWrap::Unwrap<NanFrameNode>(
+        Nan::To<v8::Object>(info[1]).ToLocalChecked());
+    owt_base::FrameDestination* dest = param->FrameDestination();
+
+    if (track == "audio") {
+        obj->removeAudioDestination(dest);
+    } else if (track == "video") {
+        obj->removeVideoDestination(dest);
+    } else if (track == "data") {
+        obj->removeDataDestination(dest);
+    }
+}
+
+NAN_METHOD(QuicTransportMuxTrack::close)
+{
+    QuicTransportMuxTrack* obj = Nan::ObjectWrap::Unwrap<QuicTransportMuxTrack>(info.Holder());
+    obj->detach();
+}
+
+NAN_METHOD(QuicTransportMuxTrack::getId)
+{
+    QuicTransportMuxTrack* obj = Nan::ObjectWrap::Unwrap<QuicTransportMuxTrack>(info.Holder());
+    info.GetReturnValue().Set(Nan::New(static_cast<uint32_t>(obj->m_trackId)));
+}
+
+NAN_METHOD(QuicTransportMuxTrack::getStats)
+{
+    QuicTransportMuxTrack* obj = Nan::ObjectWrap::Unwrap<QuicTransportMuxTrack>(info.Holder());
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("sentDatagrams").ToLocalChecked(), Nan::New(static_cast<double>(obj->m_sentDatagrams.load())));
+    Nan::Set(result, Nan::New("sentReliable").ToLocalChecked(), Nan::New(static_cast<double>(obj->m_sentReliable.load())));
+    if (obj->m_reorderBuffer) {
+        FrameReorderBuffer::Stats stats;
+        {
+            std::lock_guard<std::mutex> lock(obj->m_receiveMutex);
+            stats = obj->m_reorderBuffer->stats();
+        }
+        Nan::Set(result, Nan::New("received").ToLocalChecked(), Nan::New(static_cast<double>(stats.received)));
+        Nan::Set(result, Nan::New("reordered").ToLocalChecked(), Nan::New(static_cast<double>(stats.reordered)));
+        Nan::Set(result, Nan::New("lost").ToLocalChecked(), Nan::New(static_cast<double>(stats.lost)));
+        Nan::Set(result, Nan::New("late").ToLocalChecked(), Nan::New(static_cast<double>(stats.late)));
+    }
+    info.GetReturnValue().Set(result);
+}
+
+void QuicTransportMuxTrack::onFeedback(const FeedbackMsg& msg)
+{
+    m_stream->sendTrackFeedback(m_trackId, msg);
+}
+
+void QuicTransportMuxTrack::onFrame(const Frame& frame)
+{
+    if (!m_options.datagram) {
+        m_stream->sendTrackFrame(m_trackId, frame);
+        return;
+    }
+    uint16_t seq = m_sendSeq++;
+    bool unreliable = isAudioFrame(frame)
+        || (m_options.videoDatagram && isVideoFrame(frame) && !frame.additionalInfo.video.isKeyFrame);
+    if (unreliable && m_datagramChannel && m_datagramChannel->send(m_trackId, seq, frame)) {
+        m_sentDatagrams++;
+        return;
+    }
+    m_stream->sendSequencedTrackFrame(m_trackId, seq, frame);
+    m_sentReliable++;
+}
+
+void QuicTransportMuxTrack::onVideoSourceChanged()
+{
+    // Do nothing.
+}
+
+void QuicTransportMuxTrack::onTrackFrame(const Frame& frame)
+{
+    if (m_isVideo && m_needKeyFrame) {
+        if (!frame.additionalInfo.video.isKeyFrame) {
+            ELOG_DEBUG("Request key frame for track %u", m_trackId);
+            FeedbackMsg msg {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
+            m_stream->sendTrackFeedback(m_trackId, msg);
+            return;
+        }
+        m_needKeyFrame = false;
+    }
+    deliverFrame(frame);
+}
+
+void QuicTransportMuxTrack::onTrackFeedback(const FeedbackMsg& msg)
+{
+    deliverFeedbackMsg(msg);
+}
+
+void QuicTransportMuxTrack::onSequencedFrame(uint16_t seq, const Frame& frame)
+{
+    std::lock_guard<std::mutex> lock(m_receiveMutex);
+    if (!m_reorderBuffer) {
+        // The sender is in datagram mode but this track is not
+        onTrackFrame(frame);
+        return;
+    }
+    m_reorderBuffer->insert(seq, frame, currentTimeMs());
+}
+
+void QuicTransportMuxTrack::onOrderedFrame(const Frame& frame)
+{
+    onTrackFrame(frame);
+}
+
+void QuicTransportMuxTrack::onTimeout()
+{
+    std::lock_guard<std::mutex> lock(m_receiveMutex);
+    m_reorderBuffer->checkTimeout(currentTimeMs());
+}
+
+void QuicTransportMuxTrack::onFramesLost(uint32_t count)
+{
+    ELOG_DEBUG("Track %u lost %u frames", m_trackId, count);
+    if (m_isVideo) {
+        m_needKeyFrame = true;
+    }
+}
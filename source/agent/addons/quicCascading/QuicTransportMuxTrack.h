@@ -0,0 +1,108 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef QUIC_TRANSPORT_MUX_TRACK_H_
+#define QUIC_TRANSPORT_MUX_TRACK_H_
+
+#include <atomic>
+#include <logger.h>
+#include <memory>
+#include <mutex>
+#include <nan.h>
+
+#include "../../core/owt_base/MediaFramePipeline.h"
+#include "../common/MediaFramePipelineWrapper.h"
+#include "DatagramChannel.h"
+#include "FrameReorderBuffer.h"
+#include "JobTimer.h"
+#include "QuicTransportStream.h"
+
+/*
+ * A media track multiplexed with other tracks on one QuicTransportStream.
+ * Messages of the track carry its id, so the track needs no QUIC stream,
+ * buffers or uv handle of its own. A track stays on one stream, which keeps
+ * its frames in order. Put audio tracks on a stream without video tracks,
+ * so audio is never queued behind a large video frame.
+ *
+ * In datagram mode audio frames, and optionally video frames which are not
+ * key frames, are sent as QUIC datagrams so a lost packet does not block
+ * later frames. Other frames, and frames too large for a datagram, still
+ * go over the stream. Frames of both paths carry a sequence number and are
+ * put back in order by a FrameReorderBuffer. A lost video frame makes the
+ * track wait for, and request, a key frame.
+ */
+class QuicTransportMuxTrack : public owt_base::FrameSource, public owt_base::FrameDestination, public NanFrameNode, public DatagramChannel::Receiver, public FrameReorderBuffer::Visitor, public JobTimerListener {
+    DECLARE_LOGGER();
+
+public:
+    struct Options {
+        bool datagram = false;
+        bool videoDatagram = false;
+        int reorderDelayMs = 20;
+    };
+
+    QuicTransportMuxTrack(QuicTransportStream* stream, uint16_t trackId, bool isVideo, const Options& options);
+    ~QuicTransportMuxTrack();
+
+    static NAN_MODULE_INIT(init);
+
+    // Overrides owt_base::FrameSource.
+    void onFeedback(const owt_base::FeedbackMsg&) override;
+
+    // Overrides owt_base::FrameDestination.
+    void onFrame(const owt_base::Frame&) override;
+    void onVideoSourceChanged() override;
+
+    // Overrides NanFrameNode.
+    owt_base::FrameSource* FrameSource() override { return this; }
+    owt_base::FrameDestination* FrameDestination() override { return this; }
+
+    // Called by the stream for messages of this track.
+    void onTrackFrame(const owt_base::Frame&);
+    void onTrackFeedback(const owt_base::FeedbackMsg&);
+    // Overrides DatagramChannel::Receiver, also called by the stream.
+    void onSequencedFrame(uint16_t seq, const owt_base::Frame&) override;
+
+    // Overrides FrameReorderBuffer::Visitor.
+    void onOrderedFrame(const owt_base::Frame&) override;
+    void onFramesLost(uint32_t count) override;
+
+    // Overrides JobTimerListener, gives up gaps of the reorder buffer.
+    void onTimeout() override;
+
+private:
+    // new QuicTransportMuxTrack(stream, trackId, kind[, options])
+    // kind could be "audio", "video" or "data".
+    // options: {datagram: bool, videoDatagram: bool, reorderDelayMs: number}
+    static NAN_METHOD(newInstance);
+    static NAN_METHOD(addDestination);
+    static NAN_METHOD(removeDestination);
+    static NAN_METHOD(close);
+    static NAN_METHOD(getId);
+    // Returns sent and received frame counters of datagram mode
+    static NAN_METHOD(getStats);
+
+    void detach();
+
+    static Nan::Persistent<v8::Function> s_constructor;
+
+    QuicTransportStream* m_stream;
+    // Keeps the stream alive while the track uses it
+    Nan::Persistent<v8::Object> m_streamObject;
+    uint16_t m_trackId;
+    bool m_isVideo;
+    bool m_needKeyFrame;
+    bool m_attached;
+
+    Options m_options;
+    std::shared_ptr<DatagramChannel> m_datagramChannel;
+    std::atomic<uint16_t> m_sendSeq;
+    std::atomic<uint64_t> m_sentDatagrams;
+    std::atomic<uint64_t> m_sentReliable;
+    std::mutex m_receiveMutex;
+    std::unique_ptr<FrameReorderBuffer> m_reorderBuffer;
+    std::shared_ptr<SharedJobTimer> m_reorderTimer;
+};
+
+#endif // QUIC_TRANSPORT_MUX_TRACK_H_
@@ -22,7 +22,9 @@ Nan::Persistent<v8::Function> QuicTransportSession::s_constructor;
 
 // QUIC Incomming
 QuicTransportSession::QuicTransportSession()
-        : m_session(nullptr) {
+        : m_session(nullptr)
+        , m_streamStats(std::make_shared<QuicSessionStreamStats>())
+        , m_datagramChannel(std::make_shared<DatagramChannel>()) {
 }
 
 QuicTransportSession::~QuicTransportSession() {
@@ -34,6 +36,7 @@ QuicTransportSession::~QuicTransportSession() {
         uv_close(reinterpret_cast<uv_handle_t*>(&m_asyncOnClosedStream), NULL);
     }
     m_session->SetVisitor(nullptr);
+    m_datagramChannel->setWriter(nullptr);
     delete asyncResourceNewStream_;
     delete asyncResourceClosedStream_;
     delete m_session;
@@ -53,6 +56,7 @@ NAN_MODULE_INIT(QuicTransportSession::init)
     Nan::SetPrototypeMethod(tpl, "onClosedStream", onClosedStream);
     Nan::SetPrototypeMethod(tpl, "getId", getId);
     Nan::SetPrototypeMethod(tpl, "closeStream", closeStream);
+    Nan::SetPrototypeMethod(tpl, "getStats", getStats);
 
     s_constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
     Nan::Set(target, Nan::New("QuicTransportSession").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
@@ -80,6 +84,9 @@ v8::Local<v8::Object> QuicTransportSession::newInstance(owt::quic::QuicTransport
     Local<Object> connectionObject = Nan::NewInstance(Nan::New(QuicTransportSession::s_constructor)).ToLocalChecked();
     QuicTransportSession* obj = Nan::ObjectWrap::Unwrap<QuicTransportSession>(connectionObject);
     obj->m_session = session;
+#ifdef OWT_QUIC_DATAGRAM
+    obj->m_datagramChannel->setWriter(obj);
+#endif
     return connectionObject;
 }
 
@@ -87,7 +94,7 @@ NAN_METHOD(QuicTransportSession::createBidirectionalStream){
     ELOG_DEBUG("QuicTransportSession::createBidirectionalStream");
     QuicTransportSession* obj = Nan::ObjectWrap::Unwrap<QuicTransportSession>(info.Holder());
     auto stream=obj->m_session->CreateBidirectionalStream();
-    v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(stream);
+    v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(stream, obj->m_streamStats, obj->m_datagramChannel);
     QuicTransportStream* clientStream = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
     stream->SetVisitor(clientStream);
     info.GetReturnValue().Set(streamObject);
@@ -116,6 +123,7 @@ NAN_METHOD(QuicTransportSession::close) {
   QuicTransportSession* obj = Nan::ObjectWrap::Unwrap<QuicTransportSession>(info.Holder());
   obj->m_session->Stop();
   obj->m_session->SetVisitor(nullptr);
+  obj->m_datagramChannel->setWriter(nullptr);
 
   obj->has_stream_callback_ = false;
   delete obj->stream_callback_;
@@ -135,7 +143,7 @@ NAUV_WORK_CB(QuicTransportSession::onNewStreamCallback){
 
     if (obj->has_stream_callback_) {
       while (!obj->stream_messages.empty()) {
-        v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(obj->stream_messages.front());
+        v8::Local<v8::Object> streamObject = QuicTransportStream::newInstance(obj->stream_messages.front(), obj->m_streamStats, obj->m_datagramChannel);
         QuicTransportStream* stream = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
         obj->stream_messages.front()->SetVisitor(stream);
          ELOG_DEBUG("stream_messages size:%d", obj->stream_messages.size());
@@ -186,6 +194,11 @@ NAN_METHOD(QuicTransportSession::closeStream) {
   obj->m_session->CloseStream(streamId);
 }
 
+NAN_METHOD(QuicTransportSession::getStats) {
+  QuicTransportSession* obj = Nan::ObjectWrap::Unwrap<QuicTransportSession>(info.Holder());
+  info.GetReturnValue().Set(QuicTransportStream::sessionStatsObject(*obj->m_streamStats));
+}
+
 void QuicTransportSession::OnIncomingStream(owt::quic::QuicTransportStreamInterface* stream) {
     std::cout << "QuicTransportSession::OnIncomingStream and id is:" << stream->Id() << " in session:" << m_session->Id();
     boost::mutex::scoped_lock lock(mutex);
@@ -205,4 +218,16 @@ void QuicTransportSession::OnStreamClosed(uint32_t id) {
     this->streamclosed_messages.push(id);
     m_asyncOnClosedStream.data = this;
     uv_async_send(&m_asyncOnClosedStream); 
-}
\ No newline at end of file
+}
+
+#ifdef OWT_QUIC_DATAGRAM
+void QuicTransportSession::OnDatagramReceived(const uint8_t* data, size_t length) {
+    m_datagramChannel->onDatagram(data, length);
+}
+#endif
+
+void QuicTransportSession::writeDatagram(uint8_t* data, size_t length) {
+#ifdef OWT_QUIC_DATAGRAM
+    m_session->SendOrQueueDatagram(data, length);
+#endif
+}
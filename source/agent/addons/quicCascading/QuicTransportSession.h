@@ -23,7 +23,7 @@
  *
  * Receives media from one
  */
-class QuicTransportSession : public owt::quic::QuicTransportSessionInterface::Visitor, public Nan::ObjectWrap {
+class QuicTransportSession : public owt::quic::QuicTransportSessionInterface::Visitor, public Nan::ObjectWrap, public DatagramChannel::Writer {
     DECLARE_LOGGER();
 public:
     explicit QuicTransportSession();
@@ -39,6 +39,8 @@ public:
     static NAN_METHOD(getId);
     static NAN_METHOD(onClosedStream);
     static NAN_METHOD(closeStream);
+    // Returns {streams, multiplexedTracks, memoryBytes} of this session
+    static NAN_METHOD(getStats);
 
     static NAUV_WORK_CB(onNewStreamCallback);
     static NAUV_WORK_CB(onClosedStreamCallback);
@@ -46,6 +48,12 @@ public:
     // Implements QuicTransportSessionInterface.
     void OnIncomingStream(owt::quic::QuicTransportStreamInterface*) override;
     void OnStreamClosed(uint32_t id) override;
+#ifdef OWT_QUIC_DATAGRAM
+    void OnDatagramReceived(const uint8_t* data, size_t length) override;
+#endif
+
+    // Implements DatagramChannel::Writer.
+    void writeDatagram(uint8_t* data, size_t length) override;
 private:
 
     owt::quic::QuicTransportSessionInterface* m_session;
@@ -60,6 +68,8 @@ private:
     Nan::AsyncResource *asyncResourceNewStream_;
     Nan::AsyncResource *asyncResourceClosedStream_;
     boost::mutex mutex;
+    std::shared_ptr<QuicSessionStreamStats> m_streamStats;
+    std::shared_ptr<DatagramChannel> m_datagramChannel;
     static Nan::Persistent<v8::Function> s_constructor;
 };
 
@@ -7,6 +7,8 @@
 #include <chrono>
 #include <iostream>
 #include "QuicTransportStream.h"
+#include "QuicTransportMuxTrack.h"
+#include <arpa/inet.h>
 
 //using namespace net;
 using namespace owt_base;
@@ -20,7 +22,13 @@ using v8::Value;
 const char TDT_FEEDBACK_MSG = 0x5A;
 const char TDT_MEDIA_FRAME = 0x8F;
 const char TDT_MEDIA_METADATA = 0x3A;
-const size_t INIT_BUFF_SIZE = 80000;
+// Messages of multiplexed tracks, the body starts with a 2 bytes track id.
+const char TDT_MUX_FEEDBACK_MSG = 0x6A;
+const char TDT_MUX_MEDIA_FRAME = 0x9F;
+// Followed by a 2 bytes sequence number after the track id.
+const char TDT_MUX_SEQUENCED_FRAME = 0x9E;
+const size_t kTrackIdSize = 2;
+const size_t kSeqSize = 2;
 
 DEFINE_LOGGER(QuicTransportStream, "QuicTransportStream");
 
@@ -45,12 +53,12 @@ QuicTransportStream::QuicTransportStream()
 }
 
 QuicTransportStream::QuicTransportStream(owt::quic::QuicTransportStreamInterface* stream)
-        : m_stream(stream)
-        , m_bufferSize(INIT_BUFF_SIZE)
-        , m_receivedBytes(0)
+        : m_sendArena(this)
+        , m_parser(this)
+        , m_stream(stream)
         , m_needKeyFrame(true)
-        , m_trackKind("unknown") {
-    m_receiveData.buffer.reset(new char[m_bufferSize]);
+        , m_trackKind("unknown")
+        , m_reportedMemory(0) {
 }
 
 QuicTransportStream::~QuicTransportStream() {
@@ -62,6 +70,10 @@ QuicTransportStream::~QuicTransportStream() {
     delete asyncResource_;
     delete m_stream;
     m_stream = nullptr;
+    if (m_sessionStats) {
+        m_sessionStats->streams--;
+        m_sessionStats->memoryBytes -= m_reportedMemory;
+    }
     /*delete[] m_receiveData.buffer;
     data_callback_.Reset();*/
 }
@@ -98,16 +110,32 @@ NAN_METHOD(QuicTransportStream::newInstance)
     info.GetReturnValue().Set(info.This());
 }
 
-v8::Local<v8::Object> QuicTransportStream::newInstance(owt::quic::QuicTransportStreamInterface* stream)
+v8::Local<v8::Object> QuicTransportStream::newInstance(owt::quic::QuicTransportStreamInterface* stream,
+    std::shared_ptr<QuicSessionStreamStats> sessionStats, std::shared_ptr<DatagramChannel> datagramChannel)
 {
     ELOG_DEBUG("QuicTransportStream::newInstance");
     Local<Object> streamObject = Nan::NewInstance(Nan::New(QuicTransportStream::s_constructor)).ToLocalChecked();
     QuicTransportStream* obj = Nan::ObjectWrap::Unwrap<QuicTransportStream>(streamObject);
     obj->m_stream = stream;
     obj->id = stream->Id();
+    obj->m_sessionStats = sessionStats;
+    obj->m_datagramChannel = datagramChannel;
+    if (sessionStats) {
+        sessionStats->streams++;
+        obj->updateMemoryStats();
+    }
     return streamObject;
 }
 
+v8::Local<v8::Object> QuicTransportStream::sessionStatsObject(const QuicSessionStreamStats& stats)
+{
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("streams").ToLocalChecked(), Nan::New(stats.streams.load()));
+    Nan::Set(result, Nan::New("multiplexedTracks").ToLocalChecked(), Nan::New(stats.multiplexedTracks.load()));
+    Nan::Set(result, Nan::New("memoryBytes").ToLocalChecked(), Nan::New(static_cast<double>(stats.memoryBytes.load())));
+    return result;
+}
+
 NAN_METHOD(QuicTransportStream::send) {
   ELOG_DEBUG("QuicTransportStream::send");
   QuicTransportStream* obj = Nan::ObjectWrap::Unwrap<QuicTransportStream>(info.Holder());
@@ -220,15 +248,7 @@ NAUV_WORK_CB(QuicTransportStream::onStreamDataCallback){
 
 void QuicTransportStream::onFeedback(const FeedbackMsg& msg) {
     ELOG_DEBUG("QuicTransportStream::onFeedback in stream:%d", id);
-    TransportData sendData;
-    uint32_t payloadLength = sizeof(FeedbackMsg);
-    sendData.buffer.reset(new char[payloadLength + 5]);
-    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(payloadLength + 1);
-    sendData.buffer[4] = TDT_FEEDBACK_MSG;
-    memcpy(sendData.buffer.get() + 5, reinterpret_cast<char*>(const_cast<FeedbackMsg*>(&msg)), payloadLength);
-    sendData.length = payloadLength + 5;
-
-    m_stream->SendData(sendData.buffer.get(), sendData.length);
+    sendFeedback(msg);
 }
 
 void QuicTransportStream::onVideoSourceChanged()
@@ -241,123 +261,185 @@ void QuicTransportStream::onFrame(const owt_base::Frame& frame)
 {
     //ELOG_DEBUG("QuicTransportStream::onFrame");
     //dump(this, frame.payload, frame.length);
-    TransportData sendData;
-    sendData.buffer.reset(new char[sizeof(Frame) + frame.length + 5]);
-    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(sizeof(Frame) + frame.length + 1);
-    sendData.buffer[4] = TDT_MEDIA_FRAME;
-    memcpy(sendData.buffer.get() + 5, reinterpret_cast<uint8_t*>(const_cast<Frame*>(&frame)),
-           sizeof(Frame));
-    memcpy(sendData.buffer.get() + 5 + sizeof(Frame), frame.payload, frame.length);
-    sendData.length = sizeof(Frame) + frame.length + 5;
-
-    m_stream->SendData(sendData.buffer.get(), sendData.length);
+    m_sendArena.send(TDT_MEDIA_FRAME, reinterpret_cast<const char*>(&frame), sizeof(Frame),
+        reinterpret_cast<const char*>(frame.payload), frame.length);
 }
 
 
 void QuicTransportStream::sendData(const std::string& data) {
     ELOG_DEBUG("QuicTransportStream::sendData:%s in stream:%d\n", data.c_str(), id);
-    TransportData sendData;
-    uint32_t payloadLength = data.length();
-    sendData.buffer.reset(new char[payloadLength + 5]);
-    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(payloadLength + 1);
-    sendData.buffer[4] = TDT_MEDIA_METADATA;
-    memcpy(sendData.buffer.get() + 5, data.c_str(), payloadLength);
-    sendData.length = payloadLength + 5;
-
-    m_stream->SendData(sendData.buffer.get(), sendData.length);
+    m_sendArena.send(TDT_MEDIA_METADATA, nullptr, 0, data.c_str(), data.length());
 }
 
 void QuicTransportStream::sendFeedback(const FeedbackMsg& msg) {
-    TransportData sendData;
-    uint32_t payloadLength = sizeof(FeedbackMsg);
-    sendData.buffer.reset(new char[payloadLength + 5]);
-    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(payloadLength + 1);
-    sendData.buffer[4] = TDT_FEEDBACK_MSG;
-    memcpy(sendData.buffer.get() + 5, reinterpret_cast<uint8_t*>(const_cast<FeedbackMsg*>(&msg)),
-           sizeof(FeedbackMsg));
-    sendData.length = payloadLength + 5;
-    ELOG_DEBUG("QuicTransportStream::sendFeedback:%s\n", sendData.buffer.get());
+    m_sendArena.send(TDT_FEEDBACK_MSG, reinterpret_cast<const char*>(&msg), sizeof(FeedbackMsg), nullptr, 0);
+}
 
-    m_stream->SendData(sendData.buffer.get(), sendData.length);
+void QuicTransportStream::write(const char* data, size_t length) {
+    m_stream->SendData(const_cast<char*>(data), length);
+}
+
+bool QuicTransportStream::attachTrack(uint16_t trackId, QuicTransportMuxTrack* track) {
+    std::lock_guard<std::mutex> lock(m_trackMutex);
+    if (!m_tracks.emplace(trackId, track).second) {
+        ELOG_WARN("Track %u already attached to stream:%d", trackId, id);
+        return false;
+    }
+    if (m_sessionStats) {
+        m_sessionStats->multiplexedTracks++;
+        m_sessionStats->memoryBytes += sizeof(QuicTransportMuxTrack);
+    }
+    return true;
+}
+
+void QuicTransportStream::detachTrack(uint16_t trackId) {
+    std::lock_guard<std::mutex> lock(m_trackMutex);
+    if (m_tracks.erase(trackId) && m_sessionStats) {
+        m_sessionStats->multiplexedTracks--;
+        m_sessionStats->memoryBytes -= sizeof(QuicTransportMuxTrack);
+    }
+}
+
+void QuicTransportStream::sendTrackFrame(uint16_t trackId, const owt_base::Frame& frame) {
+    char head[kTrackIdSize + sizeof(Frame)];
+    uint16_t netTrackId = htons(trackId);
+    memcpy(head, &netTrackId, kTrackIdSize);
+    memcpy(head + kTrackIdSize, &frame, sizeof(Frame));
+    m_sendArena.send(TDT_MUX_MEDIA_FRAME, head, sizeof(head),
+        reinterpret_cast<const char*>(frame.payload), frame.length);
+}
+
+void QuicTransportStream::sendSequencedTrackFrame(uint16_t trackId, uint16_t seq, const owt_base::Frame& frame) {
+    char head[kTrackIdSize + kSeqSize + sizeof(Frame)];
+    uint16_t netTrackId = htons(trackId);
+    uint16_t netSeq = htons(seq);
+    memcpy(head, &netTrackId, kTrackIdSize);
+    memcpy(head + kTrackIdSize, &netSeq, kSeqSize);
+    memcpy(head + kTrackIdSize + kSeqSize, &frame, sizeof(Frame));
+    m_sendArena.send(TDT_MUX_SEQUENCED_FRAME, head, sizeof(head),
+        reinterpret_cast<const char*>(frame.payload), frame.length);
+}
+
+void QuicTransportStream::sendTrackFeedback(uint16_t trackId, const owt_base::FeedbackMsg& msg) {
+    char head[kTrackIdSize + sizeof(FeedbackMsg)];
+    uint16_t netTrackId = htons(trackId);
+    memcpy(head, &netTrackId, kTrackIdSize);
+    memcpy(head + kTrackIdSize, &msg, sizeof(FeedbackMsg));
+    m_sendArena.send(TDT_MUX_FEEDBACK_MSG, head, sizeof(head), nullptr, 0);
+}
+
+void QuicTransportStream::updateMemoryStats() {
+    // The receive buffer is the only part growing with traffic.
+    int64_t memory = sizeof(QuicTransportStream) + m_parser.capacity();
+    if (memory != m_reportedMemory) {
+        m_sessionStats->memoryBytes += memory - m_reportedMemory;
+        m_reportedMemory = memory;
+    }
 }
 
 void QuicTransportStream::OnData(owt::quic::QuicTransportStreamInterface* stream, char* buf, size_t len) {
-    if (m_receivedBytes + len >= m_bufferSize) {
-        m_bufferSize += (m_receivedBytes + len);
-        std::cout << "new_bufferSize: " << m_bufferSize << " for stream id:" << id << std::endl;
-        boost::shared_array<char> new_buffer;
-        new_buffer.reset(new char[m_bufferSize]);
-        if (new_buffer.get()) {
-            memcpy(new_buffer.get(), m_receiveData.buffer.get(), m_receivedBytes);
-            m_receiveData.buffer.reset();
-            m_receiveData.buffer = new_buffer;
-        } else {
+    m_parser.feed(buf, len);
+    if (m_sessionStats) {
+        updateMemoryStats();
+    }
+}
+
+void QuicTransportStream::onTrackMessage(char type, char* body, uint32_t length) {
+    if (length < kTrackIdSize) {
+        ELOG_WARN("Invalid track message length %u in stream:%d", length, id);
+        return;
+    }
+    uint16_t trackId;
+    memcpy(&trackId, body, kTrackIdSize);
+    trackId = ntohs(trackId);
+    body += kTrackIdSize;
+    length -= kTrackIdSize;
+
+    std::lock_guard<std::mutex> lock(m_trackMutex);
+    auto it = m_tracks.find(trackId);
+    if (it == m_tracks.end()) {
+        ELOG_DEBUG("No track %u in stream:%d, drop message", trackId, id);
+        return;
+    }
+    if (type == TDT_MUX_SEQUENCED_FRAME) {
+        if (length < kSeqSize + sizeof(Frame)) {
+            ELOG_WARN("Invalid frame message length %u for track %u", length, trackId);
+            return;
+        }
+        uint16_t seq;
+        memcpy(&seq, body, kSeqSize);
+        Frame frame;
+        memcpy(&frame, body + kSeqSize, sizeof(Frame));
+        frame.payload = reinterpret_cast<uint8_t*>(body + kSeqSize + sizeof(Frame));
+        it->second->onSequencedFrame(ntohs(seq), frame);
+    } else if (type == TDT_MUX_MEDIA_FRAME) {
+        if (length < sizeof(Frame)) {
+            ELOG_WARN("Invalid frame message length %u for track %u", length, trackId);
             return;
         }
+        Frame frame;
+        memcpy(&frame, body, sizeof(Frame));
+        frame.payload = reinterpret_cast<uint8_t*>(body + sizeof(Frame));
+        it->second->onTrackFrame(frame);
+    } else {
+        if (length < sizeof(FeedbackMsg)) {
+            ELOG_WARN("Invalid feedback message length %u for track %u", length, trackId);
+            return;
+        }
+        FeedbackMsg msg;
+        memcpy(&msg, body, sizeof(FeedbackMsg));
+        it->second->onTrackFeedback(msg);
     }
-    memcpy(m_receiveData.buffer.get() + m_receivedBytes, buf, len);
-    m_receivedBytes += len;
-    while (m_receivedBytes >= 4) {
-        uint32_t payloadlen = 0;
-
-        payloadlen = ntohl(*(reinterpret_cast<uint32_t*>(m_receiveData.buffer.get())));
-        uint32_t expectedLen = payloadlen + 4;
-        if (expectedLen > m_receivedBytes) {
-            // continue
-            break;
-        } else {
-            m_receivedBytes -= expectedLen;
-            char* dpos = m_receiveData.buffer.get() + 4;
-            Frame* frame = nullptr;
-            std::string s_data(dpos + 1, payloadlen - 1);
-            owt_base::FeedbackMsg msg {.type = owt_base::VIDEO_FEEDBACK, .cmd = owt_base::REQUEST_KEY_FRAME};
-
-            switch (dpos[0]) {
-                case TDT_MEDIA_FRAME:
-                    //ELOG_DEBUG("QuicTransportStream deliver frame with trackKind: %s", m_trackKind.c_str());
-                    frame = reinterpret_cast<Frame*>(dpos + 1);
-                    frame->payload = reinterpret_cast<uint8_t*>(dpos + 1 + sizeof(Frame));
-                    if (m_trackKind == "video") {
-                      if (m_needKeyFrame) {
-                        if (frame->additionalInfo.video.isKeyFrame) {
-                            m_needKeyFrame = false;
-                        } else {
-                            ELOG_DEBUG("Request key frame\n");
-                            sendFeedback(msg);
-                            return;
-                        }
-                      }
-                    }
-                    //dump(this, frame->payload, frame->length);
-                    deliverFrame(*frame);
-                    break;
-                case TDT_MEDIA_METADATA: {
-                    ELOG_DEBUG("QuicTransportStream::onData with type TDT_MEDIA_METADATA%s", s_data.c_str(), " in stream:%d", id);
-                    //boost::mutex::scoped_lock lock(mutex);
-                    this->data_messages.push(s_data);
-                    m_asyncOnData.data = this;
-                    //uv_async_send(&m_asyncOnData);
-                    if (uv_async_send(&m_asyncOnData) == 0) {
-                        ELOG_INFO("OnData uv_async_send succeed and handle pending is:%d", m_asyncOnData.pending); 
-                    } else {
-                        ELOG_INFO("OnData uv_async_send failed");
-                    };
-                    //lock.unlock();
-                    ELOG_DEBUG("QuicTransportStream::onData with type TDT_MEDIA_METADATA end in stream:%d in thread:%d", id, std::this_thread::get_id());
+}
+
+void QuicTransportStream::onMessage(char type, char* body, uint32_t length) {
+    owt_base::FeedbackMsg msg {.type = owt_base::VIDEO_FEEDBACK, .cmd = owt_base::REQUEST_KEY_FRAME};
+
+    switch (type) {
+        case TDT_MEDIA_FRAME: {
+            if (length < sizeof(Frame)) {
+                ELOG_WARN("Invalid frame message length %u in stream:%d", length, id);
+                break;
+            }
+            Frame frame;
+            memcpy(&frame, body, sizeof(Frame));
+            frame.payload = reinterpret_cast<uint8_t*>(body + sizeof(Frame));
+            if (m_trackKind == "video" && m_needKeyFrame) {
+                if (frame.additionalInfo.video.isKeyFrame) {
+                    m_needKeyFrame = false;
+                } else {
+                    ELOG_DEBUG("Request key frame\n");
+                    sendFeedback(msg);
                     break;
                 }
-                case TDT_FEEDBACK_MSG:
-                    ELOG_DEBUG("QuicTransportStream deliver feedback msg");
-                    deliverFeedbackMsg(msg);
-                    break;
-                default:
-                    break;
             }
-
-            if (m_receivedBytes > 0) {
-                std::cout << "not zero m_receiveBytes" << std::endl;
-                memcpy(m_receiveData.buffer.get(), m_receiveData.buffer.get() + expectedLen, m_receivedBytes);
+            //dump(this, frame.payload, frame.length);
+            deliverFrame(frame);
+            break;
+        }
+        case TDT_MEDIA_METADATA: {
+            std::string s_data(body, length);
+            ELOG_DEBUG("QuicTransportStream::onData with type TDT_MEDIA_METADATA %s in stream:%d", s_data.c_str(), id);
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                this->data_messages.push(s_data);
+            }
+            m_asyncOnData.data = this;
+            if (uv_async_send(&m_asyncOnData) != 0) {
+                ELOG_INFO("OnData uv_async_send failed");
             }
+            break;
         }
+        case TDT_FEEDBACK_MSG:
+            ELOG_DEBUG("QuicTransportStream deliver feedback msg");
+            deliverFeedbackMsg(msg);
+            break;
+        case TDT_MUX_MEDIA_FRAME:
+        case TDT_MUX_SEQUENCED_FRAME:
+        case TDT_MUX_FEEDBACK_MSG:
+            onTrackMessage(type, body, length);
+            break;
+        default:
+            break;
     }
 }
@@ -5,6 +5,8 @@
 #ifndef QUIC_TRANSPORT_STREAM_H_
 #define QUIC_TRANSPORT_STREAM_H_
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <nan.h>
@@ -17,23 +19,37 @@
 
 #include "../../core/owt_base/MediaFramePipeline.h"
 #include "../common/MediaFramePipelineWrapper.h"
+#include "DatagramChannel.h"
+#include "MessageFraming.h"
 #include "owt/quic/quic_transport_stream_interface.h"
 
+class QuicTransportMuxTrack;
+
+// Streams and memory of one session, shared with the streams it created.
+struct QuicSessionStreamStats {
+    std::atomic<uint32_t> streams { 0 };
+    std::atomic<uint32_t> multiplexedTracks { 0 };
+    std::atomic<int64_t> memoryBytes { 0 };
+};
+
 /*
  * Wrapper class of TQuicServer
  *
  * Receives media from one
  */
-class QuicTransportStream : public owt_base::FrameSource, public owt_base::FrameDestination, public owt::quic::QuicTransportStreamInterface::Visitor, public NanFrameNode {
+class QuicTransportStream : public owt_base::FrameSource, public owt_base::FrameDestination, public owt::quic::QuicTransportStreamInterface::Visitor, public NanFrameNode, public MessageSendArena::Writer, public MessageParser::Visitor {
     DECLARE_LOGGER();
 public:
     explicit QuicTransportStream();
     explicit QuicTransportStream(owt::quic::QuicTransportStreamInterface* stream);
     virtual ~QuicTransportStream();
 
-    static v8::Local<v8::Object> newInstance(owt::quic::QuicTransportStreamInterface* stream);
+    static v8::Local<v8::Object> newInstance(owt::quic::QuicTransportStreamInterface* stream,
+        std::shared_ptr<QuicSessionStreamStats> sessionStats = nullptr,
+        std::shared_ptr<DatagramChannel> datagramChannel = nullptr);
 
     static NAN_MODULE_INIT(init);
+    static v8::Local<v8::Object> sessionStatsObject(const QuicSessionStreamStats& stats);
 
     static NAN_METHOD(newInstance);
     static NAN_METHOD(addDestination);
@@ -62,20 +78,32 @@ public:
 
     void OnData(owt::quic::QuicTransportStreamInterface* stream, char* buf, size_t len) override;
 
+    // Overrides MessageSendArena::Writer.
+    void write(const char* data, size_t length) override;
+    // Overrides MessageParser::Visitor.
+    void onMessage(char type, char* body, uint32_t length) override;
+
     void sendData(const std::string& data);
 
+    // Multiplexed tracks share this stream, their messages carry the track id.
+    bool attachTrack(uint16_t trackId, QuicTransportMuxTrack* track);
+    void detachTrack(uint16_t trackId);
+    void sendTrackFrame(uint16_t trackId, const owt_base::Frame& frame);
+    void sendTrackFeedback(uint16_t trackId, const owt_base::FeedbackMsg& msg);
+    // Sends a frame of a track which also uses datagrams, with its sequence number
+    void sendSequencedTrackFrame(uint16_t trackId, uint16_t seq, const owt_base::Frame& frame);
+    // Datagrams of the session this stream belongs to, null if not supported
+    std::shared_ptr<DatagramChannel> datagramChannel() const { return m_datagramChannel; }
+
     uint32_t id;
 private:
     void sendFeedback(const owt_base::FeedbackMsg& msg);
-    typedef struct {
-        boost::shared_array<char> buffer;
-        int length;
-    } TransportData;
+    void onTrackMessage(char type, char* body, uint32_t length);
+    void updateMemoryStats();
 
     std::unordered_map<std::string, bool> hasStream_;
-    size_t m_bufferSize;
-    TransportData m_receiveData;
-    uint32_t m_receivedBytes;
+    MessageSendArena m_sendArena;
+    MessageParser m_parser;
     uv_async_t m_asyncOnData;
     bool has_data_callback_;
     std::queue<std::string> data_messages;
@@ -86,6 +114,11 @@ private:
     static Nan::Persistent<v8::Function> s_constructor;
     bool m_needKeyFrame;
     std::string m_trackKind;
+    std::mutex m_trackMutex;
+    std::unordered_map<uint16_t, QuicTransportMuxTrack*> m_tracks;
+    std::shared_ptr<QuicSessionStreamStats> m_sessionStats;
+    std::shared_ptr<DatagramChannel> m_datagramChannel;
+    int64_t m_reportedMemory;
 };
 
 #endif  // QUIC_TRANSPORT_SERVER_H_
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "QuicTransportStream.h"
+#include "QuicTransportMuxTrack.h"
 #include "QuicTransportSession.h"
 #include "QuicTransportServer.h"
 #include "QuicTransportClient.h"
@@ -15,6 +16,7 @@ using namespace v8;
 NAN_MODULE_INIT(InitAll)
 {
   QuicTransportStream::init(target);
+  QuicTransportMuxTrack::init(target);
   QuicTransportSession::init(target);
   QuicTransportServer::init(target);
   QuicTransportClient::init(target);
@@ -1,16 +1,26 @@
 {
+  'variables': {
+    # Datagrams need a QUIC library newer than owt-deps-quic v0.1
+    'quic_datagram': '<!(grep -qs SendOrQueueDatagram ../../../../third_party/quic-lib/dist/include/owt/quic/*.h && echo 1 || echo 0)',
+  },
   'targets': [{
     'target_name': 'quicCascading',
     'sources': [
       'addon.cc',
       'QuicTransportStream.cc',
+      'QuicTransportMuxTrack.cc',
+      'MessageFraming.cc',
+      'DatagramChannel.cc',
+      'FrameReorderBuffer.cc',
       'QuicTransportSession.cc',
       'QuicTransportServer.cc',
       'QuicTransportClient.cc',
       'QuicFactory.cc',
       'QuicTransportFrameDestination.cc',
       'QuicTransportFrameSource.cc',
+      '../../../core/common/JobTimer.cpp',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/KeyFrameArbiter.cpp',
       '../../../core/owt_base/MediaFrameMulticaster.cpp'
     ],
     'include_dirs': [
@@ -32,6 +42,9 @@
       '-lowt_quic_transport'
     ],
     'conditions': [
+      [ 'quic_datagram==1', {
+        'defines': ['OWT_QUIC_DATAGRAM'],
+      }],
       [ 'OS=="mac"', {
         'xcode_settings': {
           'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
@@ -0,0 +1,115 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Simulated lossy link comparing end-to-end latency of cascaded audio sent
+// over a reliable stream and over datagrams. Each 20ms audio frame is one
+// packet with a fixed one-way delay plus jitter, lost packets are dropped
+// at random. On the stream a lost packet is retransmitted after an RTO and
+// blocks the frames behind it; with datagrams it is lost and the rest pass
+// FrameReorderBuffer, whose gaps are also given up on a timer. Reports
+// p50/p99/max latency and lost frames.
+//
+// Usage: datagramLatencyBenchmark [loss percent] [one-way delay ms] [jitter ms] [reorder delay ms]
+
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../FrameReorderBuffer.h"
+
+static const int kFrameIntervalMs = 20;
+static const int kFrameCount = 50000;
+static const int kTimerIntervalMs = 10;
+
+struct Packet {
+    uint16_t seq;
+    int64_t sendMs;
+    int64_t arrivalMs;
+};
+
+class LatencyCollector : public FrameReorderBuffer::Visitor {
+public:
+    int64_t nowMs = 0;
+    std::vector<int64_t> latencies;
+    uint64_t lost = 0;
+
+    void onOrderedFrame(const owt_base::Frame& frame) override
+    {
+        latencies.push_back(nowMs - frame.timeStamp);
+    }
+    void onFramesLost(uint32_t count) override { lost += count; }
+};
+
+static void report(const char* name, std::vector<int64_t> latencies, uint64_t lost)
+{
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    printf("%-9s p50 %4ld ms, p99 %4ld ms, max %4ld ms, lost %lu/%d frames\n", name,
+        latencies[n / 2], latencies[std::min(n - 1, n * 99 / 100)], latencies.back(), lost, kFrameCount);
+}
+
+int main(int argc, char* argv[])
+{
+    double loss = (argc > 1 ? atof(argv[1]) : 2.0) / 100;
+    int delayMs = argc > 2 ? atoi(argv[2]) : 25;
+    int jitterMs = argc > 3 ? atoi(argv[3]) : 5;
+    int reorderDelayMs = argc > 4 ? atoi(argv[4]) : kFrameIntervalMs;
+    int rtoMs = delayMs * 2 * 3 / 2 + jitterMs;
+    printf("loss %.1f%%, one-way delay %d ms, jitter %d ms, rto %d ms, reorder delay %d ms\n",
+        loss * 100, delayMs, jitterMs, rtoMs, reorderDelayMs);
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> jitter(0, jitterMs);
+
+    // Reliable stream: retransmit until received, deliver in order
+    std::vector<int64_t> streamLatencies;
+    int64_t lastDeliveryMs = 0;
+    for (int i = 0; i < kFrameCount; i++) {
+        int64_t sendMs = static_cast<int64_t>(i) * kFrameIntervalMs;
+        int64_t attemptMs = sendMs;
+        while (uniform(random) < loss) {
+            attemptMs += rtoMs;
+        }
+        int64_t arrivalMs = attemptMs + delayMs + jitter(random);
+        lastDeliveryMs = std::max(lastDeliveryMs, arrivalMs);
+        streamLatencies.push_back(lastDeliveryMs - sendMs);
+    }
+    report("stream", streamLatencies, 0);
+
+    // Datagrams: lost packets are gone, reordered ones wait in the buffer
+    std::vector<Packet> packets;
+    for (int i = 0; i < kFrameCount; i++) {
+        int64_t sendMs = static_cast<int64_t>(i) * kFrameIntervalMs;
+        if (uniform(random) < loss) {
+            continue;
+        }
+        packets.push_back({ static_cast<uint16_t>(i), sendMs, sendMs + delayMs + jitter(random) });
+    }
+    std::stable_sort(packets.begin(), packets.end(),
+        [](const Packet& a, const Packet& b) { return a.arrivalMs < b.arrivalMs; });
+
+    LatencyCollector collector;
+    FrameReorderBuffer buffer(&collector, reorderDelayMs);
+    uint8_t payload[160] = { 0 };
+    owt_base::Frame frame = {};
+    frame.format = owt_base::FRAME_FORMAT_OPUS;
+    frame.payload = payload;
+    frame.length = sizeof(payload);
+    int64_t nextTimerMs = 0;
+    for (const Packet& packet : packets) {
+        // The track gives up gaps on a 10ms timer between arrivals
+        for (; nextTimerMs <= packet.arrivalMs; nextTimerMs += kTimerIntervalMs) {
+            collector.nowMs = nextTimerMs;
+            buffer.checkTimeout(nextTimerMs);
+        }
+        collector.nowMs = packet.arrivalMs;
+        frame.timeStamp = packet.sendMs;
+        buffer.insert(packet.seq, frame, packet.arrivalMs);
+    }
+    report("datagram", collector.latencies, kFrameCount - collector.latencies.size());
+    return 0;
+}
@@ -0,0 +1,236 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Loopback benchmark of the cascading stream framing. Frames are sent
+// through the framing into an in-memory wire, which is cut into chunks of
+// varying size and fed back to the parser, as a QUIC stream delivers them.
+// Reports frames per second and heap allocations per frame for the
+// previous framing code and for MessageSendArena/MessageParser.
+//
+// Usage: messageFramingBenchmark [frames]
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <boost/shared_array.hpp>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "../MessageFraming.h"
+#include "MediaFramePipeline.h"
+
+static std::atomic<uint64_t> s_allocations(0);
+
+void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static const char TDT_MEDIA_FRAME = 0x8F;
+
+// Cuts what is written into chunks and hands them to |feed|.
+class LoopbackWire {
+public:
+    LoopbackWire()
+        : m_seed(1)
+    {
+        m_wire.reserve(1 << 20);
+    }
+
+    template <typename Feed>
+    void write(const char* data, size_t length, Feed feed)
+    {
+        // The QUIC stack copies the data into its send buffer.
+        m_wire.assign(data, data + length);
+        size_t offset = 0;
+        while (offset < m_wire.size()) {
+            size_t chunk = std::min(nextChunkSize(), m_wire.size() - offset);
+            feed(m_wire.data() + offset, chunk);
+            offset += chunk;
+        }
+    }
+
+private:
+    size_t nextChunkSize()
+    {
+        m_seed = m_seed * 1103515245 + 12345;
+        return 200 + (m_seed >> 8) % 16000;
+    }
+
+    std::vector<char> m_wire;
+    uint32_t m_seed;
+};
+
+struct Counter {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+
+    void onFrame(char type, const char* body, uint32_t length)
+    {
+        if (type == TDT_MEDIA_FRAME && length >= sizeof(owt_base::Frame)) {
+            owt_base::Frame frame;
+            memcpy(&frame, body, sizeof(frame));
+            frames++;
+            bytes += frame.length;
+        }
+    }
+};
+
+// The framing QuicTransportStream used before MessageFraming.
+class LegacyFraming {
+public:
+    explicit LegacyFraming(Counter* counter)
+        : m_counter(counter)
+        , m_bufferSize(80000)
+        , m_receivedBytes(0)
+    {
+        m_receiveBuffer.reset(new char[m_bufferSize]);
+    }
+
+    void send(const owt_base::Frame& frame)
+    {
+        boost::shared_array<char> buffer(new char[sizeof(owt_base::Frame) + frame.length + 5]);
+        *(reinterpret_cast<uint32_t*>(buffer.get())) = htonl(sizeof(owt_base::Frame) + frame.length + 1);
+        buffer[4] = TDT_MEDIA_FRAME;
+        memcpy(buffer.get() + 5, &frame, sizeof(owt_base::Frame));
+        memcpy(buffer.get() + 5 + sizeof(owt_base::Frame), frame.payload, frame.length);
+        m_wire.write(buffer.get(), sizeof(owt_base::Frame) + frame.length + 5,
+            [this](char* data, size_t length) { onData(data, length); });
+    }
+
+private:
+    void onData(char* buf, size_t len)
+    {
+        if (m_receivedBytes + len >= m_bufferSize) {
+            m_bufferSize += (m_receivedBytes + len);
+            boost::shared_array<char> newBuffer(new char[m_bufferSize]);
+            memcpy(newBuffer.get(), m_receiveBuffer.get(), m_receivedBytes);
+            m_receiveBuffer = newBuffer;
+        }
+        memcpy(m_receiveBuffer.get() + m_receivedBytes, buf, len);
+        m_receivedBytes += len;
+        while (m_receivedBytes >= 4) {
+            uint32_t payloadLength = ntohl(*(reinterpret_cast<uint32_t*>(m_receiveBuffer.get())));
+            uint32_t expectedLength = payloadLength + 4;
+            if (expectedLength > m_receivedBytes) {
+                break;
+            }
+            m_receivedBytes -= expectedLength;
+            char* dpos = m_receiveBuffer.get() + 4;
+            m_counter->onFrame(dpos[0], dpos + 1, payloadLength - 1);
+            if (m_receivedBytes > 0) {
+                memmove(m_receiveBuffer.get(), m_receiveBuffer.get() + expectedLength, m_receivedBytes);
+            }
+        }
+    }
+
+    Counter* m_counter;
+    LoopbackWire m_wire;
+    boost::shared_array<char> m_receiveBuffer;
+    size_t m_bufferSize;
+    size_t m_receivedBytes;
+};
+
+class ArenaFraming : public MessageSendArena::Writer, public MessageParser::Visitor {
+public:
+    explicit ArenaFraming(Counter* counter)
+        : m_counter(counter)
+        , m_arena(this)
+        , m_parser(this)
+    {
+    }
+
+    void send(const owt_base::Frame& frame)
+    {
+        m_arena.send(TDT_MEDIA_FRAME, reinterpret_cast<const char*>(&frame), sizeof(owt_base::Frame),
+            reinterpret_cast<const char*>(frame.payload), frame.length);
+    }
+
+    void write(const char* data, size_t length) override
+    {
+        m_wire.write(data, length, [this](char* chunk, size_t chunkLength) { m_parser.feed(chunk, chunkLength); });
+    }
+
+    void onMessage(char type, char* body, uint32_t length) override
+    {
+        m_counter->onFrame(type, body, length);
+    }
+
+private:
+    Counter* m_counter;
+    LoopbackWire m_wire;
+    MessageSendArena m_arena;
+    MessageParser m_parser;
+};
+
+template <typename Framing>
+static void run(const char* name, uint32_t frameCount, const std::vector<uint8_t>& payload)
+{
+    Counter counter;
+    Framing framing(&counter);
+    owt_base::Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_VP8;
+    frame.payload = const_cast<uint8_t*>(payload.data());
+
+    uint32_t seed = 7;
+    uint64_t allocations = s_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frameCount; i++) {
+        seed = seed * 1103515245 + 12345;
+        // Half audio sized frames, half video frames up to 60KB
+        frame.length = (i % 2) ? 160 : 1000 + (seed >> 8) % 60000;
+        frame.timeStamp = i;
+        framing.send(frame);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    allocations = s_allocations.load() - allocations;
+
+    printf("%-8s frames %lu/%u, %.0f frames/s, %.1f MB/s, %.3f allocations/frame\n",
+        name, counter.frames, frameCount, counter.frames / seconds,
+        counter.bytes / seconds / 1e6, static_cast<double>(allocations) / frameCount);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t frameCount = argc > 1 ? atoi(argv[1]) : 200000;
+    std::vector<uint8_t> payload(61000, 0x5A);
+
+    run<LegacyFraming>("legacy", frameCount, payload);
+    run<ArenaFraming>("arena", frameCount, payload);
+    return 0;
+}
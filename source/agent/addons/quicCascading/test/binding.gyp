@@ -0,0 +1,37 @@
+{
+  'targets': [{
+    'target_name': 'messageFramingBenchmark',
+    'type': 'executable',
+    'sources': [
+      'MessageFramingBenchmark.cc',
+      '../MessageFraming.cc',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-llog4cxx',
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }, {
+    'target_name': 'datagramLatencyBenchmark',
+    'type': 'executable',
+    'sources': [
+      'DatagramLatencyBenchmark.cc',
+      '../FrameReorderBuffer.cc',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-llog4cxx',
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }]
+}
@@ -62,12 +62,18 @@ NAN_METHOD(VideoSwitch::close) {
 
 NAN_METHOD(VideoSwitch::setTargetBitrate) {
   VideoSwitch* obj = ObjectWrap::Unwrap<VideoSwitch>(info.Holder());
+  if (!obj->me) {
+    return;
+  }
   unsigned int bitrate = Nan::To<unsigned int>(info[0]).FromJust();
   obj->me->setTargetBitrate(bitrate);
 }
 
 NAN_METHOD(VideoSwitch::addDestination) {
   VideoSwitch* obj = ObjectWrap::Unwrap<VideoSwitch>(info.Holder());
+  if (!obj->me) {
+    return;
+  }
 
   Nan::Utf8String param0(Nan::To<v8::String>(info[0]).ToLocalChecked());
   std::string track = std::string(*param0);
@@ -86,6 +92,9 @@ NAN_METHOD(VideoSwitch::addDestination) {
 
 NAN_METHOD(VideoSwitch::removeDestination) {
   VideoSwitch* obj = ObjectWrap::Unwrap<VideoSwitch>(info.Holder());
+  if (!obj->me) {
+    return;
+  }
 
   Nan::Utf8String param0(Nan::To<v8::String>(info[0]).ToLocalChecked());
   std::string track = std::string(*param0);
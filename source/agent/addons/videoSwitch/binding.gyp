@@ -5,6 +5,8 @@
       'addon.cc',
       'VideoSwitchWrapper.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../core/owt_base/selector/LayerRateEstimator.cpp',
+      '../../../core/owt_base/selector/VideoLayerFilter.cpp',
       '../../../core/owt_base/selector/VideoQualitySwitch.cpp',
     ],
     'include_dirs': [
@@ -0,0 +1,142 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Measures the per frame cost of bitrate bookkeeping with many quality
+// switches on the same three simulcast layers. "legacy" attaches one
+// deque based counter per switch and layer, the way every switch used to
+// count for itself. "estimator" is the shared LayerRateEstimator alone,
+// counted once per layer whatever the number of switches. "shared" builds
+// real VideoQualitySwitches, which forward frames through their layer
+// filters and share one estimator per layer, so it also includes the
+// forwarding. Frames are delivered as fast as possible.
+//
+// Usage: qualitySwitchBenchmark [switches] [frames per layer]
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "VideoQualitySwitch.h"
+
+using namespace owt_base;
+using Clock = std::chrono::steady_clock;
+
+static const int kLayers = 3;
+static const uint32_t kLayerFrameSize[kLayers] = {400, 1200, 4000};
+
+class LayerSource : public FrameSource {
+public:
+    void generateFrame(const Frame& frame) { deliverFrame(frame); }
+};
+
+class NullDestination : public FrameDestination {
+public:
+    void onFrame(const Frame&) override {}
+};
+
+// Copy of the previous per switch counter
+class LegacyCounter : public FrameDestination {
+public:
+    LegacyCounter() : m_totalBits(0) {}
+
+    void onFrame(const Frame& frame) override
+    {
+        uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
+            Clock::now().time_since_epoch()).count();
+        if (m_timeFrames.empty() || (tsNow - m_timeFrames.back().timeStamp) >= 100) {
+            m_timeFrames.push_back({tsNow, 0});
+        }
+        m_timeFrames.back().total += frame.length * 8;
+        m_totalBits += frame.length * 8;
+        while (m_timeFrames.size() > 50) {
+            m_totalBits -= m_timeFrames.front().total;
+            m_timeFrames.pop_front();
+        }
+    }
+private:
+    struct Bucket {
+        uint64_t timeStamp;
+        uint32_t total;
+    };
+    std::deque<Bucket> m_timeFrames;
+    uint32_t m_totalBits;
+};
+
+static double deliver(LayerSource* sources, int frames)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_VP8;
+
+    auto start = Clock::now();
+    for (int n = 0; n < frames; n++) {
+        for (int l = 0; l < kLayers; l++) {
+            frame.timeStamp = n * 3000;
+            frame.length = kLayerFrameSize[l];
+            frame.additionalInfo.video.isKeyFrame = (n % 100 == 0);
+            sources[l].generateFrame(frame);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count()
+        / (static_cast<double>(frames) * kLayers);
+}
+
+int main(int argc, char* argv[])
+{
+    int switches = argc > 1 ? atoi(argv[1]) : 1000;
+    int frames = argc > 2 ? atoi(argv[2]) : 3000;
+    printf("%d switches, %d layers, %d frames per layer\n", switches, kLayers, frames);
+
+    {
+        LayerSource sources[kLayers];
+        std::vector<std::unique_ptr<LegacyCounter>> counters;
+        for (int i = 0; i < switches; i++) {
+            for (int l = 0; l < kLayers; l++) {
+                counters.emplace_back(new LegacyCounter());
+                sources[l].addVideoDestination(counters.back().get());
+            }
+        }
+        double ns = deliver(sources, frames);
+        printf("legacy %9.1f ns per source frame, %7.1f ns per switch\n", ns, ns / switches);
+        for (int i = 0; i < switches * kLayers; i++) {
+            sources[i % kLayers].removeVideoDestination(counters[i].get());
+        }
+    }
+
+    {
+        LayerSource sources[kLayers];
+        std::vector<std::shared_ptr<LayerRateEstimator>> estimators;
+        for (int l = 0; l < kLayers; l++) {
+            estimators.push_back(LayerRateEstimator::get(&sources[l]));
+        }
+        double ns = deliver(sources, frames);
+        printf("estimator %6.1f ns per source frame\n", ns);
+    }
+
+    {
+        LayerSource sources[kLayers];
+        NullDestination dest;
+        std::vector<std::unique_ptr<VideoQualitySwitch>> vswitches;
+        for (int i = 0; i < switches; i++) {
+            vswitches.emplace_back(new VideoQualitySwitch({&sources[0], &sources[1], &sources[2]}));
+            vswitches.back()->addVideoDestination(&dest);
+        }
+        double ns = deliver(sources, frames);
+        auto start = Clock::now();
+        for (auto& vswitch : vswitches) {
+            vswitch->setTargetBitrate(500000);
+        }
+        double selectUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / switches;
+        printf("shared %9.1f ns per source frame, %7.1f ns per switch, %.1f us per setTargetBitrate\n",
+            ns, ns / switches, selectUs);
+        for (auto& vswitch : vswitches) {
+            vswitch->removeVideoDestination(&dest);
+        }
+    }
+    return 0;
+}
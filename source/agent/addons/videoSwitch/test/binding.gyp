@@ -0,0 +1,62 @@
+{
+  'targets': [{
+    'target_name': 'videoLayerFilterTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/selector/VideoLayerFilterTest.cpp',
+      '../../../../core/owt_base/selector/LayerRateEstimator.cpp',
+      '../../../../core/owt_base/selector/VideoLayerFilter.cpp',
+      '../../../../core/owt_base/selector/VideoQualitySwitch.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '../../../../core/owt_base/selector/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  },
+  {
+    'target_name': 'qualitySwitchBenchmark',
+    'type': 'executable',
+    'sources': [
+      'QualitySwitchBenchmark.cc',
+      '../../../../core/owt_base/selector/LayerRateEstimator.cpp',
+      '../../../../core/owt_base/selector/VideoLayerFilter.cpp',
+      '../../../../core/owt_base/selector/VideoQualitySwitch.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+    ],
+    'include_dirs': [
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+        '../../../../core/owt_base/selector/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }]
+}
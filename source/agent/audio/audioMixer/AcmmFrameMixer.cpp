@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+
 #include "AcmmFrameMixer.h"
 
 namespace mcu {
@@ -31,6 +33,8 @@ DEFINE_LOGGER(AcmmFrameMixer, "mcu.media.AcmmFrameMixer");
 AcmmFrameMixer::AcmmFrameMixer()
     : m_asyncHandle(NULL)
     , m_vadEnabled(false)
+    , m_decodeOnDemand(0)
+    , m_mixTicks(0)
     , m_frequency(0)
 {
     m_mixerModule.reset(AudioConferenceMixer::Create(0));
@@ -145,14 +149,22 @@ void AcmmFrameMixer::resetVAD()
     m_mostActiveInput.reset();
 }
 
-bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source)
+void AcmmFrameMixer::enableDecodeOnDemand(uint32_t maxInputs)
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    ELOG_DEBUG("enableDecodeOnDemand, maxInputs(%u)", maxInputs);
+
+    m_decodeOnDemand = maxInputs;
+}
+
+bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source, bool fastDecode)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
     boost::shared_ptr<AcmmGroup> acmmGroup;
     boost::shared_ptr<AcmmInput> acmmInput;
     int ret;
 
-    ELOG_DEBUG("addInput: group(%s), inStream(%s), format(%s), source(%p)", group.c_str(), inStream.c_str(), getFormatStr(format), source);
+    ELOG_DEBUG("addInput: group(%s), inStream(%s), format(%s), source(%p), fastDecode(%d)", group.c_str(), inStream.c_str(), getFormatStr(format), source, fastDecode);
 
     acmmGroup = getGroup(group);
     if (!acmmGroup) {
@@ -168,7 +180,7 @@ bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStr
         ELOG_DEBUG("Update previous input");
 
         acmmInput->unsetSource();
-        if(!acmmInput->setSource(format, source)) {
+        if(!acmmInput->setSource(format, source, fastDecode, m_decodeOnDemand > 0)) {
             ELOG_ERROR("Fail to update source");
             return false;
         }
@@ -179,7 +191,7 @@ bool AcmmFrameMixer::addInput(const std::string& group, const std::string& inStr
             return false;
         }
 
-        if (!acmmInput->setSource(format, source)) {
+        if (!acmmInput->setSource(format, source, fastDecode, m_decodeOnDemand > 0)) {
             ELOG_ERROR("Fail to set source");
             return false;
         }
@@ -492,9 +504,54 @@ void AcmmFrameMixer::onTimeout()
 void AcmmFrameMixer::performMix()
 {
     boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+    if (m_decodeOnDemand && m_mixTicks % DECODE_RANK_TICKS == 0)
+        rankDecodingInputs();
+    m_mixTicks++;
+
     m_mixerModule->Process();
 }
 
+void AcmmFrameMixer::rankDecodingInputs()
+{
+    std::vector<boost::shared_ptr<AcmmInput>> candidates;
+
+    for (auto& g : m_groups) {
+        std::vector<boost::shared_ptr<AcmmInput>> inputs;
+        g.second->getInputs(inputs);
+        for (auto& i : inputs) {
+            if (!i->decodesOnDemand())
+                continue;
+
+            // Without audio levels there is nothing to rank by
+            if (!i->hasAudioLevel()) {
+                i->setDecoding(i->isActive());
+                continue;
+            }
+
+            if (!i->isActive()) {
+                i->setDecoding(false);
+                continue;
+            }
+
+            candidates.push_back(i);
+        }
+    }
+
+    size_t loudest = std::min<size_t>(m_decodeOnDemand, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + loudest, candidates.end(),
+        [](const boost::shared_ptr<AcmmInput>& a, const boost::shared_ptr<AcmmInput>& b) {
+            return a->audioLevel() > b->audioLevel();
+        });
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        boost::shared_ptr<AcmmInput>& acmmInput = candidates[i];
+        if (i < loudest && acmmInput->audioLevel() > 0)
+            acmmInput->setDecodeHoldTick(m_mixTicks + DECODE_HOLD_TICKS);
+
+        acmmInput->setDecoding(m_mixTicks < acmmInput->decodeHoldTick());
+    }
+}
+
 void AcmmFrameMixer::NewMixedAudio(int32_t id,
         const AudioFrame& generalAudioFrame,
         const AudioFrame** uniqueAudioFrames,
@@ -579,7 +636,7 @@ void AcmmFrameMixer::VadParticipants(const ParticipantVadStatistics *statistics,
                 , activeAcmmInput->name().c_str());
 
         m_mostActiveInput = activeAcmmInput;
-        m_asyncHandle->notifyAsyncEvent("vad", m_mostActiveInput->name().c_str());
+        m_asyncHandle->notifyAsyncEventCoalesced("vad", m_mostActiveInput->name().c_str());
     }
 }
 
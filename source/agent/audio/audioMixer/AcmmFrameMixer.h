@@ -32,6 +32,10 @@ class AcmmFrameMixer : public AudioFrameMixer,
 
     static const int32_t MAX_GROUPS = 10240;
     static const int32_t MIXER_FREQUENCY = 100;
+    // Mix ticks between rankings of decode on demand inputs
+    static const uint32_t DECODE_RANK_TICKS = 10;
+    // Mix ticks an input keeps decoding after leaving the loudest set
+    static const uint32_t DECODE_HOLD_TICKS = 100;
 
     struct OutputInfo {
         owt_base::FrameFormat format;
@@ -47,7 +51,9 @@ public:
     void disableVAD() override;
     void resetVAD() override;
 
-    bool addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source) override;
+    void enableDecodeOnDemand(uint32_t maxInputs) override;
+
+    bool addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source, bool fastDecode) override;
     void removeInput(const std::string& group, const std::string& inStream) override;
 
     void setInputActive(const std::string& group, const std::string& inStream, bool active) override;
@@ -83,6 +89,8 @@ protected:
 
     void updateFrequency();
 
+    void rankDecodingInputs();
+
     boost::shared_ptr<AcmmInput> getInputById(int32_t id);
 
     void statistics();
@@ -101,6 +109,8 @@ private:
     boost::shared_mutex m_mutex;
 
     bool m_vadEnabled;
+    uint32_t m_decodeOnDemand;
+    uint64_t m_mixTicks;
     boost::shared_ptr<AcmmInput> m_mostActiveInput;
     int32_t m_frequency;
 };
@@ -6,6 +6,7 @@
 
 #include "AcmDecoder.h"
 #include "FfDecoder.h"
+#include "FastDecoder.h"
 
 namespace mcu {
 
@@ -20,6 +21,8 @@ AcmmInput::AcmmInput(int32_t id, const std::string &name)
     , m_active(true)
     , m_srcFormat(FRAME_FORMAT_UNKNOWN)
     , m_source(NULL)
+    , m_onDemandDecoder(NULL)
+    , m_decodeHoldTick(0)
 {
     ELOG_DEBUG_T("AcmmInput(0x%x)", id);
 }
@@ -32,9 +35,9 @@ AcmmInput::~AcmmInput()
         unsetSource();
 }
 
-bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
+bool AcmmInput::setSource(FrameFormat format, FrameSource* source, bool fastDecode, bool decodeOnDemand)
 {
-    ELOG_DEBUG_T("setSource, format(%s), source(%p)", getFormatStr(format), source);
+    ELOG_DEBUG_T("setSource, format(%s), source(%p), fastDecode(%d), decodeOnDemand(%d)", getFormatStr(format), source, fastDecode, decodeOnDemand);
 
     switch(format) {
         case FRAME_FORMAT_AAC:
@@ -52,7 +55,13 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
         case FRAME_FORMAT_ILBC:
         case FRAME_FORMAT_G722_16000_1:
         case FRAME_FORMAT_G722_16000_2:
-            m_decoder.reset(new AcmDecoder(format));
+            if (decodeOnDemand) {
+                m_onDemandDecoder = new OnDemandDecoder(format, fastDecode);
+                m_decoder.reset(m_onDemandDecoder);
+            } else if (fastDecode && FastDecoder::isSupported(format))
+                m_decoder.reset(new FastDecoder(format));
+            else
+                m_decoder.reset(new AcmDecoder(format));
             break;
         default:
             ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
@@ -61,6 +70,7 @@ bool AcmmInput::setSource(FrameFormat format, FrameSource* source)
 
     if (!m_decoder->init()) {
         m_decoder.reset();
+        m_onDemandDecoder = NULL;
         return false;
     }
 
@@ -78,6 +88,8 @@ void AcmmInput::unsetSource()
     m_source = NULL;
     m_srcFormat = FRAME_FORMAT_UNKNOWN;
     m_decoder.reset();
+    m_onDemandDecoder = NULL;
+    m_decodeHoldTick = 0;
 }
 
 void AcmmInput::setActive(bool active)
@@ -85,6 +97,12 @@ void AcmmInput::setActive(bool active)
     m_active = active;
 }
 
+void AcmmInput::setDecoding(bool decoding)
+{
+    if (m_onDemandDecoder)
+        m_onDemandDecoder->setDecoding(decoding);
+}
+
 int32_t AcmmInput::GetAudioFrame(int32_t id, AudioFrame* audio_frame)
 {
     if (!m_active)
@@ -15,6 +15,7 @@
 #include "MediaFramePipeline.h"
 
 #include "AudioDecoder.h"
+#include "OnDemandDecoder.h"
 
 namespace mcu {
 
@@ -33,11 +34,21 @@ public:
 
     bool isActive() {return m_active;}
 
-    bool setSource(FrameFormat format, FrameSource* source);
+    bool setSource(FrameFormat format, FrameSource* source, bool fastDecode = false, bool decodeOnDemand = false);
     void unsetSource();
 
     void setActive(bool active);
 
+    // Decode on demand, only for inputs set with decodeOnDemand
+    bool decodesOnDemand() {return m_onDemandDecoder != NULL;}
+    bool hasAudioLevel() {return m_onDemandDecoder && m_onDemandDecoder->hasAudioLevel();}
+    uint32_t audioLevel() {return m_onDemandDecoder ? m_onDemandDecoder->audioLevel() : 0;}
+    void setDecoding(bool decoding);
+
+    // Mix tick until which the input keeps decoding after leaving the loudest set
+    uint64_t decodeHoldTick() {return m_decodeHoldTick;}
+    void setDecodeHoldTick(uint64_t tick) {m_decodeHoldTick = tick;}
+
     // Implements MixerParticipant
     int32_t GetAudioFrame(int32_t id, AudioFrame* audioFrame) override;
     int32_t NeededFrequency(int32_t id) const override;
@@ -52,6 +63,8 @@ private:
     FrameSource *m_source;
 
     boost::shared_ptr<AudioDecoder> m_decoder;
+    OnDemandDecoder *m_onDemandDecoder;
+    uint64_t m_decodeHoldTick;
 };
 
 } /* namespace mcu */
@@ -19,7 +19,13 @@ public:
     virtual void disableVAD() = 0;
     virtual void resetVAD() = 0;
 
-    virtual bool addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source) = 0;
+    // Inputs added afterwards are only decoded while among the loudest
+    // maxInputs by RTP audio level, 0 to decode all
+    virtual void enableDecodeOnDemand(uint32_t maxInputs) = 0;
+
+    // fastDecode decodes without NetEQ when the codec allows, only for
+    // sources that arrive paced and in order
+    virtual bool addInput(const std::string& group, const std::string& inStream, const owt_base::FrameFormat format, owt_base::FrameSource* source, bool fastDecode = false) = 0;
     virtual void removeInput(const std::string& group, const std::string& inStream) = 0;
 
     virtual void setInputActive(const std::string& group, const std::string& inStream, bool active) = 0;
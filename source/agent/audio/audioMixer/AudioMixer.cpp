@@ -69,7 +69,12 @@ void AudioMixer::resetVAD()
     m_mixer->resetVAD();
 }
 
-bool AudioMixer::addInput(const std::string& endpoint, const std::string& inStreamId, const std::string& codec, owt_base::FrameSource* source)
+void AudioMixer::enableDecodeOnDemand(uint32_t maxInputs)
+{
+    m_mixer->enableDecodeOnDemand(maxInputs);
+}
+
+bool AudioMixer::addInput(const std::string& endpoint, const std::string& inStreamId, const std::string& codec, owt_base::FrameSource* source, bool fastDecode)
 {
     assert(source);
 
@@ -79,7 +84,7 @@ bool AudioMixer::addInput(const std::string& endpoint, const std::string& inStre
         return false;
     }
 
-    return m_mixer->addInput(endpoint, inStreamId, format, source);
+    return m_mixer->addInput(endpoint, inStreamId, format, source, fastDecode);
 }
 
 void AudioMixer::removeInput(const std::string& endpoint, const std::string& inStreamId)
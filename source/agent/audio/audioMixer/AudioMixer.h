@@ -23,8 +23,9 @@ public:
     void enableVAD(uint32_t period);
     void disableVAD();
     void resetVAD();
+    void enableDecodeOnDemand(uint32_t maxInputs);
 
-    bool addInput(const std::string& endpoint, const std::string& inStreamId, const std::string& codec, owt_base::FrameSource* source);
+    bool addInput(const std::string& endpoint, const std::string& inStreamId, const std::string& codec, owt_base::FrameSource* source, bool fastDecode = false);
     void removeInput(const std::string& endpoint, const std::string& inStreamId);
     void setInputActive(const std::string& endpoint, const std::string& inStreamId, bool active);
 
@@ -25,6 +25,7 @@ void AudioMixer::Init(Local<Object> exports, Local<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "enableVAD", enableVAD);
   NODE_SET_PROTOTYPE_METHOD(tpl, "disableVAD", disableVAD);
   NODE_SET_PROTOTYPE_METHOD(tpl, "resetVAD", resetVAD);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "enableDecodeOnDemand", enableDecodeOnDemand);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addInput", addInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeInput", removeInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "setInputActive", setInputActive);
@@ -94,6 +95,17 @@ void AudioMixer::resetVAD(const v8::FunctionCallbackInfo<v8::Value>& args) {
   obj->me->resetVAD();
 }
 
+void AudioMixer::enableDecodeOnDemand(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  AudioMixer* obj = ObjectWrap::Unwrap<AudioMixer>(args.Holder());
+  if (obj->me == nullptr)
+    return;
+
+  uint32_t maxInputs = Nan::To<uint32_t>(args[0]).FromJust();
+  obj->me->enableDecodeOnDemand(maxInputs);
+}
+
 void AudioMixer::addInput(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -109,8 +121,9 @@ void AudioMixer::addInput(const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string codec = std::string(*param2);
   FrameSource* param3 = ObjectWrap::Unwrap<FrameSource>(args[3]->ToObject(Nan::GetCurrentContext()).ToLocalChecked());
   owt_base::FrameSource* src = param3->src;
+  bool fastDecode = args.Length() > 4 && Nan::To<bool>(args[4]).FromJust();
 
-  bool r = me->addInput(endpointID, streamID, codec, src);
+  bool r = me->addInput(endpointID, streamID, codec, src, fastDecode);
 
   args.GetReturnValue().Set(Boolean::New(isolate, r));
 }
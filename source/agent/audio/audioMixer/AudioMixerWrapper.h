@@ -29,6 +29,7 @@ class AudioMixer : public node::ObjectWrap, public NodeEventRegistry {
   static void enableVAD(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void disableVAD(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void resetVAD(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void enableDecodeOnDemand(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void addInput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void removeInput(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void setInputActive(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -0,0 +1,251 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <string.h>
+
+#include <rtputils.h>
+
+#include <webrtc/modules/audio_coding/codecs/g711/g711_interface.h>
+
+#include "AudioUtilities.h"
+#include "FastDecoder.h"
+
+namespace mcu {
+
+using namespace webrtc;
+using namespace owt_base;
+
+DEFINE_LOGGER(FastDecoder, "mcu.media.FastDecoder");
+
+const int FastDecoder::kRingSize;
+const int FastDecoder::kMaxDelayFrames;
+const int FastDecoder::kMaxPlcFrames;
+const int FastDecoder::kMaxMisorder;
+
+FastDecoder::FastDecoder(const FrameFormat format)
+    : m_format(format)
+    , m_sampleRate(0)
+    , m_channels(0)
+    , m_samplesPer10Ms(0)
+    , m_valid(false)
+    , m_opusDecoder(NULL)
+    , m_pendingSamples(0)
+    , m_hasLast(false)
+    , m_lastSeqNumber(0)
+    , m_lastTimestamp(0)
+    , m_outOfOrder(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_overflows(0)
+    , m_plcFrames(kMaxPlcFrames)
+    , m_timestamp(0)
+{
+}
+
+FastDecoder::~FastDecoder()
+{
+    if (m_opusDecoder) {
+        WebRtcOpus_DecoderFree(m_opusDecoder);
+        m_opusDecoder = NULL;
+    }
+    if (m_overflows) {
+        ELOG_DEBUG_T("%lu frames dropped on full ring", m_overflows.load());
+    }
+    if (m_outOfOrder) {
+        ELOG_DEBUG_T("%lu duplicate or reordered packets dropped", m_outOfOrder);
+    }
+}
+
+bool FastDecoder::isSupported(const FrameFormat format)
+{
+    return format == FRAME_FORMAT_OPUS
+        || format == FRAME_FORMAT_PCMU
+        || format == FRAME_FORMAT_PCMA;
+}
+
+bool FastDecoder::init()
+{
+    if (!isSupported(m_format)) {
+        ELOG_ERROR_T("Unsupported format(%s)", getFormatStr(m_format));
+        return false;
+    }
+
+    m_sampleRate = getAudioSampleRate(m_format);
+    m_channels = getAudioChannels(m_format);
+    m_samplesPer10Ms = m_sampleRate / 100;
+
+    if (m_format == FRAME_FORMAT_OPUS) {
+        if (WebRtcOpus_DecoderCreate(&m_opusDecoder, m_channels) != 0) {
+            ELOG_ERROR_T("Error WebRtcOpus_DecoderCreate");
+            return false;
+        }
+        WebRtcOpus_DecoderInit(m_opusDecoder);
+    }
+
+    m_valid = true;
+    return true;
+}
+
+bool FastDecoder::getAudioFrame(AudioFrame* audioFrame)
+{
+    if (!m_valid)
+        return false;
+
+    size_t samples = m_samplesPer10Ms * m_channels;
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    if (head - tail > static_cast<uint32_t>(kMaxDelayFrames)) {
+        ELOG_TRACE_T("Skip %u frames", head - tail - kMaxDelayFrames);
+        tail = head - kMaxDelayFrames;
+    }
+
+    AudioFrame::SpeechType speechType = AudioFrame::kNormalSpeech;
+    if (head != tail) {
+        memcpy(m_last.data, m_ring[tail % kRingSize].data, samples * sizeof(int16_t));
+        m_tail.store(tail + 1, std::memory_order_release);
+        m_plcFrames = 0;
+    } else {
+        if (m_plcFrames >= kMaxPlcFrames)
+            return false;
+        // Repeat the last frame at half the level each time
+        for (size_t i = 0; i < samples; i++) {
+            m_last.data[i] /= 2;
+        }
+        m_plcFrames++;
+        speechType = AudioFrame::kPLC;
+    }
+
+    int outRate = audioFrame->sample_rate_hz_ > 0 ? audioFrame->sample_rate_hz_ : m_sampleRate;
+    if (m_resampler.InitializeIfNeeded(m_sampleRate, outRate, m_channels) != 0) {
+        ELOG_ERROR_T("Error InitializeIfNeeded(%d -> %d)", m_sampleRate, outRate);
+        return false;
+    }
+    int length = m_resampler.Resample(m_last.data, samples, m_output, kMaxSamplesPer10Ms);
+    if (length <= 0) {
+        ELOG_ERROR_T("Error Resample(%d -> %d)", m_sampleRate, outRate);
+        return false;
+    }
+
+    audioFrame->UpdateFrame(
+            -1,
+            m_timestamp,
+            m_output,
+            length / m_channels,
+            outRate,
+            speechType,
+            AudioFrame::kVadUnknown,
+            m_channels
+            );
+    m_timestamp += length / m_channels;
+    return true;
+}
+
+void FastDecoder::pushSamples(const int16_t* samples, size_t samplesPerChannel)
+{
+    size_t frameSamples = m_samplesPer10Ms * m_channels;
+    size_t remaining = samplesPerChannel * m_channels;
+
+    while (remaining) {
+        size_t copy = std::min(frameSamples - m_pendingSamples, remaining);
+        memcpy(m_pending.data + m_pendingSamples, samples, copy * sizeof(int16_t));
+        m_pendingSamples += copy;
+        samples += copy;
+        remaining -= copy;
+        if (m_pendingSamples < frameSamples)
+            break;
+
+        m_pendingSamples = 0;
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= static_cast<uint32_t>(kRingSize)) {
+            m_overflows++;
+            continue;
+        }
+        memcpy(m_ring[head % kRingSize].data, m_pending.data, frameSamples * sizeof(int16_t));
+        m_head.store(head + 1, std::memory_order_release);
+    }
+}
+
+bool FastDecoder::isInOrder(const Frame& frame)
+{
+    bool inOrder = true;
+    if (frame.additionalInfo.audio.isRtpPacket) {
+        uint16_t seqNumber = reinterpret_cast<::RTPHeader*>(frame.payload)->getSeqNumber();
+        int16_t diff = static_cast<int16_t>(seqNumber - m_lastSeqNumber);
+        inOrder = !m_hasLast || diff > 0 || diff <= -kMaxMisorder;
+        if (inOrder) {
+            m_lastSeqNumber = seqNumber;
+        }
+    } else {
+        // Timestamps in samples at the codec rate, a 10ms frame a packet
+        int32_t diff = static_cast<int32_t>(frame.timeStamp - m_lastTimestamp);
+        int32_t maxMisorder = kMaxMisorder * static_cast<int32_t>(m_samplesPer10Ms);
+        inOrder = !m_hasLast || diff > 0 || diff <= -maxMisorder;
+        if (inOrder) {
+            m_lastTimestamp = frame.timeStamp;
+        }
+    }
+    if (!inOrder) {
+        m_outOfOrder++;
+        return false;
+    }
+    m_hasLast = true;
+    return true;
+}
+
+void FastDecoder::onFrame(const Frame& frame)
+{
+    uint8_t *payload = NULL;
+    size_t length = 0;
+    int16_t speechType;
+    int samples;
+
+    if (!m_valid) {
+        ELOG_ERROR_T("Not valid");
+        return;
+    }
+
+    if (!isInOrder(frame)) {
+        ELOG_TRACE_T("Drop duplicate or reordered packet, timeStamp(%u)", frame.timeStamp);
+        return;
+    }
+
+    if (frame.additionalInfo.audio.isRtpPacket) {
+        ::RTPHeader *head = reinterpret_cast<::RTPHeader*>(frame.payload);
+        payload = frame.payload + head->getHeaderLength();
+        length = frame.length - head->getHeaderLength();
+    } else {
+        payload = frame.payload;
+        length = frame.length;
+    }
+
+    switch (m_format) {
+        case FRAME_FORMAT_OPUS:
+            samples = WebRtcOpus_Decode(m_opusDecoder, payload, length, m_decoded, &speechType);
+            break;
+        case FRAME_FORMAT_PCMU:
+            length = std::min(length, static_cast<size_t>(kMaxDecodedSamples));
+            samples = WebRtcG711_DecodeU(payload, length, m_decoded, &speechType);
+            break;
+        case FRAME_FORMAT_PCMA:
+            length = std::min(length, static_cast<size_t>(kMaxDecodedSamples));
+            samples = WebRtcG711_DecodeA(payload, length, m_decoded, &speechType);
+            break;
+        default:
+            return;
+    }
+
+    if (samples < 0) {
+        ELOG_ERROR_T("Fail to decode, format(%s), length(%ld)", getFormatStr(m_format), length);
+        return;
+    }
+
+    ELOG_TRACE_T("onFrame(%s), timeStamp(%u), length(%ld), samples(%d)",
+            getFormatStr(frame.format), frame.timeStamp, length, samples);
+
+    pushSamples(m_decoded, samples);
+}
+
+} /* namespace mcu */
@@ -0,0 +1,103 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FastDecoder_h
+#define FastDecoder_h
+
+#include <atomic>
+
+#include <webrtc/common_audio/resampler/include/push_resampler.h>
+#include <webrtc/modules/audio_coding/codecs/opus/opus_interface.h>
+
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+#include "AudioDecoder.h"
+
+namespace mcu {
+using namespace owt_base;
+using namespace webrtc;
+
+/*
+ * Decoder for inputs produced by other media nodes, which arrive paced
+ * and in order, without the NetEQ of an AudioCodingModule. Duplicate and
+ * reordered packets are dropped by RTP sequence number, or by timestamp
+ * for frames that are not RTP packets, as there is no jitter buffer to
+ * put them back in place. Opus, PCMU and PCMA packets
+ * are decoded in onFrame into a ring of 10ms frames at the codec rate,
+ * which the mixer thread takes without locking. A missing frame is
+ * concealed by repeating the last one fading out, after that the input is
+ * muted until packets come again. When the ring runs ahead of the mixer,
+ * the oldest frames are skipped to keep the delay low.
+ */
+class FastDecoder : public AudioDecoder {
+    DECLARE_LOGGER();
+
+public:
+    static const int kRingSize = 16;
+    // Frames kept before the oldest are skipped
+    static const int kMaxDelayFrames = 6;
+    // Concealed frames before the input is muted
+    static const int kMaxPlcFrames = 5;
+    // Packets further behind are taken as a restarted stream
+    static const int kMaxMisorder = 100;
+
+    FastDecoder(const FrameFormat format);
+    ~FastDecoder();
+
+    static bool isSupported(const FrameFormat format);
+
+    bool init() override;
+    bool getAudioFrame(AudioFrame *audioFrame) override;
+
+    // Implements owt_base::FrameDestination
+    void onFrame(const Frame& frame) override;
+
+private:
+    static const int kMaxSamplesPer10Ms = 480 * 2;
+    // 120ms of 48kHz stereo, the longest opus packet
+    static const int kMaxDecodedSamples = 5760 * 2;
+
+    struct PcmFrame {
+        int16_t data[kMaxSamplesPer10Ms];
+    };
+
+    // Moves decoded samples into the ring in 10ms frames
+    void pushSamples(const int16_t* samples, size_t samplesPerChannel);
+    // False for a duplicate or a packet older than the last one
+    bool isInOrder(const Frame& frame);
+
+    FrameFormat m_format;
+    int m_sampleRate;
+    size_t m_channels;
+    size_t m_samplesPer10Ms;
+    bool m_valid;
+
+    // Producer side, used from onFrame only
+    OpusDecInst* m_opusDecoder;
+    int16_t m_decoded[kMaxDecodedSamples];
+    size_t m_pendingSamples;
+    PcmFrame m_pending;
+    bool m_hasLast;
+    uint16_t m_lastSeqNumber;
+    uint32_t m_lastTimestamp;
+    uint64_t m_outOfOrder;
+
+    // Single producer single consumer ring
+    PcmFrame m_ring[kRingSize];
+    std::atomic<uint32_t> m_head;
+    std::atomic<uint32_t> m_tail;
+    std::atomic<uint64_t> m_overflows;
+
+    // Consumer side, used from getAudioFrame only
+    PushResampler<int16_t> m_resampler;
+    PcmFrame m_last;
+    int m_plcFrames;
+    uint32_t m_timestamp;
+    int16_t m_output[kMaxSamplesPer10Ms];
+};
+
+} /* namespace mcu */
+
+#endif /* FastDecoder_h */
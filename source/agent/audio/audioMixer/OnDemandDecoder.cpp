@@ -0,0 +1,171 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#include "AcmDecoder.h"
+#include "FastDecoder.h"
+#include "OnDemandDecoder.h"
+
+namespace mcu {
+
+using namespace webrtc;
+using namespace owt_base;
+
+DEFINE_LOGGER(OnDemandDecoder, "mcu.media.OnDemandDecoder");
+
+const int OnDemandDecoder::kWarmupPackets;
+const int OnDemandDecoder::kWarmupMs;
+
+static inline int64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+OnDemandDecoder::OnDemandDecoder(const FrameFormat format, bool fastDecode)
+    : m_format(format)
+    , m_fastDecode(fastDecode)
+    , m_wanted(false)
+    , m_decoding(false)
+    , m_hasLevel(false)
+    , m_level(0)
+    , m_packetCount(0)
+    , m_nextPacket(0)
+    , m_promotions(0)
+{
+}
+
+OnDemandDecoder::~OnDemandDecoder()
+{
+    ELOG_DEBUG_T("%lu promotions", m_promotions);
+}
+
+AudioDecoder* OnDemandDecoder::createDecoder()
+{
+    if (m_fastDecode && FastDecoder::isSupported(m_format))
+        return new FastDecoder(m_format);
+    return new AcmDecoder(m_format);
+}
+
+bool OnDemandDecoder::init()
+{
+    // Make sure the format can be decoded before the input is accepted
+    boost::shared_ptr<AudioDecoder> decoder(createDecoder());
+    if (!decoder->init()) {
+        ELOG_ERROR_T("Error init decoder(%s)", getFormatStr(m_format));
+        return false;
+    }
+    return true;
+}
+
+void OnDemandDecoder::setDecoding(bool decoding)
+{
+    m_wanted.store(decoding, std::memory_order_relaxed);
+}
+
+bool OnDemandDecoder::getAudioFrame(AudioFrame* audioFrame)
+{
+    if (!m_decoding.load(std::memory_order_acquire))
+        return false;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_decoder)
+        return false;
+
+    return m_decoder->getAudioFrame(audioFrame);
+}
+
+void OnDemandDecoder::updateLevel(const Frame& frame)
+{
+    const AudioFrameSpecificInfo& info = frame.additionalInfo.audio;
+    if (!info.hasAudioLevel)
+        return;
+
+    if (!m_hasLevel.load(std::memory_order_relaxed))
+        m_hasLevel.store(true, std::memory_order_relaxed);
+
+    // Ranked by level, senders without VAD never set the V bit, so it
+    // only breaks ties between equal levels. Rise at once, fall over a
+    // few hundred ms
+    uint32_t score = ((127 - std::min<uint32_t>(info.audioLevel, 127)) << 1)
+        | (info.voice ? 1 : 0);
+    uint32_t level = m_level.load(std::memory_order_relaxed);
+    if (score >= level)
+        level = score;
+    else
+        level -= (level - score + 7) / 8;
+    m_level.store(level, std::memory_order_relaxed);
+}
+
+void OnDemandDecoder::bufferPacket(const Frame& frame, int64_t nowMs)
+{
+    if (frame.length > kMaxPacketSize) {
+        ELOG_TRACE_T("Packet too large to buffer, %u", frame.length);
+        return;
+    }
+
+    BufferedPacket& packet = m_packets[m_nextPacket];
+    packet.frame = frame;
+    packet.frame.payload = packet.data;
+    packet.arrivalMs = nowMs;
+    memcpy(packet.data, frame.payload, frame.length);
+
+    m_nextPacket = (m_nextPacket + 1) % kWarmupPackets;
+    if (m_packetCount < static_cast<uint32_t>(kWarmupPackets))
+        m_packetCount++;
+}
+
+void OnDemandDecoder::replayPackets(int64_t nowMs)
+{
+    uint32_t first = (m_nextPacket + kWarmupPackets - m_packetCount) % kWarmupPackets;
+    uint32_t replayed = 0;
+    for (uint32_t i = 0; i < m_packetCount; i++) {
+        BufferedPacket& packet = m_packets[(first + i) % kWarmupPackets];
+        if (nowMs - packet.arrivalMs > kWarmupMs)
+            continue;
+        m_decoder->onFrame(packet.frame);
+        replayed++;
+    }
+    ELOG_TRACE_T("Replayed %u packets", replayed);
+
+    m_packetCount = 0;
+    m_nextPacket = 0;
+}
+
+void OnDemandDecoder::onFrame(const Frame& frame)
+{
+    updateLevel(frame);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    bool wanted = m_wanted.load(std::memory_order_relaxed);
+    int64_t nowMs = currentTimeMs();
+
+    if (m_decoder && !wanted) {
+        ELOG_DEBUG_T("Stop decoding, level(%u)", m_level.load());
+        m_decoding.store(false, std::memory_order_release);
+        m_decoder.reset();
+    } else if (!m_decoder && wanted) {
+        ELOG_DEBUG_T("Start decoding, level(%u)", m_level.load());
+        m_decoder.reset(createDecoder());
+        if (!m_decoder->init()) {
+            ELOG_ERROR_T("Error init decoder(%s)", getFormatStr(m_format));
+            m_decoder.reset();
+            m_wanted.store(false, std::memory_order_relaxed);
+        } else {
+            replayPackets(nowMs);
+            m_decoding.store(true, std::memory_order_release);
+            m_promotions++;
+        }
+    }
+
+    if (m_decoder)
+        m_decoder->onFrame(frame);
+    else
+        bufferPacket(frame, nowMs);
+}
+
+} /* namespace mcu */
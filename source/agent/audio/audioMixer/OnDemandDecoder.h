@@ -0,0 +1,91 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OnDemandDecoder_h
+#define OnDemandDecoder_h
+
+#include <atomic>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+#include "AudioDecoder.h"
+
+namespace mcu {
+using namespace owt_base;
+using namespace webrtc;
+
+/*
+ * Decoder that only decodes while the mixer wants the input. The RFC 6464
+ * audio level carried by the frames is tracked on every packet, so the
+ * mixer can rank inputs without decoding them. While not decoding, the
+ * last packets are kept in a small ring and nothing else is done. When
+ * the input is promoted, a fresh AcmDecoder or FastDecoder is created and
+ * the packets of the last kWarmupMs are replayed into it before the new
+ * ones, so the decoder and its jitter buffer are warm when the mixer
+ * takes the first frame. The decoder is released again on demotion.
+ */
+class OnDemandDecoder : public AudioDecoder {
+    DECLARE_LOGGER();
+
+public:
+    static const int kWarmupPackets = 6;
+    // Buffered packets older than this are not replayed
+    static const int kWarmupMs = 60;
+
+    OnDemandDecoder(const FrameFormat format, bool fastDecode);
+    ~OnDemandDecoder();
+
+    bool init() override;
+    bool getAudioFrame(AudioFrame *audioFrame) override;
+
+    // Implements owt_base::FrameDestination
+    void onFrame(const Frame& frame) override;
+
+    // Takes effect on the next packet
+    void setDecoding(bool decoding);
+    bool isDecoding() { return m_decoding.load(std::memory_order_relaxed); }
+
+    // False until a frame with the audio level extension is received
+    bool hasAudioLevel() { return m_hasLevel.load(std::memory_order_relaxed); }
+    // Smoothed level score, 0 (silence) to 255 (0 dBov with voice)
+    uint32_t audioLevel() { return m_level.load(std::memory_order_relaxed); }
+
+private:
+    static const uint32_t kMaxPacketSize = 1500;
+
+    struct BufferedPacket {
+        Frame frame;
+        int64_t arrivalMs;
+        uint8_t data[kMaxPacketSize];
+    };
+
+    AudioDecoder* createDecoder();
+    void updateLevel(const Frame& frame);
+    void bufferPacket(const Frame& frame, int64_t nowMs);
+    void replayPackets(int64_t nowMs);
+
+    FrameFormat m_format;
+    bool m_fastDecode;
+
+    std::atomic<bool> m_wanted;
+    std::atomic<bool> m_decoding;
+    std::atomic<bool> m_hasLevel;
+    std::atomic<uint32_t> m_level;
+
+    boost::mutex m_mutex;
+    boost::shared_ptr<AudioDecoder> m_decoder;
+    BufferedPacket m_packets[kWarmupPackets];
+    uint32_t m_packetCount;
+    uint32_t m_nextPacket;
+
+    uint64_t m_promotions;
+};
+
+} /* namespace mcu */
+
+#endif /* OnDemandDecoder_h */
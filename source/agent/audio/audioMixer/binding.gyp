@@ -8,6 +8,8 @@
                 "AudioMixer.cpp",
                 "AcmDecoder.cpp",
                 "FfDecoder.cpp",
+                "FastDecoder.cpp",
+                "OnDemandDecoder.cpp",
                 "AcmEncoder.cpp",
                 "PcmEncoder.cpp",
                 "FfEncoder.cpp",
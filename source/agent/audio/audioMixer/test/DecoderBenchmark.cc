@@ -0,0 +1,152 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Compares the cost of AcmDecoder (NetEQ) and FastDecoder for many mixer
+// inputs. Every input gets a 20ms packet of a sine tone each round, and the
+// mixer side takes two 10ms frames at 48kHz, as AcmmFrameMixer does.
+// Reports the time spent in onFrame and getAudioFrame per input second.
+// The "demand" run wraps AcmDecoder in OnDemandDecoder with only the first
+// [loudest] inputs speaking, as in a large meeting with decode on demand.
+//
+// Usage: decoderBenchmark [opus|pcmu|pcma] [inputs] [seconds] [loudest]
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <webrtc/modules/audio_coding/codecs/g711/g711_interface.h>
+#include <webrtc/modules/audio_coding/codecs/opus/opus_interface.h>
+
+#include "../AcmDecoder.h"
+#include "../FastDecoder.h"
+#include "../OnDemandDecoder.h"
+
+using namespace owt_base;
+using Clock = std::chrono::steady_clock;
+
+static std::vector<std::vector<uint8_t>> encodePackets(FrameFormat format, int count)
+{
+    int sampleRate = format == FRAME_FORMAT_OPUS ? 48000 : 8000;
+    size_t channels = format == FRAME_FORMAT_OPUS ? 2 : 1;
+    size_t samples = sampleRate / 50;
+    std::vector<int16_t> pcm(samples * channels);
+    std::vector<std::vector<uint8_t>> packets;
+
+    OpusEncInst* encoder = NULL;
+    if (format == FRAME_FORMAT_OPUS) {
+        WebRtcOpus_EncoderCreate(&encoder, channels, 1);
+    }
+    for (int n = 0; n < count; n++) {
+        for (size_t i = 0; i < samples; i++) {
+            int16_t value = 8000 * sin(2 * M_PI * 440 * (n * samples + i) / sampleRate);
+            for (size_t c = 0; c < channels; c++) {
+                pcm[i * channels + c] = value;
+            }
+        }
+        std::vector<uint8_t> packet(1500);
+        int length;
+        if (format == FRAME_FORMAT_OPUS) {
+            length = WebRtcOpus_Encode(encoder, pcm.data(), samples, packet.size(), packet.data());
+        } else if (format == FRAME_FORMAT_PCMU) {
+            length = WebRtcG711_EncodeU(pcm.data(), samples, packet.data());
+        } else {
+            length = WebRtcG711_EncodeA(pcm.data(), samples, packet.data());
+        }
+        packet.resize(length > 0 ? length : 0);
+        packets.push_back(packet);
+    }
+    if (encoder) {
+        WebRtcOpus_EncoderFree(encoder);
+    }
+    return packets;
+}
+
+static void run(const char* name, FrameFormat format, int inputs, int seconds,
+    std::function<mcu::AudioDecoder*(int)> create, int loudest)
+{
+    int rounds = seconds * 50;
+    std::vector<std::vector<uint8_t>> packets = encodePackets(format, rounds);
+    std::vector<std::unique_ptr<mcu::AudioDecoder>> decoders;
+    for (int i = 0; i < inputs; i++) {
+        decoders.emplace_back(create(i));
+        if (!decoders.back()->init()) {
+            printf("%s: init failed\n", name);
+            return;
+        }
+    }
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = format;
+    frame.additionalInfo.audio.sampleRate = format == FRAME_FORMAT_OPUS ? 48000 : 8000;
+    frame.additionalInfo.audio.channels = format == FRAME_FORMAT_OPUS ? 2 : 1;
+
+    webrtc::AudioFrame audioFrame;
+    Clock::duration decodeTime(0);
+    Clock::duration playoutTime(0);
+    uint64_t frames = 0;
+    for (int n = 0; n < rounds; n++) {
+        frame.payload = packets[n].data();
+        frame.length = packets[n].size();
+        frame.timeStamp = n * frame.additionalInfo.audio.sampleRate / 50;
+
+        auto start = Clock::now();
+        for (int i = 0; i < inputs; i++) {
+            // Speaking inputs at -30 dBov, the others silent
+            frame.additionalInfo.audio.voice = i < loudest;
+            frame.additionalInfo.audio.audioLevel = i < loudest ? 30 : 127;
+            frame.additionalInfo.audio.hasAudioLevel = 1;
+            decoders[i]->onFrame(frame);
+        }
+        auto decoded = Clock::now();
+        for (int k = 0; k < 2; k++) {
+            for (auto& decoder : decoders) {
+                audioFrame.sample_rate_hz_ = 48000;
+                if (decoder->getAudioFrame(&audioFrame)) {
+                    frames++;
+                }
+            }
+        }
+        decodeTime += decoded - start;
+        playoutTime += Clock::now() - decoded;
+    }
+
+    double inputSeconds = static_cast<double>(inputs) * seconds;
+    printf("%-5s onFrame %7.1f us, getAudioFrame %7.1f us per input second, %.0f%% frames, %.2f inputs per core\n",
+        name,
+        std::chrono::duration<double, std::micro>(decodeTime).count() / inputSeconds,
+        std::chrono::duration<double, std::micro>(playoutTime).count() / inputSeconds,
+        100.0 * frames / (2.0 * rounds * inputs),
+        inputSeconds / std::chrono::duration<double>(decodeTime + playoutTime).count());
+}
+
+int main(int argc, char* argv[])
+{
+    std::string codec = argc > 1 ? argv[1] : "opus";
+    int inputs = argc > 2 ? atoi(argv[2]) : 200;
+    int seconds = argc > 3 ? atoi(argv[3]) : 10;
+    int loudest = argc > 4 ? atoi(argv[4]) : 4;
+    FrameFormat format = codec == "pcmu" ? FRAME_FORMAT_PCMU
+        : codec == "pcma" ? FRAME_FORMAT_PCMA : FRAME_FORMAT_OPUS;
+
+    printf("%s, %d inputs, %d seconds\n", codec.c_str(), inputs, seconds);
+    run("acm", format, inputs, seconds,
+        [format](int) { return new mcu::AcmDecoder(format); }, inputs);
+    run("fast", format, inputs, seconds,
+        [format](int) { return new mcu::FastDecoder(format); }, inputs);
+    // AcmmFrameMixer does the ranking, here the loudest inputs are known
+    run("demand", format, inputs, seconds,
+        [format, loudest](int i) {
+            mcu::OnDemandDecoder* decoder = new mcu::OnDemandDecoder(format, false);
+            decoder->setDecoding(i < loudest);
+            return decoder;
+        }, loudest);
+    return 0;
+}
@@ -0,0 +1,29 @@
+{
+  'targets': [{
+    'target_name': 'decoderBenchmark',
+    'type': 'executable',
+    'sources': [
+      'DecoderBenchmark.cc',
+      '../AcmDecoder.cpp',
+      '../FastDecoder.cpp',
+      '../OnDemandDecoder.cpp',
+      '../../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../../core/owt_base/AudioUtilities.cpp',
+    ],
+    'include_dirs': [
+      '$(CORE_HOME)/common',
+      '$(CORE_HOME)/owt_base',
+      '$(CORE_HOME)/../../third_party/webrtc/src',
+      '$(DEFAULT_DEPENDENCY_PATH)/include',
+    ],
+    'libraries': [
+      '-L$(CORE_HOME)/../../third_party/webrtc',
+      '-lwebrtc',
+      '-lboost_thread',
+      '-llog4cxx',
+      '-lpthread',
+    ],
+    'cflags_cc': ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17', '-DWEBRTC_POSIX'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }]
+}
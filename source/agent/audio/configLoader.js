@@ -46,6 +46,8 @@ module.exports.load = async function () {
 
     config.mix = config.mix || {};
     config.mix.top_k = config.mix.top_k || 0;
+    config.mix.fast_decode = !!config.mix.fast_decode;
+    config.mix.decode_on_demand = config.mix.decode_on_demand || 0;
 
     return config;
   } catch (e) {
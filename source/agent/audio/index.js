@@ -80,7 +80,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                 return;
             }
 
-            if (engine.addInput(owner, stream_id, codec, conn)) {
+            // Inputs from media nodes come paced and in order, no NetEQ needed
+            const fastDecode = global.config.mix.fast_decode && !!options.internalSource;
+            if (engine.addInput(owner, stream_id, codec, conn, fastDecode)) {
                 inputs[stream_id] = {owner: owner,
                                      connection: conn};
                 log.debug('addInput ok, for:', owner, 'codec:', codec, 'options:', options);
@@ -142,6 +144,9 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         } else {
             engine = new AudioMixer(JSON.stringify(config));
         }
+        if (global.config.mix.decode_on_demand > 0) {
+            engine.enableDecodeOnDemand(global.config.mix.decode_on_demand);
+        }
         belong_to_room = belongToRoom;
         controller = ctrlr;
 
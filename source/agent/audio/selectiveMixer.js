@@ -109,6 +109,10 @@ class SelectiveMixer {
         this.mixer.removeOutput(forWhom, streamId);
     }
 
+    enableDecodeOnDemand(maxInputs) {
+        this.mixer.enableDecodeOnDemand(maxInputs);
+    }
+
     enableVAD(period, cb) {
         this.mixer.enableVAD(period, cb);
     }
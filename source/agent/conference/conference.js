@@ -1556,6 +1556,9 @@ var Conference = function (rpcClient, selfRpcId) {
             track.formatPreference = {
               optional: room_config.mediaIn[track.type],
             };
+            // Assemble frames without the full receive stream of webrtc
+            track.frameAssembler = pubInfo.type === 'webrtc' &&
+              track.type === 'video' && track.frameAssembler === true;
           });
         }
         initiateStream(streamId, {
@@ -2159,6 +2162,10 @@ var Conference = function (rpcClient, selfRpcId) {
                 ));
             }
             track.formatPreference = formatPreference;
+            // Share of the connection bandwidth for webrtc video only
+            if (subDesc.type !== 'webrtc' || track.type !== 'video') {
+              delete track.bandwidth;
+            }
           });
         }
 
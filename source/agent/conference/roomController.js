@@ -596,6 +596,17 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
     );
   };
 
+  // Streams of these terminals are produced by media nodes
+  var isMediaNodeTerminal = function (terminal_id) {
+    return (
+      terminals[terminal_id] &&
+      (terminals[terminal_id].type === 'amixer' ||
+        terminals[terminal_id].type === 'axcoder' ||
+        terminals[terminal_id].type === 'vmixer' ||
+        terminals[terminal_id].type === 'vxcoder')
+    );
+  };
+
   var spreadStream = function (
     stream_id,
     target_node,
@@ -755,6 +766,7 @@ module.exports.create = function (spec, on_init_ok, on_init_failed) {
             {
               controller: selfRpcId,
               publisher: terminals[stream_owner].owner || 'common',
+              internalSource: isMediaNodeTerminal(stream_owner),
               audio: audio ? { codec: streams[stream_id].audio.format } : false,
               video: video ? { codec: streams[stream_id].video.format } : false,
               data: data,
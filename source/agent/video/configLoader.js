@@ -51,6 +51,13 @@ module.exports.load = async function () {
     config.video.enableBetterHEVCQuality =
       !!config.video.enableBetterHEVCQuality;
     config.video.MFE_timeout = config.video.MFE_timeout || 0;
+    config.video.intra_refresh_frames = config.video.intra_refresh_frames || 0;
+    config.video.transcode_ladder = config.video.transcode_ladder || {};
+    if (config.video.transcode_ladder.bitrate_step === undefined) {
+      config.video.transcode_ladder.bitrate_step = 0.1;
+    }
+    config.video.transcode_ladder.rungs =
+      config.video.transcode_ladder.rungs || [];
     let videoCap = require('./videoCapability').detected(
       config.video.hardwareAccelerated
     );
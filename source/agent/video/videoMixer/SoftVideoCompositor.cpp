@@ -397,6 +397,7 @@ void SoftFrameGenerator::onTimeout()
     }
 
     if (hasValidOutput) {
+        int64_t startUs = PipelineTracer::enabled() ? PipelineTracer::nowUs() : 0;
         rtc::scoped_refptr<webrtc::VideoFrameBuffer> compositeBuffer = generateFrame();
         if (compositeBuffer) {
             webrtc::VideoFrame compositeFrame(
@@ -416,14 +417,21 @@ void SoftFrameGenerator::onTimeout()
 
             m_textDrawer->drawFrame(frame);
 
+            int64_t captureTimeUs = 0;
+            if (startUs) {
+                captureTimeUs = m_owner->m_latestCaptureTimeUs.load(std::memory_order_relaxed);
+                PipelineTracer::instance().record(TRACE_STAGE_COMPOSE, captureTimeUs, startUs);
+            }
+
             {
+                PipelineTracer::CaptureScope scope(captureTimeUs);
                 boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
                 for (uint32_t i = 0; i < m_outputs.size(); i++) {
                     if (m_counter % (i + 1))
                         continue;
 
                     for (auto it = m_outputs[i].begin(); it != m_outputs[i].end(); ++it) {
-                        ELOG_TRACE_T("+++deliverFrame(%d), dst(%p), fps(%d), timestamp(%d)", m_counter, it->dest, m_maxSupportedFps / (i + 1), frame.timeStamp / 90);
+                        ELOG_TRACE_ASYNC_T("+++deliverFrame(%d), dst(%p), fps(%d), timestamp(%d)", m_counter, it->dest, m_maxSupportedFps / (i + 1), frame.timeStamp / 90);
 
                         it->dest->onFrame(frame);
                     }
@@ -599,6 +607,7 @@ DEFINE_LOGGER(SoftVideoCompositor, "mcu.media.SoftVideoCompositor");
 
 SoftVideoCompositor::SoftVideoCompositor(uint32_t maxInput, VideoSize rootSize, YUVColor bgColor, bool crop)
     : m_maxInput(maxInput)
+    , m_latestCaptureTimeUs(0)
 {
     m_inputs.resize(m_maxInput);
     for (auto& input : m_inputs) {
@@ -665,6 +674,10 @@ void SoftVideoCompositor::pushInput(int input, const Frame& frame)
     webrtc::VideoFrame* i420Frame = reinterpret_cast<webrtc::VideoFrame*>(frame.payload);
 
     m_inputs[input]->pushInput(i420Frame);
+    int64_t captureTimeUs = PipelineTracer::enabled() ? PipelineTracer::captureTimeUs() : 0;
+    if (captureTimeUs > m_latestCaptureTimeUs.load(std::memory_order_relaxed)) {
+        m_latestCaptureTimeUs.store(captureTimeUs, std::memory_order_relaxed);
+    }
 }
 
 bool SoftVideoCompositor::addOutput(const uint32_t width, const uint32_t height, const uint32_t framerateFPS, owt_base::FrameDestination* dst)
@@ -5,6 +5,7 @@
 #ifndef SoftVideoCompositor_h
 #define SoftVideoCompositor_h
 
+#include <atomic>
 #include <vector>
 
 #include <boost/asio.hpp>
@@ -21,6 +22,7 @@
 #include "I420BufferManager.h"
 #include "JobTimer.h"
 #include "MediaFramePipeline.h"
+#include "PipelineTracer.h"
 #include "VideoFrameMixer.h"
 #include "VideoLayout.h"
 #include "logger.h"
@@ -194,6 +196,8 @@ private:
 
     std::vector<boost::shared_ptr<SoftInput>> m_inputs;
     boost::scoped_ptr<AvatarManager> m_avatarManager;
+    // Capture time of the freshest input frame, for PipelineTracer
+    std::atomic<int64_t> m_latestCaptureTimeUs;
 };
 
 }
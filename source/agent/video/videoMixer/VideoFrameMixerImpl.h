@@ -53,7 +53,7 @@ private:
 
 class VideoFrameMixerImpl : public VideoFrameMixer {
 public:
-    VideoFrameMixerImpl(uint32_t maxInput, owt_base::VideoSize rootSize, owt_base::YUVColor bgColor, bool useSimulcast, bool crop);
+    VideoFrameMixerImpl(uint32_t maxInput, owt_base::VideoSize rootSize, owt_base::YUVColor bgColor, bool useSimulcast, bool crop, uint32_t intraRefreshFrames = 0);
     ~VideoFrameMixerImpl();
 
     bool addInput(int input, owt_base::FrameFormat, owt_base::FrameSource*, const std::string& avatar);
@@ -98,10 +98,12 @@ private:
     boost::shared_mutex m_outputMutex;
 
     bool m_useSimulcast;
+    uint32_t m_intraRefreshFrames;
 };
 
-VideoFrameMixerImpl::VideoFrameMixerImpl(uint32_t maxInput, owt_base::VideoSize rootSize, owt_base::YUVColor bgColor, bool useSimulcast, bool crop)
+VideoFrameMixerImpl::VideoFrameMixerImpl(uint32_t maxInput, owt_base::VideoSize rootSize, owt_base::YUVColor bgColor, bool useSimulcast, bool crop, uint32_t intraRefreshFrames)
     : m_useSimulcast(useSimulcast)
+    , m_intraRefreshFrames(intraRefreshFrames)
 {
     if (!m_compositor)
         m_compositor.reset(new SoftVideoCompositor(maxInput, rootSize, bgColor, crop));
@@ -146,7 +148,7 @@ inline bool VideoFrameMixerImpl::addInput(int input, owt_base::FrameFormat forma
         decoder.reset(new owt_base::VCMFrameDecoder(format));
 
     if (!decoder && owt_base::FFmpegFrameDecoder::supportFormat(format))
-        decoder.reset(new owt_base::FFmpegFrameDecoder());
+        decoder.reset(new owt_base::FFmpegFrameDecoder(true));
 
     if (!decoder)
         return false;
@@ -250,6 +252,9 @@ inline bool VideoFrameMixerImpl::addOutput(int output,
         if (!encoder)
             return false;
 
+        if (m_intraRefreshFrames)
+            encoder->setIntraRefresh(m_intraRefreshFrames);
+
         streamId = encoder->generateStream(outputSize.width, outputSize.height, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, dest);
         if (streamId < 0)
             return false;
@@ -29,6 +29,8 @@ struct VideoMixerConfig {
     } bgColor;
     bool useGacc;
     uint32_t MFE_timeout;
+    // Gradual intra refresh period in frames, 0 for periodic key frames
+    uint32_t intraRefreshFrames;
 };
 
 class VideoMixer {
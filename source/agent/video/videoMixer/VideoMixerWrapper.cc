@@ -91,6 +91,7 @@ void VideoMixer::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     }
     config.useGacc = Nan::To<bool>(nanGetChecked(options, "gaccplugin")).FromJust();
     config.MFE_timeout = Nan::To<int32_t>(nanGetChecked(options, "MFE_timeout")).FromJust();
+    config.intraRefreshFrames = Nan::To<int32_t>(nanGetChecked(options, "intraRefreshFrames")).FromJust();
 
     VideoMixer* obj = new VideoMixer();
     obj->me = new mcu::VideoMixer(config);
@@ -9,6 +9,7 @@
                 "../VideoMixer.cpp",
                 "../../../../core/owt_base/I420BufferManager.cpp",
                 "../../../../core/owt_base/MediaFramePipeline.cpp",
+                "../../../../core/owt_base/PipelineTracer.cpp",
                 "../../../../core/owt_base/FrameConverter.cpp",
                 "../../../../core/owt_base/FFmpegFrameDecoder.cpp",
                 "../../../../core/owt_base/FFmpegDrawText.cpp",
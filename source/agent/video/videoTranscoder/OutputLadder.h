@@ -0,0 +1,103 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OutputLadder_h
+#define OutputLadder_h
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <MediaFramePipeline.h>
+#include <VideoHelper.h>
+
+namespace mcu {
+
+struct LadderRung {
+    // FRAME_FORMAT_UNKNOWN in a configured rung matches any codec
+    owt_base::FrameFormat format;
+    owt_base::VideoSize size;
+    uint32_t framerateFPS;
+    uint32_t bitrateKbps;
+};
+
+/**
+ * Snaps requested transcoding outputs to a ladder of rungs, so that
+ * requests differing slightly share one encoder. A request takes the rung
+ * of its codec and aspect ratio nearest in size, then in frame rate, then
+ * in bitrate. Requests no rung fits keep their size and frame rate, and
+ * their bitrate is rounded to geometric buckets bitrateStep apart (0
+ * keeps it as is).
+ */
+class OutputLadder {
+public:
+    explicit OutputLadder(double bitrateStep = 0)
+        : m_bitrateStep(bitrateStep > 0 ? bitrateStep : 0)
+    {
+    }
+
+    void addRung(const LadderRung& rung) { m_rungs.push_back(rung); }
+    size_t rungCount() const { return m_rungs.size(); }
+
+    LadderRung snap(owt_base::FrameFormat format,
+        const owt_base::VideoSize& size,
+        uint32_t framerateFPS,
+        uint32_t bitrateKbps) const
+    {
+        const LadderRung* best = nullptr;
+        for (const LadderRung& rung : m_rungs) {
+            if (rung.format != owt_base::FRAME_FORMAT_UNKNOWN && rung.format != format)
+                continue;
+            // Size 0x0 follows the input, which no rung fits
+            if (!size.width || !size.height
+                || rung.size.width * size.height != rung.size.height * size.width)
+                continue;
+            if (!best || closer(rung, *best, size, framerateFPS, bitrateKbps))
+                best = &rung;
+        }
+
+        if (best)
+            return { format, best->size, best->framerateFPS, best->bitrateKbps };
+        return { format, size, framerateFPS, snapBitrate(bitrateKbps) };
+    }
+
+private:
+    static uint64_t distance(uint64_t a, uint64_t b) { return a > b ? a - b : b - a; }
+
+    static bool closer(const LadderRung& a, const LadderRung& b,
+        const owt_base::VideoSize& size, uint32_t framerateFPS, uint32_t bitrateKbps)
+    {
+        uint64_t area = static_cast<uint64_t>(size.width) * size.height;
+        uint64_t areaA = distance(static_cast<uint64_t>(a.size.width) * a.size.height, area);
+        uint64_t areaB = distance(static_cast<uint64_t>(b.size.width) * b.size.height, area);
+        if (areaA != areaB)
+            return areaA < areaB;
+
+        uint64_t fpsA = distance(a.framerateFPS, framerateFPS);
+        uint64_t fpsB = distance(b.framerateFPS, framerateFPS);
+        if (fpsA != fpsB)
+            return fpsA < fpsB;
+
+        // Bitrates compare by ratio
+        double kbps = bitrateKbps ? bitrateKbps : 1;
+        return std::abs(std::log(a.bitrateKbps / kbps)) < std::abs(std::log(b.bitrateKbps / kbps));
+    }
+
+    uint32_t snapBitrate(uint32_t bitrateKbps) const
+    {
+        if (!m_bitrateStep || !bitrateKbps)
+            return bitrateKbps;
+
+        double base = std::log(1 + m_bitrateStep);
+        double bucket = std::round(std::log(bitrateKbps) / base);
+        return static_cast<uint32_t>(std::round(std::exp(bucket * base)));
+    }
+
+    std::vector<LadderRung> m_rungs;
+    double m_bitrateStep;
+};
+
+} /* namespace mcu */
+
+#endif /* OutputLadder_h */
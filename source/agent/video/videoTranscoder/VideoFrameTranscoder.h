@@ -5,6 +5,7 @@
 #ifndef VideoFrameTranscoder_h
 #define VideoFrameTranscoder_h
 
+#include "OutputLadder.h"
 #include "VideoHelper.h"
 #include <MediaFramePipeline.h>
 
@@ -25,6 +26,8 @@ public:
         owt_base::FrameDestination*)
         = 0;
     virtual void removeOutput(int output) = 0;
+    // What the output was snapped to
+    virtual bool getOutputRung(int output, LadderRung& rung) = 0;
 
     virtual void requestKeyFrame(int output) = 0;
     virtual void drawText(const std::string& textSpec) = 0;
@@ -5,17 +5,25 @@
 #ifndef VideoFrameTranscoderImpl_h
 #define VideoFrameTranscoderImpl_h
 
+#include <boost/asio.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <chrono>
 #include <map>
+#include <tuple>
 
 #include <FrameProcessor.h>
+#include <MediaFrameMulticaster.h>
 #include <MediaFramePipeline.h>
+#include <logger.h>
 #include <MediaUtilities.h>
 #include <VCMFrameDecoder.h>
 #include <VCMFrameEncoder.h>
 
+#include <OutputLadder.h>
 #include <VideoFrameTranscoder.h>
 
 #include <FFmpegFrameDecoder.h>
@@ -25,9 +33,97 @@
 
 namespace mcu {
 
-class VideoFrameTranscoderImpl : public VideoFrameTranscoder, public owt_base::FrameSource, public owt_base::FrameDestination {
+/**
+ * A scaling node of the transcoding graph. Outputs that ask for the same
+ * target size and frame rate share one node, so a decoded frame is scaled
+ * once per distinct rung of the ladder rather than once per output.
+ * Scaling runs on the transcoder's worker pool; encoders are attached as
+ * destinations of the node's processor and keep their own encoding threads.
+ */
+class ScalerNode {
+    DECLARE_LOGGER();
+
+    static const uint32_t kStatsReportInterval = 300;
+
 public:
-    VideoFrameTranscoderImpl();
+    ScalerNode(boost::shared_ptr<owt_base::VideoFrameProcessor> processor, uint32_t width, uint32_t height)
+        : m_processor(processor)
+        , m_width(width)
+        , m_height(height)
+        , m_refs(0)
+        , m_busy(false)
+        , m_processed(0)
+        , m_dropped(0)
+        , m_totalLatencyUs(0)
+        , m_maxLatencyUs(0)
+    {
+    }
+
+    owt_base::VideoFrameProcessor* processor() { return m_processor.get(); }
+
+    uint32_t addRef() { return ++m_refs; }
+    uint32_t release() { return --m_refs; }
+
+    // Returns false if the previous frame is still being scaled, in which
+    // case the caller drops the frame for this node instead of queuing it.
+    bool tryAcquire()
+    {
+        bool expected = false;
+        if (m_busy.compare_exchange_strong(expected, true))
+            return true;
+
+        m_dropped++;
+        return false;
+    }
+
+    void process(const webrtc::VideoFrame& videoFrame, const owt_base::Frame& input)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        owt_base::Frame frame = input;
+        frame.payload = reinterpret_cast<uint8_t*>(const_cast<webrtc::VideoFrame*>(&videoFrame));
+        m_processor->onFrame(frame);
+
+        uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        // The latency stats belong to the node owner until m_busy is released
+        m_totalLatencyUs += latencyUs;
+        if (latencyUs > m_maxLatencyUs)
+            m_maxLatencyUs = latencyUs;
+
+        ELOG_TRACE_T("node(%ux%u) scale latency %lu us", m_width, m_height, latencyUs);
+
+        if (++m_processed % kStatsReportInterval == 0) {
+            ELOG_DEBUG_T("node(%ux%u) processed %u, dropped %u, avg latency %lu us, max latency %lu us",
+                m_width, m_height, m_processed.load(), m_dropped.load(),
+                m_totalLatencyUs / kStatsReportInterval, m_maxLatencyUs);
+            m_totalLatencyUs = 0;
+            m_maxLatencyUs = 0;
+        }
+        m_busy = false;
+    }
+
+private:
+    boost::shared_ptr<owt_base::VideoFrameProcessor> m_processor;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_refs;
+
+    std::atomic<bool> m_busy;
+    std::atomic<uint32_t> m_processed;
+    std::atomic<uint32_t> m_dropped;
+    uint64_t m_totalLatencyUs;
+    uint64_t m_maxLatencyUs;
+};
+
+class VideoFrameTranscoderImpl : public VideoFrameTranscoder, public owt_base::FrameDestination {
+    DECLARE_LOGGER();
+
+    static const uint32_t kMaxWorkerNum = 8;
+
+public:
+    VideoFrameTranscoderImpl(uint32_t intraRefreshFrames = 0, const OutputLadder& ladder = OutputLadder());
     ~VideoFrameTranscoderImpl();
 
     bool setInput(int input, owt_base::FrameFormat, owt_base::FrameSource*);
@@ -43,50 +139,108 @@ public:
         owt_base::FrameDestination*);
 
     void removeOutput(int output);
+    bool getOutputRung(int output, LadderRung& rung);
     void requestKeyFrame(int output);
 
     void drawText(const std::string& textSpec);
     void clearText();
 
-    void onFrame(const owt_base::Frame& frame)
-    {
-        deliverFrame(frame);
-    }
+    void onFrame(const owt_base::Frame& frame);
 
 private:
+    // (input format of the encoder, width, height, framerate)
+    typedef std::tuple<owt_base::FrameFormat, uint32_t, uint32_t, uint32_t> ScalerKey;
+
     struct Input {
         owt_base::FrameSource* source;
         boost::shared_ptr<owt_base::VideoFrameDecoder> decoder;
     };
 
-    struct Output {
-
-        boost::shared_ptr<owt_base::VideoFrameProcessor> processor;
+    // (codec, profile, width, height, framerate, bitrate, key frame interval)
+    typedef std::tuple<owt_base::FrameFormat, owt_base::VideoCodecProfile,
+        uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>
+        EncoderKey;
+
+    // One encoder per rung of the ladder, its stream is fanned out to the
+    // destinations of all outputs snapped to the rung. The fan-out keeps
+    // the rung bitrate and coalesces key frame requests of the outputs.
+    struct SharedEncoder {
+        EncoderKey key;
+        LadderRung rung;
+        ScalerKey scalerKey;
+        boost::shared_ptr<ScalerNode> scaler;
         boost::shared_ptr<owt_base::VideoFrameEncoder> encoder;
         int streamId;
+        boost::shared_ptr<owt_base::MediaFrameMulticaster> fanout;
+        uint32_t refs;
+    };
+
+    struct Output {
+        boost::shared_ptr<SharedEncoder> shared;
+        owt_base::FrameDestination* dest;
     };
 
+    boost::shared_ptr<SharedEncoder> createEncoder(const EncoderKey& key,
+        const LadderRung& rung,
+        const owt_base::VideoCodecProfile profile,
+        const unsigned int keyFrameIntervalSeconds);
+    void releaseEncoder(const boost::shared_ptr<SharedEncoder>& shared);
+    void releaseScaler(const SharedEncoder& shared);
+
     std::map<int, Input> m_inputs;
     boost::shared_mutex m_inputMutex;
 
     std::map<int, Output> m_outputs;
+    std::map<EncoderKey, boost::shared_ptr<SharedEncoder>> m_encoders;
+    std::map<ScalerKey, boost::shared_ptr<ScalerNode>> m_scalers;
     boost::shared_mutex m_outputMutex;
+
+    // worker pool shared by all scaling nodes
+    boost::shared_ptr<boost::asio::io_service> m_srv;
+    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
+    boost::shared_ptr<boost::thread_group> m_thrGrp;
+
+    uint32_t m_intraRefreshFrames;
+    OutputLadder m_ladder;
 };
 
-VideoFrameTranscoderImpl::VideoFrameTranscoderImpl()
+VideoFrameTranscoderImpl::VideoFrameTranscoderImpl(uint32_t intraRefreshFrames, const OutputLadder& ladder)
+    : m_intraRefreshFrames(intraRefreshFrames)
+    , m_ladder(ladder)
 {
+    uint32_t workerNum = boost::thread::hardware_concurrency() / 2;
+    if (workerNum > kMaxWorkerNum)
+        workerNum = kMaxWorkerNum;
+    if (workerNum < 1)
+        workerNum = 1;
+
+    ELOG_DEBUG_T("scaling worker num %u", workerNum);
+
+    m_srv = boost::make_shared<boost::asio::io_service>();
+    m_srvWork = boost::make_shared<boost::asio::io_service::work>(*m_srv);
+    m_thrGrp = boost::make_shared<boost::thread_group>();
+
+    for (uint32_t i = 0; i < workerNum; i++)
+        m_thrGrp->create_thread(boost::bind(&boost::asio::io_service::run, m_srv));
 }
 
 VideoFrameTranscoderImpl::~VideoFrameTranscoderImpl()
 {
+    m_srvWork.reset();
+    m_srv->stop();
+    m_thrGrp->join_all();
+
     {
         boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
-        for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
-            this->removeVideoDestination(it->second.processor.get());
-            it->second.processor->removeVideoDestination(it->second.encoder.get());
-            it->second.encoder->degenerateStream(it->second.streamId);
+        for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it)
+            it->second.shared->fanout->removeVideoDestination(it->second.dest);
+        for (auto it = m_encoders.begin(); it != m_encoders.end(); ++it) {
+            it->second->scaler->processor()->removeVideoDestination(it->second->encoder.get());
+            it->second->encoder->degenerateStream(it->second->streamId);
         }
         m_outputs.clear();
+        m_encoders.clear();
+        m_scalers.clear();
     }
 
     {
@@ -115,7 +269,7 @@ inline bool VideoFrameTranscoderImpl::setInput(int input, owt_base::FrameFormat
         decoder.reset(new owt_base::VCMFrameDecoder(format));
 
     if (!decoder && owt_base::FFmpegFrameDecoder::supportFormat(format))
-        decoder.reset(new owt_base::FFmpegFrameDecoder());
+        decoder.reset(new owt_base::FFmpegFrameDecoder(true));
 
     if (!decoder)
         return false;
@@ -151,78 +305,195 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
     const unsigned int bitrateKbps,
     const unsigned int keyFrameIntervalSeconds,
     owt_base::FrameDestination* dest)
+{
+    LadderRung rung = m_ladder.snap(format, rootSize, framerateFPS, bitrateKbps);
+    EncoderKey key(format, profile, rung.size.width, rung.size.height,
+        rung.framerateFPS, rung.bitrateKbps, keyFrameIntervalSeconds);
+
+    boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
+    if (m_outputs.find(output) != m_outputs.end())
+        return false;
+
+    boost::shared_ptr<SharedEncoder> shared;
+    auto it = m_encoders.find(key);
+    if (it != m_encoders.end()) {
+        shared = it->second;
+        // The new output starts decoding from the next key frame
+        shared->encoder->requestKeyFrame(shared->streamId);
+    } else {
+        shared = createEncoder(key, rung, profile, keyFrameIntervalSeconds);
+        if (!shared)
+            return false;
+        m_encoders[key] = shared;
+    }
+
+    shared->refs++;
+    shared->fanout->addVideoDestination(dest);
+    Output out { .shared = shared, .dest = dest };
+    m_outputs[output] = out;
+
+    ELOG_DEBUG_T("addOutput(%d) %ux%u@%u %ukbps -> %ux%u@%u %ukbps, encoders %zu, outputs %zu",
+        output, rootSize.width, rootSize.height, framerateFPS, bitrateKbps,
+        rung.size.width, rung.size.height, rung.framerateFPS, rung.bitrateKbps,
+        m_encoders.size(), m_outputs.size());
+    return true;
+}
+
+inline boost::shared_ptr<VideoFrameTranscoderImpl::SharedEncoder>
+VideoFrameTranscoderImpl::createEncoder(const EncoderKey& key,
+    const LadderRung& rung,
+    const owt_base::VideoCodecProfile profile,
+    const unsigned int keyFrameIntervalSeconds)
 {
     boost::shared_ptr<owt_base::VideoFrameEncoder> encoder;
     boost::shared_ptr<owt_base::VideoFrameProcessor> processor;
-    boost::upgrade_lock<boost::shared_mutex> lock(m_outputMutex);
+    boost::shared_ptr<owt_base::MediaFrameMulticaster> fanout(new owt_base::MediaFrameMulticaster());
     int32_t streamId = -1;
 
 #if ENABLE_SVT_HEVC_ENCODER
-    if (!encoder && format == owt_base::FRAME_FORMAT_H265)
-        encoder.reset(new owt_base::SVTHEVCEncoder(format, profile));
+    if (!encoder && rung.format == owt_base::FRAME_FORMAT_H265)
+        encoder.reset(new owt_base::SVTHEVCEncoder(rung.format, profile));
 #endif
 
-    if (!encoder && owt_base::VCMFrameEncoder::supportFormat(format))
-        encoder.reset(new owt_base::VCMFrameEncoder(format, profile, false));
+    if (!encoder && owt_base::VCMFrameEncoder::supportFormat(rung.format))
+        encoder.reset(new owt_base::VCMFrameEncoder(rung.format, profile, false));
 
     if (!encoder)
-        return false;
+        return nullptr;
 
-    streamId = encoder->generateStream(rootSize.width, rootSize.height, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, dest);
-    if (streamId < 0)
-        return false;
+    if (m_intraRefreshFrames)
+        encoder->setIntraRefresh(m_intraRefreshFrames);
 
-    if (!processor) {
+    streamId = encoder->generateStream(rung.size.width, rung.size.height, rung.framerateFPS, rung.bitrateKbps, keyFrameIntervalSeconds, fanout.get());
+    if (streamId < 0)
+        return nullptr;
+
+    ScalerKey scalerKey(encoder->getInputFormat(), rung.size.width, rung.size.height, rung.framerateFPS);
+    boost::shared_ptr<ScalerNode> scaler;
+    auto it = m_scalers.find(scalerKey);
+    if (it != m_scalers.end()) {
+        scaler = it->second;
+    } else {
         processor.reset(new owt_base::FrameProcessor());
+        if (!processor->init(encoder->getInputFormat(), rung.size.width, rung.size.height, rung.framerateFPS)) {
+            encoder->degenerateStream(streamId);
+            return nullptr;
+        }
+
+        scaler.reset(new ScalerNode(processor, rung.size.width, rung.size.height));
+        ELOG_DEBUG_T("new scaler node %ux%u@%u", rung.size.width, rung.size.height, rung.framerateFPS);
     }
 
-    if (!processor->init(encoder->getInputFormat(), rootSize.width, rootSize.height, framerateFPS))
-        return false;
+    scaler->processor()->addVideoDestination(encoder.get());
+    scaler->addRef();
+    m_scalers[scalerKey] = scaler;
+
+    boost::shared_ptr<SharedEncoder> shared(new SharedEncoder {
+        .key = key,
+        .rung = rung,
+        .scalerKey = scalerKey,
+        .scaler = scaler,
+        .encoder = encoder,
+        .streamId = streamId,
+        .fanout = fanout,
+        .refs = 0 });
+    ELOG_DEBUG_T("new encoder(%s) %ux%u@%u %ukbps", owt_base::getFormatStr(rung.format),
+        rung.size.width, rung.size.height, rung.framerateFPS, rung.bitrateKbps);
+    return shared;
+}
 
-    this->addVideoDestination(processor.get());
-    processor->addVideoDestination(encoder.get());
+inline void VideoFrameTranscoderImpl::releaseScaler(const SharedEncoder& shared)
+{
+    if (shared.scaler->release() == 0) {
+        ELOG_DEBUG_T("release scaler node %ux%u@%u",
+            std::get<1>(shared.scalerKey), std::get<2>(shared.scalerKey), std::get<3>(shared.scalerKey));
+        m_scalers.erase(shared.scalerKey);
+    }
+}
 
-    boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
-    Output out { .processor = processor, .encoder = encoder, .streamId = streamId };
-    m_outputs[output] = out;
-    return true;
+inline void VideoFrameTranscoderImpl::releaseEncoder(const boost::shared_ptr<SharedEncoder>& shared)
+{
+    if (--shared->refs > 0)
+        return;
+
+    ELOG_DEBUG_T("release encoder(%s) %ux%u@%u %ukbps", owt_base::getFormatStr(shared->rung.format),
+        shared->rung.size.width, shared->rung.size.height, shared->rung.framerateFPS, shared->rung.bitrateKbps);
+    shared->scaler->processor()->removeVideoDestination(shared->encoder.get());
+    shared->encoder->degenerateStream(shared->streamId);
+    releaseScaler(*shared);
+    m_encoders.erase(shared->key);
 }
 
 inline void VideoFrameTranscoderImpl::removeOutput(int32_t output)
 {
-    boost::upgrade_lock<boost::shared_mutex> lock(m_outputMutex);
+    boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
     auto it = m_outputs.find(output);
     if (it != m_outputs.end()) {
-        it->second.encoder->degenerateStream(it->second.streamId);
-        if (it->second.encoder->isIdle()) {
-            this->removeVideoDestination(it->second.processor.get());
-            it->second.processor->removeVideoDestination(it->second.encoder.get());
-        }
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
-        m_outputs.erase(output);
+        boost::shared_ptr<SharedEncoder> shared = it->second.shared;
+        shared->fanout->removeVideoDestination(it->second.dest);
+        m_outputs.erase(it);
+        releaseEncoder(shared);
     }
 }
 
+inline bool VideoFrameTranscoderImpl::getOutputRung(int output, LadderRung& rung)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
+    auto it = m_outputs.find(output);
+    if (it == m_outputs.end())
+        return false;
+
+    rung = it->second.shared->rung;
+    return true;
+}
+
 inline void VideoFrameTranscoderImpl::requestKeyFrame(int output)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
     auto it = m_outputs.find(output);
-    if (it != m_outputs.end())
-        it->second.encoder->requestKeyFrame(it->second.streamId);
+    if (it != m_outputs.end()) {
+        // Coalesced with the requests of the other outputs on the rung
+        owt_base::FeedbackMsg msg(owt_base::VIDEO_FEEDBACK, owt_base::REQUEST_KEY_FRAME);
+        it->second.shared->fanout->onFeedback(msg);
+    }
 }
 
 inline void VideoFrameTranscoderImpl::drawText(const std::string& textSpec)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it)
-        it->second.processor->drawText(textSpec);
+    for (auto it = m_scalers.begin(); it != m_scalers.end(); ++it)
+        it->second->processor()->drawText(textSpec);
 }
 
 inline void VideoFrameTranscoderImpl::clearText()
 {
     boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it)
-        it->second.processor->clearText();
+    for (auto it = m_scalers.begin(); it != m_scalers.end(); ++it)
+        it->second->processor()->clearText();
+}
+
+inline void VideoFrameTranscoderImpl::onFrame(const owt_base::Frame& frame)
+{
+    if (frame.format != owt_base::FRAME_FORMAT_I420)
+        return;
+
+    // The decoded frame is shared by reference, every scaling node of the
+    // graph gets it once and runs concurrently on the worker pool.
+    boost::shared_ptr<webrtc::VideoFrame> videoFrame(
+        new webrtc::VideoFrame(*reinterpret_cast<webrtc::VideoFrame*>(frame.payload)));
+
+    boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
+    for (auto it = m_scalers.begin(); it != m_scalers.end(); ++it) {
+        boost::shared_ptr<ScalerNode> scaler = it->second;
+        if (!scaler->tryAcquire()) {
+            ELOG_TRACE_T("scaler node busy, drop frame(%u)", frame.timeStamp);
+            continue;
+        }
+
+        m_srv->post([scaler, videoFrame, frame]() {
+            scaler->process(*videoFrame, frame);
+        });
+    }
 }
 
 }
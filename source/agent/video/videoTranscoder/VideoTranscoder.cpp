@@ -14,6 +14,8 @@ using namespace owt_base;
 namespace mcu {
 
 DEFINE_LOGGER(VideoTranscoder, "mcu.media.VideoTranscoder");
+DEFINE_LOGGER(VideoFrameTranscoderImpl, "mcu.media.VideoFrameTranscoderImpl");
+DEFINE_LOGGER(ScalerNode, "mcu.media.VideoFrameTranscoderImpl.ScalerNode");
 
 VideoTranscoder::VideoTranscoder(const VideoTranscoderConfig& config)
     : m_inputCount(0)
@@ -44,7 +46,7 @@ VideoTranscoder::VideoTranscoder(const VideoTranscoderConfig& config)
 
     ELOG_INFO("Init");
 
-    m_frameTranscoder.reset(new VideoFrameTranscoderImpl());
+    m_frameTranscoder.reset(new VideoFrameTranscoderImpl(config.intraRefreshFrames, config.ladder));
 }
 
 VideoTranscoder::~VideoTranscoder()
@@ -137,6 +139,19 @@ void VideoTranscoder::removeOutput(const std::string& outStreamID)
     }
 }
 
+bool VideoTranscoder::getOutputRung(const std::string& outStreamID, LadderRung& rung)
+{
+    int32_t index = -1;
+    boost::shared_lock<boost::shared_mutex> lock(m_outputsMutex);
+    auto it = m_outputs.find(outStreamID);
+    if (it != m_outputs.end()) {
+        index = it->second;
+    }
+    lock.unlock();
+
+    return index != -1 && m_frameTranscoder->getOutputRung(index, rung);
+}
+
 void VideoTranscoder::forceKeyFrame(const std::string& outStreamID)
 {
     int32_t index = -1;
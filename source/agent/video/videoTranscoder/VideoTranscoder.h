@@ -18,6 +18,10 @@ namespace mcu {
 struct VideoTranscoderConfig {
     bool useGacc;
     uint32_t MFE_timeout;
+    // Gradual intra refresh period in frames, 0 for periodic key frames
+    uint32_t intraRefreshFrames;
+    // Outputs snapped to one rung share an encoder
+    OutputLadder ladder;
 };
 
 class VideoTranscoder {
@@ -32,6 +36,7 @@ public:
     bool addOutput(const std::string& outStreamID, const std::string& codec, const owt_base::VideoCodecProfile profile, const std::string& resolution, const unsigned int framerateFPS, const unsigned int bitrateKbps, const unsigned int keyFrameIntervalSeconds, owt_base::FrameDestination* dest);
 
     void removeOutput(const std::string& outStreamID);
+    bool getOutputRung(const std::string& outStreamID, LadderRung& rung);
     void forceKeyFrame(const std::string& outStreamID);
     void drawText(const std::string& textSpec);
     void clearText();
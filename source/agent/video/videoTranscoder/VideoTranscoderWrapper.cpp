@@ -55,6 +55,38 @@ void VideoTranscoder::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     config.MFE_timeout = Nan::To<int32_t>(
         Nan::Get(options, Nan::New("MFE_timeout").ToLocalChecked()).ToLocalChecked())
                              .FromJust();
+    config.intraRefreshFrames = Nan::To<int32_t>(
+        Nan::Get(options, Nan::New("intraRefreshFrames").ToLocalChecked()).ToLocalChecked())
+                                    .FromJust();
+
+    Local<Value> ladder = Nan::Get(options, Nan::New("ladder").ToLocalChecked()).ToLocalChecked();
+    if (ladder->IsObject()) {
+        Local<Object> ladderObj = Nan::To<v8::Object>(ladder).ToLocalChecked();
+        config.ladder = mcu::OutputLadder(Nan::To<double>(
+            Nan::Get(ladderObj, Nan::New("bitrateStep").ToLocalChecked()).ToLocalChecked())
+                                              .FromMaybe(0));
+        Local<Value> rungs = Nan::Get(ladderObj, Nan::New("rungs").ToLocalChecked()).ToLocalChecked();
+        if (rungs->IsArray()) {
+            Local<Array> rungArray = Local<Array>::Cast(rungs);
+            for (uint32_t i = 0; i < rungArray->Length(); i++) {
+                Local<Object> rungObj = Nan::To<v8::Object>(Nan::Get(rungArray, i).ToLocalChecked()).ToLocalChecked();
+                mcu::LadderRung rung;
+                std::string codec = getString(Nan::Get(rungObj, Nan::New("codec").ToLocalChecked()).ToLocalChecked());
+                rung.format = codec.empty() ? owt_base::FRAME_FORMAT_UNKNOWN : owt_base::getFormat(codec);
+                std::string resolution = getString(Nan::Get(rungObj, Nan::New("resolution").ToLocalChecked()).ToLocalChecked());
+                rung.framerateFPS = Nan::To<uint32_t>(
+                    Nan::Get(rungObj, Nan::New("framerate").ToLocalChecked()).ToLocalChecked())
+                                        .FromJust();
+                rung.bitrateKbps = Nan::To<uint32_t>(
+                    Nan::Get(rungObj, Nan::New("bitrate").ToLocalChecked()).ToLocalChecked())
+                                       .FromJust();
+                if (owt_base::VideoResolutionHelper::getVideoSize(resolution, rung.size)
+                    && rung.framerateFPS && rung.bitrateKbps) {
+                    config.ladder.addRung(rung);
+                }
+            }
+        }
+    }
 
     VideoTranscoder* obj = new VideoTranscoder();
     obj->me = new mcu::VideoTranscoder(config);
@@ -144,7 +176,21 @@ void VideoTranscoder::addOutput(const v8::FunctionCallbackInfo<v8::Value>& args)
 
     bool r = me->addOutput(outStreamID, codec, profile, resolution, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, dest);
 
-    args.GetReturnValue().Set(Boolean::New(isolate, r));
+    // The output as snapped to the ladder, false on failure
+    mcu::LadderRung rung;
+    if (!r || !me->getOutputRung(outStreamID, rung)) {
+        args.GetReturnValue().Set(Boolean::New(isolate, r));
+        return;
+    }
+
+    Local<Object> size = Nan::New<Object>();
+    Nan::Set(size, Nan::New("width").ToLocalChecked(), Nan::New(rung.size.width));
+    Nan::Set(size, Nan::New("height").ToLocalChecked(), Nan::New(rung.size.height));
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("resolution").ToLocalChecked(), size);
+    Nan::Set(result, Nan::New("framerate").ToLocalChecked(), Nan::New(rung.framerateFPS));
+    Nan::Set(result, Nan::New("bitrate").ToLocalChecked(), Nan::New(rung.bitrateKbps));
+    args.GetReturnValue().Set(result);
 }
 
 void VideoTranscoder::removeOutput(const v8::FunctionCallbackInfo<v8::Value>& args)
@@ -3,8 +3,18 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "VideoTranscoderWrapper.h"
+#include "../../addons/common/PipelineTracerWrapper.h"
 #include <node.h>
 
 using namespace v8;
 
-NODE_MODULE(addon, VideoTranscoder::Init)
+void InitAll(Local<Object> exports, Local<Object> module) {
+  VideoTranscoder::Init(exports, module);
+  // module.exports is replaced by the VideoTranscoder constructor, add the tracer
+  // functions as its static methods.
+  Local<Object> moduleExports = Nan::To<Object>(
+      Nan::Get(module, Nan::New("exports").ToLocalChecked()).ToLocalChecked()).ToLocalChecked();
+  InitPipelineTracer(moduleExports);
+}
+
+NODE_MODULE(addon, InitAll)
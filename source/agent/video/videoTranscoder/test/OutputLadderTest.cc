@@ -0,0 +1,62 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OutputLadder
+#include <boost/test/unit_test.hpp>
+
+#include "OutputLadder.h"
+
+using namespace mcu;
+using namespace owt_base;
+
+static OutputLadder makeLadder()
+{
+    OutputLadder ladder(0.1);
+    ladder.addRung({ FRAME_FORMAT_UNKNOWN, { 1280, 720 }, 30, 2000 });
+    ladder.addRung({ FRAME_FORMAT_UNKNOWN, { 640, 360 }, 30, 800 });
+    ladder.addRung({ FRAME_FORMAT_UNKNOWN, { 640, 360 }, 15, 500 });
+    ladder.addRung({ FRAME_FORMAT_H265, { 1280, 720 }, 30, 1200 });
+    return ladder;
+}
+
+BOOST_AUTO_TEST_CASE(snapToNearestRung)
+{
+    OutputLadder ladder = makeLadder();
+    LadderRung rung = ladder.snap(FRAME_FORMAT_VP8, { 960, 540 }, 24, 1000);
+    BOOST_CHECK_EQUAL(rung.format, FRAME_FORMAT_VP8);
+    BOOST_CHECK_EQUAL(rung.size.width, 640u);
+    BOOST_CHECK_EQUAL(rung.framerateFPS, 30u);
+    BOOST_CHECK_EQUAL(rung.bitrateKbps, 800u);
+
+    rung = ladder.snap(FRAME_FORMAT_VP8, { 640, 360 }, 12, 450);
+    BOOST_CHECK_EQUAL(rung.framerateFPS, 15u);
+    BOOST_CHECK_EQUAL(rung.bitrateKbps, 500u);
+}
+
+BOOST_AUTO_TEST_CASE(rungOfCodec)
+{
+    OutputLadder ladder = makeLadder();
+    LadderRung rung = ladder.snap(FRAME_FORMAT_H265, { 1280, 720 }, 30, 1300);
+    BOOST_CHECK_EQUAL(rung.bitrateKbps, 1200u);
+    rung = ladder.snap(FRAME_FORMAT_H264, { 1280, 720 }, 30, 1300);
+    BOOST_CHECK_EQUAL(rung.bitrateKbps, 2000u);
+}
+
+BOOST_AUTO_TEST_CASE(bucketsWithoutRung)
+{
+    OutputLadder ladder = makeLadder();
+    // 4:3 has no rung, keeps size and frame rate
+    LadderRung a = ladder.snap(FRAME_FORMAT_VP8, { 640, 480 }, 25, 1010);
+    LadderRung b = ladder.snap(FRAME_FORMAT_VP8, { 640, 480 }, 25, 1040);
+    BOOST_CHECK_EQUAL(a.size.height, 480u);
+    BOOST_CHECK_EQUAL(a.framerateFPS, 25u);
+    BOOST_CHECK_EQUAL(a.bitrateKbps, b.bitrateKbps);
+    BOOST_CHECK(a.bitrateKbps > 1000 && a.bitrateKbps < 1100);
+    LadderRung c = ladder.snap(FRAME_FORMAT_VP8, { 640, 480 }, 25, 1200);
+    BOOST_CHECK(c.bitrateKbps != a.bitrateKbps);
+
+    // Follows the input size
+    LadderRung d = ladder.snap(FRAME_FORMAT_VP8, { 0, 0 }, 30, 800);
+    BOOST_CHECK_EQUAL(d.size.width, 0u);
+
+    OutputLadder exact;
+    BOOST_CHECK_EQUAL(exact.snap(FRAME_FORMAT_VP8, { 640, 480 }, 25, 1030).bitrateKbps, 1030u);
+}
@@ -7,7 +7,10 @@
                 "../VideoTranscoderWrapper.cc",
                 "../VideoTranscoder.cpp",
                 "../../../../core/owt_base/I420BufferManager.cpp",
+                "../../../../core/owt_base/KeyFrameArbiter.cpp",
+                "../../../../core/owt_base/MediaFrameMulticaster.cpp",
                 "../../../../core/owt_base/MediaFramePipeline.cpp",
+                "../../../../core/owt_base/PipelineTracer.cpp",
                 "../../../../core/owt_base/FrameConverter.cpp",
                 "../../../../core/owt_base/FrameProcessor.cpp",
                 "../../../../core/owt_base/FFmpegDrawText.cpp",
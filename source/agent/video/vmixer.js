@@ -26,6 +26,7 @@ const isUnspecified = (value) => value === undefined || value === 'unspecified';
 const useHardware = global.config.video.hardwareAccelerated;
 const gaccPluginEnabled = global.config.video.enableBetterHEVCQuality || false;
 const MFE_timeout = global.config.video.MFE_timeout || 0;
+const intraRefreshFrames = global.config.video.intra_refresh_frames || 0;
 const supported_codecs = global.config.video.codecs;
 
 /*
@@ -440,6 +441,7 @@ function VMixer(rpcClient, clusterIP, VideoMixer, router, streamingEmitter) {
       crop: videoConfig.layout.fitPolicy === 'crop' ? true : false,
       gaccplugin: gaccPluginEnabled,
       MFE_timeout: MFE_timeout,
+      intraRefreshFrames: intraRefreshFrames,
     };
 
     inputManager = new InputManager(videoConfig.maxInput);
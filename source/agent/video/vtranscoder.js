@@ -19,6 +19,8 @@ const isUnspecified = (value) => value === undefined || value === 'unspecified';
 const useHardware = global.config.video.hardwareAccelerated;
 const gaccPluginEnabled = global.config.video.enableBetterHEVCQuality || false;
 const MFE_timeout = global.config.video.MFE_timeout || 0;
+const intraRefreshFrames = global.config.video.intra_refresh_frames || 0;
+const transcodeLadder = global.config.video.transcode_ladder || {};
 const supported_codecs = global.config.video.codecs;
 
 function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
@@ -122,23 +124,29 @@ function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
     if (engine) {
       var stream_id = Math.random() * 1000000000000000000 + '';
       var dispatcher = new MediaFrameMulticaster();
-      if (
-        engine.addOutput(
-          stream_id,
-          codec,
-          resolution2String(resolution),
-          framerate,
-          bitrate,
-          keyFrameInterval,
-          dispatcher
-        )
-      ) {
+      // The output snapped to the transcoding ladder
+      var snapped = engine.addOutput(
+        stream_id,
+        codec,
+        resolution2String(resolution),
+        framerate,
+        bitrate,
+        keyFrameInterval,
+        dispatcher
+      );
+      if (snapped) {
         outputs[stream_id] = {
           codec: codec,
-          resolution: resolution,
-          framerate: framerate,
-          bitrate: bitrate,
+          resolution: snapped.resolution || resolution,
+          framerate: snapped.framerate || framerate,
+          bitrate: snapped.bitrate || bitrate,
           kfi: keyFrameInterval,
+          // As asked for, later requests for the same are matched on it
+          requested: {
+            resolution: resolution,
+            framerate: framerate,
+            bitrate: bitrate,
+          },
           dispatcher: dispatcher,
           connections: {},
         };
@@ -193,6 +201,16 @@ function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
       crop: false,
       gaccplugin: gaccPluginEnabled,
       MFE_timeout: MFE_timeout,
+      intraRefreshFrames: intraRefreshFrames,
+      ladder: {
+        bitrateStep: transcodeLadder.bitrate_step || 0,
+        rungs: (transcodeLadder.rungs || []).map((rung) => ({
+          codec: rung.codec || '',
+          resolution: resolution2String(rung.resolution),
+          framerate: rung.framerate,
+          bitrate: rung.bitrate,
+        })),
+      },
     };
 
     controller = ctrlr;
@@ -286,11 +304,12 @@ function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
       : keyFrameInterval;
 
     for (var stream_id in outputs) {
+      var requested = outputs[stream_id].requested;
       if (
         outputs[stream_id].codec === codec &&
-        isResolutionEqual(outputs[stream_id].resolution, resolution) &&
-        outputs[stream_id].framerate === framerate &&
-        outputs[stream_id].bitrate === bitrate &&
+        isResolutionEqual(requested.resolution, resolution) &&
+        requested.framerate === framerate &&
+        requested.bitrate === bitrate &&
         outputs[stream_id].kfi === keyFrameInterval
       ) {
         callback('callback', getOutput(stream_id));
@@ -63,6 +63,10 @@ module.exports.load = async function () {
     config.webrtc.use_nicer = config.webrtc.use_nicer || false;
     config.webrtc.io_workers = config.webrtc.io_workers || 8;
     config.webrtc.network_interfaces = config.webrtc.network_interfaces || [];
+    // Minimal interval(ms) between key frame requests sent to a publisher
+    if (config.webrtc.keyframe_min_interval === undefined) {
+      config.webrtc.keyframe_min_interval = 1000;
+    }
 
     config.webrtc.network_interfaces.forEach((item) => {
       let addr = networkHelper.getAddress(item.name);
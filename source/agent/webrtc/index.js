@@ -10,6 +10,7 @@ var WrtcConnection = require('./wrtcConnection');
 var Connections = require('./connections');
 var logger = require('../logger').logger;
 var { InternalConnectionRouter } = require('./internalConnectionRouter');
+var { QualitySwitches } = require('./qualitySwitch');
 
 // Logger
 var log = logger.getLogger('WebrtcNode');
@@ -47,8 +48,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
   var mappingPublicId = new Map();
   // Map { operationId => transportId }
   var mappingTransports = new Map();
-  // Map { switchId => videoSwitch }
-  var switches = new Map();
+  var switches = new QualitySwitches(router, {
+    VideoSwitch: videoSwitch,
+    MediaFrameMulticaster,
+  });
   var streamingEmitter = new EventEmitter();
 
   var notifyTransportStatus = function (controller, transportId, status) {
@@ -136,13 +139,13 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
       }
 
       // Bind media-update handler
-      track.on('media-update', (jsonUpdate) => {
-        log.debug('notifyMediaUpdate:', publicTrackId, jsonUpdate);
+      track.on('media-update', (mediaUpdate) => {
+        log.debug('notifyMediaUpdate:', publicTrackId, mediaUpdate);
         notifyMediaUpdate(
           controller,
           publicTrackId,
           track.direction,
-          JSON.parse(jsonUpdate)
+          mediaUpdate
         );
       });
       // Notify controller
@@ -296,7 +299,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
   // functions: publish, unpublish, subscribe, unsubscribe, linkup, cutoff
   // options = {
   //   transportId,
-  //   tracks = [{mid, type, formatPreference, scalabilityMode}],
+  //   tracks = [{mid, type, formatPreference, scalabilityMode, frameAssembler}],
   //   controller, owner
   // }
   // formatPreference = {preferred: MediaFormat, optional: [MediaFormat]}
@@ -361,9 +364,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
   // functions: publish, unpublish, subscribe, unsubscribe, linkup, cutoff
   // options = {
   //   transportId,
-  //   tracks = [{mid, type, formatPreference, scalabilityMode}],
+  //   tracks = [{mid, type, formatPreference, scalabilityMode, bandwidth}],
   //   controller, owner, enableBWE
   // }
+  // bandwidth = {priority, minBitrate, maxBitrate}, bitrates in kbps
   // formatPreference = {preferred: MediaFormat, optional: [MediaFormat]}
   that.subscribe = function (operationId, connectionType, options, callback) {
     log.debug(
@@ -550,59 +554,13 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     }
   };
 
-  const dispatchers = new Map();
-
   // Create quality switch for given source streams,
   // which can switch source based on bitrate setting.
   // return created switch ID
   that.createQualitySwitch = function (sourceStreams, callback) {
     log.debug('createQualitySwitch', JSON.stringify(sourceStreams));
     const switchId = Math.round(Math.random() * 1000000000000000000) + '';
-    const switchSources = [];
-    for (const source of sourceStreams) {
-      if (!router.hasConnection(source.id)) {
-        router.getOrCreateRemoteSource(
-          {
-            id: source.id,
-            ip: source.ip,
-            port: source.port,
-          },
-          function onStats(stat) {
-            if (stat === 'disconnected') {
-              if (switches.get(switchId)) {
-                log.debug('Quality switch source disconnect:', source.id);
-                switches.get(switchId).close();
-                switches.delete(switchId);
-              }
-              router.destroyRemoteSource(source.id);
-            }
-          }
-        );
-      }
-      const conn = router.getConnection(source.id);
-      if (conn) {
-        log.debug('Added switch source:', source.id);
-        const dispatcher = new MediaFrameMulticaster();
-        dispatcher.receiver = function () {
-          return dispatcher;
-        };
-        const dispatcherId = switchId + switchSources.length;
-        dispatchers.set(dispatcherId, dispatcher);
-        router.addLocalDestination(dispatcherId, 'dispatcher', dispatcher);
-        router
-          .linkup(dispatcherId, { video: { id: source.id } })
-          .catch((e) => log.debug(e));
-        switchSources.push(dispatcher.source());
-      }
-    }
-    const dispatcher = new MediaFrameMulticaster();
-    dispatchers.set(switchId, dispatcher);
-    switchSources.push(dispatcher.source());
-    const vswitch = new videoSwitch(...switchSources);
-    switches.set(switchId, vswitch);
-    router
-      .addLocalSource(switchId, 'webrtc', vswitch)
-      .catch((e) => log.warn('Adding switch:', e));
+    switches.create(switchId, sourceStreams);
     callback('callback', { id: switchId });
   };
 
@@ -612,6 +570,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
 
   that.close = function () {
     log.debug('close called');
+    switches.clear();
     router.clear();
     peerConnections.forEach((pc) => {
       pc.close();
@@ -0,0 +1,148 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+
+const log = require('../logger').logger.getLogger('QualitySwitch');
+
+/*
+ * Quality switches of a webrtc agent, each switch selects one of its
+ * source streams based on bitrate setting.
+ */
+class QualitySwitches {
+  /*
+   * @param {InternalConnectionRouter} router
+   * @param {function} VideoSwitch Addon constructor for switch
+   * @param {function} MediaFrameMulticaster Addon constructor for dispatcher
+   */
+  constructor(router, {VideoSwitch, MediaFrameMulticaster}) {
+    this.router = router;
+    this.VideoSwitch = VideoSwitch;
+    this.MediaFrameMulticaster = MediaFrameMulticaster;
+    // Map { switchId => videoSwitch }
+    this.switches = new Map();
+    // Map { dispatcherId => { dispatcher, refs } }, a per-source dispatcher
+    // is shared by the switches on that source
+    this.dispatchers = new Map();
+    // Map { switchId => [dispatcherId] }
+    this.switchDispatchers = new Map();
+  }
+
+  has(switchId) {
+    return this.switches.has(switchId);
+  }
+
+  /*
+   * Create a switch on the given source streams
+   * @param {string} switchId
+   * @param {array} sourceStreams [{id, ip, port}]
+   */
+  create(switchId, sourceStreams) {
+    const router = this.router;
+    const switchSources = [];
+    const usedDispatchers = [];
+    for (const source of sourceStreams) {
+      const dispatcherId = 'switch-' + source.id;
+      if (!router.hasConnection(source.id)) {
+        router.getOrCreateRemoteSource(
+          {
+            id: source.id,
+            ip: source.ip,
+            port: source.port,
+          },
+          (stat) => {
+            if (stat === 'disconnected') {
+              // Close every switch on the source, not only the first one
+              for (const [id, used] of this.switchDispatchers) {
+                if (used.includes(dispatcherId)) {
+                  log.debug('Quality switch source disconnect:', source.id, id);
+                  this.close(id);
+                }
+              }
+              router.destroyRemoteSource(source.id);
+            }
+          }
+        );
+      }
+      const conn = router.getConnection(source.id);
+      if (conn) {
+        log.debug('Added switch source:', source.id);
+        // Switches on the same source share its dispatcher, so the layer
+        // bitrates of the source are only counted once
+        let entry = this.dispatchers.get(dispatcherId);
+        if (!entry) {
+          const dispatcher = new this.MediaFrameMulticaster();
+          dispatcher.receiver = function () {
+            return dispatcher;
+          };
+          entry = { dispatcher, refs: 0 };
+          this.dispatchers.set(dispatcherId, entry);
+          router.addLocalDestination(dispatcherId, 'dispatcher', dispatcher);
+          router
+            .linkup(dispatcherId, { video: { id: source.id } })
+            .catch((e) => log.debug(e));
+        }
+        entry.refs++;
+        usedDispatchers.push(dispatcherId);
+        switchSources.push(entry.dispatcher.source());
+      }
+    }
+    // The trailing dispatcher is owned by this switch only, keep it apart
+    // from the switch ID which is registered as a local source
+    const tailId = 'switch-tail-' + switchId;
+    const dispatcher = new this.MediaFrameMulticaster();
+    this.dispatchers.set(tailId, { dispatcher, refs: 1 });
+    usedDispatchers.push(tailId);
+    switchSources.push(dispatcher.source());
+    this.switchDispatchers.set(switchId, usedDispatchers);
+    const vswitch = new this.VideoSwitch(...switchSources);
+    this.switches.set(switchId, vswitch);
+    return router
+      .addLocalSource(switchId, 'webrtc', vswitch)
+      .catch((e) => log.warn('Adding switch:', e));
+  }
+
+  /*
+   * Close the switch, its linked subscriptions are cut off before
+   * the addon object is released
+   * @param {string} switchId
+   */
+  close(switchId) {
+    const vswitch = this.switches.get(switchId);
+    if (vswitch) {
+      if (this.router.hasConnection(switchId)) {
+        this.router.removeLocalSource(switchId)
+          .catch((e) => log.debug('Remove switch:', e));
+      }
+      vswitch.close();
+      this.switches.delete(switchId);
+    }
+    for (const dispatcherId of this.switchDispatchers.get(switchId) || []) {
+      this._releaseDispatcher(dispatcherId);
+    }
+    this.switchDispatchers.delete(switchId);
+  }
+
+  // Close all the switches
+  clear() {
+    for (const switchId of [...this.switches.keys()]) {
+      this.close(switchId);
+    }
+  }
+
+  _releaseDispatcher(dispatcherId) {
+    const entry = this.dispatchers.get(dispatcherId);
+    if (!entry || --entry.refs > 0) {
+      return;
+    }
+    this.dispatchers.delete(dispatcherId);
+    if (this.router.hasConnection(dispatcherId)) {
+      this.router.removeLocalDestination(dispatcherId)
+        .catch((e) => log.debug('Remove dispatcher:', e));
+    }
+    entry.dispatcher.close();
+  }
+}
+
+exports.QualitySwitches = QualitySwitches;
@@ -61,19 +61,18 @@ void WoogeenHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet) {
           totalLength += redhead->getLength() + 4; // RED header
           redhead = (redheader*) (buf + totalLength);
         }
-        // Parse RED packet to external[payloadType] packet.
-        // Copy RTP header
+        // Parse RED packet to external[payloadType] packet in place,
+        // the packet is not shared with other streams.
         int newLen = len - 1 - totalLength + rtpHeaderLength;
-        assert(newLen <= 3000);
+        int payloadType = redhead->payloadtype;
 
-        memcpy((void*)deliverMediaBuffer, (void*)buf, rtpHeaderLength);
-        // Copy payload data
-        memcpy(deliverMediaBuffer + totalLength, buf + totalLength + 1, newLen - rtpHeaderLength);
-        // Copy payload type
-        RTPHeader* mediahead = (RTPHeader*) deliverMediaBuffer;
-        mediahead->setPayloadType(redhead->payloadtype);
+        // Move payload data over the RED header
+        memmove(buf + totalLength, buf + totalLength + 1, newLen - rtpHeaderLength);
+        h->setPayloadType(payloadType);
+        packet->length = newLen;
+        packet->type = VIDEO_PACKET;
 
-        ctx->fireWrite(std::make_shared<DataPacket>(0, deliverMediaBuffer, newLen, VIDEO_PACKET));
+        ctx->fireWrite(std::move(packet));
         return;
       }
     }
@@ -34,7 +34,6 @@ class WoogeenHandler: public Handler, public std::enable_shared_from_this<Woogee
  private:
   MediaStream *connection_;
   bool enabled_;
-  char deliverMediaBuffer[3000];
 };
 
 }  // namespace erizo
@@ -16,6 +16,9 @@ Nan::Persistent<Function> VideoFrameConstructor::constructor;
 VideoFrameConstructor::VideoFrameConstructor()
   : me(nullptr)
   , src(nullptr)
+  , videoInfoChanged(false)
+  , videoWidth(0)
+  , videoHeight(0)
   , parent(nullptr)
 {}
 
@@ -36,7 +39,10 @@ NAN_MODULE_INIT(VideoFrameConstructor::Init) {
   Nan::SetPrototypeMethod(tpl, "removeDestination", removeDestination);
   Nan::SetPrototypeMethod(tpl, "setBitrate", setBitrate);
   Nan::SetPrototypeMethod(tpl, "setPreferredLayers", setPreferredLayers);
+  Nan::SetPrototypeMethod(tpl, "setFrameAssembler", setFrameAssembler);
+  Nan::SetPrototypeMethod(tpl, "setKeyFrameMinInterval", setKeyFrameMinInterval);
   Nan::SetPrototypeMethod(tpl, "requestKeyFrame", requestKeyFrame);
+  Nan::SetPrototypeMethod(tpl, "statsSlot", statsSlot);
   Nan::SetPrototypeMethod(tpl, "source", source);
 
   constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
@@ -167,6 +173,22 @@ NAN_METHOD(VideoFrameConstructor::setPreferredLayers) {
   }
 }
 
+NAN_METHOD(VideoFrameConstructor::setFrameAssembler) {
+  VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
+  owt_base::VideoFrameConstructor* me = obj->me;
+
+  bool b = Nan::To<bool>(info[0]).FromMaybe(false);
+  me->setFrameAssembler(b);
+}
+
+NAN_METHOD(VideoFrameConstructor::setKeyFrameMinInterval) {
+  VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
+  owt_base::VideoFrameConstructor* me = obj->me;
+
+  uint32_t ms = Nan::To<uint32_t>(info[0]).FromMaybe(0);
+  me->setKeyFrameMinInterval(ms);
+}
+
 NAN_METHOD(VideoFrameConstructor::requestKeyFrame) {
   VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
   owt_base::VideoFrameConstructor* me = obj->me;
@@ -174,6 +196,13 @@ NAN_METHOD(VideoFrameConstructor::requestKeyFrame) {
   me->RequestKeyFrame();
 }
 
+NAN_METHOD(VideoFrameConstructor::statsSlot) {
+  VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
+  owt_base::VideoFrameConstructor* me = obj->me;
+
+  info.GetReturnValue().Set(Nan::New(me->statsSlot()));
+}
+
 NAN_METHOD(VideoFrameConstructor::enable) {
   VideoFrameConstructor* obj = Nan::ObjectWrap::Unwrap<VideoFrameConstructor>(info.Holder());
   owt_base::VideoFrameConstructor* me = obj->me;
@@ -182,9 +211,13 @@ NAN_METHOD(VideoFrameConstructor::enable) {
   me->enable(b);
 }
 
-void VideoFrameConstructor::onVideoInfo(const std::string& message) {
-  boost::mutex::scoped_lock lock(mutex);
-  this->videoInfoMsgs.push(message);
+void VideoFrameConstructor::onVideoInfoChanged(uint32_t width, uint32_t height) {
+  this->videoWidth = width;
+  this->videoHeight = height;
+  // Only the latest values matter, one wake-up is enough
+  if (this->videoInfoChanged.exchange(true)) {
+    return;
+  }
   async_.data = this;
   uv_async_send(&async_);
 }
@@ -194,11 +227,12 @@ NAUV_WORK_CB(VideoFrameConstructor::Callback) {
   VideoFrameConstructor* obj = reinterpret_cast<VideoFrameConstructor*>(async->data);
   if (!obj || obj->me == NULL)
     return;
-  boost::mutex::scoped_lock lock(obj->mutex);
-  while (!obj->videoInfoMsgs.empty()) {
-    Local<Value> args[] = {Nan::New(obj->videoInfoMsgs.front().c_str()).ToLocalChecked()};
-    obj->asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), obj->Callback_->GetFunction(), 1, args);
-    obj->videoInfoMsgs.pop();
+  if (obj->videoInfoChanged.exchange(false)) {
+    Local<Value> args[] = {
+      Nan::New(obj->videoWidth.load()),
+      Nan::New(obj->videoHeight.load()),
+    };
+    obj->asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), obj->Callback_->GetFunction(), 2, args);
   }
 }
 
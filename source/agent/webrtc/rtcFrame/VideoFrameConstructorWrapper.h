@@ -8,6 +8,7 @@
 #include "MediaWrapper.h"
 #include "../../addons/common/MediaFramePipelineWrapper.h"
 #include <VideoFrameConstructor.h>
+#include <atomic>
 #include <node.h>
 #include <node_object_wrap.h>
 #include <nan.h>
@@ -21,8 +22,10 @@ class VideoFrameConstructor : public MediaSink, public owt_base::VideoInfoListen
   owt_base::VideoFrameConstructor* me;
   owt_base::FrameSource* src;
 
-  std::queue<std::string> videoInfoMsgs;
-  boost::mutex mutex;
+  std::atomic<bool> videoInfoChanged;
+  // Latest resolution, for streams without a stats registry slot
+  std::atomic<uint32_t> videoWidth;
+  std::atomic<uint32_t> videoHeight;
 
   owt_base::VideoFrameConstructor* parent;
   std::string layerId;
@@ -47,15 +50,19 @@ class VideoFrameConstructor : public MediaSink, public owt_base::VideoInfoListen
 
   static NAN_METHOD(setBitrate);
   static NAN_METHOD(setPreferredLayers);
+  static NAN_METHOD(setFrameAssembler);
+  static NAN_METHOD(setKeyFrameMinInterval);
 
   static NAN_METHOD(requestKeyFrame);
 
+  static NAN_METHOD(statsSlot);
+
   static NAN_METHOD(source);
 
   static Nan::Persistent<v8::Function> constructor;
 
   static NAUV_WORK_CB(Callback);
-  virtual void onVideoInfo(const std::string& message);
+  void onVideoInfoChanged(uint32_t width, uint32_t height) override;
 };
 
 class VideoFrameSource : public FrameSource {
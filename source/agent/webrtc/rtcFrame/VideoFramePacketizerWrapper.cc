@@ -33,6 +33,7 @@ void VideoFramePacketizer::Init(v8::Local<v8::Object> exports) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "getTotalBitrateBps", getTotalBitrate);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getRetransmitBitrateBps", getRetransmitBitrate);
   NODE_SET_PROTOTYPE_METHOD(tpl, "getEstimatedBandwidthBps", getEstimatedBandwidth);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "statsSlot", getStatsSlot);
 
   constructor.Reset(isolate, Nan::GetFunction(tpl).ToLocalChecked());
   Nan::Set(exports, Nan::New("VideoFramePacketizer").ToLocalChecked(),
@@ -60,6 +61,13 @@ void VideoFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
       : nullptr;
   bool enableBandwidthEstimation = (args.Length() >= 8)
       ? Nan::To<bool>(args[7]).FromJust() : false;
+  // Bandwidth allocation among the video senders of the connection
+  int priority = (args.Length() >= 9)
+      ? Nan::To<int32_t>(args[8]).FromJust() : 1;
+  uint32_t minBitrateBps = (args.Length() >= 10)
+      ? Nan::To<uint32_t>(args[9]).FromJust() : 0;
+  uint32_t maxBitrateBps = (args.Length() >= 11)
+      ? Nan::To<uint32_t>(args[10]).FromJust() : 0;
 
   VideoFramePacketizer* obj = new VideoFramePacketizer();
   owt_base::VideoFramePacketizer::Config config;
@@ -69,6 +77,9 @@ void VideoFramePacketizer::New(const FunctionCallbackInfo<Value>& args) {
   config.mid = mid;
   config.midExtId = midExtId;
   config.enableBandwidthEstimation = enableBandwidthEstimation;
+  config.priority = priority;
+  config.minBitrateBps = minBitrateBps;
+  config.maxBitrateBps = maxBitrateBps;
   if (baseWrapper) {
     config.rtcAdapter = baseWrapper->rtcAdapter;
   }
@@ -176,3 +187,13 @@ void VideoFramePacketizer::getEstimatedBandwidth(const v8::FunctionCallbackInfo<
   uint32_t bitrate = me->getEstimatedBandwidth();
   args.GetReturnValue().Set(Number::New(isolate, bitrate));
 }
+
+void VideoFramePacketizer::getStatsSlot(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoFramePacketizer* obj = ObjectWrap::Unwrap<VideoFramePacketizer>(args.Holder());
+  owt_base::VideoFramePacketizer* me = obj->me;
+
+  args.GetReturnValue().Set(Integer::New(isolate, me->statsSlot()));
+}
@@ -35,6 +35,7 @@ class VideoFramePacketizer : public FrameDestination {
   static void getTotalBitrate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void getRetransmitBitrate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void getEstimatedBandwidth(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void getStatsSlot(const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 #endif
@@ -7,6 +7,8 @@
 #include "CallBaseWrapper.h"
 #include "VideoFrameConstructorWrapper.h"
 #include "VideoFramePacketizerWrapper.h"
+#include "../../addons/common/PipelineTracerWrapper.h"
+#include "../../addons/common/StreamStatsRegistryWrapper.h"
 
 #include <node.h>
 
@@ -18,6 +20,8 @@ void InitAll(Local<Object> exports) {
   VideoFrameConstructor::Init(exports);
   VideoFramePacketizer::Init(exports);
   CallBase::Init(exports);
+  Nan::SetMethod(exports, "streamStatsRegistry", streamStatsRegistry);
+  InitPipelineTracer(exports);
 }
 
 NODE_MODULE(addon, InitAll)
@@ -10,7 +10,11 @@
       '<(source_rel_dir)/core/owt_base/AudioFramePacketizer.cpp',
       '<(source_rel_dir)/core/owt_base/VideoFrameConstructor.cpp',
       '<(source_rel_dir)/core/owt_base/VideoFramePacketizer.cpp',
+      '<(source_rel_dir)/core/owt_base/DataPacketPool.cpp',
+      '<(source_rel_dir)/core/owt_base/KeyFrameArbiter.cpp',
       '<(source_rel_dir)/core/owt_base/MediaFramePipeline.cpp',
+      '<(source_rel_dir)/core/owt_base/PipelineTracer.cpp',
+      '<(source_rel_dir)/core/owt_base/StreamStatsRegistry.cpp',
       '<(source_rel_dir)/core/common/JobTimer.cpp',
       'AudioFrameConstructorWrapper.cc',
       'AudioFramePacketizerWrapper.cc',
@@ -69,7 +73,12 @@
     'sources': [
         '<(source_rel_dir)/core/rtc_adapter/RtcAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/VideoReceiveAdapter.cc',
+        '<(source_rel_dir)/core/rtc_adapter/VideoFrameAssembler.cc',
         '<(source_rel_dir)/core/rtc_adapter/VideoSendAdapter.cc',
+        '<(source_rel_dir)/core/rtc_adapter/SharedVideoPacketizer.cc',
+        '<(source_rel_dir)/core/rtc_adapter/SharedPacketHistory.cc',
+        '<(source_rel_dir)/core/rtc_adapter/SharedPacer.cc',
+        '<(source_rel_dir)/core/rtc_adapter/BandwidthAllocator.cc',
         '<(source_rel_dir)/core/rtc_adapter/AudioSendAdapter.cc',
         '<(source_rel_dir)/core/rtc_adapter/thread/StaticTaskQueueFactory.cc',
         '<(source_rel_dir)/core/owt_base/SsrcGenerator.cc',
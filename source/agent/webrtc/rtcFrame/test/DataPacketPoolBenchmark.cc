@@ -0,0 +1,97 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Counts the heap allocations per RTP packet handed to the erizo transport.
+// "make_shared" is the previous std::make_shared<erizo::DataPacket> per
+// packet, "pool" takes the packets from a DataPacketPool. Packets of 1200
+// bytes are released in order once a number of later packets are in
+// flight, like packets waiting in the transport queue. The benchmark fails
+// if pooled packets still allocate once the pool is warm.
+//
+// Usage: dataPacketPoolBenchmark [packets] [packets in flight]
+
+#include <chrono>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "DataPacketPool.h"
+
+using namespace owt_base;
+using Clock = std::chrono::steady_clock;
+
+static uint64_t g_allocations = 0;
+
+void* operator new(size_t size)
+{
+    g_allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static const int kPacketSize = 1200;
+
+template <typename Factory>
+static void run(const char* name, int packets, int inFlight, Factory factory)
+{
+    static char data[kPacketSize] = { 0 };
+    // Replacing the oldest packet releases it
+    std::vector<std::shared_ptr<erizo::DataPacket>> queue(inFlight);
+    for (int i = 0; i < inFlight * 2; i++) {
+        queue[i % inFlight] = factory(data, kPacketSize);
+    }
+
+    uint64_t allocations = g_allocations;
+    auto start = Clock::now();
+    for (int i = 0; i < packets; i++) {
+        queue[i % inFlight] = factory(data, kPacketSize);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / packets;
+    double perPacket = static_cast<double>(g_allocations - allocations) / packets;
+    printf("%-12s %6.3f allocations per packet, %7.1f ns per packet\n", name, perPacket, ns);
+}
+
+int main(int argc, char* argv[])
+{
+    int packets = argc > 1 ? atoi(argv[1]) : 1000000;
+    int inFlight = argc > 2 ? atoi(argv[2]) : 64;
+    if (packets <= 0 || inFlight <= 0) {
+        fprintf(stderr, "Usage: %s [packets] [packets in flight]\n", argv[0]);
+        return 1;
+    }
+
+    run("make_shared", packets, inFlight, [](const char* data, int len) {
+        return std::make_shared<erizo::DataPacket>(0, data, len, erizo::VIDEO_PACKET);
+    });
+
+    DataPacketPool pool;
+    run("pool", packets, inFlight, [&pool](const char* data, int len) {
+        return pool.get(data, len, erizo::VIDEO_PACKET);
+    });
+
+    DataPacketPool::Stats stats = pool.getStats();
+    printf("pool: %llu packets, %llu blocks from the heap\n",
+        static_cast<unsigned long long>(stats.packets),
+        static_cast<unsigned long long>(stats.allocations));
+    if (stats.allocations > static_cast<uint64_t>(inFlight) + 1) {
+        printf("pooled packets allocate in steady state\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Compares one pacer per subscriber connection, the way every
+// RtpTransportControllerSend paces for itself, with one MultiFlowPacer for
+// all of them. Subscribers receive 2Mbps video at 30fps with a key frame
+// every 3s, paced at 2.5 times the media rate. Time is simulated in 1ms
+// steps; a pacer runs when it was woken up by a packet or when its
+// process delay is due, each run counts as a wakeup. The CPU time is the
+// time spent in process(), including the hand over of the batches; the
+// cost of the thread wakeups themselves is not simulated.
+//
+// Pacing accuracy is measured by the queue delay of packets and by the
+// peak bytes of a flow in 100ms windows relative to its pacing rate. The
+// benchmark fails if the shared pacer is less accurate than the per
+// connection pacers, beyond one process interval of delay.
+//
+// Usage: pacerBenchmark [subscribers] [seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "MultiFlowPacer.h"
+
+using namespace rtc_adapter;
+using Clock = std::chrono::steady_clock;
+
+struct Packet {
+    int flow;
+    int64_t enqueueMs;
+};
+typedef MultiFlowPacer<Packet> Pacer;
+
+static const uint32_t kMediaRateBps = 2000000;
+static const uint32_t kPacingRateBps = kMediaRateBps * 5 / 2;
+static const int kFrameRate = 30;
+static const int kKeyFrameInterval = 90;
+static const int kKeyFrameScale = 4;
+static const size_t kPacketSize = 1200;
+static const int64_t kWindowMs = 100;
+static const int64_t kMaxDelayMs = 3000;
+
+struct Result {
+    uint64_t wakeups = 0;
+    uint64_t packets = 0;
+    double cpuMs = 0;
+    std::vector<uint64_t> delays = std::vector<uint64_t>(kMaxDelayMs + 1);
+    double peakWindow = 0;
+
+    int64_t percentile(double p) const
+    {
+        uint64_t target = std::min<uint64_t>(packets * p, packets - 1);
+        uint64_t count = 0;
+        for (int64_t ms = 0; ms <= kMaxDelayMs; ms++) {
+            count += delays[ms];
+            if (count > target) {
+                return ms;
+            }
+        }
+        return kMaxDelayMs;
+    }
+};
+
+class Simulation {
+public:
+    Simulation(int flows, bool shared)
+        : m_nowMs(0)
+        , m_windowBytes(flows)
+        , m_windowStartMs(flows)
+        , m_nextFrameMs(flows)
+        , m_frameCount(flows)
+    {
+        for (int i = 0; i < flows; i++) {
+            if (!shared || m_pacers.empty()) {
+                m_pacers.emplace_back(new Pacer());
+                m_nextRunMs.push_back(-1);
+            }
+            Pacer* pacer = m_pacers.back().get();
+            m_flows.push_back(pacer->addFlow(
+                [this](std::vector<std::unique_ptr<Packet>>& batch) { onBatch(batch); }));
+            m_flows.back()->setPacingRate(kPacingRateBps);
+            m_flowPacer.push_back(m_pacers.size() - 1);
+            // Spread the frames of the subscribers over the frame interval
+            m_nextFrameMs[i] = (i * 7919) % (1000 / kFrameRate);
+            m_frameCount[i] = i % kKeyFrameInterval;
+        }
+    }
+
+    Result run(int64_t durationMs)
+    {
+        bool busy = true;
+        // No more frames after the duration, the queues are drained
+        for (m_nowMs = 0; m_nowMs < durationMs || busy; m_nowMs++) {
+            for (size_t i = 0; i < m_flows.size() && m_nowMs < durationMs; i++) {
+                if (m_nowMs >= static_cast<int64_t>(m_nextFrameMs[i])) {
+                    sendFrame(i);
+                    m_nextFrameMs[i] += 1000.0 / kFrameRate;
+                }
+            }
+            busy = false;
+            for (size_t p = 0; p < m_pacers.size(); p++) {
+                if (m_nextRunMs[p] >= 0 && m_nextRunMs[p] <= m_nowMs) {
+                    auto start = Clock::now();
+                    int64_t delayMs = m_pacers[p]->process(m_nowMs);
+                    m_result.cpuMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                    m_result.wakeups++;
+                    m_nextRunMs[p] = delayMs < 0 ? -1 : m_nowMs + delayMs;
+                }
+                busy = busy || m_nextRunMs[p] >= 0;
+            }
+        }
+        for (size_t i = 0; i < m_flows.size(); i++) {
+            closeWindow(i);
+        }
+        return m_result;
+    }
+
+private:
+    void sendFrame(size_t flow)
+    {
+        size_t frameSize = kMediaRateBps / 8 / kFrameRate;
+        if (m_frameCount[flow]++ % kKeyFrameInterval == 0) {
+            frameSize *= kKeyFrameScale;
+        }
+        size_t pacer = m_flowPacer[flow];
+        for (size_t offset = 0; offset < frameSize; offset += kPacketSize) {
+            std::unique_ptr<Packet> packet(new Packet{ static_cast<int>(flow), m_nowMs });
+            size_t size = std::min(kPacketSize, frameSize - offset);
+            if (m_pacers[pacer]->enqueue(m_flows[flow].get(), std::move(packet), size, false)) {
+                m_nextRunMs[pacer] = m_nowMs;
+            }
+        }
+    }
+
+    void onBatch(std::vector<std::unique_ptr<Packet>>& batch)
+    {
+        for (auto& packet : batch) {
+            int64_t delayMs = std::min(m_nowMs - packet->enqueueMs, kMaxDelayMs);
+            m_result.delays[delayMs]++;
+            m_result.packets++;
+
+            size_t flow = packet->flow;
+            if (m_nowMs - m_windowStartMs[flow] >= kWindowMs) {
+                closeWindow(flow);
+                m_windowStartMs[flow] = m_nowMs;
+            }
+            // Packets of the same frame are of the same size except the last
+            m_windowBytes[flow] += kPacketSize;
+        }
+    }
+
+    void closeWindow(size_t flow)
+    {
+        double windowBytes = static_cast<double>(kPacingRateBps) * kWindowMs / 8000;
+        m_result.peakWindow = std::max(m_result.peakWindow, m_windowBytes[flow] / windowBytes);
+        m_windowBytes[flow] = 0;
+    }
+
+    int64_t m_nowMs;
+    std::vector<std::unique_ptr<Pacer>> m_pacers;
+    std::vector<int64_t> m_nextRunMs;
+    std::vector<std::shared_ptr<Pacer::Flow>> m_flows;
+    std::vector<size_t> m_flowPacer;
+    std::vector<uint64_t> m_windowBytes;
+    std::vector<int64_t> m_windowStartMs;
+    std::vector<double> m_nextFrameMs;
+    std::vector<uint32_t> m_frameCount;
+    Result m_result;
+};
+
+static void report(const char* name, const Result& result, int flows, int seconds)
+{
+    double scale = 1000.0 / flows;
+    printf("%-10s %10.0f wakeups/s %8.2f ms CPU/s per 1000 subscribers, "
+           "delay p50 %lldms p99 %lldms max %lldms, peak window %.2f of rate\n",
+        name, result.wakeups * scale / seconds, result.cpuMs * scale / seconds,
+        static_cast<long long>(result.percentile(0.5)),
+        static_cast<long long>(result.percentile(0.99)),
+        static_cast<long long>(result.percentile(1)),
+        result.peakWindow);
+}
+
+int main(int argc, char* argv[])
+{
+    int flows = argc > 1 ? atoi(argv[1]) : 1000;
+    int seconds = argc > 2 ? atoi(argv[2]) : 10;
+    if (flows <= 0 || seconds <= 0) {
+        fprintf(stderr, "Usage: %s [subscribers] [seconds]\n", argv[0]);
+        return 1;
+    }
+    printf("%d subscribers, %u bps at %d fps, paced at %u bps, %d s\n",
+        flows, kMediaRateBps, kFrameRate, kPacingRateBps, seconds);
+
+    Result perFlow = Simulation(flows, false).run(seconds * 1000);
+    report("per-flow", perFlow, flows, seconds);
+    Result shared = Simulation(flows, true).run(seconds * 1000);
+    report("shared", shared, flows, seconds);
+
+    bool accurate = shared.packets == perFlow.packets
+        && shared.percentile(0.99) <= perFlow.percentile(0.99) + Pacer::kProcessIntervalMs
+        && shared.peakWindow <= perFlow.peakWindow * 1.05;
+    if (!accurate) {
+        printf("shared pacing is less accurate than per-flow pacing\n");
+        return 1;
+    }
+    return 0;
+}
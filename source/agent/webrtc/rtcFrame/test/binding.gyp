@@ -0,0 +1,37 @@
+{
+  'targets': [{
+    'target_name': 'pacerBenchmark',
+    'type': 'executable',
+    'sources': [
+      'PacerBenchmark.cc',
+    ],
+    'include_dirs': [
+        '../../../../core/rtc_adapter/',
+    ],
+    'libraries': [
+      '-lpthread',
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  },
+  {
+    'target_name': 'dataPacketPoolBenchmark',
+    'type': 'executable',
+    'sources': [
+      'DataPacketPoolBenchmark.cc',
+      '../../../../core/owt_base/DataPacketPool.cpp',
+    ],
+    'include_dirs': [
+        '../../rtcConn/erizo/src/erizo',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+    ],
+    'cflags!':    ['-fno-exceptions'],
+    'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++17'],
+    'cflags_cc!': ['-fno-exceptions'],
+  }]
+}
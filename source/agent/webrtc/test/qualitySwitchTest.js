@@ -0,0 +1,131 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+const assert = require('assert');
+const Module = require('module');
+
+// Stub the logger and the internalIO addon required by the router
+const nullLog = { debug: () => {}, info: () => {}, warn: () => {}, error: () => {} };
+const stubs = {
+  '../logger': { logger: { getLogger: () => nullLog } },
+  '../internalIO/build/Release/internalIO': {
+    InternalServer: class {
+      constructor() { this.sources = new Map(); }
+      getListeningPort() { return 0; }
+      addSource(id, source) { this.sources.set(id, source); }
+      removeSource(id) { this.sources.delete(id); }
+    },
+    InternalClient: class {},
+  },
+};
+const originalLoad = Module._load;
+Module._load = function (request, parent, isMain) {
+  if (stubs[request]) {
+    return stubs[request];
+  }
+  return originalLoad.call(this, request, parent, isMain);
+};
+global.config = global.config || {};
+
+const { InternalConnectionRouter } = require('../../internalConnectionRouter');
+const { QualitySwitches } = require('../qualitySwitch');
+
+// Fake addon objects, a closed object throws like a released native one
+class FakeNode {
+  constructor() {
+    this.closed = false;
+    this.dests = new Set();
+  }
+  source() {
+    return this;
+  }
+  receiver() {
+    return this;
+  }
+  addDestination(track, dest) {
+    assert(!this.closed, 'addDestination after close');
+    this.dests.add(dest);
+  }
+  removeDestination(track, dest) {
+    assert(!this.closed, 'removeDestination after close');
+    this.dests.delete(dest);
+  }
+  close() {
+    this.closed = true;
+  }
+}
+class FakeSwitch extends FakeNode {
+  constructor(...sources) {
+    super();
+    this.sources = sources;
+  }
+}
+
+const createRouter = function () {
+  const router = new InternalConnectionRouter({ protocol: 'tcp' });
+  return new Promise((resolve) => setImmediate(() => resolve(router)));
+};
+
+describe('Test QualitySwitches.', () => {
+  let router;
+  let switches;
+
+  beforeEach(async () => {
+    router = await createRouter();
+    switches = new QualitySwitches(router, {
+      VideoSwitch: FakeSwitch,
+      MediaFrameMulticaster: FakeNode,
+    });
+    await router.addLocalSource('stream1', 'webrtc', new FakeNode());
+  });
+
+  it('Close a switch with a linked subscriber.', async () => {
+    await switches.create('switch1', [{ id: 'stream1' }]);
+    const vswitch = switches.switches.get('switch1');
+    const subscriber = new FakeNode();
+    await router.addLocalDestination('sub1', 'webrtc', subscriber);
+    await router.linkup('sub1', { video: { id: 'switch1' } });
+    assert(vswitch.dests.has(subscriber));
+
+    switches.close('switch1');
+    assert(vswitch.closed);
+    assert(!vswitch.dests.has(subscriber));
+    assert(!router.hasConnection('switch1'));
+    assert(!router.internalServer.sources.has('switch1'));
+    assert(!router.hasConnection('switch-stream1'));
+    assert.strictEqual(switches.dispatchers.size, 0);
+    // Subscriber is left in router without source
+    assert(router.hasConnection('sub1'));
+    assert.strictEqual(router.connections.getConnection('sub1').videoFrom, undefined);
+  });
+
+  it('Keep the shared dispatcher until the last switch closes.', async () => {
+    await switches.create('switch1', [{ id: 'stream1' }]);
+    await switches.create('switch2', [{ id: 'stream1' }]);
+    const shared = switches.dispatchers.get('switch-stream1');
+    assert.strictEqual(shared.refs, 2);
+
+    switches.close('switch1');
+    assert(!shared.dispatcher.closed);
+    assert(router.hasConnection('switch-stream1'));
+    assert(router.hasConnection('switch2'));
+
+    switches.close('switch2');
+    assert(shared.dispatcher.closed);
+    assert(!router.hasConnection('switch-stream1'));
+    assert.strictEqual(switches.dispatchers.size, 0);
+  });
+
+  it('Clear switches before the router.', async () => {
+    await switches.create('switch1', [{ id: 'stream1' }]);
+    await router.addLocalDestination('sub1', 'webrtc', new FakeNode());
+    await router.linkup('sub1', { video: { id: 'switch1' } });
+
+    switches.clear();
+    router.clear();
+    assert.strictEqual(switches.switches.size, 0);
+    assert.strictEqual(router.connections.getIds().length, 0);
+  });
+});
@@ -12,8 +12,13 @@ const {
   VideoFrameConstructor,
   VideoFramePacketizer,
   CallBase,
+  streamStatsRegistry,
 } = require('../rtcFrame/build/Release/rtcFrame.node');
 
+// { buffer: SharedArrayBuffer, capacity, fields: { name: index } }
+const statsRegistry = streamStatsRegistry();
+const statsValues = new Uint32Array(statsRegistry.buffer);
+
 const logger = require('../logger').logger;
 // Logger
 const log = logger.getLogger('WrtcConnection');
@@ -80,8 +85,9 @@ class WrtcStream extends EventEmitter {
    * audio: { format, ssrc, mid, midExtId }
    * video: {
    *   format, ssrcs, mid, midExtId,
-   *   transportcc, red, ulpfec, scalabilityMode
+   *   transportcc, red, ulpfec, scalabilityMode, frameAssembler, bandwidth
    * }
+   * bandwidth: { priority, minBitrate, maxBitrate } in kbps
    */
   constructor(id, wrtc, direction, {audio, video, owner, enableBWE}) {
     super();
@@ -115,6 +121,14 @@ class WrtcStream extends EventEmitter {
       if (video) {
         this.videoFrameConstructor = new VideoFrameConstructor(
           this._onMediaUpdate.bind(this), video.transportcc, wrtc.callBase);
+        if (video.frameAssembler) {
+          // Forward-only publication, skip the full receive stream
+          this.videoFrameConstructor.setFrameAssembler(true);
+        }
+        if (global.config.webrtc.keyframe_min_interval >= 0) {
+          this.videoFrameConstructor.setKeyFrameMinInterval(
+            global.config.webrtc.keyframe_min_interval);
+        }
         this.videoFrameConstructor.bindTransport(wrtc.getMediaStream(id));
         wrtc.setVideoSsrcList(id, video.ssrcs);
       }
@@ -130,9 +144,13 @@ class WrtcStream extends EventEmitter {
         }
       }
       if (video) {
+        const bandwidth = video.bandwidth || {};
         this.videoFramePacketizer = new VideoFramePacketizer(
           video.red, video.ulpfec, video.transportcc, video.mid,
-          video.midExtId, false, wrtc.callBase, enableBWE);
+          video.midExtId, false, wrtc.callBase, enableBWE,
+          bandwidth.priority || 1,
+          (bandwidth.minBitrate || 0) * 1000,
+          (bandwidth.maxBitrate || 0) * 1000);
         this.videoFramePacketizer.bindTransport(wrtc.getMediaStream(id));
       }
     }
@@ -181,10 +199,26 @@ class WrtcStream extends EventEmitter {
     }
   }
 
-  _onMediaUpdate(jsonUpdate) {
-    this.emit('media-update', jsonUpdate);
+  // Native values are passed in, the registry slot is preferred when there is one
+  _onMediaUpdate(width, height) {
+    const slot = this.videoFrameConstructor
+      ? this.videoFrameConstructor.statsSlot()
+      : -1;
+    const stat = (field, value) => (slot < 0) ? value :
+      statsValues[statsRegistry.fields[field] * statsRegistry.capacity + slot];
+    this.emit('media-update', {
+      video: {
+        parameters: {
+          resolution: {
+            width: stat('width', width),
+            height: stat('height', height),
+          },
+        },
+      },
+    });
   }
 
+
   addDestination(track, dest) {
     if (track === 'audio' && this.audioFrameConstructor) {
       this.audioFrameConstructor.addDestination(dest);
@@ -361,10 +395,12 @@ module.exports = function (spec, on_status, on_track) {
   var bweTimer = null;
   var bweInterval = 3000;
 
-  // option = {mid, type, formatPreference, scalabilityMode}
+  // option = {mid, type, formatPreference, scalabilityMode, frameAssembler,
+  //   bandwidth}
   that.addTrackOperation = function (operationId, sdpDirection, option) {
     var ret = false;
-    var {mid, type, formatPreference, scalabilityMode} = option;
+    var {mid, type, formatPreference, scalabilityMode, frameAssembler,
+      bandwidth} = option;
     if (!operationMap.has(mid)) {
       log.debug(`MID ${mid} for operation ${operationId} add`);
       const enabled = true;
@@ -372,6 +408,12 @@ module.exports = function (spec, on_status, on_track) {
       if (scalabilityMode) {
         operationMap.get(mid).scalabilityMode = scalabilityMode;
       }
+      if (frameAssembler) {
+        operationMap.get(mid).frameAssembler = true;
+      }
+      if (bandwidth) {
+        operationMap.get(mid).bandwidth = bandwidth;
+      }
       ret = true;
     } else {
       log.warn(`MID ${mid} has mapped operation ${operationMap.get(mid).operationId}`);
@@ -459,6 +501,13 @@ module.exports = function (spec, on_status, on_track) {
 
     trackSettings.owner = owner;
     trackSettings.enableBWE = that.enableBWE;
+    if (mediaType === 'video' && trackSettings.video &&
+        opSettings.frameAssembler) {
+      trackSettings.video.frameAssembler = true;
+    }
+    if (mediaType === 'video' && trackSettings.video && opSettings.bandwidth) {
+      trackSettings.video.bandwidth = opSettings.bandwidth;
+    }
     if (opSettings.finalFormat) {
       trackSettings[mediaType].format = opSettings.finalFormat;
       if (opSettings.finalFormat.codec === 'vp9' && simSsrcs) {
@@ -0,0 +1,401 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AsyncLogger_h
+#define AsyncLogger_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <log4cxx/logger.h>
+
+namespace elog {
+
+enum Level {
+    LEVEL_TRACE = 0,
+    LEVEL_DEBUG,
+    LEVEL_INFO,
+    LEVEL_WARN,
+    LEVEL_ERROR,
+    LEVEL_FATAL
+};
+
+// Formats |fmt| into |inlineBuffer|, or into |heapBuffer| if it does not fit.
+inline const char* formatMessage(char* inlineBuffer, size_t size, std::string& heapBuffer,
+                                 const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+inline const char* formatMessage(char* inlineBuffer, size_t size, std::string& heapBuffer,
+                                 const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int length = vsnprintf(inlineBuffer, size, fmt, args);
+    va_end(args);
+    if (length < 0 || static_cast<size_t>(length) < size) {
+        return inlineBuffer;
+    }
+    heapBuffer.resize(length + 1);
+    va_start(args, fmt);
+    vsnprintf(&heapBuffer[0], length + 1, fmt, args);
+    va_end(args);
+    heapBuffer.resize(length);
+    return heapBuffer.c_str();
+}
+
+inline void logMessage(const log4cxx::LoggerPtr& logger, int level, const char* message)
+{
+    switch (level) {
+    case LEVEL_TRACE:
+#ifdef LOG4CXX_TRACE
+        LOG4CXX_TRACE(logger, message);
+        break;
+#endif
+    case LEVEL_DEBUG:
+        LOG4CXX_DEBUG(logger, message);
+        break;
+    case LEVEL_INFO:
+        LOG4CXX_INFO(logger, message);
+        break;
+    case LEVEL_WARN:
+        LOG4CXX_WARN(logger, message);
+        break;
+    case LEVEL_ERROR:
+        LOG4CXX_ERROR(logger, message);
+        break;
+    default:
+        LOG4CXX_FATAL(logger, message);
+        break;
+    }
+}
+
+// Never called, lets the compiler check the format of async log calls
+inline void checkFormat(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void checkFormat(const char*, ...) {}
+
+/**
+ * Allows one message per |intervalMs| for a log call site and counts the
+ * ones suppressed in between.
+ */
+class RateLimiter {
+public:
+    RateLimiter()
+        : m_lastMs(INT64_MIN)
+        , m_suppressed(0)
+    {
+    }
+
+    bool allow(int64_t intervalMs, uint32_t& suppressed)
+    {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = m_lastMs.load(std::memory_order_relaxed);
+        if ((last != INT64_MIN && now - last < intervalMs)
+            || !m_lastMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::atomic<int64_t> m_lastMs;
+    std::atomic<uint32_t> m_suppressed;
+};
+
+/**
+ * Logger that formats on a background thread. Each posting thread owns a
+ * single-producer ring of fixed-size records, so a call takes no lock and
+ * does not allocate: it copies the format pointer and its arguments into
+ * the next free record. C strings are copied by value into the record and
+ * truncated when the record is full, other arguments must be trivially
+ * copyable. |fmt| must outlive the call, which string literals do. When
+ * the ring of a thread is full, new records are dropped and counted.
+ */
+class AsyncLogger {
+public:
+    static const size_t kRingRecords = 512;
+    static const size_t kArgBytes = 224;
+    static const int kFlushIntervalMs = 10;
+
+    static AsyncLogger& instance()
+    {
+        static AsyncLogger logger;
+        return logger;
+    }
+
+    // |logger| must outlive the process, as the DEFINE_LOGGER statics do
+    template <typename... Args>
+    void post(const log4cxx::LoggerPtr& logger, int level, const char* fmt, const Args&... args)
+    {
+        Ring& ring = localRing();
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) >= kRingRecords) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Record& record = ring.records[head % kRingRecords];
+        record.logger = &logger;
+        record.level = level;
+        record.fmt = fmt;
+        record.write = &AsyncLogger::writeRecord<typename std::decay<Args>::type...>;
+        ArgCursor cursor { record.args, 0, fixedSize<typename std::decay<Args>::type...>() };
+        int order[] = { 0, (Arg<typename std::decay<Args>::type>::store(cursor, args), 0)... };
+        (void)order;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    ~AsyncLogger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_cond.notify_one();
+        m_thread.join();
+    }
+
+private:
+    struct Record {
+        const log4cxx::LoggerPtr* logger;
+        int level;
+        const char* fmt;
+        void (*write)(const Record& record, char* buffer, size_t size, std::string& heapBuffer);
+        char args[kArgBytes];
+    };
+
+    struct Ring {
+        Ring()
+            : head(0)
+            , tail(0)
+            , dropped(0)
+            , inUse(true)
+        {
+        }
+
+        Record records[kRingRecords];
+        std::atomic<uint32_t> head;
+        std::atomic<uint32_t> tail;
+        std::atomic<uint64_t> dropped;
+        std::atomic<bool> inUse;
+    };
+
+    // Returns the ring to the logger when its thread exits
+    struct RingHolder {
+        Ring* ring = nullptr;
+        ~RingHolder()
+        {
+            if (ring) {
+                ring->inUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    // Fixed-size arguments are kept in order from the start of the record,
+    // strings follow them
+    struct ArgCursor {
+        char* data;
+        size_t fixed;
+        size_t strings;
+    };
+    struct ArgReader {
+        const char* data;
+        size_t fixed;
+        size_t strings;
+    };
+
+    template <typename T, typename Enable = void>
+    struct Arg {
+        static_assert(std::is_trivially_copyable<T>::value, "Async log arguments must be trivially copyable");
+        typedef T type;
+        static const size_t kFixedSize = sizeof(T);
+
+        static void store(ArgCursor& cursor, const T& value)
+        {
+            memcpy(cursor.data + cursor.fixed, &value, sizeof(T));
+            cursor.fixed += sizeof(T);
+        }
+        static T load(ArgReader& reader)
+        {
+            T value;
+            memcpy(&value, reader.data + reader.fixed, sizeof(T));
+            reader.fixed += sizeof(T);
+            return value;
+        }
+    };
+    template <typename T>
+    struct Arg<T, typename std::enable_if<std::is_convertible<T, const char*>::value>::type> {
+        typedef const char* type;
+        static const size_t kFixedSize = 0;
+
+        static void store(ArgCursor& cursor, const char* value)
+        {
+            if (cursor.strings >= kArgBytes) {
+                return;
+            }
+            const char* string = value ? value : "(null)";
+            size_t length = strnlen(string, kArgBytes - cursor.strings - 1);
+            memcpy(cursor.data + cursor.strings, string, length);
+            cursor.data[cursor.strings + length] = '\0';
+            cursor.strings += length + 1;
+        }
+        static const char* load(ArgReader& reader)
+        {
+            if (reader.strings >= kArgBytes) {
+                return "";
+            }
+            const char* string = reader.data + reader.strings;
+            reader.strings += strlen(string) + 1;
+            return string;
+        }
+    };
+
+    template <typename... Args>
+    static constexpr size_t fixedSize()
+    {
+        size_t size = 0;
+        size_t sizes[] = { 0, Arg<Args>::kFixedSize... };
+        for (size_t s : sizes) {
+            size += s;
+        }
+        return size;
+    }
+
+    template <size_t... I>
+    struct IndexSequence {
+    };
+    template <size_t N, size_t... I>
+    struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {
+    };
+    template <size_t... I>
+    struct MakeIndexSequence<0, I...> {
+        typedef IndexSequence<I...> type;
+    };
+
+    template <typename... Args>
+    static void writeRecord(const Record& record, char* buffer, size_t size, std::string& heapBuffer)
+    {
+        static_assert(fixedSize<Args...>() <= kArgBytes, "Too many async log arguments");
+        ArgReader reader { record.args, 0, fixedSize<Args...>() };
+        // Braced initialization loads the arguments in order
+        std::tuple<typename Arg<Args>::type...> values { Arg<Args>::load(reader)... };
+        format(record, buffer, size, heapBuffer, values, typename MakeIndexSequence<sizeof...(Args)>::type());
+    }
+
+    template <typename Tuple, size_t... I>
+    static void format(const Record& record, char* buffer, size_t size, std::string& heapBuffer,
+                       const Tuple& values, IndexSequence<I...>)
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+        int length = snprintf(buffer, size, record.fmt, std::get<I>(values)...);
+        const char* message = buffer;
+        if (length >= 0 && static_cast<size_t>(length) >= size) {
+            heapBuffer.resize(length + 1);
+            snprintf(&heapBuffer[0], length + 1, record.fmt, std::get<I>(values)...);
+            message = heapBuffer.c_str();
+        }
+#pragma GCC diagnostic pop
+        logMessage(*record.logger, record.level, message);
+    }
+
+    AsyncLogger()
+        : m_running(true)
+    {
+        m_thread = std::thread(&AsyncLogger::run, this);
+    }
+
+    // Allocates once per posting thread, rings of exited threads are reused
+    Ring& localRing()
+    {
+        static thread_local RingHolder holder;
+        if (!holder.ring) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& ring : m_rings) {
+                bool inUse = false;
+                if (ring->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+                    holder.ring = ring.get();
+                    break;
+                }
+            }
+            if (!holder.ring) {
+                m_rings.emplace_back(new Ring());
+                holder.ring = m_rings.back().get();
+            }
+        }
+        return *holder.ring;
+    }
+
+    // Returns the number of records written
+    size_t drain(Ring& ring, char* buffer, size_t size, std::string& heapBuffer)
+    {
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        for (; tail != head; tail++) {
+            const Record& record = ring.records[tail % kRingRecords];
+            record.write(record, buffer, size, heapBuffer);
+            ring.tail.store(tail + 1, std::memory_order_release);
+        }
+        uint64_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped) {
+            snprintf(buffer, size, "AsyncLogger dropped %llu records",
+                static_cast<unsigned long long>(dropped));
+            logMessage(log4cxx::Logger::getRootLogger(), LEVEL_WARN, buffer);
+        }
+        return count;
+    }
+
+    void run()
+    {
+        char buffer[1024];
+        std::string heapBuffer;
+        std::vector<Ring*> rings;
+        bool running = true;
+        size_t written = 1;
+        // Leaves after a final pass that finds nothing pending
+        while (running || written) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_running && !written) {
+                    m_cond.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+                }
+                running = m_running;
+                rings.clear();
+                for (auto& ring : m_rings) {
+                    rings.push_back(ring.get());
+                }
+            }
+            written = 0;
+            for (Ring* ring : rings) {
+                written += drain(*ring, buffer, sizeof(buffer), heapBuffer);
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    // Never released before the logger, the writer thread reads them
+    // without holding the lock
+    std::vector<std::unique_ptr<Ring>> m_rings;
+    bool m_running;
+    std::thread m_thread;
+};
+
+} /* namespace elog */
+
+#endif /* AsyncLogger_h */
@@ -16,6 +16,12 @@ public:
     // which would be handled before other normal notifications (LIFO).
     // Do not abuse it.
     virtual bool notifyAsyncEventInEmergency(const std::string& event, const std::string& data) = 0;
+    // For frequent state updates like stats: a pending notification of the same event is replaced,
+    // only the latest data is handled.
+    virtual bool notifyAsyncEventCoalesced(const std::string& event, const std::string& data)
+    {
+        return notifyAsyncEvent(event, data);
+    }
 };
 
 #endif // EventRegistry_h
@@ -40,56 +40,95 @@
  #define DEFINE_TEMPLATE_LOGGER(templateArg, namespace, logName) \
  templateArg log4cxx::LoggerPtr namespace::logger = log4cxx::Logger::getLogger( logName );
 
-#define ELOG_MAX_BUFFER_SIZE 30000
+#include "AsyncLogger.h"
+
+#define ELOG_LEVEL_TRACE 0
+#define ELOG_LEVEL_DEBUG 1
+#define ELOG_LEVEL_INFO 2
+#define ELOG_LEVEL_WARN 3
+#define ELOG_LEVEL_ERROR 4
+#define ELOG_LEVEL_FATAL 5
+
+// Log calls below this level compile to nothing, e.g. -DELOG_MIN_LEVEL=ELOG_LEVEL_INFO
+#ifndef ELOG_MIN_LEVEL
+#define ELOG_MIN_LEVEL ELOG_LEVEL_TRACE
+#endif
+
+// Messages longer than this are formatted on the heap
+#define ELOG_INLINE_BUFFER_SIZE 512
 
 #define SPRINTF_ELOG_MSG(buffer, fmt, args...) \
-    char buffer[ELOG_MAX_BUFFER_SIZE]; \
-    snprintf( buffer, ELOG_MAX_BUFFER_SIZE, fmt, ##args );
+    char buffer##_inline[ELOG_INLINE_BUFFER_SIZE]; \
+    std::string buffer##_heap; \
+    const char* buffer = elog::formatMessage(buffer##_inline, ELOG_INLINE_BUFFER_SIZE, buffer##_heap, fmt, ##args);
 
 // older versions of log4cxx don't support tracing
 #ifdef LOG4CXX_TRACE
-#define ELOG_TRACE2(logger, fmt, args...) \
-    if (logger->isTraceEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_TRACE( logger, __tmp ); \
-    }
+#define ELOG_ENABLED_TRACE(logger) logger->isTraceEnabled()
+#define ELOG_LOG4CXX_TRACE(logger, msg) LOG4CXX_TRACE(logger, msg)
 #else
-#define ELOG_TRACE2(logger, fmt, args...) \
-    if (logger->isDebugEnabled()) { \
+#define ELOG_ENABLED_TRACE(logger) logger->isDebugEnabled()
+#define ELOG_LOG4CXX_TRACE(logger, msg) LOG4CXX_DEBUG(logger, msg)
+#endif
+#define ELOG_ENABLED_DEBUG(logger) logger->isDebugEnabled()
+#define ELOG_LOG4CXX_DEBUG(logger, msg) LOG4CXX_DEBUG(logger, msg)
+#define ELOG_ENABLED_INFO(logger) logger->isInfoEnabled()
+#define ELOG_LOG4CXX_INFO(logger, msg) LOG4CXX_INFO(logger, msg)
+#define ELOG_ENABLED_WARN(logger) logger->isWarnEnabled()
+#define ELOG_LOG4CXX_WARN(logger, msg) LOG4CXX_WARN(logger, msg)
+#define ELOG_ENABLED_ERROR(logger) logger->isErrorEnabled()
+#define ELOG_LOG4CXX_ERROR(logger, msg) LOG4CXX_ERROR(logger, msg)
+#define ELOG_ENABLED_FATAL(logger) logger->isFatalEnabled()
+#define ELOG_LOG4CXX_FATAL(logger, msg) LOG4CXX_FATAL(logger, msg)
+
+#define ELOG_IS_ENABLED2(level, logger) \
+    (ELOG_LEVEL_##level >= ELOG_MIN_LEVEL && ELOG_ENABLED_##level(logger))
+
+#define ELOG_LOG2(level, logger, fmt, args...) \
+    if (ELOG_IS_ENABLED2(level, logger)) { \
         SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_DEBUG( logger, __tmp ); \
+        ELOG_LOG4CXX_##level( logger, __tmp ); \
     }
-#endif
 
-#define ELOG_DEBUG2(logger, fmt, args...) \
-    if (logger->isDebugEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_DEBUG( logger, __tmp ); \
+// Logs at most once per |intervalMs| from a call site, with the number of
+// messages suppressed since the last one.
+#define ELOG_RATE_LIMITED2(level, logger, intervalMs, fmt, args...) \
+    if (ELOG_IS_ENABLED2(level, logger)) { \
+        static elog::RateLimiter __limiter; \
+        uint32_t __suppressed = 0; \
+        if (__limiter.allow(intervalMs, __suppressed)) { \
+            SPRINTF_ELOG_MSG( __tmp, fmt " (suppressed %u)", ##args, __suppressed ); \
+            ELOG_LOG4CXX_##level( logger, __tmp ); \
+        } \
     }
 
-#define ELOG_INFO2(logger, fmt, args...) \
-    if (logger->isInfoEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_INFO( logger, __tmp ); \
+// Copies the arguments and leaves formatting to the AsyncLogger thread,
+// |fmt| must be a string literal.
+#define ELOG_ASYNC2(level, logger, fmt, args...) \
+    if (ELOG_IS_ENABLED2(level, logger)) { \
+        if (false) { \
+            elog::checkFormat(fmt, ##args); \
+        } \
+        elog::AsyncLogger::instance().post(logger, elog::LEVEL_##level, fmt, ##args); \
     }
 
+#define ELOG_TRACE2(logger, fmt, args...) \
+    ELOG_LOG2(TRACE, logger, fmt, ##args)
+
+#define ELOG_DEBUG2(logger, fmt, args...) \
+    ELOG_LOG2(DEBUG, logger, fmt, ##args)
+
+#define ELOG_INFO2(logger, fmt, args...) \
+    ELOG_LOG2(INFO, logger, fmt, ##args)
+
 #define ELOG_WARN2(logger, fmt, args...) \
-    if (logger->isWarnEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_WARN( logger, __tmp ); \
-    }
+    ELOG_LOG2(WARN, logger, fmt, ##args)
 
 #define ELOG_ERROR2(logger, fmt, args...) \
-    if (logger->isErrorEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_ERROR( logger, __tmp ); \
-    }
+    ELOG_LOG2(ERROR, logger, fmt, ##args)
 
 #define ELOG_FATAL2(logger, fmt, args...) \
-    if (logger->isFatalEnabled()) { \
-        SPRINTF_ELOG_MSG( __tmp, fmt, ##args ); \
-        LOG4CXX_FATAL( logger, __tmp ); \
-    }
+    ELOG_LOG2(FATAL, logger, fmt, ##args)
 
 
 #define ELOG_TRACE(fmt, args...) \
@@ -129,27 +168,54 @@
 #define ELOG_FATAL_T(fmt, args...) \
     ELOG_FATAL2( logger, "(%p)" fmt, this, ##args );
 
-#ifdef LOG4CXX_TRACE
-#define ELOG_IS_TRACE_ENABLED() \
-    logger->isTraceEnabled()
-#else
+//rate limited
+#define ELOG_TRACE_RATE_LIMITED(intervalMs, fmt, args...) \
+    ELOG_RATE_LIMITED2( TRACE, logger, intervalMs, fmt, ##args );
+
+#define ELOG_DEBUG_RATE_LIMITED(intervalMs, fmt, args...) \
+    ELOG_RATE_LIMITED2( DEBUG, logger, intervalMs, fmt, ##args );
+
+#define ELOG_INFO_RATE_LIMITED(intervalMs, fmt, args...) \
+    ELOG_RATE_LIMITED2( INFO, logger, intervalMs, fmt, ##args );
+
+#define ELOG_WARN_RATE_LIMITED(intervalMs, fmt, args...) \
+    ELOG_RATE_LIMITED2( WARN, logger, intervalMs, fmt, ##args );
+
+#define ELOG_ERROR_RATE_LIMITED(intervalMs, fmt, args...) \
+    ELOG_RATE_LIMITED2( ERROR, logger, intervalMs, fmt, ##args );
+
+//async
+#define ELOG_TRACE_ASYNC(fmt, args...) \
+    ELOG_ASYNC2( TRACE, logger, fmt, ##args );
+
+#define ELOG_DEBUG_ASYNC(fmt, args...) \
+    ELOG_ASYNC2( DEBUG, logger, fmt, ##args );
+
+#define ELOG_INFO_ASYNC(fmt, args...) \
+    ELOG_ASYNC2( INFO, logger, fmt, ##args );
+
+#define ELOG_TRACE_ASYNC_T(fmt, args...) \
+    ELOG_ASYNC2( TRACE, logger, "(%p)" fmt, this, ##args );
+
+#define ELOG_DEBUG_ASYNC_T(fmt, args...) \
+    ELOG_ASYNC2( DEBUG, logger, "(%p)" fmt, this, ##args );
+
 #define ELOG_IS_TRACE_ENABLED() \
-    logger->isDebugEnabled()
-#endif
+    ELOG_IS_ENABLED2(TRACE, logger)
 
 #define ELOG_IS_DEBUG_ENABLED() \
-    logger->isDebugEnabled()
+    ELOG_IS_ENABLED2(DEBUG, logger)
 
 #define ELOG_IS_INFO_ENABLED() \
-    logger->isInfoEnabled()
+    ELOG_IS_ENABLED2(INFO, logger)
 
 #define ELOG_IS_WARN_ENABLED() \
-    logger->isWarnEnabled()
+    ELOG_IS_ENABLED2(WARN, logger)
 
 #define ELOG_IS_ERROR_ENABLED() \
-    logger->isErrorEnabled()
+    ELOG_IS_ENABLED2(ERROR, logger)
 
 #define ELOG_IS_FATAL_ENABLED() \
-    logger->isFatalEnabled()
+    ELOG_IS_ENABLED2(FATAL, logger)
 
 #endif  /* __ELOG_H__ */
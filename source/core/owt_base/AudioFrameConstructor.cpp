@@ -130,9 +130,10 @@ int AudioFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
     if (audioLevel) {
         frame.additionalInfo.audio.audioLevel = audioLevel->getLevel();
         frame.additionalInfo.audio.voice = audioLevel->getVoice();
-        ELOG_DEBUG("Has audio level extension %u, %d", audioLevel->getLevel(), audioLevel->getVoice());
+        frame.additionalInfo.audio.hasAudioLevel = 1;
+        ELOG_DEBUG_RATE_LIMITED(1000, "Has audio level extension %u, %d", audioLevel->getLevel(), audioLevel->getVoice());
     } else {
-        ELOG_DEBUG("No audio level extension");
+        ELOG_DEBUG_RATE_LIMITED(1000, "No audio level extension");
     }
 
     deliverFrame(frame);
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "AudioFramePacketizer.h"
+#include "DataPacketPool.h"
 #include "AudioUtilitiesNew.h"
 
 using namespace rtc_adapter;
@@ -76,7 +77,7 @@ void AudioFramePacketizer::receiveRtpData(char* buf, int len, erizoExtra::DataTy
     }
 
     assert(type == erizoExtra::AUDIO);
-    audio_sink_->deliverAudioData(std::make_shared<erizo::DataPacket>(0, buf, len, erizo::AUDIO_PACKET));
+    audio_sink_->deliverAudioData(DataPacketPool::GetInstance().get(buf, len, erizo::AUDIO_PACKET));
 }
 
 void AudioFramePacketizer::onFrame(const Frame& frame)
@@ -147,9 +148,12 @@ void AudioFramePacketizer::onAdapterStats(const AdapterStats& stats) {}
 
 void AudioFramePacketizer::onAdapterData(char* data, int len)
 {
+    // Copied out of the adapter before taking the transport lock
+    std::shared_ptr<erizo::DataPacket> packet =
+        DataPacketPool::GetInstance().get(data, len, erizo::AUDIO_PACKET);
     boost::shared_lock<boost::shared_mutex> lock(m_transport_mutex);
     if (audio_sink_) {
-        audio_sink_->deliverAudioData(std::make_shared<erizo::DataPacket>(0, data, len, erizo::AUDIO_PACKET));
+        audio_sink_->deliverAudioData(std::move(packet));
     }
 }
 
@@ -0,0 +1,84 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DataPacketPool.h"
+
+namespace owt_base {
+
+const size_t DataPacketPool::kDefaultMaxFreeBlocks;
+
+DataPacketPool& DataPacketPool::GetInstance()
+{
+    static DataPacketPool pool;
+    return pool;
+}
+
+DataPacketPool::DataPacketPool(size_t maxFreeBlocks)
+    : m_arena(std::make_shared<Arena>(maxFreeBlocks))
+{
+}
+
+std::shared_ptr<erizo::DataPacket> DataPacketPool::get(const char* data, int len, erizo::packetType type)
+{
+    return std::allocate_shared<erizo::DataPacket>(
+        Allocator<erizo::DataPacket>(m_arena), 0, data, len, type);
+}
+
+DataPacketPool::Stats DataPacketPool::getStats()
+{
+    return m_arena->getStats();
+}
+
+DataPacketPool::Arena::Arena(size_t maxFreeBlocks)
+    : m_maxFreeBlocks(maxFreeBlocks)
+    , m_blockSize(0)
+{
+    m_freeBlocks.reserve(m_maxFreeBlocks);
+}
+
+DataPacketPool::Arena::~Arena()
+{
+    for (void* block : m_freeBlocks) {
+        ::operator delete(block);
+    }
+}
+
+void* DataPacketPool::Arena::allocate(size_t size)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        // One block per packet
+        m_stats.packets++;
+        if (!m_blockSize) {
+            m_blockSize = size;
+        }
+        if (size == m_blockSize && !m_freeBlocks.empty()) {
+            void* block = m_freeBlocks.back();
+            m_freeBlocks.pop_back();
+            return block;
+        }
+        m_stats.allocations++;
+    }
+    return ::operator new(size);
+}
+
+void DataPacketPool::Arena::deallocate(void* block, size_t size)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (size == m_blockSize && m_freeBlocks.size() < m_maxFreeBlocks) {
+            m_freeBlocks.push_back(block);
+            return;
+        }
+    }
+    ::operator delete(block);
+}
+
+DataPacketPool::Stats DataPacketPool::Arena::getStats()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_stats;
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,99 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DataPacketPool_h
+#define DataPacketPool_h
+
+#include <boost/thread/mutex.hpp>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include <MediaDefinitions.h>
+
+namespace owt_base {
+
+/**
+ * Recycles the memory of erizo::DataPackets sent to the transport. A packet
+ * and its shared_ptr control block are one block of the pool, returned to
+ * the pool when the last reference is dropped, so packets in steady state
+ * cost no heap allocation. Packets are plain erizo::DataPackets and go
+ * through the erizo pipeline like any other. Blocks outlive the pool while
+ * packets are in flight.
+ */
+class DataPacketPool {
+public:
+    static const size_t kDefaultMaxFreeBlocks = 4096;
+
+    struct Stats {
+        uint64_t packets = 0;
+        // Blocks taken from the heap, not from the pool
+        uint64_t allocations = 0;
+    };
+
+    // Shared by all the packetizers of the process
+    static DataPacketPool& GetInstance();
+
+    explicit DataPacketPool(size_t maxFreeBlocks = kDefaultMaxFreeBlocks);
+
+    // Copies the data into a pooled packet
+    std::shared_ptr<erizo::DataPacket> get(const char* data, int len, erizo::packetType type);
+
+    Stats getStats();
+
+private:
+    class Arena {
+    public:
+        explicit Arena(size_t maxFreeBlocks);
+        ~Arena();
+
+        void* allocate(size_t size);
+        void deallocate(void* block, size_t size);
+        Stats getStats();
+
+    private:
+        const size_t m_maxFreeBlocks;
+        boost::mutex m_mutex;
+        // Blocks of the first size asked for, others are not pooled
+        size_t m_blockSize;
+        std::vector<void*> m_freeBlocks;
+        Stats m_stats;
+    };
+
+    template <typename T>
+    class Allocator {
+    public:
+        typedef T value_type;
+
+        explicit Allocator(const std::shared_ptr<Arena>& arena)
+            : m_arena(arena)
+        {
+        }
+        template <typename U>
+        Allocator(const Allocator<U>& other)
+            : m_arena(other.m_arena)
+        {
+        }
+
+        T* allocate(size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T))); }
+        void deallocate(T* p, size_t n) { m_arena->deallocate(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const { return m_arena == other.m_arena; }
+        template <typename U>
+        bool operator!=(const Allocator<U>& other) const { return m_arena != other.m_arena; }
+
+    private:
+        template <typename U>
+        friend class Allocator;
+
+        std::shared_ptr<Arena> m_arena;
+    };
+
+    std::shared_ptr<Arena> m_arena;
+};
+
+} /* namespace owt_base */
+
+#endif /* DataPacketPool_h */
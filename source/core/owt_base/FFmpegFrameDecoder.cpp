@@ -4,8 +4,16 @@
 
 #include "FFmpegFrameDecoder.h"
 
+#include <chrono>
+
 namespace owt_base {
 
+static inline int64_t currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 DEFINE_LOGGER(FFmpegFrameDecoder, "owt.FFmpegFrameDecoder");
 
 int FFmpegFrameDecoder::AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags)
@@ -16,7 +24,11 @@ int FFmpegFrameDecoder::AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags
 
     avcodec_align_dimensions(s, &width, &height);
 
-    rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer = FFmpegDecoder->m_bufferManager->getFreeBuffer(width, height);
+    rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer;
+    {
+        boost::mutex::scoped_lock lock(FFmpegDecoder->m_bufferMutex);
+        frame_buffer = FFmpegDecoder->m_bufferManager->getFreeBuffer(width, height);
+    }
     if (!frame_buffer) {
         ELOG_ERROR("No free video buffer");
         return -1;
@@ -57,14 +69,27 @@ void FFmpegFrameDecoder::AVFreeBuffer(void* opaque, uint8_t* data)
     return;
 }
 
-FFmpegFrameDecoder::FFmpegFrameDecoder()
+FFmpegFrameDecoder::FFmpegFrameDecoder(bool useDecodeThread)
     : m_decCtx(NULL)
     , m_decFrame(NULL)
+    , m_useDecodeThread(useDecodeThread)
+    , m_needKeyFrame(false)
+    , m_pendingFrames(0)
+    , m_decodedCount(0)
+    , m_totalLatencyUs(0)
+    , m_maxLatencyUs(0)
 {
 }
 
 FFmpegFrameDecoder::~FFmpegFrameDecoder()
 {
+    if (m_thread) {
+        m_srvWork.reset();
+        m_srv->stop();
+        m_thread->join();
+        m_thread.reset();
+    }
+
     if (m_decFrame) {
         av_frame_free(&m_decFrame);
         m_decFrame = NULL;
@@ -99,6 +124,10 @@ bool FFmpegFrameDecoder::init(FrameFormat format)
             codec_id = AV_CODEC_ID_VP9;
             break;
 
+        case FRAME_FORMAT_AV1:
+            codec_id = AV_CODEC_ID_AV1;
+            break;
+
         default:
             ELOG_ERROR_T("Unspported video frame format %s(%d)", getFormatStr(format), format);
             return false;
@@ -120,6 +149,21 @@ bool FFmpegFrameDecoder::init(FrameFormat format)
 
     m_decCtx->get_buffer2 = AVGetBuffer;
     m_decCtx->opaque = this;
+
+    if (m_useDecodeThread) {
+        uint32_t threads = boost::thread::hardware_concurrency();
+        if (threads > kMaxDecodeThreads)
+            threads = kMaxDecodeThreads;
+        if (threads < 1)
+            threads = 1;
+
+        m_decCtx->thread_count = threads;
+        m_decCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#if FF_API_THREAD_SAFE_CALLBACKS
+        m_decCtx->thread_safe_callbacks = 1;
+#endif
+        ELOG_DEBUG_T("Decode thread enabled, ffmpeg threads %u", threads);
+    }
     ret = avcodec_open2(m_decCtx, dec , NULL);
     if (ret < 0) {
         ELOG_ERROR_T("Could not open ffmpeg decoder context, %s", ff_err2str(ret));
@@ -136,16 +180,67 @@ bool FFmpegFrameDecoder::init(FrameFormat format)
 
     m_bufferManager.reset(new I420BufferManager(50));
 
+    if (m_useDecodeThread) {
+        m_srv.reset(new boost::asio::io_service());
+        m_srvWork.reset(new boost::asio::io_service::work(*m_srv));
+        m_thread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, m_srv.get())));
+    }
+
     return true;
 }
 
+void FFmpegFrameDecoder::requestKeyFrame()
+{
+    FeedbackMsg msg { .type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
+    deliverFeedbackMsg(msg);
+}
+
 void FFmpegFrameDecoder::onFrame(const Frame& frame)
+{
+    int64_t receivedUs = currentTimeUs();
+
+    if (!m_useDecodeThread) {
+        decode(frame.payload, frame.length, frame.timeStamp, receivedUs);
+        return;
+    }
+
+    if (m_needKeyFrame) {
+        if (!frame.additionalInfo.video.isKeyFrame)
+            return;
+        m_needKeyFrame = false;
+    }
+
+    if (m_pendingFrames >= kMaxPendingFrames) {
+        ELOG_DEBUG_T("Decode queue full(%u), drop until next key frame", m_pendingFrames.load());
+        m_needKeyFrame = true;
+        requestKeyFrame();
+        return;
+    }
+
+    // FFmpeg requires zeroed padding at the end of the input buffer
+    boost::shared_array<uint8_t> data(new uint8_t[frame.length + AV_INPUT_BUFFER_PADDING_SIZE]);
+    memcpy(data.get(), frame.payload, frame.length);
+    memset(data.get() + frame.length, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    m_pendingFrames++;
+    m_srv->post(boost::bind(&FFmpegFrameDecoder::decodeFromQueue, this, data, frame.length, frame.timeStamp, receivedUs));
+}
+
+void FFmpegFrameDecoder::decodeFromQueue(boost::shared_array<uint8_t> data, uint32_t length, uint32_t timeStamp, int64_t receivedUs)
+{
+    decode(data.get(), length, timeStamp, receivedUs);
+    m_pendingFrames--;
+}
+
+void FFmpegFrameDecoder::decode(uint8_t* data, uint32_t length, uint32_t timeStamp, int64_t receivedUs)
 {
     int ret;
 
     av_init_packet(&m_packet);
-    m_packet.data = frame.payload;
-    m_packet.size = frame.length;
+    m_packet.data = data;
+    m_packet.size = length;
+    m_packet.pts = timeStamp;
+    m_decCtx->reordered_opaque = receivedUs;
 
     ret = avcodec_send_packet(m_decCtx, &m_packet);
     if (ret < 0) {
@@ -153,19 +248,21 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
         return;
     }
 
-    ret = avcodec_receive_frame(m_decCtx, m_decFrame);
-    if (ret == AVERROR(EAGAIN)) {
-        ELOG_DEBUG_T("Retry receive frame, %s", ff_err2str(ret));
-        return;
-    }else if (ret < 0) {
-        ELOG_ERROR_T("Error while receive frame, %s", ff_err2str(ret));
-        return;
-    }
-
-    webrtc::VideoFrame *video_frame = static_cast<webrtc::VideoFrame*>(
-            av_buffer_get_opaque(m_decFrame->buf[0]));
+    // With frame threading, one packet may flush zero or several frames
+    while (true) {
+        ret = avcodec_receive_frame(m_decCtx, m_decFrame);
+        if (ret == AVERROR(EAGAIN)) {
+            ELOG_TRACE_T("Retry receive frame, %s", ff_err2str(ret));
+            return;
+        } else if (ret < 0) {
+            ELOG_ERROR_T("Error while receive frame, %s", ff_err2str(ret));
+            return;
+        }
+
+        webrtc::VideoFrame *video_frame = static_cast<webrtc::VideoFrame*>(
+                av_buffer_get_opaque(m_decFrame->buf[0]));
+        video_frame->set_timestamp(m_decFrame->pts);
 
-    {
         Frame frame;
         memset(&frame, 0, sizeof(frame));
         frame.format = FRAME_FORMAT_I420;
@@ -180,6 +277,19 @@ void FFmpegFrameDecoder::onFrame(const Frame& frame)
                 frame.additionalInfo.video.height,
                 frame.timeStamp);
         deliverFrame(frame);
+
+        int64_t latencyUs = currentTimeUs() - m_decFrame->reordered_opaque;
+        m_totalLatencyUs += latencyUs;
+        if (latencyUs > m_maxLatencyUs)
+            m_maxLatencyUs = latencyUs;
+        if (++m_decodedCount % kLatencyReportInterval == 0) {
+            ELOG_DEBUG_T("Decode latency avg %ld us, max %ld us, pending %u",
+                    m_totalLatencyUs / kLatencyReportInterval, m_maxLatencyUs, m_pendingFrames.load());
+            m_totalLatencyUs = 0;
+            m_maxLatencyUs = 0;
+        }
+
+        av_frame_unref(m_decFrame);
     }
 }
 
@@ -5,8 +5,11 @@
 #ifndef FFmpegFrameDecoder_h
 #define FFmpegFrameDecoder_h
 
+#include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 #include <logger.h>
 
 #include "MediaFramePipeline.h"
@@ -18,11 +21,25 @@ extern "C" {
 
 namespace owt_base {
 
+/**
+ * Decodes with FFmpeg into buffers of I420BufferManager, the decoded
+ * AVFrame planes are handed out as the webrtc::VideoFrame without copy.
+ *
+ * With |useDecodeThread|, FFmpeg frame/slice threading is enabled and
+ * packets are decoded on a dedicated worker with a bounded queue, so the
+ * thread delivering the encoded frames (usually the network path) never
+ * runs the decoder. When the queue is full, frames are dropped until the
+ * next key frame and a key frame is requested.
+ */
 class FFmpegFrameDecoder : public VideoFrameDecoder {
     DECLARE_LOGGER();
 
+    static const uint32_t kMaxPendingFrames = 8;
+    static const uint32_t kMaxDecodeThreads = 4;
+    static const uint32_t kLatencyReportInterval = 300;
+
 public:
-    FFmpegFrameDecoder();
+    FFmpegFrameDecoder(bool useDecodeThread = false);
     ~FFmpegFrameDecoder();
 
     static bool supportFormat(FrameFormat format) {return true;}
@@ -34,6 +51,10 @@ protected:
     static int AVGetBuffer(AVCodecContext *s, AVFrame *frame, int flags);
     static void AVFreeBuffer(void* opaque, uint8_t* data);
 
+    void decode(uint8_t* data, uint32_t length, uint32_t timeStamp, int64_t receivedUs);
+    void decodeFromQueue(boost::shared_array<uint8_t> data, uint32_t length, uint32_t timeStamp, int64_t receivedUs);
+    void requestKeyFrame();
+
 private:
     AVCodecContext *m_decCtx;
     AVFrame *m_decFrame;
@@ -41,6 +62,20 @@ private:
     AVPacket m_packet;
 
     boost::scoped_ptr<owt_base::I420BufferManager> m_bufferManager;
+    // get_buffer2 is called from FFmpeg's threads in frame threading mode
+    boost::mutex m_bufferMutex;
+
+    bool m_useDecodeThread;
+    bool m_needKeyFrame;
+    std::atomic<uint32_t> m_pendingFrames;
+    boost::scoped_ptr<boost::asio::io_service> m_srv;
+    boost::scoped_ptr<boost::asio::io_service::work> m_srvWork;
+    boost::scoped_ptr<boost::thread> m_thread;
+
+    // decode latency, from receiving the encoded frame to delivering it
+    uint32_t m_decodedCount;
+    int64_t m_totalLatencyUs;
+    int64_t m_maxLatencyUs;
 
     char m_errbuff[500];
     char *ff_err2str(int errRet);
@@ -0,0 +1,70 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FrameSizeStats_h
+#define FrameSizeStats_h
+
+#include <atomic>
+#include <stdint.h>
+
+namespace owt_base {
+
+/**
+ * Peak to average size of encoded frames over consecutive windows of
+ * frames, showing how bursty the output of an encoder is. add() is called
+ * from the encoding thread only, results can be read from any thread.
+ */
+class FrameSizeStats {
+public:
+    static const uint32_t kDefaultWindowFrames = 300;
+
+    explicit FrameSizeStats(uint32_t windowFrames = kDefaultWindowFrames)
+        : m_windowFrames(windowFrames ? windowFrames : 1)
+        , m_frames(0)
+        , m_totalBytes(0)
+        , m_peakBytes(0)
+        , m_averageBytes(0)
+        , m_lastPeakBytes(0)
+    {
+    }
+
+    // Returns true when a window completes
+    bool add(uint32_t bytes)
+    {
+        m_totalBytes += bytes;
+        if (bytes > m_peakBytes) {
+            m_peakBytes = bytes;
+        }
+        if (++m_frames < m_windowFrames) {
+            return false;
+        }
+        m_averageBytes = m_totalBytes / m_frames;
+        m_lastPeakBytes = m_peakBytes;
+        m_frames = 0;
+        m_totalBytes = 0;
+        m_peakBytes = 0;
+        return true;
+    }
+
+    // Of the last complete window, 0 before the first one
+    uint32_t peakBytes() const { return m_lastPeakBytes; }
+    uint32_t averageBytes() const { return m_averageBytes; }
+    double peakToAverage() const
+    {
+        uint32_t average = m_averageBytes;
+        return average ? static_cast<double>(m_lastPeakBytes) / average : 0;
+    }
+
+private:
+    uint32_t m_windowFrames;
+    uint32_t m_frames;
+    uint64_t m_totalBytes;
+    uint32_t m_peakBytes;
+    std::atomic<uint32_t> m_averageBytes;
+    std::atomic<uint32_t> m_lastPeakBytes;
+};
+
+} /* namespace owt_base */
+
+#endif /* FrameSizeStats_h */
@@ -0,0 +1,53 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FrameSizeStats
+#include <boost/test/unit_test.hpp>
+
+#include "FrameSizeStats.h"
+
+using namespace owt_base;
+
+BOOST_AUTO_TEST_CASE(emptyUntilWindowComplete)
+{
+    FrameSizeStats stats(3);
+    BOOST_CHECK(!stats.add(100));
+    BOOST_CHECK(!stats.add(200));
+    BOOST_CHECK_EQUAL(stats.peakToAverage(), 0);
+    BOOST_CHECK(stats.add(300));
+    BOOST_CHECK_EQUAL(stats.peakBytes(), 300u);
+    BOOST_CHECK_EQUAL(stats.averageBytes(), 200u);
+    BOOST_CHECK_CLOSE(stats.peakToAverage(), 1.5, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(windowsAreIndependent)
+{
+    FrameSizeStats stats(2);
+    stats.add(1000);
+    stats.add(1000);
+    stats.add(100);
+    BOOST_CHECK(stats.add(300));
+    BOOST_CHECK_EQUAL(stats.peakBytes(), 300u);
+    BOOST_CHECK_EQUAL(stats.averageBytes(), 200u);
+}
+
+// Total of a 300 frame window of large frames exceeds 32 bits
+BOOST_AUTO_TEST_CASE(largeWindowDoesNotOverflow)
+{
+    const uint32_t kKey = 64 * 1024 * 1024;
+    const uint32_t kDelta = 16 * 1024 * 1024;
+    FrameSizeStats stats(300);
+    for (uint32_t i = 0; i < 300; i++) {
+        stats.add(i % 30 ? kDelta : kKey);
+    }
+    BOOST_CHECK_EQUAL(stats.peakBytes(), kKey);
+    BOOST_CHECK_EQUAL(stats.averageBytes(), (10ULL * kKey + 290ULL * kDelta) / 300);
+    BOOST_CHECK_CLOSE(stats.peakToAverage(), 300.0 * 4 / (10 * 4 + 290), 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(zeroWindowCountsEachFrame)
+{
+    FrameSizeStats stats(0);
+    BOOST_CHECK(stats.add(500));
+    BOOST_CHECK_CLOSE(stats.peakToAverage(), 1.0, 0.01);
+    BOOST_CHECK(stats.add(700));
+    BOOST_CHECK_EQUAL(stats.peakBytes(), 700u);
+}
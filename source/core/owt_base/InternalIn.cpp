@@ -3,10 +3,12 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalIn.h"
+#include "PipelineTracer.h"
 
 namespace owt_base {
 
 InternalIn::InternalIn(const std::string& protocol, unsigned int minPort, unsigned int maxPort)
+    : m_frameTrace { 0, 0 }
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
@@ -25,6 +27,7 @@ InternalIn::InternalIn(
     const std::string& ticket,
     unsigned int minPort,
     unsigned int maxPort)
+    : m_frameTrace { 0, 0 }
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
@@ -62,11 +65,21 @@ void InternalIn::onTransportData(char* buf, int len)
     Frame* frame = nullptr;
     MetaData* metadata = nullptr;
     switch (buf[0]) {
-        case TDT_MEDIA_FRAME:
+        case TDT_MEDIA_FRAME: {
             frame = reinterpret_cast<Frame*>(buf + 1);
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
+            // The trace of a lost frame does not match the next one
+            PipelineTracer::CaptureScope scope(
+                m_frameTrace.timeStamp == frame->timeStamp ? m_frameTrace.captureTimeUs : 0);
+            m_frameTrace.captureTimeUs = 0;
             deliverFrame(*frame);
             break;
+        }
+        case TDT_FRAME_TRACE:
+            if (len >= static_cast<int>(FrameTrace::kSize + 1)) {
+                m_frameTrace.read(reinterpret_cast<uint8_t*>(buf + 1));
+            }
+            break;
         case TDT_MEDIA_METADATA:
             metadata = reinterpret_cast<MetaData*>(buf + 1);
             metadata->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(MetaData));
@@ -29,6 +29,8 @@ public:
 
 private:
     boost::shared_ptr<owt_base::RawTransportInterface> m_transport;
+    // Capture time of the next frame, from TDT_FRAME_TRACE
+    FrameTrace m_frameTrace;
 };
 
 } /* namespace owt_base */
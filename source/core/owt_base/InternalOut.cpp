@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalOut.h"
+#include "PipelineTracer.h"
 
 namespace owt_base {
 
@@ -38,6 +39,15 @@ InternalOut::~InternalOut()
 
 void InternalOut::onFrame(const Frame& frame)
 {
+    int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+    if (captureTimeUs) {
+        char traceBuffer[FrameTrace::kSize + 1];
+        FrameTrace trace { frame.timeStamp, captureTimeUs };
+        traceBuffer[0] = TDT_FRAME_TRACE;
+        trace.write(reinterpret_cast<uint8_t*>(&traceBuffer[1]));
+        m_transport->sendData(traceBuffer, sizeof(traceBuffer));
+    }
+
     char sendBuffer[sizeof(Frame) + 1];
     size_t header_len = sizeof(Frame);
 
@@ -0,0 +1,121 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "KeyFrameArbiter.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace owt_base {
+
+// Initial guess of the delay from a request to the key frame(ms)
+static constexpr uint32_t kInitialResponseMs = 200;
+
+const uint32_t KeyFrameArbiter::kDefaultMinIntervalMs;
+
+KeyFrameArbiter::KeyFrameArbiter(uint32_t minIntervalMs)
+    : m_minIntervalMs(minIntervalMs)
+    , m_lastForwardMs(0)
+    , m_lastKeyFrameMs(0)
+    , m_pending(false)
+    , m_responseMs(kInitialResponseMs)
+    , m_received(0)
+    , m_forwarded(0)
+{
+}
+
+uint64_t KeyFrameArbiter::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void KeyFrameArbiter::setMinInterval(uint32_t minIntervalMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_minIntervalMs = minIntervalMs;
+}
+
+bool KeyFrameArbiter::inFlight(uint64_t nowMs)
+{
+    // A request without answer is given up after the minimal interval
+    return m_lastForwardMs > m_lastKeyFrameMs
+        && nowMs < m_lastForwardMs + m_minIntervalMs;
+}
+
+uint64_t KeyFrameArbiter::nextAllowedMs()
+{
+    uint64_t lastMs = std::max(m_lastForwardMs, m_lastKeyFrameMs);
+    return lastMs ? lastMs + m_minIntervalMs : 0;
+}
+
+void KeyFrameArbiter::forward(uint64_t nowMs)
+{
+    m_lastForwardMs = nowMs;
+    m_pending = false;
+    m_forwarded++;
+}
+
+KeyFrameArbiter::Decision KeyFrameArbiter::onRequest(uint64_t nowMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_received++;
+    if (inFlight(nowMs) || m_pending) {
+        return COALESCED;
+    }
+    if (nowMs < nextAllowedMs()) {
+        m_pending = true;
+        return DEFERRED;
+    }
+    forward(nowMs);
+    return FORWARD;
+}
+
+bool KeyFrameArbiter::poll(uint64_t nowMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_pending && nowMs >= nextAllowedMs()) {
+        forward(nowMs);
+        return true;
+    }
+    return false;
+}
+
+void KeyFrameArbiter::onKeyFrame(uint64_t nowMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (inFlight(nowMs)) {
+        uint32_t responseMs = nowMs - m_lastForwardMs;
+        m_responseMs = (m_responseMs * 3 + responseMs) / 4;
+    }
+    // The key frame answers every request made before it
+    m_lastKeyFrameMs = nowMs;
+    m_pending = false;
+}
+
+int32_t KeyFrameArbiter::keyFrameEta(uint64_t nowMs)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (inFlight(nowMs)) {
+        return std::max<int64_t>(m_lastForwardMs + m_responseMs - nowMs, 0);
+    }
+    if (m_pending) {
+        return std::max<int64_t>(nextAllowedMs() - nowMs, 0) + m_responseMs;
+    }
+    return -1;
+}
+
+uint32_t KeyFrameArbiter::requestsReceived()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_received;
+}
+
+uint32_t KeyFrameArbiter::requestsForwarded()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_forwarded;
+}
+
+} /* namespace owt_base */
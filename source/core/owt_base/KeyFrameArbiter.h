@@ -0,0 +1,69 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef KeyFrameArbiter_h
+#define KeyFrameArbiter_h
+
+#include <boost/thread/mutex.hpp>
+#include <stdint.h>
+
+namespace owt_base {
+
+/**
+ * Decides which key frame requests of one video source are sent upstream.
+ * Requests made while a forwarded request is still waiting for its key
+ * frame are answered by that key frame. Requests made within the minimal
+ * interval after the last key frame or forwarded request are coalesced
+ * into one, which is forwarded by poll() once the interval has passed.
+ * Times are in milliseconds of a monotonic clock supplied by the caller.
+ */
+class KeyFrameArbiter {
+public:
+    static const uint32_t kDefaultMinIntervalMs = 1000;
+
+    enum Decision {
+        // Send the request upstream now
+        FORWARD,
+        // Answered by a key frame already requested or due
+        COALESCED,
+        // First request held back, poll() forwards it later
+        DEFERRED
+    };
+
+    explicit KeyFrameArbiter(uint32_t minIntervalMs = kDefaultMinIntervalMs);
+
+    void setMinInterval(uint32_t minIntervalMs);
+
+    Decision onRequest(uint64_t nowMs);
+    // Returns true if a coalesced request is due
+    bool poll(uint64_t nowMs);
+    void onKeyFrame(uint64_t nowMs);
+
+    // Estimated time(ms) until the next key frame, -1 if none is expected
+    int32_t keyFrameEta(uint64_t nowMs);
+
+    uint32_t requestsReceived();
+    uint32_t requestsForwarded();
+
+    static uint64_t nowMs();
+
+private:
+    bool inFlight(uint64_t nowMs);
+    uint64_t nextAllowedMs();
+    void forward(uint64_t nowMs);
+
+    boost::mutex m_mutex;
+    uint32_t m_minIntervalMs;
+    uint64_t m_lastForwardMs;
+    uint64_t m_lastKeyFrameMs;
+    bool m_pending;
+    // Smoothed delay(ms) from a forwarded request to the key frame
+    uint32_t m_responseMs;
+    uint32_t m_received;
+    uint32_t m_forwarded;
+};
+
+} /* namespace owt_base */
+
+#endif /* KeyFrameArbiter_h */
@@ -0,0 +1,190 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE KeyFrameArbiter
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+
+#include "KeyFrameArbiter.h"
+#include "MediaFrameMulticaster.h"
+
+using namespace owt_base;
+
+BOOST_AUTO_TEST_CASE(firstRequestForwarded)
+{
+    KeyFrameArbiter arbiter(1000);
+    BOOST_CHECK_EQUAL(arbiter.keyFrameEta(1000), -1);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1000), KeyFrameArbiter::FORWARD);
+    BOOST_CHECK(arbiter.keyFrameEta(1000) >= 0);
+    // Answered by the key frame already requested
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1010), KeyFrameArbiter::COALESCED);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1020), KeyFrameArbiter::COALESCED);
+    BOOST_CHECK(!arbiter.poll(1500));
+    BOOST_CHECK_EQUAL(arbiter.requestsReceived(), 3u);
+    BOOST_CHECK_EQUAL(arbiter.requestsForwarded(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(deferAfterKeyFrame)
+{
+    KeyFrameArbiter arbiter(1000);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1000), KeyFrameArbiter::FORWARD);
+    arbiter.onKeyFrame(1100);
+    BOOST_CHECK_EQUAL(arbiter.keyFrameEta(1100), -1);
+
+    // Held until one interval after the key frame
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1200), KeyFrameArbiter::DEFERRED);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1300), KeyFrameArbiter::COALESCED);
+    int32_t eta = arbiter.keyFrameEta(1300);
+    BOOST_CHECK(eta >= 800);
+    BOOST_CHECK(!arbiter.poll(2099));
+    BOOST_CHECK(arbiter.poll(2100));
+    BOOST_CHECK(!arbiter.poll(2101));
+    BOOST_CHECK_EQUAL(arbiter.requestsForwarded(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(keyFrameClearsPending)
+{
+    KeyFrameArbiter arbiter(1000);
+    arbiter.onKeyFrame(1000);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1100), KeyFrameArbiter::DEFERRED);
+    // A periodic key frame answers the held request
+    arbiter.onKeyFrame(1500);
+    BOOST_CHECK(!arbiter.poll(2600));
+    BOOST_CHECK_EQUAL(arbiter.requestsForwarded(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(retryLostRequest)
+{
+    KeyFrameArbiter arbiter(1000);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1000), KeyFrameArbiter::FORWARD);
+    // No key frame came, a new request goes out after the interval
+    BOOST_CHECK_EQUAL(arbiter.onRequest(1500), KeyFrameArbiter::COALESCED);
+    BOOST_CHECK_EQUAL(arbiter.onRequest(2000), KeyFrameArbiter::FORWARD);
+}
+
+BOOST_AUTO_TEST_CASE(requestStorm)
+{
+    // 10000 subscribers asking within 10s, key frames answer in 100ms
+    KeyFrameArbiter arbiter(1000);
+    uint64_t keyFrameMs = 0;
+    for (uint64_t ms = 1000; ms < 11000; ms++) {
+        bool forwarded = arbiter.poll(ms);
+        forwarded |= (arbiter.onRequest(ms) == KeyFrameArbiter::FORWARD);
+        if (forwarded) {
+            keyFrameMs = ms + 100;
+        }
+        if (ms == keyFrameMs) {
+            arbiter.onKeyFrame(ms);
+        }
+    }
+    BOOST_CHECK_EQUAL(arbiter.requestsReceived(), 10000u);
+    BOOST_CHECK(arbiter.requestsForwarded() <= 10u);
+    BOOST_CHECK(arbiter.requestsForwarded() >= 9u);
+}
+
+class TestSource : public FrameSource {
+public:
+    TestSource() : m_keyFrameRequests(0), m_refreshRequests(0) {}
+
+    void generateFrame(const Frame& frame) { deliverFrame(frame); }
+    void onFeedback(const FeedbackMsg& msg) override
+    {
+        if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
+            m_keyFrameRequests++;
+        } else if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_REFRESH) {
+            m_refreshRequests++;
+        }
+    }
+    int keyFrameRequests() { return m_keyFrameRequests; }
+    int refreshRequests() { return m_refreshRequests; }
+private:
+    int m_keyFrameRequests;
+    int m_refreshRequests;
+};
+
+class TestDestination : public FrameDestination {
+public:
+    TestDestination() : m_eta(-1) {}
+
+    void onFrame(const Frame&) override {}
+    void onMetaData(const MetaData& metadata) override
+    {
+        if (metadata.type == META_DATA_KEY_FRAME_ETA) {
+            m_eta = *reinterpret_cast<const int32_t*>(metadata.payload);
+        }
+    }
+    void requestKeyFrame()
+    {
+        FeedbackMsg msg(VIDEO_FEEDBACK, REQUEST_KEY_FRAME);
+        deliverFeedbackMsg(msg);
+    }
+    void requestRefresh()
+    {
+        FeedbackMsg msg(VIDEO_FEEDBACK, REQUEST_REFRESH);
+        deliverFeedbackMsg(msg);
+    }
+    int32_t m_eta;
+};
+
+BOOST_AUTO_TEST_CASE(multicasterCoalesces)
+{
+    TestSource source;
+    MediaFrameMulticaster multicaster;
+    TestDestination dests[100];
+    source.addVideoDestination(&multicaster);
+    for (auto& dest : dests) {
+        multicaster.addVideoDestination(&dest);
+    }
+
+    for (auto& dest : dests) {
+        dest.requestKeyFrame();
+    }
+    BOOST_CHECK_EQUAL(source.keyFrameRequests(), 1);
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_VP8;
+    frame.additionalInfo.video.isKeyFrame = true;
+    source.generateFrame(frame);
+
+    // Held back right after the key frame, with an estimate for requesters
+    for (auto& dest : dests) {
+        dest.requestKeyFrame();
+    }
+    BOOST_CHECK_EQUAL(source.keyFrameRequests(), 1);
+    BOOST_CHECK(dests[0].m_eta > 0);
+    BOOST_CHECK(dests[99].m_eta > 0);
+
+    for (auto& dest : dests) {
+        multicaster.removeVideoDestination(&dest);
+    }
+    source.removeVideoDestination(&multicaster);
+}
+
+BOOST_AUTO_TEST_CASE(multicasterKeepsRefreshRequests)
+{
+    TestSource source;
+    MediaFrameMulticaster multicaster;
+    TestDestination dests[10];
+    source.addVideoDestination(&multicaster);
+    for (auto& dest : dests) {
+        multicaster.addVideoDestination(&dest);
+    }
+
+    // Coalesced into one refresh, not turned into a key frame request
+    for (auto& dest : dests) {
+        dest.requestRefresh();
+    }
+    BOOST_CHECK_EQUAL(source.refreshRequests(), 1);
+    BOOST_CHECK_EQUAL(source.keyFrameRequests(), 0);
+
+    // A joining receiver still gets its key frame, which answers refreshes
+    dests[0].requestKeyFrame();
+    BOOST_CHECK_EQUAL(source.keyFrameRequests(), 1);
+    dests[1].requestRefresh();
+    BOOST_CHECK_EQUAL(source.refreshRequests(), 1);
+
+    for (auto& dest : dests) {
+        multicaster.removeVideoDestination(&dest);
+    }
+    source.removeVideoDestination(&multicaster);
+}
@@ -179,7 +179,7 @@ public:
 
     void onFeedback(const owt_base::FeedbackMsg& msg) {
         if (msg.type == owt_base::VIDEO_FEEDBACK) {
-            if (msg.cmd == REQUEST_KEY_FRAME) {
+            if (msg.cmd == REQUEST_KEY_FRAME || msg.cmd == REQUEST_REFRESH) {
                 requestKeyFrame();
             }
         }
@@ -7,7 +7,6 @@
 namespace owt_base {
 
 MediaFrameMulticaster::MediaFrameMulticaster()
-    : m_pendingKeyFrameRequests(0)
 {
     m_feedbackTimer = SharedJobTimer::GetSharedFrequencyTimer(1);
     m_feedbackTimer->addListener(this);
@@ -21,11 +20,28 @@ MediaFrameMulticaster::~MediaFrameMulticaster()
 void MediaFrameMulticaster::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
-        if (!m_pendingKeyFrameRequests) {
+        uint64_t nowMs = KeyFrameArbiter::nowMs();
+        KeyFrameArbiter::Decision decision = m_keyFrameArbiter.onRequest(nowMs);
+        if (decision == KeyFrameArbiter::FORWARD) {
             FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
             deliverFeedbackMsg(msg);
+        } else if (decision == KeyFrameArbiter::DEFERRED) {
+            // The source only sees forwarded requests, announce the held one here
+            int32_t eta = m_keyFrameArbiter.keyFrameEta(nowMs);
+            MetaData metadata;
+            metadata.type = META_DATA_KEY_FRAME_ETA;
+            metadata.payload = reinterpret_cast<uint8_t*>(&eta);
+            metadata.length = sizeof(eta);
+            deliverMetaData(metadata);
+        }
+    } else if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_REFRESH) {
+        uint64_t nowMs = KeyFrameArbiter::nowMs();
+        // A key frame already requested answers the refresh as well
+        if (m_keyFrameArbiter.keyFrameEta(nowMs) < 0
+            && m_refreshArbiter.onRequest(nowMs) == KeyFrameArbiter::FORWARD) {
+            FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_REFRESH};
+            deliverFeedbackMsg(msg);
         }
-        ++m_pendingKeyFrameRequests;
     } else if (msg.type == AUDIO_FEEDBACK) {
         deliverFeedbackMsg(msg);
     }
@@ -33,6 +49,15 @@ void MediaFrameMulticaster::onFeedback(const FeedbackMsg& msg)
 
 void MediaFrameMulticaster::onFrame(const Frame& frame)
 {
+    if (isVideoFrame(frame)) {
+        uint64_t nowMs = KeyFrameArbiter::nowMs();
+        if (frame.additionalInfo.video.isKeyFrame) {
+            m_keyFrameArbiter.onKeyFrame(nowMs);
+            m_refreshArbiter.onKeyFrame(nowMs);
+        } else {
+            pollRequests(nowMs);
+        }
+    }
     deliverFrame(frame);
 }
 
@@ -43,11 +68,18 @@ void MediaFrameMulticaster::onMetaData(const MetaData& metadata)
 
 void MediaFrameMulticaster::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
+    pollRequests(KeyFrameArbiter::nowMs());
+}
+
+void MediaFrameMulticaster::pollRequests(uint64_t nowMs)
+{
+    if (m_keyFrameArbiter.poll(nowMs)) {
         FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_KEY_FRAME};
         deliverFeedbackMsg(msg);
+    } else if (m_refreshArbiter.poll(nowMs) && m_keyFrameArbiter.keyFrameEta(nowMs) < 0) {
+        FeedbackMsg msg = {VIDEO_FEEDBACK, REQUEST_REFRESH};
+        deliverFeedbackMsg(msg);
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 } /* namespace owt_base */
@@ -5,6 +5,7 @@
 #ifndef MediaFrameMulticaster_h
 #define MediaFrameMulticaster_h
 
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
 #include <JobTimer.h>
 
@@ -28,8 +29,12 @@ public:
     void onTimeout();
 
 private:
+    void pollRequests(uint64_t nowMs);
+
     std::shared_ptr<SharedJobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameArbiter m_keyFrameArbiter;
+    // REQUEST_REFRESH is coalesced on its own, key frames answer both
+    KeyFrameArbiter m_refreshArbiter;
 };
 
 } /* namespace owt_base */
@@ -79,6 +79,18 @@ void FrameSource::removeDataDestination(FrameDestination* dest)
 
 void FrameSource::deliverFrame(const Frame& frame)
 {
+    // Destinations may deliver the frame further, restore the outer identity
+    DeliveringFrame& delivering = deliveringFrameSlot();
+    DeliveringFrame outer = delivering;
+    // A destination passing the same frame on does not make a new one
+    if (!outer.id || outer.payload != frame.payload
+        || outer.length != frame.length || outer.timeStamp != frame.timeStamp) {
+        delivering.id = nextFrameId()++;
+        delivering.source = this;
+        delivering.payload = frame.payload;
+        delivering.length = frame.length;
+        delivering.timeStamp = frame.timeStamp;
+    }
     if (isAudioFrame(frame)) {
         boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
         for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
@@ -97,6 +109,7 @@ void FrameSource::deliverFrame(const Frame& frame)
     } else {
         //TODO: log error here.
     }
+    delivering = outer;
 }
 
 void FrameSource::deliverMetaData(const MetaData& metadata)
@@ -5,6 +5,7 @@
 #ifndef MediaFramePipeline_h
 #define MediaFramePipeline_h
 
+#include <atomic>
 #include <boost/thread/shared_mutex.hpp>
 #include <list>
 #include <map>
@@ -63,6 +64,9 @@ struct VideoFrameSpecificInfo {
     uint16_t width;
     uint16_t height;
     bool isKeyFrame;
+    // Layer of the frame within an SVC stream, 0 when the stream is not layered
+    uint8_t spatialId;
+    uint8_t temporalId;
 };
 
 struct AudioFrameSpecificInfo {
@@ -73,6 +77,9 @@ struct AudioFrameSpecificInfo {
     uint8_t channels;
     uint8_t voice;
     uint8_t audioLevel;
+    // Set if the packet carries the audio level extension, which may
+    // validly hold level 0 (0 dBov) with the V bit clear
+    uint8_t hasAudioLevel;
 };
 
 typedef union MediaSpecInfo {
@@ -90,6 +97,10 @@ struct Frame {
 
 enum MetaDataType {
     META_DATA_OWNER_ID = 0,
+    // Payload is an ascending uint32_t array of layer bitrates(bps)
+    META_DATA_LAYER_BITRATES,
+    // Payload is an int32_t, estimated time(ms) until the next key frame
+    META_DATA_KEY_FRAME_ETA,
 };
 
 struct MetaData {
@@ -237,7 +248,11 @@ enum FeedbackCmd {
     SET_BITRATE,
     REQUEST_OWNER_ID,
     INIT_STREAM_ID,
-    RTCP_PACKET // FIXME: Temporarily use FeedbackMsg to carry audio rtcp-packets due to the premature AudioFrameConstructor implementation.
+    RTCP_PACKET, // FIXME: Temporarily use FeedbackMsg to carry audio rtcp-packets due to the premature AudioFrameConstructor implementation.
+    // Picture loss of a receiver which already decoded the stream. Encoders
+    // in intra refresh mode may recover it gradually, anything else handles
+    // it as REQUEST_KEY_FRAME. Joining receivers keep asking for key frames.
+    REQUEST_REFRESH
 };
 
 struct FeedbackMsg {
@@ -279,11 +294,41 @@ public:
     virtual void addDataDestination(FrameDestination*);
     virtual void removeDataDestination(FrameDestination*);
 
+    // Identity of the frame being delivered on the calling thread, unique
+    // in the process and shared by all the destinations of one delivery,
+    // including those a destination passes the same frame on to,
+    // 0 outside of deliverFrame
+    static uint64_t deliveringFrameId() { return deliveringFrameSlot().id; }
+    // Source that first delivered that frame, nullptr outside of deliverFrame
+    static const FrameSource* deliveringSource() { return deliveringFrameSlot().source; }
+
 protected:
     void deliverFrame(const Frame&);
     void deliverMetaData(const MetaData&);
 
 private:
+    struct DeliveringFrame {
+        uint64_t id = 0;
+        const FrameSource* source = nullptr;
+        // Content of the frame, a nested delivery of it keeps the id
+        const uint8_t* payload = nullptr;
+        uint32_t length = 0;
+        uint32_t timeStamp = 0;
+    };
+
+    // Statics of inline functions are bound once per process, so sources
+    // and destinations compiled into different addons see the same identity
+    static DeliveringFrame& deliveringFrameSlot()
+    {
+        static thread_local DeliveringFrame frame;
+        return frame;
+    }
+    static std::atomic<uint64_t>& nextFrameId()
+    {
+        static std::atomic<uint64_t> frameId(1);
+        return frameId;
+    }
+
     std::list<FrameDestination*> m_audio_dests;
     boost::shared_mutex m_audio_dests_mutex;
     std::list<FrameDestination*> m_video_dests;
@@ -363,6 +408,13 @@ public:
     virtual void degenerateStream(int32_t streamId) = 0;
     virtual void setBitrate(unsigned short kbps, int32_t streamId) = 0;
     virtual void requestKeyFrame(int32_t streamId) = 0;
+    // Answers REQUEST_REFRESH, a key frame unless the stream refreshes itself
+    virtual void requestRefresh(int32_t streamId) { requestKeyFrame(streamId); }
+    // Stop periodic key frames and refresh the picture gradually over about
+    // periodFrames frames where the codec can. Key frame requests stay IDR,
+    // refresh requests are left to the running refresh. Call before
+    // generateStream, returns false if not supported.
+    virtual bool setIntraRefresh(uint32_t periodFrames) { return false; }
 };
 
 }
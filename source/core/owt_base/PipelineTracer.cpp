@@ -0,0 +1,224 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PipelineTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace owt_base {
+
+const int LatencyHistogram::kBucketCount;
+const uint64_t LatencyHistogram::kMaxValue;
+
+int LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value > kMaxValue) {
+        value = kMaxValue;
+    }
+    if (value < 32) {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - 4;
+    return 32 + (shift - 1) * 16 + static_cast<int>((value >> shift) - 16);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < 32) {
+        return index;
+    }
+    int shift = (index - 32) / 16 + 1;
+    uint64_t mantissa = (index - 32) % 16 + 16;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < kBucketCount; i++) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+std::atomic<bool> PipelineTracer::s_enabled(false);
+const size_t PipelineTracer::kMaxSpans;
+
+PipelineTracer& PipelineTracer::instance()
+{
+    static PipelineTracer tracer;
+    return tracer;
+}
+
+PipelineTracer::PipelineTracer()
+    : m_sampleInterval(0)
+    , m_nextSpan(0)
+{
+    for (int stage = 0; stage < TRACE_STAGE_COUNT; stage++) {
+        m_sampleCounters[stage].store(0);
+    }
+    // OWT_PIPELINE_TRACE=<sample interval> turns tracing on at startup
+    const char* env = std::getenv("OWT_PIPELINE_TRACE");
+    if (env) {
+        enable(true, std::strtoul(env, nullptr, 10));
+    }
+}
+
+int64_t PipelineTracer::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void PipelineTracer::enable(bool enabled, uint32_t sampleInterval)
+{
+    m_sampleInterval.store(sampleInterval, std::memory_order_relaxed);
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PipelineTracer::reset()
+{
+    for (int stage = 0; stage < TRACE_STAGE_COUNT; stage++) {
+        m_latency[stage].reset();
+        m_duration[stage].reset();
+    }
+    std::lock_guard<std::mutex> lock(m_spanMutex);
+    m_spans.clear();
+    m_nextSpan = 0;
+}
+
+void PipelineTracer::record(TraceStage stage, int64_t captureTimeUs, int64_t startUs)
+{
+    if (!enabled() || !captureTimeUs || !startUs) {
+        return;
+    }
+    int64_t now = nowUs();
+    // Wall clock may step back, count it as no latency
+    int64_t latencyUs = std::max<int64_t>(now - captureTimeUs, 0);
+    int64_t durationUs = std::max<int64_t>(now - startUs, 0);
+    m_latency[stage].record(latencyUs);
+    m_duration[stage].record(durationUs);
+
+    uint32_t interval = m_sampleInterval.load(std::memory_order_relaxed);
+    if (interval == 0
+        || m_sampleCounters[stage].fetch_add(1, std::memory_order_relaxed) % interval != 0) {
+        return;
+    }
+    static thread_local uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    Span span { stage, tid, startUs, durationUs, latencyUs };
+    std::lock_guard<std::mutex> lock(m_spanMutex);
+    if (m_spans.size() < kMaxSpans) {
+        m_spans.push_back(span);
+    } else {
+        m_spans[m_nextSpan] = span;
+        m_nextSpan = (m_nextSpan + 1) % kMaxSpans;
+    }
+}
+
+std::string PipelineTracer::statsJSON() const
+{
+    std::ostringstream json;
+    json << "{";
+    for (int i = 0; i < TRACE_STAGE_COUNT; i++) {
+        TraceStage stage = static_cast<TraceStage>(i);
+        const LatencyHistogram& latency = m_latency[stage];
+        const LatencyHistogram& duration = m_duration[stage];
+        json << (i ? ", " : "") << "\"" << stageName(stage) << "\": {"
+             << "\"count\": " << latency.count() << ", "
+             << "\"latency\": {"
+             << "\"p50\": " << latency.percentile(50) << ", "
+             << "\"p90\": " << latency.percentile(90) << ", "
+             << "\"p99\": " << latency.percentile(99) << ", "
+             << "\"max\": " << latency.max() << "}, "
+             << "\"duration\": {"
+             << "\"p50\": " << duration.percentile(50) << ", "
+             << "\"p90\": " << duration.percentile(90) << ", "
+             << "\"p99\": " << duration.percentile(99) << ", "
+             << "\"max\": " << duration.max() << "}}";
+    }
+    json << "}";
+    return json.str();
+}
+
+std::string PipelineTracer::exportChromeTrace()
+{
+    std::vector<Span> spans;
+    size_t first;
+    {
+        std::lock_guard<std::mutex> lock(m_spanMutex);
+        spans = m_spans;
+        first = m_nextSpan;
+    }
+    std::ostringstream json;
+    json << "{\"traceEvents\": [";
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span& span = spans[(first + i) % spans.size()];
+        json << (i ? ", " : "")
+             << "{\"name\": \"" << stageName(span.stage) << "\", "
+             << "\"cat\": \"media\", \"ph\": \"X\", "
+             << "\"ts\": " << span.startUs << ", "
+             << "\"dur\": " << span.durationUs << ", "
+             << "\"pid\": " << getpid() << ", "
+             << "\"tid\": " << span.tid << ", "
+             << "\"args\": {\"latencyUs\": " << span.latencyUs << "}}";
+    }
+    json << "], \"displayTimeUnit\": \"ms\"}";
+    return json.str();
+}
+
+const char* PipelineTracer::stageName(TraceStage stage)
+{
+    switch (stage) {
+    case TRACE_STAGE_RECEIVE:
+        return "receive";
+    case TRACE_STAGE_DECODE:
+        return "decode";
+    case TRACE_STAGE_COMPOSE:
+        return "compose";
+    case TRACE_STAGE_ENCODE:
+        return "encode";
+    case TRACE_STAGE_PACKETIZE:
+        return "packetize";
+    default:
+        return "";
+    }
+}
+
+} /* namespace owt_base */
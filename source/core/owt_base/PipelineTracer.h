@@ -0,0 +1,189 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PipelineTracer_h
+#define PipelineTracer_h
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace owt_base {
+
+enum TraceStage {
+    TRACE_STAGE_RECEIVE = 0,
+    TRACE_STAGE_DECODE,
+    TRACE_STAGE_COMPOSE,
+    TRACE_STAGE_ENCODE,
+    TRACE_STAGE_PACKETIZE,
+    TRACE_STAGE_COUNT
+};
+
+/**
+ * Lock-free histogram with HDR-style log-linear buckets. Values below 32
+ * are exact, larger values are kept in 16 sub-buckets per power of 2, so
+ * the relative error of a reported percentile is below 6.25%.
+ */
+class LatencyHistogram {
+public:
+    static const int kBucketCount = 592;
+    static const uint64_t kMaxValue = (1ULL << 40) - 1;
+
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t value);
+    void reset();
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the percentile, |p| in [0, 100]
+    uint64_t percentile(double p) const;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_max;
+};
+
+/**
+ * Per-stage latency of video frames through the media pipeline.
+ * The first stage delivers frames inside a CaptureScope, later stages
+ * record the latency from captureTimeUs() and their own processing time
+ * into histograms. Frame itself is unchanged, as its layout is the wire
+ * header of the internal transports. One of every |sampleInterval|
+ * records per stage is also kept as a trace span for export in Chrome
+ * trace format. Capture times are wall clock, as InternalOut and
+ * InternalServer send them ahead of the frame to other processes.
+ *
+ * When disabled, the cost at each stage is the relaxed load in enabled().
+ */
+class PipelineTracer {
+public:
+    static PipelineTracer& instance();
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static int64_t nowUs();
+
+    // Capture time of the frame being delivered on the calling thread, 0
+    // if unknown. Shared by all the addons of the process.
+    static int64_t captureTimeUs() { return captureTimeSlot(); }
+
+    // Sets the capture time for the frames delivered in its lifetime
+    class CaptureScope {
+    public:
+        explicit CaptureScope(int64_t captureTimeUs)
+            : m_outerUs(captureTimeSlot())
+        {
+            captureTimeSlot() = captureTimeUs;
+        }
+        ~CaptureScope() { captureTimeSlot() = m_outerUs; }
+
+    private:
+        int64_t m_outerUs;
+    };
+
+    // |sampleInterval| 0 disables the trace spans, histograms are always kept
+    void enable(bool enabled, uint32_t sampleInterval = 0);
+    void reset();
+
+    // The frame captured at |captureTimeUs| finished |stage|, which started
+    // working on it at |startUs|.
+    void record(TraceStage stage, int64_t captureTimeUs, int64_t startUs);
+
+    const LatencyHistogram& latency(TraceStage stage) const { return m_latency[stage]; }
+    const LatencyHistogram& duration(TraceStage stage) const { return m_duration[stage]; }
+
+    std::string statsJSON() const;
+    // Trace Event Format, loadable by chrome://tracing and Perfetto
+    std::string exportChromeTrace();
+
+    static const char* stageName(TraceStage stage);
+
+private:
+    PipelineTracer();
+
+    struct Span {
+        TraceStage stage;
+        uint32_t tid;
+        int64_t startUs;
+        int64_t durationUs;
+        int64_t latencyUs;
+    };
+    static const size_t kMaxSpans = 16384;
+
+    static std::atomic<bool> s_enabled;
+
+    // Statics of inline functions are bound once per process
+    static int64_t& captureTimeSlot()
+    {
+        static thread_local int64_t captureTimeUs = 0;
+        return captureTimeUs;
+    }
+
+    LatencyHistogram m_latency[TRACE_STAGE_COUNT];
+    LatencyHistogram m_duration[TRACE_STAGE_COUNT];
+    std::atomic<uint32_t> m_sampleInterval;
+    std::atomic<uint32_t> m_sampleCounters[TRACE_STAGE_COUNT];
+
+    std::mutex m_spanMutex;
+    std::vector<Span> m_spans;
+    size_t m_nextSpan;
+};
+
+/**
+ * Keeps the trace timestamps of frames in flight inside a codec, which
+ * only carries the RTP timestamp from input to output callback. Input and
+ * output may run on different threads.
+ */
+class TraceTimestampMap {
+public:
+    TraceTimestampMap()
+        : m_next(0)
+    {
+        for (Entry& entry : m_entries) {
+            entry = Entry { 0, 0, 0 };
+        }
+    }
+
+    void push(uint32_t timestamp, int64_t captureTimeUs, int64_t startUs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[m_next] = Entry { timestamp, captureTimeUs, startUs };
+        m_next = (m_next + 1) % kSize;
+    }
+
+    bool pop(uint32_t timestamp, int64_t& captureTimeUs, int64_t& startUs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Entry& entry : m_entries) {
+            if (entry.startUs && entry.timestamp == timestamp) {
+                captureTimeUs = entry.captureTimeUs;
+                startUs = entry.startUs;
+                entry.startUs = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static const size_t kSize = 16;
+    struct Entry {
+        uint32_t timestamp;
+        int64_t captureTimeUs;
+        int64_t startUs;
+    };
+    std::mutex m_mutex;
+    Entry m_entries[kSize];
+    size_t m_next;
+};
+
+} /* namespace owt_base */
+
+#endif /* PipelineTracer_h */
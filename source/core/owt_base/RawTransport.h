@@ -12,6 +12,7 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <logger.h>
+#include <cstring>
 #include <queue>
 #include "IOService.h"
 
@@ -20,6 +21,28 @@ namespace owt_base {
 const char TDT_FEEDBACK_MSG = 0x5A;
 const char TDT_MEDIA_FRAME = 0x8F;
 const char TDT_MEDIA_METADATA = 0x3A;
+// Sent ahead of a TDT_MEDIA_FRAME while PipelineTracer knows its capture
+// time, receivers that do not trace skip it
+const char TDT_FRAME_TRACE = 0x7A;
+
+// Written field by field, the struct padding is never sent
+struct FrameTrace {
+    static const size_t kSize = sizeof(uint32_t) + sizeof(int64_t);
+
+    uint32_t timeStamp;
+    int64_t captureTimeUs;
+
+    void write(uint8_t* buf) const
+    {
+        memcpy(buf, &timeStamp, sizeof(timeStamp));
+        memcpy(buf + sizeof(timeStamp), &captureTimeUs, sizeof(captureTimeUs));
+    }
+    void read(const uint8_t* buf)
+    {
+        memcpy(&timeStamp, buf, sizeof(timeStamp));
+        memcpy(&captureTimeUs, buf + sizeof(timeStamp), sizeof(captureTimeUs));
+    }
+};
 
 enum Protocol {
     TCP = 0,
@@ -25,6 +25,7 @@ SVTHEVCEncoder::SVTHEVCEncoder(FrameFormat format, VideoCodecProfile profile, bo
     , m_frameRate(0)
     , m_bitrateKbps(0)
     , m_keyFrameIntervalSeconds(0)
+    , m_intraRefreshFrames(0)
     , m_handle(NULL)
     , m_forceIDR(false)
     , m_frameCount(0)
@@ -194,6 +195,11 @@ void SVTHEVCEncoder::updateParameters(uint32_t width, uint32_t height, uint32_t
 #else
     m_encParameters.intraPeriodLength   = frameRate >> 1;
 #endif
+    if (m_intraRefreshFrames) {
+        // No gradual refresh in SVT-HEVC, periodFrames is ignored and both
+        // key frame and refresh requests are answered with IDR
+        m_encParameters.intraPeriodLength = -1;
+    }
 
     //framerate
     m_encParameters.frameRate           = frameRate;
@@ -335,6 +341,21 @@ void SVTHEVCEncoder::requestKeyFrame(int32_t streamId)
     m_forceIDR = true;
 }
 
+bool SVTHEVCEncoder::setIntraRefresh(uint32_t periodFrames)
+{
+    boost::unique_lock<boost::shared_mutex> ulock(m_mutex);
+
+    ELOG_DEBUG_T("setIntraRefresh(%u)", periodFrames);
+
+    if (m_dest) {
+        ELOG_WARN_T("setIntraRefresh after stream generated");
+        return false;
+    }
+
+    m_intraRefreshFrames = periodFrames;
+    return true;
+}
+
 void SVTHEVCEncoder::onFrame(const Frame& frame)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
@@ -607,6 +628,13 @@ void SVTHEVCEncoder::fillPacketDone(EB_BUFFERHEADERTYPE* pBufferHeader)
             outFrame.additionalInfo.video.isKeyFrame ? "key" : "delta",
             outFrame.length);
 
+    if (m_frameSizeStats.add(outFrame.length)) {
+        ELOG_DEBUG_T("Frame size peak %u, average %u, peak to average %.2f",
+                m_frameSizeStats.peakBytes(),
+                m_frameSizeStats.averageBytes(),
+                m_frameSizeStats.peakToAverage());
+    }
+
     m_dest->onFrame(outFrame);
 }
 
@@ -14,6 +14,7 @@
 #include <boost/thread.hpp>
 
 #include "logger.h"
+#include "FrameSizeStats.h"
 #include "MediaFramePipeline.h"
 
 #include "svt-hevc/EbApi.h"
@@ -37,6 +38,7 @@ public:
     void degenerateStream(int32_t streamId);
     void setBitrate(unsigned short kbps, int32_t streamId);
     void requestKeyFrame(int32_t streamId);
+    bool setIntraRefresh(uint32_t periodFrames);
 
 protected:
     void initDefaultParameters();
@@ -69,6 +71,7 @@ private:
     uint32_t m_frameRate;
     uint32_t m_bitrateKbps;
     uint32_t m_keyFrameIntervalSeconds;
+    uint32_t m_intraRefreshFrames;
 
     EB_COMPONENTTYPE            *m_handle;
     EB_H265_ENC_CONFIGURATION   m_encParameters;
@@ -80,6 +83,7 @@ private:
     bool m_forceIDR;
     uint32_t m_frameCount;
     uint32_t m_frameEncodedCount;
+    FrameSizeStats m_frameSizeStats;
 
     boost::shared_mutex m_mutex;
 
@@ -0,0 +1,101 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "StreamStatsRegistry.h"
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Stats region is read as plain uint32 values");
+
+namespace owt_base {
+
+StreamStatsRegistry& StreamStatsRegistry::instance()
+{
+    static StreamStatsRegistry registry;
+    return registry;
+}
+
+StreamStatsRegistry::StreamStatsRegistry()
+    : m_values(new std::atomic<uint32_t>[FIELD_COUNT * kCapacity])
+    , m_generation(0)
+{
+    for (uint32_t i = 0; i < FIELD_COUNT * kCapacity; i++) {
+        m_values[i].store(0, std::memory_order_relaxed);
+    }
+    m_freeSlots.reserve(kCapacity);
+    for (int slot = kCapacity - 1; slot >= 0; slot--) {
+        m_freeSlots.push_back(slot);
+    }
+}
+
+int StreamStatsRegistry::allocate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_freeSlots.empty()) {
+        return -1;
+    }
+    int slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    for (int field = GENERATION + 1; field < FIELD_COUNT; field++) {
+        set(slot, static_cast<Field>(field), 0);
+    }
+    if (++m_generation == 0) {
+        m_generation = 1;
+    }
+    m_values[GENERATION * kCapacity + slot].store(m_generation, std::memory_order_release);
+    return slot;
+}
+
+void StreamStatsRegistry::release(int slot)
+{
+    if (slot < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_values[GENERATION * kCapacity + slot].store(0, std::memory_order_release);
+    m_freeSlots.push_back(slot);
+}
+
+const char* StreamStatsRegistry::fieldName(Field field)
+{
+    switch (field) {
+    case GENERATION:
+        return "generation";
+    case WIDTH:
+        return "width";
+    case HEIGHT:
+        return "height";
+    case FRAMES_RECEIVED:
+        return "framesReceived";
+    case BYTES_RECEIVED:
+        return "bytesReceived";
+    case KEY_FRAMES_RECEIVED:
+        return "keyFramesReceived";
+    case FRAMES_SENT:
+        return "framesSent";
+    case BYTES_SENT:
+        return "bytesSent";
+    case SEND_BITRATE_BPS:
+        return "sendBitrate";
+    case RETRANSMIT_BITRATE_BPS:
+        return "retransmitBitrate";
+    case ESTIMATED_BANDWIDTH_BPS:
+        return "estimatedBandwidth";
+    case FRACTION_LOST:
+        return "fractionLost";
+    case RTT_MS:
+        return "rtt";
+    case KEY_FRAME_REQUESTS_RECEIVED:
+        return "keyFrameRequestsReceived";
+    case KEY_FRAME_REQUESTS_FORWARDED:
+        return "keyFrameRequestsForwarded";
+    case FRAMERATE:
+        return "framerate";
+    case QUEUE_DEPTH:
+        return "queueDepth";
+    default:
+        return "";
+    }
+}
+
+} /* namespace owt_base */
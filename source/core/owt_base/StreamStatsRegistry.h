@@ -0,0 +1,116 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef StreamStatsRegistry_h
+#define StreamStatsRegistry_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace owt_base {
+
+/**
+ * Per-stream stats counters in one fixed memory region, shared with
+ * JavaScript as a SharedArrayBuffer. The region is struct-of-arrays:
+ * field f of slot s is the uint32 at index (f * kCapacity + s), so readers
+ * scan a field of all streams contiguously. Each slot has a single writer
+ * and updates are plain relaxed stores, nothing is allocated or serialized.
+ * Cumulative counters wrap around at 2^32, readers take deltas modulo 2^32.
+ */
+class StreamStatsRegistry {
+public:
+    enum Field {
+        // Non-zero while the slot is in use, changes when the slot is reused
+        GENERATION = 0,
+        WIDTH,
+        HEIGHT,
+        FRAMES_RECEIVED,
+        BYTES_RECEIVED,
+        KEY_FRAMES_RECEIVED,
+        FRAMES_SENT,
+        BYTES_SENT,
+        SEND_BITRATE_BPS,
+        RETRANSMIT_BITRATE_BPS,
+        ESTIMATED_BANDWIDTH_BPS,
+        // Fraction of packets lost reported by the remote, in 1/256
+        FRACTION_LOST,
+        RTT_MS,
+        // Key frame requests from downstream, and those sent to the publisher
+        KEY_FRAME_REQUESTS_RECEIVED,
+        KEY_FRAME_REQUESTS_FORWARDED,
+        // Frames per second received or sent, updated about once a second
+        FRAMERATE,
+        // Packets waiting in the pacer of the sending connection
+        QUEUE_DEPTH,
+        FIELD_COUNT
+    };
+
+    static const uint32_t kCapacity = 8192;
+
+    static StreamStatsRegistry& instance();
+
+    // Returns -1 if all slots are in use, writes to slot -1 are ignored.
+    int allocate();
+    void release(int slot);
+
+    void set(int slot, Field field, uint32_t value)
+    {
+        if (slot >= 0) {
+            m_values[field * kCapacity + slot].store(value, std::memory_order_relaxed);
+        }
+    }
+    void add(int slot, Field field, uint32_t value)
+    {
+        if (slot >= 0) {
+            std::atomic<uint32_t>& v = m_values[field * kCapacity + slot];
+            v.store(v.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    }
+    uint32_t get(int slot, Field field) const
+    {
+        return slot >= 0 ? m_values[field * kCapacity + slot].load(std::memory_order_relaxed) : 0;
+    }
+
+    // Counts the frames of one slot, for its single writer
+    class FrameRateMeter {
+    public:
+        void onFrame(int slot, uint64_t nowMs)
+        {
+            if (!m_windowStartMs) {
+                m_windowStartMs = nowMs;
+                return;
+            }
+            m_frames++;
+            if (nowMs - m_windowStartMs >= 1000) {
+                instance().set(slot, FRAMERATE,
+                    (m_frames * 1000 + (nowMs - m_windowStartMs) / 2) / (nowMs - m_windowStartMs));
+                m_windowStartMs = nowMs;
+                m_frames = 0;
+            }
+        }
+
+    private:
+        uint64_t m_windowStartMs = 0;
+        uint32_t m_frames = 0;
+    };
+
+    void* data() { return m_values.get(); }
+    size_t size() const { return sizeof(uint32_t) * FIELD_COUNT * kCapacity; }
+    static const char* fieldName(Field);
+
+private:
+    StreamStatsRegistry();
+
+    std::unique_ptr<std::atomic<uint32_t>[]> m_values;
+    std::mutex m_mutex;
+    std::vector<int> m_freeSlots;
+    uint32_t m_generation;
+};
+
+} /* namespace owt_base */
+
+#endif /* StreamStatsRegistry_h */
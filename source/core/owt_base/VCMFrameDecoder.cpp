@@ -101,9 +101,17 @@ int32_t VCMFrameDecoder::Decoded(VideoFrame& decodedImage)
     frame.additionalInfo.video.width = decodedImage.width();
     frame.additionalInfo.video.height = decodedImage.height();
 
-    ELOG_TRACE_T("deliverFrame, %dx%d",
+    int64_t captureTimeUs = 0;
+    int64_t startUs = 0;
+    if (PipelineTracer::enabled()
+        && m_traceTimestamps.pop(frame.timeStamp, captureTimeUs, startUs)) {
+        PipelineTracer::instance().record(TRACE_STAGE_DECODE, captureTimeUs, startUs);
+    }
+
+    ELOG_TRACE_ASYNC_T("deliverFrame, %dx%d",
         frame.additionalInfo.video.width,
         frame.additionalInfo.video.height);
+    PipelineTracer::CaptureScope scope(captureTimeUs);
     deliverFrame(frame);
     return 0;
 }
@@ -113,7 +121,7 @@ void VCMFrameDecoder::onFrame(const Frame& frame)
     if (!m_needDecode)
         return;
 
-    ELOG_TRACE_T("onFrame(%s), %s, %dx%d, length(%d)",
+    ELOG_TRACE_ASYNC_T("onFrame(%s), %s, %dx%d, length(%d)",
         getFormatStr(frame.format),
         frame.additionalInfo.video.isKeyFrame ? "key" : "delta",
         frame.additionalInfo.video.width,
@@ -161,6 +169,11 @@ void VCMFrameDecoder::onFrame(const Frame& frame)
     image._timeStamp = frame.timeStamp;
     image._encodedWidth = frame.additionalInfo.video.width;
     image._encodedHeight = frame.additionalInfo.video.height;
+    if (PipelineTracer::enabled()) {
+        int64_t startUs = PipelineTracer::nowUs();
+        int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+        m_traceTimestamps.push(frame.timeStamp, captureTimeUs ? captureTimeUs : startUs, startUs);
+    }
     int ret = m_decoder->Decode(image, false, nullptr, &m_codecInfo);
     if (ret != 0) {
         ELOG_ERROR_T("Decode frame error: %d", ret);
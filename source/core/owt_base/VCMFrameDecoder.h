@@ -6,6 +6,7 @@
 #define VCMFrameDecoder_h
 
 #include "MediaFramePipeline.h"
+#include "PipelineTracer.h"
 
 #include <boost/scoped_ptr.hpp>
 #include <logger.h>
@@ -39,6 +40,7 @@ private:
     bool m_needKeyFrame;
     webrtc::CodecSpecificInfo m_codecInfo;
     boost::scoped_ptr<webrtc::VideoDecoder> m_decoder;
+    TraceTimestampMap m_traceTimestamps;
 };
 
 } /* namespace owt_base */
@@ -32,6 +32,8 @@ VCMFrameEncoder::VCMFrameEncoder(FrameFormat format, VideoCodecProfile profile,
     , m_height(0)
     , m_frameRate(0)
     , m_bitrateKbps(0)
+    , m_intraRefreshFrames(0)
+    , m_gradualRefresh(false)
     , m_enableBsDump(false)
     , m_bsDumpfp(nullptr)
 {
@@ -135,6 +137,14 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
             codecSettings.VP8()->tl_factory = &tl_factory_;
 
             codecSettings.VP8()->keyFrameInterval = frameRate * keyFrameIntervalSeconds;
+            if (m_intraRefreshFrames) {
+                // Error resilient mode turns on cyclic refresh of libvpx. Its
+                // period is not configurable through webrtc and does not
+                // guarantee recovery, so periodFrames is ignored and refresh
+                // requests are answered with key frames.
+                codecSettings.VP8()->resilience = kResilientStream;
+                codecSettings.VP8()->keyFrameInterval = 0;
+            }
             break;
         case FRAME_FORMAT_VP9:
             if (m_profile != PROFILE_UNKNOWN) {
@@ -148,12 +158,28 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
             codecSettings.VP9()->numberOfSpatialLayers = 1;
 
             codecSettings.VP9()->keyFrameInterval = frameRate * keyFrameIntervalSeconds;
+            if (m_intraRefreshFrames) {
+                // Only periodic key frames are turned off, cyclic refresh aq
+                // mode is already on by default. As with VP8 periodFrames is
+                // ignored and refresh requests are answered with key frames.
+                codecSettings.VP9()->keyFrameInterval = 0;
+            }
             break;
         case FRAME_FORMAT_H264:
             if (m_profile != PROFILE_AVC_CONSTRAINED_BASELINE) {
                 ELOG_WARN_T("Only support profile (Constrained Baseline), required (%d)", m_profile);
             }
-            m_encoder.reset(new NVH264GStreamerVideoEncoder({}));
+            if (m_intraRefreshFrames && X264GStreamerVideoEncoder::isSupported()) {
+                auto x264Encoder = new X264GStreamerVideoEncoder({});
+                x264Encoder->setIntraRefresh(true);
+                m_encoder.reset(x264Encoder);
+            } else {
+                if (m_intraRefreshFrames) {
+                    ELOG_WARN_T("No intra refresh capable H264 encoder, keep periodic key frames");
+                    m_intraRefreshFrames = 0;
+                }
+                m_encoder.reset(new NVH264GStreamerVideoEncoder({}));
+            }
             if (!m_encoder) {
                 m_encoder.reset(H264Encoder::Create(cricket::VideoCodec(cricket::kH264CodecName)));
             }
@@ -161,6 +187,11 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
             codecSettings.H264()->frameDroppingOn = true;
 
             codecSettings.H264()->keyFrameInterval = frameRate * keyFrameIntervalSeconds;
+            if (m_intraRefreshFrames) {
+                // x264 refreshes over key-int-max frames in intra refresh mode
+                codecSettings.H264()->keyFrameInterval = m_intraRefreshFrames;
+                m_gradualRefresh = true;
+            }
             break;
         default:
             ELOG_ERROR_T("Invalid encoder(%s)", getFormatStr(m_encodeFormat));
@@ -245,7 +276,7 @@ int32_t VCMFrameEncoder::generateStream(uint32_t width, uint32_t height, uint32_
     encodeOut.reset(new EncodeOut(m_streamId, this, dest));
     OutStream stream = { .width = width, .height = height, .simulcastId = simulcastId, .encodeOut = encodeOut };
     m_streams[m_streamId] = stream;
-    ELOG_DEBUG_T("generateStream: {.width=%d, .height=%d, .frameRate=%d, .bitrateKbps=%d, .keyFrameIntervalSeconds=%d}, simulcastId=%d, adaptiveMode=%d", width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds, simulcastId, m_isAdaptiveMode);
+    ELOG_DEBUG_T("generateStream: {.width=%d, .height=%d, .frameRate=%d, .bitrateKbps=%d, .keyFrameIntervalSeconds=%d}, simulcastId=%d, adaptiveMode=%d, intraRefreshFrames=%u", width, height, frameRate, bitrateKbps, keyFrameIntervalSeconds, simulcastId, m_isAdaptiveMode, m_intraRefreshFrames);
 
     m_width = width;
     m_height = height;
@@ -304,6 +335,33 @@ void VCMFrameEncoder::requestKeyFrame(int32_t streamId)
     }
 }
 
+void VCMFrameEncoder::requestRefresh(int32_t streamId)
+{
+    if (m_gradualRefresh) {
+        // The running refresh recovers the receiver within a period
+        ELOG_DEBUG_T("requestRefresh(%d), left to intra refresh", streamId);
+        return;
+    }
+    requestKeyFrame(streamId);
+}
+
+bool VCMFrameEncoder::setIntraRefresh(uint32_t periodFrames)
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    if (m_encoder) {
+        ELOG_WARN_T("setIntraRefresh after encoder created");
+        return false;
+    }
+
+    if (m_encodeFormat == FRAME_FORMAT_H264 && periodFrames && !X264GStreamerVideoEncoder::isSupported()) {
+        return false;
+    }
+
+    m_intraRefreshFrames = periodFrames;
+    return true;
+}
+
 void VCMFrameEncoder::onFrame(const Frame& frame)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_mutex);
@@ -312,6 +370,12 @@ void VCMFrameEncoder::onFrame(const Frame& frame)
         return;
     }
 
+    if (PipelineTracer::enabled()) {
+        int64_t startUs = PipelineTracer::nowUs();
+        int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+        m_traceTimestamps.push(frame.timeStamp, captureTimeUs ? captureTimeUs : startUs, startUs);
+    }
+
     boost::shared_ptr<webrtc::VideoFrame> videoFrame = frameConvert(frame);
     if (videoFrame == nullptr) {
         return;
@@ -424,7 +488,14 @@ webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const Encod
         frame.additionalInfo.video.height = encoded_frame._encodedHeight;
         frame.additionalInfo.video.isKeyFrame = (encoded_frame._frameType == kVideoFrameKey);
 
-        ELOG_TRACE_T("SendData, %s, %dx%d, %s, length(%d), timestamp %d",
+        int64_t captureTimeUs = 0;
+        int64_t startUs = 0;
+        if (PipelineTracer::enabled()
+            && m_traceTimestamps.pop(frame.timeStamp, captureTimeUs, startUs)) {
+            PipelineTracer::instance().record(TRACE_STAGE_ENCODE, captureTimeUs, startUs);
+        }
+
+        ELOG_TRACE_ASYNC_T("SendData, %s, %dx%d, %s, length(%d), timestamp %d",
             getFormatStr(frame.format),
             frame.additionalInfo.video.width,
             frame.additionalInfo.video.height,
@@ -434,6 +505,14 @@ webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const Encod
 
         dump(frame.payload, frame.length);
 
+        if (m_frameSizeStats.add(frame.length)) {
+            ELOG_DEBUG_T("Frame size peak %u, average %u, peak to average %.2f",
+                m_frameSizeStats.peakBytes(),
+                m_frameSizeStats.averageBytes(),
+                m_frameSizeStats.peakToAverage());
+        }
+
+        PipelineTracer::CaptureScope scope(captureTimeUs);
         auto it = m_streams.begin();
         for (; it != m_streams.end(); ++it) {
             if (it->second.encodeOut.get() && it->second.simulcastId == 0)
@@ -20,8 +20,10 @@
 #include <webrtc/modules/video_coding/codecs/vp9/include/vp9.h>
 
 #include "FrameConverter.h"
+#include "FrameSizeStats.h"
 #include "I420BufferManager.h"
 #include "MediaFramePipeline.h"
+#include "PipelineTracer.h"
 #include "logger.h"
 
 using namespace webrtc;
@@ -47,6 +49,8 @@ public:
         if (msg.type == owt_base::VIDEO_FEEDBACK) {
             if (msg.cmd == REQUEST_KEY_FRAME) {
                 m_owner->requestKeyFrame(m_streamId);
+            } else if (msg.cmd == REQUEST_REFRESH) {
+                m_owner->requestRefresh(m_streamId);
             } else if (msg.cmd == SET_BITRATE) {
                 m_owner->setBitrate(msg.data.kbps, m_streamId);
             }
@@ -96,6 +100,8 @@ public:
     void degenerateStream(int32_t streamId);
     void setBitrate(unsigned short kbps, int32_t streamId);
     void requestKeyFrame(int32_t streamId);
+    void requestRefresh(int32_t streamId);
+    bool setIntraRefresh(uint32_t periodFrames);
 
 protected:
     static void Encode(VCMFrameEncoder* This, boost::shared_ptr<webrtc::VideoFrame> videoFrame) { This->encode(videoFrame); };
@@ -137,8 +143,13 @@ private:
     int32_t m_height;
     uint32_t m_frameRate;
     uint32_t m_bitrateKbps;
+    uint32_t m_intraRefreshFrames;
+    // Encoder refreshes the picture by itself
+    std::atomic<bool> m_gradualRefresh;
 
     boost::scoped_ptr<FrameConverter> m_converter;
+    FrameSizeStats m_frameSizeStats;
+    TraceTimestampMap m_traceTimestamps;
 
     bool m_enableBsDump;
     FILE* m_bsDumpfp;
@@ -18,7 +18,6 @@ VideoFrameConstructor::VideoFrameConstructor(VideoInfoListener* vil, uint32_t tr
     : m_enabled(true)
     , m_ssrc(0)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
     , m_videoInfoListener(vil)
     , m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
     , m_videoReceive(nullptr)
@@ -34,7 +33,6 @@ VideoFrameConstructor::VideoFrameConstructor(
     : m_enabled(true)
     , m_ssrc(0)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
     , m_videoInfoListener(vil)
     , m_videoReceive(nullptr)
 {
@@ -49,7 +47,6 @@ VideoFrameConstructor::VideoFrameConstructor(KeyFrameRequester* requester)
     : m_enabled(true)
     , m_ssrc(0)
     , m_transport(nullptr)
-    , m_pendingKeyFrameRequests(0)
     , m_videoInfoListener(nullptr)
     , m_rtcAdapter(RtcAdapterFactory::CreateRtcAdapter())
     , m_videoReceive(nullptr)
@@ -69,6 +66,7 @@ VideoFrameConstructor::~VideoFrameConstructor()
         m_rtcAdapter.reset();
         m_videoReceive = nullptr;
     }
+    StreamStatsRegistry::instance().release(m_statsSlot);
 }
 
 void VideoFrameConstructor::maybeCreateReceiveVideo(uint32_t ssrc)
@@ -79,6 +77,7 @@ void VideoFrameConstructor::maybeCreateReceiveVideo(uint32_t ssrc)
         rtc_adapter::RtcAdapter::Config recvConfig;
         recvConfig.ssrc = ssrc;
         recvConfig.transport_cc = m_config.transport_cc;
+        recvConfig.frame_assembler = m_config.frame_assembler;
         recvConfig.rtp_listener = this;
         recvConfig.stats_listener = this;
         recvConfig.frame_listener = this;
@@ -149,6 +148,16 @@ void VideoFrameConstructor::setPreferredLayers(int spatialId, int temporalId)
     }
 }
 
+void VideoFrameConstructor::setFrameAssembler(bool enabled)
+{
+    m_config.frame_assembler = enabled;
+}
+
+void VideoFrameConstructor::setKeyFrameMinInterval(uint32_t ms)
+{
+    m_keyFrameArbiter.setMinInterval(ms);
+}
+
 bool VideoFrameConstructor::addChildProcessor(std::string id, erizo::MediaSink* sink)
 {
     if (m_childProcessors.count(id) == 0 && sink) {
@@ -171,21 +180,41 @@ bool VideoFrameConstructor::removeChildProcessor(std::string id)
 
 void VideoFrameConstructor::onAdapterFrame(const Frame& frame)
 {
+    StreamStatsRegistry& registry = StreamStatsRegistry::instance();
+    registry.add(m_statsSlot, StreamStatsRegistry::FRAMES_RECEIVED, 1);
+    registry.add(m_statsSlot, StreamStatsRegistry::BYTES_RECEIVED, frame.length);
+    uint64_t nowMs = KeyFrameArbiter::nowMs();
+    m_frameRate.onFrame(m_statsSlot, nowMs);
+    if (frame.additionalInfo.video.isKeyFrame) {
+        registry.add(m_statsSlot, StreamStatsRegistry::KEY_FRAMES_RECEIVED, 1);
+        m_keyFrameArbiter.onKeyFrame(nowMs);
+    } else if (m_keyFrameArbiter.poll(nowMs)) {
+        forwardKeyFrameRequest();
+    }
     if (m_enabled) {
-        deliverFrame(frame);
+        if (PipelineTracer::enabled()) {
+            // Adapters set the first packet arrival, the receive stage is
+            // the time to assemble the frame. Destinations deliver
+            // synchronously, record before their stages
+            int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+            if (!captureTimeUs) {
+                captureTimeUs = PipelineTracer::nowUs();
+            }
+            PipelineTracer::instance().record(TRACE_STAGE_RECEIVE, captureTimeUs, captureTimeUs);
+            PipelineTracer::CaptureScope scope(captureTimeUs);
+            deliverFrame(frame);
+        } else {
+            deliverFrame(frame);
+        }
     }
 }
 
 void VideoFrameConstructor::onAdapterStats(const AdapterStats& stats)
 {
+    StreamStatsRegistry::instance().set(m_statsSlot, StreamStatsRegistry::WIDTH, stats.width);
+    StreamStatsRegistry::instance().set(m_statsSlot, StreamStatsRegistry::HEIGHT, stats.height);
     if (m_videoInfoListener) {
-        std::ostringstream json_str;
-        json_str.str("");
-        json_str << "{\"video\": {\"parameters\": {\"resolution\": {"
-                 << "\"width\":" << stats.width << ", "
-                 << "\"height\":" << stats.height
-                 << "}}}}";
-        m_videoInfoListener->onVideoInfo(json_str.str().c_str());
+        m_videoInfoListener->onVideoInfoChanged(stats.width, stats.height);
     }
 }
 
@@ -250,20 +279,45 @@ int VideoFrameConstructor::deliverAudioData_(std::shared_ptr<erizo::DataPacket>
 
 void VideoFrameConstructor::onTimeout()
 {
-    if (m_pendingKeyFrameRequests > 1) {
-        RequestKeyFrame();
+    // Frames may stop while a request is held back
+    if (m_keyFrameArbiter.poll(KeyFrameArbiter::nowMs())) {
+        forwardKeyFrameRequest();
+    }
+}
+
+void VideoFrameConstructor::forwardKeyFrameRequest()
+{
+    StreamStatsRegistry::instance().add(m_statsSlot, StreamStatsRegistry::KEY_FRAME_REQUESTS_FORWARDED, 1);
+    RequestKeyFrame();
+}
+
+void VideoFrameConstructor::deliverKeyFrameEta(uint64_t nowMs)
+{
+    int32_t eta = m_keyFrameArbiter.keyFrameEta(nowMs);
+    if (eta >= 0) {
+        MetaData metadata;
+        metadata.type = META_DATA_KEY_FRAME_ETA;
+        metadata.payload = reinterpret_cast<uint8_t*>(&eta);
+        metadata.length = sizeof(eta);
+        deliverMetaData(metadata);
     }
-    m_pendingKeyFrameRequests = 0;
 }
 
 void VideoFrameConstructor::onFeedback(const FeedbackMsg& msg)
 {
     if (msg.type == owt_base::VIDEO_FEEDBACK) {
-        if (msg.cmd == REQUEST_KEY_FRAME) {
-            if (!m_pendingKeyFrameRequests) {
-                RequestKeyFrame();
+        // Received streams are not refreshed gradually on request
+        if (msg.cmd == REQUEST_KEY_FRAME || msg.cmd == REQUEST_REFRESH) {
+            StreamStatsRegistry::instance().add(m_statsSlot, StreamStatsRegistry::KEY_FRAME_REQUESTS_RECEIVED, 1);
+            uint64_t nowMs = KeyFrameArbiter::nowMs();
+            KeyFrameArbiter::Decision decision = m_keyFrameArbiter.onRequest(nowMs);
+            if (decision == KeyFrameArbiter::FORWARD) {
+                forwardKeyFrameRequest();
+            }
+            // Tell requesters once per request cycle when to expect the key frame
+            if (decision != KeyFrameArbiter::COALESCED) {
+                deliverKeyFrameEta(nowMs);
             }
-            ++m_pendingKeyFrameRequests;
         } else if (msg.cmd == SET_BITRATE) {
             this->setBitrate(msg.data.kbps);
         }
@@ -5,7 +5,10 @@
 #ifndef VideoFrameConstructor_h
 #define VideoFrameConstructor_h
 
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
+#include "PipelineTracer.h"
+#include "StreamStatsRegistry.h"
 
 #include <MediaDefinitionExtra.h>
 #include <MediaDefinitions.h>
@@ -21,7 +24,8 @@ namespace owt_base {
 class VideoInfoListener {
 public:
     virtual ~VideoInfoListener(){};
-    virtual void onVideoInfo(const std::string& videoInfoJSON) = 0;
+    // Resolution of the stream has changed, also in its StreamStatsRegistry slot
+    virtual void onVideoInfoChanged(uint32_t width, uint32_t height) = 0;
 };
 
 class KeyFrameRequester {
@@ -47,6 +51,7 @@ class VideoFrameConstructor : public erizo::MediaSink,
 public:
     struct Config {
         uint32_t transport_cc = 0;
+        bool frame_assembler = false;
     };
 
     VideoFrameConstructor(VideoInfoListener*, uint32_t transportccExtId = 0);
@@ -79,14 +84,23 @@ public:
     bool setBitrate(uint32_t kbps);
 
     void setPreferredLayers(int spatialId, int temporalId);
+    // Use the lightweight frame assembler for the next receiver
+    void setFrameAssembler(bool enabled);
+    // Minimal interval(ms) between key frame requests sent to the publisher
+    void setKeyFrameMinInterval(uint32_t ms);
 
     bool addChildProcessor(std::string id, erizo::MediaSink* sink);
     bool removeChildProcessor(std::string id);
 
+    // Slot of this stream in StreamStatsRegistry, -1 if the registry is full
+    int statsSlot() const { return m_statsSlot; }
+
 private:
     Config m_config;
 
     void maybeCreateReceiveVideo(uint32_t ssrc);
+    void forwardKeyFrameRequest();
+    void deliverKeyFrameEta(uint64_t nowMs);
 
     // Implement erizo::MediaSink
     int deliverAudioData_(std::shared_ptr<erizo::DataPacket> audio_packet) override;
@@ -100,7 +114,7 @@ private:
     erizo::MediaSource* m_transport;
     boost::shared_mutex m_transportMutex;
     std::shared_ptr<SharedJobTimer> m_feedbackTimer;
-    uint32_t m_pendingKeyFrameRequests;
+    KeyFrameArbiter m_keyFrameArbiter;
 
     VideoInfoListener* m_videoInfoListener;
 
@@ -111,6 +125,8 @@ private:
     int m_currentSpatialLayer = -1;
     int m_currentTemporalLayer = -1;
     KeyFrameRequester* m_requester = nullptr;
+    int m_statsSlot = StreamStatsRegistry::instance().allocate();
+    StreamStatsRegistry::FrameRateMeter m_frameRate;
 };
 
 } // namespace owt_base
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "VideoFramePacketizer.h"
+#include "DataPacketPool.h"
 #include "MediaUtilities.h"
 #include <rtputils.h>
 
@@ -28,6 +29,7 @@ VideoFramePacketizer::VideoFramePacketizer(VideoFramePacketizer::Config& config)
     , m_sendFrameCount(0)
     , m_rtcAdapter(config.rtcAdapter)
     , m_videoSend(nullptr)
+    , m_keyFrameDueMs(0)
 {
     video_sink_ = nullptr;
     if (!m_rtcAdapter) {
@@ -54,6 +56,7 @@ VideoFramePacketizer::~VideoFramePacketizer()
         m_rtcAdapter.reset();
         m_videoSend = nullptr;
     }
+    StreamStatsRegistry::instance().release(m_statsSlot);
 }
 
 bool VideoFramePacketizer::init(VideoFramePacketizer::Config& config)
@@ -77,6 +80,9 @@ bool VideoFramePacketizer::init(VideoFramePacketizer::Config& config)
         }
         if (config.enableBandwidthEstimation) {
             sendConfig.bandwidth_estimation = true;
+            sendConfig.priority = config.priority;
+            sendConfig.min_bitrate_bps = config.minBitrateBps;
+            sendConfig.max_bitrate_bps = config.maxBitrateBps;
         }
         sendConfig.feedback_listener = this;
         sendConfig.rtp_listener = this;
@@ -152,14 +158,41 @@ void VideoFramePacketizer::onTimeout()
         uint32_t bandwidthBps = stats.estimated_bandwidth;
         ELOG_DEBUG("Estimated bandwidth: %u", bandwidthBps);
 
+        StreamStatsRegistry& registry = StreamStatsRegistry::instance();
+        registry.set(m_statsSlot, StreamStatsRegistry::SEND_BITRATE_BPS, stats.total_bitrate_bps);
+        registry.set(m_statsSlot, StreamStatsRegistry::RETRANSMIT_BITRATE_BPS, stats.retransmit_bitrate_bps);
+        registry.set(m_statsSlot, StreamStatsRegistry::ESTIMATED_BANDWIDTH_BPS, bandwidthBps);
+        registry.set(m_statsSlot, StreamStatsRegistry::FRACTION_LOST, stats.fraction_lost);
+        registry.set(m_statsSlot, StreamStatsRegistry::RTT_MS, stats.rtt_ms);
+        registry.set(m_statsSlot, StreamStatsRegistry::QUEUE_DEPTH, stats.queued_packets);
+
         FeedbackMsg msg(VIDEO_FEEDBACK, SET_BITRATE);
         msg.data.kbps = bandwidthBps / 1000;
         deliverFeedbackMsg(msg);
     }
 }
 
+void VideoFramePacketizer::onMetaData(const MetaData& metadata)
+{
+    if (metadata.type == META_DATA_LAYER_BITRATES && m_videoSend) {
+        const uint32_t* bitrates = reinterpret_cast<const uint32_t*>(metadata.payload);
+        std::vector<uint32_t> layers(bitrates, bitrates + metadata.length / sizeof(uint32_t));
+        m_videoSend->setLayerBitrates(layers);
+    } else if (metadata.type == META_DATA_KEY_FRAME_ETA && metadata.length >= sizeof(int32_t)) {
+        int32_t eta = *reinterpret_cast<const int32_t*>(metadata.payload);
+        m_keyFrameDueMs = KeyFrameArbiter::nowMs() + eta;
+    }
+}
+
 void VideoFramePacketizer::onFeedback(const FeedbackMsg& msg)
 {
+    if (msg.type == VIDEO_FEEDBACK && (msg.cmd == REQUEST_KEY_FRAME || msg.cmd == REQUEST_REFRESH)) {
+        uint64_t dueMs = m_keyFrameDueMs;
+        if (dueMs && KeyFrameArbiter::nowMs() < dueMs) {
+            ELOG_TRACE("Key frame request dropped, key frame is due");
+            return;
+        }
+    }
     deliverFeedbackMsg(msg);
 }
 
@@ -172,12 +205,15 @@ void VideoFramePacketizer::onAdapterStats(const rtc_adapter::AdapterStats& stats
 
 void VideoFramePacketizer::onAdapterData(char* data, int len)
 {
+    // Copied out of the adapter before taking the transport lock
+    std::shared_ptr<erizo::DataPacket> packet =
+        DataPacketPool::GetInstance().get(data, len, erizo::VIDEO_PACKET);
     boost::shared_lock<boost::shared_mutex> lock(m_transportMutex);
     if (!video_sink_) {
         return;
     }
 
-    video_sink_->deliverVideoData(std::make_shared<erizo::DataPacket>(0, data, len, erizo::VIDEO_PACKET));
+    video_sink_->deliverVideoData(std::move(packet));
 }
 
 void VideoFramePacketizer::onFrame(const Frame& frame)
@@ -201,8 +237,21 @@ void VideoFramePacketizer::onFrame(const Frame& frame)
         }
     }
 
+    if (frame.additionalInfo.video.isKeyFrame) {
+        m_keyFrameDueMs = 0;
+    }
+
     if (m_videoSend) {
+        int64_t startUs = PipelineTracer::enabled() ? PipelineTracer::nowUs() : 0;
         m_videoSend->onFrame(frame);
+        if (startUs) {
+            int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+            PipelineTracer::instance().record(TRACE_STAGE_PACKETIZE,
+                captureTimeUs ? captureTimeUs : startUs, startUs);
+        }
+        StreamStatsRegistry::instance().add(m_statsSlot, StreamStatsRegistry::FRAMES_SENT, 1);
+        StreamStatsRegistry::instance().add(m_statsSlot, StreamStatsRegistry::BYTES_SENT, frame.length);
+        m_frameRate.onFrame(m_statsSlot, KeyFrameArbiter::nowMs());
     }
 }
 
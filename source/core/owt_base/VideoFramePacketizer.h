@@ -5,11 +5,15 @@
 #ifndef VideoFramePacketizer_h
 #define VideoFramePacketizer_h
 
+#include "KeyFrameArbiter.h"
 #include "MediaFramePipeline.h"
+#include "PipelineTracer.h"
+#include "StreamStatsRegistry.h"
 
 #include <MediaDefinitionExtra.h>
 #include <MediaDefinitions.h>
 
+#include <atomic>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
@@ -44,6 +48,10 @@ public:
         uint32_t midExtId = 0;
         std::shared_ptr<rtc_adapter::RtcAdapter> rtcAdapter;
         bool enableBandwidthEstimation = false;
+        // Share of the estimated bandwidth against other senders
+        int priority = 1;
+        uint32_t minBitrateBps = 0;
+        uint32_t maxBitrateBps = 0;
     };
     VideoFramePacketizer(Config& config);
     ~VideoFramePacketizer();
@@ -55,10 +63,13 @@ public:
     uint32_t getTotalBitrate();
     uint32_t getRetransmitBitrate();
     uint32_t getEstimatedBandwidth();
+    // Slot of this stream in StreamStatsRegistry, -1 if the registry is full
+    int statsSlot() const { return m_statsSlot; }
 
     // Implements FrameDestination.
     void onFrame(const Frame&);
     void onVideoSourceChanged() override;
+    void onMetaData(const MetaData&) override;
 
     // Implements erizo::MediaSource.
     int sendFirPacket();
@@ -97,6 +108,10 @@ private:
     rtc_adapter::VideoSendAdapter* m_videoSend;
 
     std::shared_ptr<SharedJobTimer> m_feedbackTimer;
+    // Key frame requests are dropped until this time(ms), 0 if none is due
+    std::atomic<uint64_t> m_keyFrameDueMs;
+    int m_statsSlot = StreamStatsRegistry::instance().allocate();
+    StreamStatsRegistry::FrameRateMeter m_frameRate;
 };
 }
 #endif /* EncodedVideoFrameSender_h */
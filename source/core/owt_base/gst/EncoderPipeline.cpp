@@ -27,6 +27,8 @@ GStreamerEncoderPipeline::~GStreamerEncoderPipeline()
 {
     if (_pipeline) {
         disconnectBusMessageCallback(_pipeline);
+        // Stop the streaming threads before the sample callback goes away
+        gst_element_set_state(GST_ELEMENT(_pipeline.get()), GST_STATE_NULL);
     }
 }
 
@@ -92,16 +94,48 @@ void GStreamerEncoderPipeline::setKeyframeInterval(int interval)
         static_cast<guint>(interval));
 }
 
+bool GStreamerEncoderPipeline::setIntraRefresh(bool enabled)
+{
+    if (!_encoder || _encoderIntraRefreshPropertyName.empty()) {
+        return false;
+    }
+
+    g_object_set(_encoder.get(), _encoderIntraRefreshPropertyName.c_str(), enabled ? TRUE : FALSE, nullptr);
+    return true;
+}
+
 GstFlowReturn
 GStreamerEncoderPipeline::pushSample(gst::unique_ptr<GstSample>& sample)
 {
     return gst_app_src_push_sample(GST_APP_SRC(_src.get()), sample.get());
 }
 
-gst::unique_ptr<GstSample> GStreamerEncoderPipeline::tryPullSample()
+void GStreamerEncoderPipeline::setSampleCallback(SampleCallback callback)
 {
-    return gst::unique_from_ptr(
-        gst_app_sink_try_pull_sample(GST_APP_SINK(_sink.get()), GST_SECOND));
+    if (!_sink) {
+        return;
+    }
+
+    _sampleCallback = std::move(callback);
+
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = &GStreamerEncoderPipeline::onNewSample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(_sink.get()), &callbacks, this, nullptr);
+}
+
+GstFlowReturn GStreamerEncoderPipeline::onNewSample(GstAppSink* sink, gpointer userData)
+{
+    auto self = static_cast<GStreamerEncoderPipeline*>(userData);
+
+    auto sample = gst::unique_from_ptr(gst_app_sink_pull_sample(sink));
+    if (!sample) {
+        return GST_FLOW_ERROR;
+    }
+
+    if (self->_sampleCallback) {
+        self->_sampleCallback(std::move(sample));
+    }
+    return GST_FLOW_OK;
 }
 
 int32_t
@@ -109,12 +143,14 @@ GStreamerEncoderPipeline::initialize(string encoderBitRatePropertyName,
     BitRateUnit encoderBitRatePropertyUnit,
     string encoderKeyframeIntervalPropertyName,
     string_view capsStr,
-    string_view encoderPipeline)
+    string_view encoderPipeline,
+    string intraRefreshPropertyName)
 {
     _encoderBitRatePropertyName = std::move(encoderBitRatePropertyName);
     _encoderBitRatePropertyUnit = encoderBitRatePropertyUnit;
     _encoderKeyframeIntervalPropertyName = std::move(
         encoderKeyframeIntervalPropertyName);
+    _encoderIntraRefreshPropertyName = std::move(intraRefreshPropertyName);
 
     if (_pipeline) {
         disconnectBusMessageCallback(_pipeline);
@@ -8,6 +8,9 @@
 
 #include <logger.h>
 
+#include <gst/app/gstappsink.h>
+
+#include <functional>
 #include <string_view>
 
 namespace owt_base {
@@ -19,6 +22,7 @@ class GStreamerEncoderPipeline {
     std::string _encoderBitRatePropertyName;
     BitRateUnit _encoderBitRatePropertyUnit;
     std::string _encoderKeyframeIntervalPropertyName;
+    std::string _encoderIntraRefreshPropertyName;
 
     gst::unique_ptr<GstPipeline> _pipeline;
     gst::unique_ptr<GstElement> _src;
@@ -30,25 +34,36 @@ class GStreamerEncoderPipeline {
     gst::unique_ptr<GError> _error;
 
 public:
+    using SampleCallback = std::function<void(gst::unique_ptr<GstSample>)>;
+
     GStreamerEncoderPipeline();
     ~GStreamerEncoderPipeline();
 
     void forceKeyFrame();
     void setBitRate(uint32_t bitRate);
     void setKeyframeInterval(int interval);
+    // Returns false if the encoder has no intra refresh property
+    bool setIntraRefresh(bool enabled);
     void setResolution(uint32_t width, uint32_t height);
 
     GstFlowReturn pushSample(gst::unique_ptr<GstSample>& sample);
-    gst::unique_ptr<GstSample> tryPullSample();
+
+    // Encoded samples are handed to |callback| on the pipeline's streaming
+    // thread as soon as they reach the appsink, instead of being pulled.
+    void setSampleCallback(SampleCallback callback);
 
     int32_t initialize(std::string encoderBitRatePropertyName,
         BitRateUnit bitRatePropertyUnit,
         std::string keyframeIntervalPropertyName,
         std::string_view capsStr,
-        std::string_view encoderPipeline);
+        std::string_view encoderPipeline,
+        std::string intraRefreshPropertyName = "");
 
 private:
     void setEncoderProperty(const std::string& name, guint value);
+    static GstFlowReturn onNewSample(GstAppSink* sink, gpointer userData);
+
+    SampleCallback _sampleCallback;
 };
 } // namespace owt_base
 
@@ -18,12 +18,14 @@ H264GStreamerVideoEncoder::H264GStreamerVideoEncoder(
     string encoderBitratePropertyName,
     BitRateUnit bitRatePropertyUnit,
     string keyframeIntervalPropertyName,
-    const char* additionalMediaTypeCaps)
+    const char* additionalMediaTypeCaps,
+    string intraRefreshPropertyName)
     : GStreamerVideoEncoder(mediaTypeCaps(parameters) + additionalMediaTypeCaps,
         std::move(encoderPipeline),
         std::move(encoderBitratePropertyName),
         bitRatePropertyUnit,
-        std::move(keyframeIntervalPropertyName))
+        std::move(keyframeIntervalPropertyName),
+        std::move(intraRefreshPropertyName))
 {
     auto packetizationModeIt = parameters.find(
         cricket::kH264FmtpPacketizationMode);
@@ -133,3 +135,20 @@ string NVH264GStreamerVideoEncoder::profileFromParameters(
     }
     return "0";
 }
+
+X264GStreamerVideoEncoder::X264GStreamerVideoEncoder(
+    const Parameters& parameters)
+    : H264GStreamerVideoEncoder(
+        parameters,
+        "videoconvert name=converter ! "
+        "x264enc name=encoder tune=zerolatency speed-preset=ultrafast ! h264parse",
+        "bitrate", BitRateUnit::KBitPerSec, "key-int-max", "", "intra-refresh")
+{
+}
+
+bool X264GStreamerVideoEncoder::isSupported()
+{
+    return gst::elementFactoryExists("x264enc") && gst::testEncoderDecoderPipeline("videoconvert ! x264enc");
+}
+
+bool X264GStreamerVideoEncoder::isHardwareAccelerated() { return false; }
@@ -23,7 +23,8 @@ public:
         std::string encoderBitratePropertyName,
         BitRateUnit bitRatePropertyUnit,
         std::string keyframeIntervalPropertyName,
-        const char* additionalMediaTypeCaps = "");
+        const char* additionalMediaTypeCaps = "",
+        std::string intraRefreshPropertyName = "");
     ~H264GStreamerVideoEncoder() override = default;
 
     static std::string
@@ -59,6 +60,18 @@ private:
     profileFromParameters(const Parameters& parameters);
 };
 
+// Software x264enc based encoder, useful to run the GStreamer encode path
+// without any hardware.
+class X264GStreamerVideoEncoder : public H264GStreamerVideoEncoder {
+public:
+    explicit X264GStreamerVideoEncoder(
+        const Parameters& parameters);
+    ~X264GStreamerVideoEncoder() override = default;
+
+    static bool isSupported();
+    static bool isHardwareAccelerated();
+};
+
 } // namespace owt_base
 
 #endif
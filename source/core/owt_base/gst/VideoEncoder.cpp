@@ -9,6 +9,7 @@
 #include <libyuv.h>
 
 #include <algorithm>
+#include <chrono>
 #include <new>
 
 using namespace owt_base;
@@ -16,22 +17,36 @@ using namespace std;
 
 DEFINE_LOGGER(GStreamerVideoEncoder, "owt.GStreamerVideoEncoder");
 
+static int64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 GStreamerVideoEncoder::GStreamerVideoEncoder(
     string mediaTypeCaps,
     string encoderPipeline,
     string encoderBitRatePropertyName,
     BitRateUnit encoderBitRatePropertyUnit,
-    string encoderKeyframeIntervalPropertyName)
+    string encoderKeyframeIntervalPropertyName,
+    string encoderIntraRefreshPropertyName)
     : _mediaTypeCaps(std::move(mediaTypeCaps))
     , _encoderPipeline(std::move(encoderPipeline))
     , _encoderBitRatePropertyName(std::move(encoderBitRatePropertyName))
     , _encoderBitRatePropertyUnit(encoderBitRatePropertyUnit)
     , _encoderKeyframeIntervalPropertyName(
           std::move(encoderKeyframeIntervalPropertyName))
+    , _encoderIntraRefreshPropertyName(std::move(encoderIntraRefreshPropertyName))
+    , _intraRefresh(false)
     , _firstBufferPts { GST_CLOCK_TIME_NONE }
     , _firstBufferDts { GST_CLOCK_TIME_NONE }
+    , _outputWidth(0)
+    , _outputHeight(0)
     , _imageReadyCb { nullptr }
     , _dropNextFrame(false)
+    , _zeroCopyInput(true)
+    , _importedFrames(0)
+    , _copiedFrames(0)
 {
 }
 
@@ -40,6 +55,10 @@ int32_t GStreamerVideoEncoder::Release()
     if (_gstEncoderPipeline) {
         _gstEncoderPipeline.reset();
     }
+    ELOG_DEBUG("Input frames imported %lu, copied %lu", _importedFrames.load(), _copiedFrames.load());
+
+    std::lock_guard<std::mutex> lock(_encodedMutex);
+    _pendingFrames.clear();
     if (_encodedFrame._buffer) {
         delete[] _encodedFrame._buffer;
         _encodedFrame._buffer = nullptr;
@@ -67,6 +86,9 @@ int32_t GStreamerVideoEncoder::InitEncode(const webrtc::VideoCodec* codecSetting
     }
     _gstEncoderPipeline->setBitRate(codecSettings->startBitrate * 1000);
     _gstEncoderPipeline->setKeyframeInterval(getKeyframeInterval(*codecSettings));
+    if (_intraRefresh && !_gstEncoderPipeline->setIntraRefresh(true)) {
+        ELOG_WARN("Intra refresh not supported by %s", _encoderPipeline.c_str());
+    }
     _gstEncoderPipeline->setResolution(codecSettings->width, codecSettings->height);
 
     _inputVideoInfo = gst::unique_from_ptr(gst_video_info_new());
@@ -87,6 +109,8 @@ int32_t GStreamerVideoEncoder::InitEncode(const webrtc::VideoCodec* codecSetting
 
     _encodedFrame._encodedWidth = codecSettings->width;
     _encodedFrame._encodedHeight = codecSettings->height;
+    _outputWidth = codecSettings->width;
+    _outputHeight = codecSettings->height;
 
     return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -136,24 +160,71 @@ int32_t GStreamerVideoEncoder::Encode(const webrtc::VideoFrame& frame,
     if (!sample) {
         return WEBRTC_VIDEO_CODEC_ERROR;
     }
-    _gstEncoderPipeline->pushSample(sample);
 
-    auto encodedSample = _gstEncoderPipeline->tryPullSample();
-    if (!encodedSample) {
-        return WEBRTC_VIDEO_CODEC_ERROR;
+    GstClockTime pts = GST_BUFFER_PTS(gst_sample_get_buffer(sample.get()));
+    {
+        int64_t nowMs = currentTimeMs();
+        std::lock_guard<std::mutex> lock(_encodedMutex);
+        expirePendingFrames(nowMs);
+        if (_pendingFrames.size() >= kMaxPendingFrames) {
+            ELOG_DEBUG("Pipeline busy, drop input frame %u", frame.timestamp());
+            return WEBRTC_VIDEO_CODEC_OK;
+        }
+        _pendingFrames[pts] = PendingFrame { frame.render_time_ms(), frame.timestamp(), frame.ntp_time_ms(), frame.rotation(), nowMs };
     }
 
-    if (!updateEncodedFrame(frame, encodedSample)) {
+    // The encoded sample is delivered asynchronously by onEncodedSample
+    if (_gstEncoderPipeline->pushSample(sample) != GST_FLOW_OK) {
+        std::lock_guard<std::mutex> lock(_encodedMutex);
+        _pendingFrames.erase(pts);
         return WEBRTC_VIDEO_CODEC_ERROR;
     }
 
+    return WEBRTC_VIDEO_CODEC_OK;
+}
+
+void GStreamerVideoEncoder::onEncodedSample(gst::unique_ptr<GstSample> encodedSample)
+{
+    GstClockTime pts = GST_BUFFER_PTS(gst_sample_get_buffer(encodedSample.get()));
+
+    PendingFrame pending;
+    {
+        std::lock_guard<std::mutex> lock(_encodedMutex);
+        // Encoders with B frames output out of PTS order, only the matching
+        // frame is done
+        auto it = _pendingFrames.find(pts);
+        if (it == _pendingFrames.end()) {
+            ELOG_WARN("No input frame for encoded sample, pts %lu", pts);
+            return;
+        }
+        pending = it->second;
+        _pendingFrames.erase(it);
+        expirePendingFrames(currentTimeMs());
+        _encodedFrame._encodedWidth = _outputWidth;
+        _encodedFrame._encodedHeight = _outputHeight;
+    }
+
+    if (!_imageReadyCb || !updateEncodedFrame(pending, encodedSample)) {
+        return;
+    }
+
     auto result = _imageReadyCb->OnEncodedImage(_encodedFrame, nullptr, nullptr);
     if (result.error != webrtc::EncodedImageCallback::Result::OK) {
-        return WEBRTC_VIDEO_CODEC_ERROR;
+        ELOG_WARN("Failed to deliver encoded frame %u", pending.timestamp);
+        return;
     }
     _dropNextFrame = result.drop_next_frame;
+}
 
-    return WEBRTC_VIDEO_CODEC_OK;
+void GStreamerVideoEncoder::expirePendingFrames(int64_t nowMs)
+{
+    for (auto it = _pendingFrames.begin(); it != _pendingFrames.end();) {
+        if (nowMs - it->second.queuedMs > kPendingFrameTimeoutMs) {
+            it = _pendingFrames.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 int32_t GStreamerVideoEncoder::SetChannelParameters(uint32_t packet_loss, int64_t rtt)
@@ -177,12 +248,12 @@ int32_t GStreamerVideoEncoder::SetResolution(uint32_t width, uint32_t height)
         return WEBRTC_VIDEO_CODEC_ERROR;
     }
 
-    auto newSize = GST_VIDEO_INFO_SIZE(_inputVideoInfo);
-    delete[] _encodedFrame._buffer;
-    _encodedFrame._buffer = new uint8_t[newSize];
-    _encodedFrame._size = newSize;
-    _encodedFrame._encodedWidth = width;
-    _encodedFrame._encodedHeight = height;
+    {
+        // The encoded buffer grows on the streaming thread as needed
+        std::lock_guard<std::mutex> lock(_encodedMutex);
+        _outputWidth = width;
+        _outputHeight = height;
+    }
 
     _gstEncoderPipeline->setResolution(width, height);
     return WEBRTC_VIDEO_CODEC_OK;
@@ -191,12 +262,20 @@ int32_t GStreamerVideoEncoder::SetResolution(uint32_t width, uint32_t height)
 bool GStreamerVideoEncoder::initializePipeline()
 {
     _gstEncoderPipeline = make_unique<GStreamerEncoderPipeline>();
-    return _gstEncoderPipeline->initialize(_encoderBitRatePropertyName,
-               _encoderBitRatePropertyUnit,
-               _encoderKeyframeIntervalPropertyName,
-               _mediaTypeCaps,
-               _encoderPipeline)
-        == WEBRTC_VIDEO_CODEC_OK;
+    if (_gstEncoderPipeline->initialize(_encoderBitRatePropertyName,
+            _encoderBitRatePropertyUnit,
+            _encoderKeyframeIntervalPropertyName,
+            _mediaTypeCaps,
+            _encoderPipeline,
+            _encoderIntraRefreshPropertyName)
+        != WEBRTC_VIDEO_CODEC_OK) {
+        return false;
+    }
+
+    _gstEncoderPipeline->setSampleCallback([this](gst::unique_ptr<GstSample> sample) {
+        onEncodedSample(std::move(sample));
+    });
+    return true;
 }
 
 void GStreamerVideoEncoder::initializeBufferTimestamps(
@@ -207,8 +286,58 @@ void GStreamerVideoEncoder::initializeBufferTimestamps(
     _firstBufferDts = (static_cast<guint64>(imageTimestamp)) * GST_MSECOND;
 }
 
-gst::unique_ptr<GstSample>
-GStreamerVideoEncoder::toGstSample(const webrtc::VideoFrame& frame)
+static void releaseFrameBuffer(gpointer data)
+{
+    delete static_cast<rtc::scoped_refptr<webrtc::VideoFrameBuffer>*>(data);
+}
+
+gst::unique_ptr<GstBuffer>
+GStreamerVideoEncoder::importBuffer(const webrtc::VideoFrame& frame)
+{
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> frameBuffer = frame.video_frame_buffer();
+    if (!frameBuffer->DataY() || !frameBuffer->DataU() || !frameBuffer->DataV()) {
+        return nullptr;
+    }
+
+    int height = frameBuffer->height();
+    int chromaHeight = (height + 1) / 2;
+    const uint8_t* planes[3] = { frameBuffer->DataY(), frameBuffer->DataU(), frameBuffer->DataV() };
+    gint strides[3] = { frameBuffer->StrideY(), frameBuffer->StrideU(), frameBuffer->StrideV() };
+    gsize sizes[3] = {
+        static_cast<gsize>(strides[0]) * height,
+        static_cast<gsize>(strides[1]) * chromaHeight,
+        static_cast<gsize>(strides[2]) * chromaHeight
+    };
+    gsize offsets[3] = { 0, sizes[0], sizes[0] + sizes[1] };
+
+    // Each plane is wrapped read-only, and keeps a reference of the frame
+    // buffer until GStreamer releases the memory.
+    gst::unique_ptr<GstBuffer> buffer = gst::unique_from_ptr(gst_buffer_new());
+    for (int i = 0; i < 3; i++) {
+        GstMemory* memory = gst_memory_new_wrapped(GST_MEMORY_FLAG_READONLY,
+            const_cast<uint8_t*>(planes[i]),
+            sizes[i],
+            0,
+            sizes[i],
+            new rtc::scoped_refptr<webrtc::VideoFrameBuffer>(frameBuffer),
+            releaseFrameBuffer);
+        gst_buffer_append_memory(buffer.get(), memory);
+    }
+
+    gst_buffer_add_video_meta_full(buffer.get(),
+        GST_VIDEO_FRAME_FLAG_NONE,
+        GST_VIDEO_FORMAT_I420,
+        frameBuffer->width(),
+        height,
+        3,
+        offsets,
+        strides);
+
+    return buffer;
+}
+
+gst::unique_ptr<GstBuffer>
+GStreamerVideoEncoder::copyBuffer(const webrtc::VideoFrame& frame)
 {
     gst::unique_ptr<GstBuffer> buffer = _gstreamerBufferPool.acquireBuffer();
     if (!buffer) {
@@ -216,11 +345,7 @@ GStreamerVideoEncoder::toGstSample(const webrtc::VideoFrame& frame)
         return nullptr;
     }
 
-    auto i420Buffer = webrtc::I420Buffer::Copy(*frame.video_frame_buffer());
-    if (GST_VIDEO_INFO_WIDTH(_inputVideoInfo.get()) != i420Buffer->width() || GST_VIDEO_INFO_HEIGHT(_inputVideoInfo.get()) != i420Buffer->height()) {
-        ELOG_ERROR("The input frame size is invalid");
-        return nullptr;
-    }
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> frameBuffer = frame.video_frame_buffer();
 
     GstMappedFrame mappedFrame(
         buffer.get(), _inputVideoInfo.get(), GST_MAP_WRITE);
@@ -229,20 +354,45 @@ GStreamerVideoEncoder::toGstSample(const webrtc::VideoFrame& frame)
         return nullptr;
     }
 
-    libyuv::I420Copy(i420Buffer->DataY(),
-        i420Buffer->StrideY(),
-        i420Buffer->DataU(),
-        i420Buffer->StrideU(),
-        i420Buffer->DataV(),
-        i420Buffer->StrideV(),
+    libyuv::I420Copy(frameBuffer->DataY(),
+        frameBuffer->StrideY(),
+        frameBuffer->DataU(),
+        frameBuffer->StrideU(),
+        frameBuffer->DataV(),
+        frameBuffer->StrideV(),
         mappedFrame.componentData(0),
         mappedFrame.componentStride(0),
         mappedFrame.componentData(1),
         mappedFrame.componentStride(1),
         mappedFrame.componentData(2),
         mappedFrame.componentStride(2),
-        i420Buffer->width(),
-        i420Buffer->height());
+        frameBuffer->width(),
+        frameBuffer->height());
+
+    return buffer;
+}
+
+gst::unique_ptr<GstSample>
+GStreamerVideoEncoder::toGstSample(const webrtc::VideoFrame& frame)
+{
+    if (GST_VIDEO_INFO_WIDTH(_inputVideoInfo.get()) != frame.width() || GST_VIDEO_INFO_HEIGHT(_inputVideoInfo.get()) != frame.height()) {
+        ELOG_ERROR("The input frame size is invalid");
+        return nullptr;
+    }
+
+    gst::unique_ptr<GstBuffer> buffer;
+    if (_zeroCopyInput) {
+        buffer = importBuffer(frame);
+    }
+    if (buffer) {
+        _importedFrames++;
+    } else {
+        buffer = copyBuffer(frame);
+        if (!buffer) {
+            return nullptr;
+        }
+        _copiedFrames++;
+    }
 
     GST_BUFFER_DTS(buffer.get()) = (static_cast<guint64>(frame.timestamp()) * GST_MSECOND) - _firstBufferDts;
     GST_BUFFER_PTS(buffer.get()) = (static_cast<guint64>(frame.render_time_ms()) * GST_MSECOND) - _firstBufferPts;
@@ -252,7 +402,7 @@ GStreamerVideoEncoder::toGstSample(const webrtc::VideoFrame& frame)
 }
 
 bool GStreamerVideoEncoder::updateEncodedFrame(
-    const webrtc::VideoFrame& frame,
+    const PendingFrame& frame,
     gst::unique_ptr<GstSample>& encodedSample)
 {
     GstMappedBuffer mappedBuffer(gst_sample_get_buffer(encodedSample.get()),
@@ -263,7 +413,7 @@ bool GStreamerVideoEncoder::updateEncodedFrame(
 
     if (_encodedFrame._size < mappedBuffer.size()) {
         delete[] _encodedFrame._buffer;
-        auto newSize = 2 * _encodedFrame._size;
+        auto newSize = std::max<size_t>(2 * _encodedFrame._size, mappedBuffer.size());
         _encodedFrame._buffer = new uint8_t[newSize];
         _encodedFrame._size = newSize;
     }
@@ -272,10 +422,10 @@ bool GStreamerVideoEncoder::updateEncodedFrame(
 
     _encodedFrame._length = mappedBuffer.size();
     _encodedFrame._frameType = getWebrtcFrameType(encodedSample);
-    _encodedFrame.capture_time_ms_ = frame.render_time_ms();
-    _encodedFrame._timeStamp = frame.timestamp();
-    _encodedFrame.ntp_time_ms_ = frame.ntp_time_ms();
-    _encodedFrame.rotation_ = frame.rotation();
+    _encodedFrame.capture_time_ms_ = frame.renderTimeMs;
+    _encodedFrame._timeStamp = frame.timestamp;
+    _encodedFrame.ntp_time_ms_ = frame.ntpTimeMs;
+    _encodedFrame.rotation_ = frame.rotation;
 
     return true;
 }
@@ -16,6 +16,8 @@
 #include <webrtc/modules/video_coding/include/video_codec_interface.h>
 
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <optional>
 
 #include <boost/scoped_ptr.hpp>
@@ -28,6 +30,8 @@ class GStreamerVideoEncoder : public webrtc::VideoEncoder {
     std::string _encoderBitRatePropertyName;
     BitRateUnit _encoderBitRatePropertyUnit;
     std::string _encoderKeyframeIntervalPropertyName;
+    std::string _encoderIntraRefreshPropertyName;
+    bool _intraRefresh;
 
     std::unique_ptr<GStreamerEncoderPipeline> _gstEncoderPipeline;
     GStreamerBufferPool _gstreamerBufferPool;
@@ -38,20 +42,46 @@ class GStreamerVideoEncoder : public webrtc::VideoEncoder {
     GstClockTime _firstBufferPts;
     GstClockTime _firstBufferDts;
 
+    // Input frames waiting for their encoded sample, keyed by buffer PTS
+    struct PendingFrame {
+        int64_t renderTimeMs;
+        uint32_t timestamp;
+        int64_t ntpTimeMs;
+        webrtc::VideoRotation rotation;
+        int64_t queuedMs;
+    };
+    std::map<GstClockTime, PendingFrame> _pendingFrames;
+    // Guards _pendingFrames and the output size, not held while delivering
+    std::mutex _encodedMutex;
+    uint32_t _outputWidth;
+    uint32_t _outputHeight;
+
+    // Only written on the streaming thread once the pipeline runs
     webrtc::EncodedImage _encodedFrame;
     webrtc::EncodedImageCallback* _imageReadyCb;
 
-    bool _dropNextFrame;
+    std::atomic<bool> _dropNextFrame;
     std::atomic<std::optional<uint32_t>> _newBitRate;
 
+    bool _zeroCopyInput;
+    std::atomic<uint64_t> _importedFrames;
+    std::atomic<uint64_t> _copiedFrames;
+
 public:
     GStreamerVideoEncoder(std::string mediaTypeCaps,
         std::string encoderPipeline,
         std::string encoderBitRatePropertyName,
         BitRateUnit encoderBitRatePropertyUnit,
-        std::string encoderKeyframeIntervalPropertyName);
+        std::string encoderKeyframeIntervalPropertyName,
+        std::string encoderIntraRefreshPropertyName = "");
     ~GStreamerVideoEncoder() override = default;
 
+    // Max input frames in flight in the pipeline, further frames are dropped
+    // so that Encode() never blocks on the pipeline.
+    static constexpr size_t kMaxPendingFrames = 8;
+    // Frames the encoder skipped never come out, they are forgotten after
+    static constexpr int64_t kPendingFrameTimeoutMs = 1000;
+
     DECLARE_NOT_COPYABLE(GStreamerVideoEncoder);
     DECLARE_NOT_MOVABLE(GStreamerVideoEncoder);
 
@@ -72,6 +102,11 @@ public:
 
     int32_t SetResolution(uint32_t width, uint32_t height) override;
 
+    // Gradual intra refresh over the key frame interval instead of periodic
+    // key frames, applied by InitEncode
+    bool supportsIntraRefresh() { return !_encoderIntraRefreshPropertyName.empty(); }
+    void setIntraRefresh(bool enabled) { _intraRefresh = enabled; }
+
 protected:
     virtual int getKeyframeInterval(const webrtc::VideoCodec& codecSettings) = 0;
 
@@ -86,7 +121,12 @@ private:
         uint32_t imageTimestamp);
 
     gst::unique_ptr<GstSample> toGstSample(const webrtc::VideoFrame& frame);
-    bool updateEncodedFrame(const webrtc::VideoFrame& frame,
+    gst::unique_ptr<GstBuffer> importBuffer(const webrtc::VideoFrame& frame);
+    gst::unique_ptr<GstBuffer> copyBuffer(const webrtc::VideoFrame& frame);
+    void onEncodedSample(gst::unique_ptr<GstSample> encodedSample);
+    // Drops frames pending for longer than kPendingFrameTimeoutMs
+    void expirePendingFrames(int64_t nowMs);
+    bool updateEncodedFrame(const PendingFrame& frame,
         gst::unique_ptr<GstSample>& encodedSample);
     webrtc::FrameType
     getWebrtcFrameType(gst::unique_ptr<GstSample>& encodedSample);
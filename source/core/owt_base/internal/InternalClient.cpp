@@ -4,6 +4,7 @@
 
 #include "InternalClient.h"
 #include "RawTransport.h"
+#include "PipelineTracer.h"
 
 namespace owt_base {
 
@@ -17,6 +18,8 @@ InternalClient::InternalClient(
     , m_streamId(streamId)
     , m_ready(false)
     , m_listener(listener)
+    , m_traceTimeStamp(0)
+    , m_traceCaptureTimeUs(0)
 {
 }
 
@@ -89,11 +92,23 @@ void InternalClient::onData(uint8_t* buf, uint32_t len)
         return;
     }
     switch ((char) buf[0]) {
-        case TDT_MEDIA_FRAME:
+        case TDT_MEDIA_FRAME: {
             frame = reinterpret_cast<Frame*>(buf + 1);
             frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
+            PipelineTracer::CaptureScope scope(
+                m_traceTimeStamp == frame->timeStamp ? m_traceCaptureTimeUs : 0);
+            m_traceCaptureTimeUs = 0;
             deliverFrame(*frame);
             break;
+        }
+        case TDT_FRAME_TRACE:
+            if (len >= 1 + FrameTrace::kSize) {
+                FrameTrace trace;
+                trace.read(reinterpret_cast<uint8_t*>(buf + 1));
+                m_traceTimeStamp = trace.timeStamp;
+                m_traceCaptureTimeUs = trace.captureTimeUs;
+            }
+            break;
         case TDT_MEDIA_METADATA:
             metadata = reinterpret_cast<MetaData*>(buf + 1);
             metadata->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(MetaData));
@@ -48,6 +48,9 @@ private:
     std::string m_streamId;
     bool m_ready;
     Listener* m_listener;
+    // Capture time of the next frame, from TDT_FRAME_TRACE
+    uint32_t m_traceTimeStamp;
+    int64_t m_traceCaptureTimeUs;
 };
 
 } /* namespace owt_base */
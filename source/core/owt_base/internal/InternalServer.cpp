@@ -4,6 +4,7 @@
 
 #include "InternalServer.h"
 #include "RawTransport.h"
+#include "PipelineTracer.h"
 
 namespace owt_base {
 
@@ -158,6 +159,15 @@ void InternalServer::onSessionRemoved(int id)
 
 void InternalServer::InternalSession::onFrame(const Frame& frame)
 {
+    int64_t captureTimeUs = PipelineTracer::captureTimeUs();
+    if (captureTimeUs) {
+        uint8_t traceBuffer[1 + FrameTrace::kSize];
+        FrameTrace trace { frame.timeStamp, captureTimeUs };
+        traceBuffer[0] = TDT_FRAME_TRACE;
+        trace.write(&traceBuffer[1]);
+        m_parent->m_server->sendSessionData(m_id, traceBuffer, sizeof(traceBuffer));
+    }
+
     uint8_t sendBuffer[1 + sizeof(Frame) + frame.length];
     sendBuffer[0] = TDT_MEDIA_FRAME;
     memcpy(&sendBuffer[1],
@@ -0,0 +1,135 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LayerRateEstimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <time.h>
+
+namespace owt_base {
+
+// Source without frames for this period(ms) has no bitrate
+static constexpr uint64_t kActiveTimeout = 2000;
+
+const int LayerRateEstimator::kMaxSpatialLayers;
+const int LayerRateEstimator::kMaxTemporalLayers;
+const uint32_t LayerRateEstimator::kBucketMs;
+const uint32_t LayerRateEstimator::kBucketNum;
+
+static std::mutex s_estimatorsMutex;
+static std::map<FrameSource*, std::weak_ptr<LayerRateEstimator>> s_estimators;
+
+std::shared_ptr<LayerRateEstimator> LayerRateEstimator::get(FrameSource* source)
+{
+    std::lock_guard<std::mutex> lock(s_estimatorsMutex);
+    std::shared_ptr<LayerRateEstimator> estimator = s_estimators[source].lock();
+    if (!estimator) {
+        estimator.reset(new LayerRateEstimator(source));
+        s_estimators[source] = estimator;
+    }
+    return estimator;
+}
+
+uint64_t LayerRateEstimator::coarseTimeMs()
+{
+#ifdef CLOCK_MONOTONIC_COARSE
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#else
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+LayerRateEstimator::LayerRateEstimator(FrameSource* source)
+    : m_source(source)
+    , m_firstMs(0)
+    , m_lastMs(0)
+    , m_maxSpatialId(0)
+    , m_maxTemporalId(0)
+{
+    for (auto& bucket : m_buckets) {
+        bucket.period = 0;
+        for (auto& bits : bucket.bits) {
+            bits = 0;
+        }
+    }
+    m_source->addVideoDestination(this);
+}
+
+LayerRateEstimator::~LayerRateEstimator()
+{
+    m_source->removeVideoDestination(this);
+
+    std::lock_guard<std::mutex> lock(s_estimatorsMutex);
+    auto it = s_estimators.find(m_source);
+    // Another estimator may have been created for the source meanwhile
+    if (it != s_estimators.end() && it->second.expired()) {
+        s_estimators.erase(it);
+    }
+}
+
+void LayerRateEstimator::onFrame(const Frame& frame)
+{
+    int spatialId = std::min<int>(frame.additionalInfo.video.spatialId, kMaxSpatialLayers - 1);
+    int temporalId = std::min<int>(frame.additionalInfo.video.temporalId, kMaxTemporalLayers - 1);
+    uint64_t nowMs = coarseTimeMs();
+    uint64_t period = nowMs / kBucketMs;
+
+    Bucket& bucket = m_buckets[period % kBucketNum];
+    if (bucket.period.load(std::memory_order_relaxed) != period) {
+        for (auto& bits : bucket.bits) {
+            bits.store(0, std::memory_order_relaxed);
+        }
+        bucket.period.store(period, std::memory_order_release);
+    }
+    bucket.bits[spatialId * kMaxTemporalLayers + temporalId].fetch_add(
+        frame.length * 8, std::memory_order_relaxed);
+
+    if (!m_firstMs.load(std::memory_order_relaxed)) {
+        m_firstMs.store(nowMs, std::memory_order_relaxed);
+    }
+    m_lastMs.store(nowMs, std::memory_order_relaxed);
+    if (spatialId > m_maxSpatialId.load(std::memory_order_relaxed)) {
+        m_maxSpatialId.store(spatialId, std::memory_order_relaxed);
+    }
+    if (temporalId > m_maxTemporalId.load(std::memory_order_relaxed)) {
+        m_maxTemporalId.store(temporalId, std::memory_order_relaxed);
+    }
+}
+
+uint32_t LayerRateEstimator::bitrate(int spatialId, int temporalId)
+{
+    uint64_t nowMs = coarseTimeMs();
+    uint64_t lastMs = m_lastMs.load(std::memory_order_relaxed);
+    if (!lastMs || nowMs - lastMs > kActiveTimeout) {
+        return 0;
+    }
+
+    uint64_t period = nowMs / kBucketMs;
+    uint64_t totalBits = 0;
+    for (auto& bucket : m_buckets) {
+        uint64_t bucketPeriod = bucket.period.load(std::memory_order_acquire);
+        if (bucketPeriod > period || bucketPeriod + kBucketNum <= period) {
+            continue;
+        }
+        for (int s = 0; s <= spatialId && s < kMaxSpatialLayers; s++) {
+            for (int t = 0; t <= temporalId && t < kMaxTemporalLayers; t++) {
+                totalBits += bucket.bits[s * kMaxTemporalLayers + t].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Count from the window start or the first frame, whichever is later
+    uint64_t windowStartMs = (period + 1 - std::min<uint64_t>(period + 1, kBucketNum)) * kBucketMs;
+    uint64_t startMs = std::max(windowStartMs, m_firstMs.load(std::memory_order_relaxed));
+    uint64_t countedMs = std::max<uint64_t>(nowMs - std::min(nowMs, startMs), kBucketMs);
+    return totalBits * 1000 / countedMs;
+}
+
+} // namespace owt_base
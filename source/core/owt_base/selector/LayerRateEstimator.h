@@ -0,0 +1,64 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OWT_BASE_SELECTOR_LAYER_RATE_ESTIMATOR_H
+#define OWT_BASE_SELECTOR_LAYER_RATE_ESTIMATOR_H
+
+#include "MediaFramePipeline.h"
+
+#include <atomic>
+#include <memory>
+
+namespace owt_base {
+
+/*
+ * Bitrate of each spatial and temporal layer of one video FrameSource.
+ * One estimator is subscribed per source and shared by every user, frames
+ * are counted once into a fixed ring of 100ms buckets stamped with a
+ * coarse clock. Reading does not lock.
+ */
+class LayerRateEstimator : public FrameDestination {
+public:
+    static const int kMaxSpatialLayers = 4;
+    static const int kMaxTemporalLayers = 4;
+
+    // Returns the estimator of source, created on first use
+    static std::shared_ptr<LayerRateEstimator> get(FrameSource* source);
+    ~LayerRateEstimator();
+
+    // Implements FrameDestination
+    void onFrame(const Frame&) override;
+
+    // Bitrate(bps) of the layers up to spatialId and temporalId,
+    // 0 if the source is not active
+    uint32_t bitrate(int spatialId, int temporalId);
+    int maxSpatialId() { return m_maxSpatialId.load(std::memory_order_relaxed); }
+    int maxTemporalId() { return m_maxTemporalId.load(std::memory_order_relaxed); }
+
+    static uint64_t coarseTimeMs();
+
+private:
+    static const int kLayerNum = kMaxSpatialLayers * kMaxTemporalLayers;
+    static const uint32_t kBucketMs = 100;
+    static const uint32_t kBucketNum = 50;
+
+    struct Bucket {
+        // Index of the 100ms period counted in this bucket
+        std::atomic<uint64_t> period;
+        std::atomic<uint32_t> bits[kLayerNum];
+    };
+
+    explicit LayerRateEstimator(FrameSource* source);
+
+    FrameSource* m_source;
+    Bucket m_buckets[kBucketNum];
+    std::atomic<uint64_t> m_firstMs;
+    std::atomic<uint64_t> m_lastMs;
+    std::atomic<int> m_maxSpatialId;
+    std::atomic<int> m_maxTemporalId;
+};
+
+} // namespace owt_base
+
+#endif // OWT_BASE_SELECTOR_LAYER_RATE_ESTIMATOR_H
@@ -0,0 +1,57 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoLayerFilter.h"
+
+namespace owt_base {
+
+VideoLayerFilter::VideoLayerFilter()
+    : m_current({-1, 0, 0})
+    , m_target({-1, 0, 0})
+{
+}
+
+void VideoLayerFilter::setTarget(const VideoLayer& target)
+{
+    m_target = target;
+    if (m_target.source < 0) {
+        m_current = m_target;
+    }
+}
+
+bool VideoLayerFilter::needKeyFrame() const
+{
+    return m_target.source >= 0 &&
+        (m_target.source != m_current.source ||
+         m_target.spatialId > m_current.spatialId);
+}
+
+bool VideoLayerFilter::onFrame(int source, const Frame& frame)
+{
+    int spatialId = frame.additionalInfo.video.spatialId;
+    int temporalId = frame.additionalInfo.video.temporalId;
+
+    if (source == m_target.source && frame.additionalInfo.video.isKeyFrame && needKeyFrame()) {
+        // Switch source or spatial layer up at the key frame
+        m_current = m_target;
+    }
+    if (source != m_current.source) {
+        return false;
+    }
+
+    if (m_target.source == m_current.source) {
+        if (m_target.spatialId < m_current.spatialId) {
+            m_current.spatialId = m_target.spatialId;
+        }
+        if (m_target.temporalId < m_current.temporalId ||
+            (m_target.temporalId > m_current.temporalId && temporalId == 0)) {
+            // Frames following a base layer frame do not refer to dropped ones
+            m_current.temporalId = m_target.temporalId;
+        }
+    }
+
+    return spatialId <= m_current.spatialId && temporalId <= m_current.temporalId;
+}
+
+} // namespace owt_base
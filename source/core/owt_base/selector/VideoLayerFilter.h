@@ -0,0 +1,57 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OWT_BASE_SELECTOR_VIDEO_LAYER_FILTER_H
+#define OWT_BASE_SELECTOR_VIDEO_LAYER_FILTER_H
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+struct VideoLayer {
+    // Index of the simulcast source, -1 for none
+    int source;
+    // Highest spatial and temporal layer forwarded within the source
+    int spatialId;
+    int temporalId;
+
+    bool operator==(const VideoLayer& other) const
+    {
+        return source == other.source && spatialId == other.spatialId
+            && temporalId == other.temporalId;
+    }
+    bool operator!=(const VideoLayer& other) const { return !(*this == other); }
+};
+
+/*
+ * Decides per frame whether a frame of a simulcast source is forwarded.
+ * All sources keep delivering their frames, a switch only changes which
+ * ones pass. Switching to another source or to a higher spatial layer
+ * waits for a key frame of the target, the current layer is forwarded
+ * until then so the output has no gap. A higher temporal layer is taken
+ * at the next base layer frame. Lower layers are dropped from the next
+ * frame on. Not thread safe.
+ */
+class VideoLayerFilter {
+public:
+    VideoLayerFilter();
+
+    void setTarget(const VideoLayer& target);
+    const VideoLayer& target() const { return m_target; }
+    const VideoLayer& current() const { return m_current; }
+
+    // True until the target is reached at a key frame
+    bool needKeyFrame() const;
+
+    // Returns true if the frame from source should be forwarded
+    bool onFrame(int source, const Frame& frame);
+
+private:
+    VideoLayer m_current;
+    VideoLayer m_target;
+};
+
+} // namespace owt_base
+
+#endif // OWT_BASE_SELECTOR_VIDEO_LAYER_FILTER_H
@@ -0,0 +1,227 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE VideoLayerFilter
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+#include <vector>
+
+#include "VideoLayerFilter.h"
+#include "VideoQualitySwitch.h"
+
+using namespace owt_base;
+
+// Synthetic simulcast stream: sources are time aligned, each is L1T3
+// (temporal ids 0, 2, 1, 2, ...) with a key frame every kKeyInterval
+// frames, the key frames of source n are shifted by n * kKeyShift frames.
+static const int kSources = 3;
+static const int kKeyInterval = 30;
+static const int kKeyShift = 10;
+static const int kTemporalPattern[] = {0, 2, 1, 2};
+
+static Frame makeFrame(int source, int n, int spatialId = 0)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_VP9;
+    frame.timeStamp = n * 3000;
+    frame.additionalInfo.video.temporalId = kTemporalPattern[n % 4];
+    frame.additionalInfo.video.spatialId = spatialId;
+    frame.additionalInfo.video.isKeyFrame =
+        (spatialId == 0) && ((n + source * kKeyShift) % kKeyInterval == 0);
+    return frame;
+}
+
+struct Output {
+    int source;
+    int n;
+};
+
+// Feeds frames [from, to) of all sources, returns the forwarded ones
+static std::vector<Output> replay(VideoLayerFilter& filter, int from, int to)
+{
+    std::vector<Output> output;
+    for (int n = from; n < to; n++) {
+        for (int s = 0; s < kSources; s++) {
+            if (filter.onFrame(s, makeFrame(s, n))) {
+                output.push_back({s, n});
+            }
+        }
+    }
+    return output;
+}
+
+BOOST_AUTO_TEST_CASE(waitForKeyFrame)
+{
+    VideoLayerFilter filter;
+    filter.setTarget({1, 0, 2});
+    BOOST_CHECK(filter.needKeyFrame());
+
+    // First key frame of source 1 is frame 20
+    std::vector<Output> output = replay(filter, 0, 40);
+    BOOST_REQUIRE(!output.empty());
+    BOOST_CHECK_EQUAL(output.front().source, 1);
+    BOOST_CHECK_EQUAL(output.front().n, 20);
+    BOOST_CHECK_EQUAL(output.size(), 20u);
+    BOOST_CHECK(!filter.needKeyFrame());
+}
+
+BOOST_AUTO_TEST_CASE(switchSourceWithoutGap)
+{
+    VideoLayerFilter filter;
+    filter.setTarget({0, 0, 2});
+    replay(filter, 0, 5);
+
+    // Switch at frame 5, next key frame of source 2 is frame 10
+    filter.setTarget({2, 0, 2});
+    std::vector<Output> output = replay(filter, 5, 60);
+
+    // Old source up to the key frame, which shares the timestamp of the
+    // last old frame, then only the new source
+    int expected = 5;
+    bool switched = false;
+    for (auto& o : output) {
+        if (o.source == 2 && !switched) {
+            switched = true;
+            BOOST_CHECK_EQUAL(o.n, 10);
+            BOOST_CHECK(makeFrame(2, o.n).additionalInfo.video.isKeyFrame);
+            expected = o.n;
+        }
+        BOOST_CHECK_EQUAL(o.source, switched ? 2 : 0);
+        BOOST_CHECK_EQUAL(o.n, expected);
+        expected++;
+    }
+    BOOST_CHECK(switched);
+    BOOST_CHECK_EQUAL(expected, 60);
+}
+
+BOOST_AUTO_TEST_CASE(switchLatency)
+{
+    // Every switch completes at the first key frame of the target
+    for (int start = 0; start < kKeyInterval; start++) {
+        for (int target = 1; target < kSources; target++) {
+            VideoLayerFilter filter;
+            filter.setTarget({0, 0, 2});
+            replay(filter, 0, kKeyInterval + start);
+
+            filter.setTarget({target, 0, 2});
+            int switchedAt = -1;
+            for (int n = kKeyInterval + start; n < 3 * kKeyInterval && switchedAt < 0; n++) {
+                for (int s = 0; s < kSources; s++) {
+                    if (filter.onFrame(s, makeFrame(s, n)) && s == target) {
+                        switchedAt = n;
+                    }
+                }
+            }
+            int latency = switchedAt - (kKeyInterval + start);
+            BOOST_CHECK(switchedAt >= 0);
+            BOOST_CHECK(makeFrame(target, switchedAt).additionalInfo.video.isKeyFrame);
+            BOOST_CHECK(latency < kKeyInterval);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(temporalLayers)
+{
+    VideoLayerFilter filter;
+    filter.setTarget({0, 0, 2});
+    replay(filter, 0, 8);
+
+    // Down to T0 within one frame
+    filter.setTarget({0, 0, 0});
+    std::vector<Output> output = replay(filter, 9, 17);
+    BOOST_REQUIRE_EQUAL(output.size(), 2u);
+    BOOST_CHECK_EQUAL(output[0].n, 12);
+    BOOST_CHECK_EQUAL(output[1].n, 16);
+
+    // Up to T1 at the next base layer frame
+    filter.setTarget({0, 0, 1});
+    BOOST_CHECK(!filter.needKeyFrame());
+    output = replay(filter, 17, 25);
+    BOOST_REQUIRE_EQUAL(output.size(), 3u);
+    BOOST_CHECK_EQUAL(output[0].n, 20);
+    BOOST_CHECK_EQUAL(output[1].n, 22);
+    BOOST_CHECK_EQUAL(output[2].n, 24);
+}
+
+BOOST_AUTO_TEST_CASE(spatialLayers)
+{
+    // L3T1 in one stream, one frame per spatial layer
+    VideoLayerFilter filter;
+    std::vector<Output> output;
+    auto feed = [&](int from, int to) {
+        output.clear();
+        for (int n = from; n < to; n++) {
+            for (int sid = 0; sid < 3; sid++) {
+                Frame frame = makeFrame(0, n, sid);
+                frame.additionalInfo.video.temporalId = 0;
+                if (filter.onFrame(0, frame)) {
+                    output.push_back({sid, n});
+                }
+            }
+        }
+    };
+
+    filter.setTarget({0, 2, 0});
+    feed(0, 2);
+    BOOST_CHECK_EQUAL(output.size(), 6u);
+
+    // Down to S1 with the next picture
+    filter.setTarget({0, 1, 0});
+    feed(2, 4);
+    BOOST_REQUIRE_EQUAL(output.size(), 4u);
+    for (auto& o : output) {
+        BOOST_CHECK(o.source <= 1);
+    }
+
+    // Up to S2 waits for the key frame at frame 30
+    filter.setTarget({0, 2, 0});
+    BOOST_CHECK(filter.needKeyFrame());
+    feed(4, 30);
+    BOOST_CHECK_EQUAL(output.size(), 26u * 2);
+    feed(30, 31);
+    BOOST_CHECK_EQUAL(output.size(), 3u);
+    BOOST_CHECK(!filter.needKeyFrame());
+}
+
+class TestSource : public FrameSource {
+public:
+    TestSource() : m_keyFrameRequests(0) {}
+
+    void generateFrame(const Frame& frame) { deliverFrame(frame); }
+    void onFeedback(const FeedbackMsg& msg) override
+    {
+        if (msg.type == VIDEO_FEEDBACK && msg.cmd == REQUEST_KEY_FRAME) {
+            m_keyFrameRequests++;
+        }
+    }
+    int keyFrameRequests() { return m_keyFrameRequests; }
+private:
+    int m_keyFrameRequests;
+};
+
+class TestDestination : public FrameDestination {
+public:
+    void onFrame(const Frame& frame) override { m_frames.push_back(frame); }
+    std::vector<Frame> m_frames;
+};
+
+BOOST_AUTO_TEST_CASE(qualitySwitchStaysSubscribed)
+{
+    TestSource src0, src1;
+    TestDestination dest;
+    {
+        VideoQualitySwitch vswitch({&src0, &src1});
+        vswitch.addVideoDestination(&dest);
+        // Starts with all layers of the first source
+        BOOST_CHECK_EQUAL(src0.keyFrameRequests(), 1);
+        BOOST_CHECK_EQUAL(src1.keyFrameRequests(), 0);
+
+        for (int n = 0; n < 40; n++) {
+            src0.generateFrame(makeFrame(0, n));
+            src1.generateFrame(makeFrame(1, n));
+        }
+        BOOST_CHECK_EQUAL(dest.m_frames.size(), 40u);
+
+        vswitch.removeVideoDestination(&dest);
+    }
+}
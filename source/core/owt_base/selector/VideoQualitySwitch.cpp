@@ -4,18 +4,15 @@
 
 #include "VideoQualitySwitch.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <memory>
 
 namespace owt_base {
 
-// Treat streams frames in a certain period(ms)
-static constexpr uint32_t kBitrateCountPeriod = 5000;
-static constexpr uint32_t kBucketNum = 50;
-// Minimal period for switching(ms)
+// Minimal period for switching up(ms), switching down is not delayed
 static constexpr uint64_t kMinimalUpdatePeriod = 5000;
-static constexpr uint64_t kActiveTimeout = 2000;
 // Only change source when difference exceed threshold
 static constexpr double kBitrateChangeThreshold = 0.1;
 
@@ -23,16 +20,14 @@ DEFINE_LOGGER(VideoQualitySwitch, "owt.VideoQualitySwitch");
 
 VideoQualitySwitch::VideoQualitySwitch(std::vector<FrameSource*> sources)
     : m_sources(sources)
-    , m_bitrateCounters(m_sources.size())
-    , m_current(-1)
-    , m_keyFrameArrived(false)
+    , m_inputs(m_sources.size())
     , m_lastUpdateTime(0)
 {
     ELOG_DEBUG("Init with sources size: %zu", m_sources.size());
     for (size_t i = 0; i < m_sources.size(); i++) {
         if (m_sources[i]) {
-            m_bitrateCounters[i] = std::make_shared<BitrateCounter>(this);
-            m_sources[i]->addVideoDestination(m_bitrateCounters[i].get());
+            m_inputs[i] = std::make_shared<LayerInput>(this, i, m_sources[i]);
+            m_sources[i]->addVideoDestination(m_inputs[i].get());
         } else {
             ELOG_WARN("Empty source for quality switch %zu", i);
         }
@@ -44,32 +39,68 @@ VideoQualitySwitch::~VideoQualitySwitch()
 {
     for (size_t i = 0; i < m_sources.size(); i++) {
         if (m_sources[i]) {
-            m_sources[i]->removeVideoDestination(m_bitrateCounters[i].get());
+            m_sources[i]->removeVideoDestination(m_inputs[i].get());
         }
     }
 }
 
-void VideoQualitySwitch::onFrame(const Frame& frame)
+void VideoQualitySwitch::onLayerFrame(int index, const Frame& frame)
 {
-    if (frame.additionalInfo.video.isKeyFrame) {
-        m_keyFrameArrived = true;
+    bool forward = false;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        forward = m_filter.onFrame(index, frame);
     }
-    if (m_keyFrameArrived) {
+    if (forward) {
         deliverFrame(frame);
     }
 }
 
-void VideoQualitySwitch::onMetaData(const MetaData& metadata)
+void VideoQualitySwitch::onLayerMetaData(int index, const MetaData& metadata)
 {
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (index != m_filter.current().source) {
+            return;
+        }
+    }
     deliverMetaData(metadata);
 }
 
+VideoQualitySwitch::LayerInput* VideoQualitySwitch::keyFrameInput()
+{
+    if (!m_filter.needKeyFrame()) {
+        return nullptr;
+    }
+    return m_inputs[m_filter.target().source].get();
+}
+
 void VideoQualitySwitch::onFeedback(const owt_base::FeedbackMsg& msg)
 {
     if (msg.type == owt_base::VIDEO_FEEDBACK && msg.cmd == SET_BITRATE) {
         setTargetBitrate(msg.data.kbps * 1000);
-    } else {
-        deliverFeedbackMsg(msg);
+        return;
+    }
+
+    LayerInput* input = nullptr;
+    FeedbackMsg feedback = msg;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        int index = m_filter.current().source;
+        bool picture = msg.cmd == REQUEST_KEY_FRAME || msg.cmd == REQUEST_REFRESH;
+        if (index < 0 || (picture && m_filter.needKeyFrame())) {
+            index = m_filter.target().source;
+            // A layer switch can't wait for a gradual refresh
+            if (msg.cmd == REQUEST_REFRESH) {
+                feedback.cmd = REQUEST_KEY_FRAME;
+            }
+        }
+        if (index >= 0) {
+            input = m_inputs[index].get();
+        }
+    }
+    if (input) {
+        input->sendFeedback(feedback);
     }
 }
 
@@ -78,90 +109,96 @@ void VideoQualitySwitch::setTargetBitrate(uint32_t targetBps)
     ELOG_DEBUG("setTargetBitrate %u %p", targetBps, this);
     uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now().time_since_epoch()).count();
-    if (tsNow - m_lastUpdateTime < kMinimalUpdatePeriod) {
-        return;
-    }
-    m_lastUpdateTime = tsNow;
 
-    int current = -1;
-    int currentBitrate = 0;
-    for (size_t i = 0; i < m_sources.size(); i++) {
-        int bitrate = m_bitrateCounters[i]->bitrate();
-        ELOG_DEBUG("BitrateCounter bitrate %zu: %d %p", i, bitrate, this);
-        if (current < 0) {
-            current = i;
-            currentBitrate = bitrate;
-        } else {
-            if (std::abs(bitrate - (int) targetBps) <
-                std::abs(currentBitrate - (int) targetBps)) {
-                current = i;
-                currentBitrate = bitrate;
+    std::vector<uint32_t> layerBitrates;
+    LayerInput* requestInput = nullptr;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        VideoLayer target = {-1, 0, 0};
+        int targetBitrate = 0;
+        for (size_t i = 0; i < m_inputs.size(); i++) {
+            if (!m_inputs[i]) {
+                continue;
             }
-        }
-    }
-    if (current != m_current) {
-        if (current >= 0 && m_current >= 0) {
-            int newBitrate = m_bitrateCounters[current]->bitrate();
-            int oldBitrate = m_bitrateCounters[m_current]->bitrate() + 1;
-            double diff = std::abs(newBitrate - oldBitrate);
-            diff = diff / oldBitrate;
-            if (diff < kBitrateChangeThreshold) {
-                ELOG_DEBUG("No change when less than threshold: %f", diff);
-                return;
+            if (target.source < 0) {
+                // Take all layers of the first source until bitrates are known
+                target = {static_cast<int>(i),
+                    LayerRateEstimator::kMaxSpatialLayers - 1,
+                    LayerRateEstimator::kMaxTemporalLayers - 1};
+            }
+            LayerRateEstimator* rate = m_inputs[i]->rate();
+            for (int s = 0; s <= rate->maxSpatialId(); s++) {
+                for (int t = 0; t <= rate->maxTemporalId(); t++) {
+                    int bitrate = rate->bitrate(s, t);
+                    ELOG_DEBUG("Layer bitrate %zu S%dT%d: %d %p", i, s, t, bitrate, this);
+                    if (bitrate <= 0) {
+                        continue;
+                    }
+                    layerBitrates.push_back(bitrate);
+                    if (targetBitrate <= 0 ||
+                        std::abs(bitrate - (int) targetBps) <
+                        std::abs(targetBitrate - (int) targetBps)) {
+                        target = {static_cast<int>(i), s, t};
+                        targetBitrate = bitrate;
+                    }
+                }
             }
         }
-        if (m_current >= 0 && m_sources[m_current]) {
-            ELOG_DEBUG("Disable source index %u", m_current);
-            m_sources[m_current]->removeVideoDestination(this);
-        }
-        m_current = current;
-        if (m_current >= 0 && m_sources[m_current]) {
-            ELOG_DEBUG("Enable source index %u", m_current);
-            m_keyFrameArrived = false;
-            m_sources[m_current]->addVideoDestination(this);
-            ELOG_DEBUG("Request key frame ");
-            // Request key frame
-            FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
-            deliverFeedbackMsg(feedback);
+
+        VideoLayer previous = m_filter.target();
+        if (target != previous) {
+            bool change = true;
+            if (target.source >= 0 && previous.source >= 0 && targetBitrate > 0) {
+                int oldBitrate = m_inputs[previous.source]->rate()->bitrate(
+                    previous.spatialId, previous.temporalId) + 1;
+                double diff = std::abs(targetBitrate - oldBitrate);
+                diff = diff / oldBitrate;
+                if (diff < kBitrateChangeThreshold) {
+                    ELOG_DEBUG("No change when less than threshold: %f", diff);
+                    change = false;
+                } else if (targetBitrate > oldBitrate &&
+                           tsNow - m_lastUpdateTime < kMinimalUpdatePeriod) {
+                    ELOG_DEBUG("Delay switching up within minimal period");
+                    change = false;
+                }
+            }
+            if (change) {
+                ELOG_DEBUG("Switch layer %d S%dT%d -> %d S%dT%d",
+                    previous.source, previous.spatialId, previous.temporalId,
+                    target.source, target.spatialId, target.temporalId);
+                m_filter.setTarget(target);
+                m_lastUpdateTime = tsNow;
+            }
         }
+        // Ask again while the target is still waiting for a key frame
+        requestInput = keyFrameInput();
     }
-}
 
-void VideoQualitySwitch::BitrateCounter::onFrame(const Frame& frame)
-{
-    ELOG_TRACE("BitrateCounter onFrame %u %p", frame.length, this);
-    uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    const uint32_t bucketInterval = kBitrateCountPeriod / kBucketNum;
-    if (m_timeFrames.empty() ||
-        (tsNow - m_timeFrames.back().timeStamp) >= bucketInterval) {
-        Bucket bucket(tsNow);
-        m_timeFrames.push_back(bucket);
+    // Let the bandwidth allocator snap to bitrates of existing layers
+    if (!layerBitrates.empty()) {
+        std::sort(layerBitrates.begin(), layerBitrates.end());
+        MetaData metadata;
+        metadata.type = META_DATA_LAYER_BITRATES;
+        metadata.payload = reinterpret_cast<uint8_t*>(layerBitrates.data());
+        metadata.length = layerBitrates.size() * sizeof(uint32_t);
+        deliverMetaData(metadata);
     }
-    m_timeFrames.back().total += frame.length * 8;
-    m_totalBits += frame.length * 8;
 
-    while (m_timeFrames.size() > kBucketNum) {
-        m_totalBits -= m_timeFrames.front().total;
-        m_timeFrames.pop_front();
+    if (requestInput) {
+        ELOG_DEBUG("Request key frame ");
+        FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
+        requestInput->sendFeedback(feedback);
     }
 }
 
-uint32_t VideoQualitySwitch::BitrateCounter::bitrate()
+void VideoQualitySwitch::LayerInput::onFrame(const Frame& frame)
 {
-    if (m_timeFrames.size() == 0) {
-        return 0;
-    }
-    uint64_t tsNow = std::chrono::duration_cast<std::chrono::milliseconds>(
-       std::chrono::steady_clock::now().time_since_epoch()).count();
-    uint64_t tsLast = m_timeFrames.back().timeStamp;
-    if ((tsNow - tsLast) > kActiveTimeout) {
-        ELOG_DEBUG("Not active %p", this);
-        return 0;
-    }
-    uint32_t countedMs = m_timeFrames.size() * (kBitrateCountPeriod / kBucketNum);
-    uint32_t bitrate = m_totalBits * 1000 / countedMs;
-    return bitrate;
+    m_parent->onLayerFrame(m_index, frame);
+}
+
+void VideoQualitySwitch::LayerInput::onMetaData(const MetaData& metadata)
+{
+    m_parent->onLayerMetaData(m_index, metadata);
 }
 
 } // namespace owt_base
@@ -6,73 +6,67 @@
 #define OWT_BASE_SELECTOR_VIDEO_QUALITY_SWITCH_H
 
 #include "MediaFramePipeline.h"
+#include "LayerRateEstimator.h"
+#include "VideoLayerFilter.h"
 #include <logger.h>
 
-#include <deque>
+#include <boost/thread/mutex.hpp>
 #include <memory>
 #include <vector>
 
 namespace owt_base {
 
-class VideoQualitySwitch : public FrameSource,
-                           public FrameDestination {
+/*
+ * Forwards one layer out of simulcast sources, each of which may carry SVC
+ * layers. The switch stays subscribed to all sources and picks frames by
+ * source index and layer id with a VideoLayerFilter, so a layer change
+ * takes effect at the next suitable frame.
+ */
+class VideoQualitySwitch : public FrameSource {
     DECLARE_LOGGER();
 public:
     VideoQualitySwitch(std::vector<FrameSource*> sources);
     ~VideoQualitySwitch();
 
-    // Implements FrameDestination
-    void onFrame(const Frame&) override;
-    void onMetaData(const MetaData&) override;
-
-    // Implements FrameDestination
+    // Implements FrameSource
     void onFeedback(const owt_base::FeedbackMsg& msg) override;
 
     void setTargetBitrate(uint32_t targetBps);
 
-    class BitrateCounter : public FrameDestination {
+    // Subscription to one source
+    class LayerInput : public FrameDestination {
     public:
-        BitrateCounter(): m_totalBits  (0) {}
-        BitrateCounter(VideoQualitySwitch* parent)
-            : m_totalBits(0)
-            , m_parent(parent) {}
-        ~BitrateCounter() = default;
+        LayerInput(VideoQualitySwitch* parent, int index, FrameSource* source)
+            : m_parent(parent)
+            , m_index(index)
+            , m_rate(LayerRateEstimator::get(source)) {}
+        ~LayerInput() = default;
 
         // Implements FrameDestination
         void onFrame(const Frame&) override;
+        void onMetaData(const MetaData&) override;
 
-        uint32_t bitrate();
-    private:
-        struct Bucket {
-            Bucket(uint64_t ts) : timeStamp(ts), total(0) {}
-            uint64_t timeStamp;
-            uint32_t total;
-        };
-        std::deque<Bucket> m_timeFrames;
-        uint32_t m_totalBits;
+        // Shared with other switches on the same source
+        LayerRateEstimator* rate() { return m_rate.get(); }
 
+        void sendFeedback(const FeedbackMsg& msg) { deliverFeedbackMsg(msg); }
+    private:
         VideoQualitySwitch* m_parent;
+        int m_index;
+        std::shared_ptr<LayerRateEstimator> m_rate;
     };
 
-    // class KeyFrameDetector : public FrameDestination {
-    // public:
-    //     KeyFrameDetector(VideoQualitySwitch* parent)
-    //         : m_targetIdx(-1)
-    //         , m_parent(parent) {}
-    //     ~KeyFrameDetector() = default;
-
-    //     // Implements FrameDestination
-    //     void onFrame(const Frame&) override;
-    // private:
-    //     int m_targetIdx;
-    //     VideoQualitySwitch* m_parent;
-    // };
-
 private:
+    void onLayerFrame(int index, const Frame& frame);
+    void onLayerMetaData(int index, const MetaData& metadata);
+    // Returns the input to send a key frame request to, nullptr if none
+    LayerInput* keyFrameInput();
+
     std::vector<FrameSource*> m_sources;
-    std::vector<std::shared_ptr<BitrateCounter>> m_bitrateCounters;
-    int m_current;
-    bool m_keyFrameArrived;
+    std::vector<std::shared_ptr<LayerInput>> m_inputs;
+
+    boost::mutex m_mutex;
+    VideoLayerFilter m_filter;
     uint64_t m_lastUpdateTime;
 };
 
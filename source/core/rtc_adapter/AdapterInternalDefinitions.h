@@ -5,10 +5,13 @@
 #ifndef RTC_ADAPTER_ADAPTER_INTERNAL_DEFINITIONS_H_
 #define RTC_ADAPTER_ADAPTER_INTERNAL_DEFINITIONS_H_
 
+#include <BandwidthAllocator.h>
+
 #include <api/task_queue/task_queue_factory.h>
 #include <api/transport/webrtc_key_value_config.h>
 #include <call/call.h>
 #include <call/rtp_transport_controller_send_interface.h>
+#include <modules/rtp_rtcp/include/rtp_packet_sender.h>
 #include <rtc_base/task_queue.h>
 
 namespace rtc_adapter {
@@ -22,8 +25,15 @@ public:
     virtual webrtc::WebRtcKeyValueConfig* trial() = 0;
     virtual std::shared_ptr<webrtc::RtpTransportControllerSendInterface>
         rtpTransportController() = 0;
+    // Paced sender for the RTP modules of the connection
+    virtual webrtc::RtpPacketSender* pacedSender() = 0;
+    // Packets of the connection waiting in the paced sender
+    virtual size_t queuedPackets() = 0;
     virtual uint32_t estimatedBandwidth(uint32_t ssrc) = 0;
-    virtual void registerVideoSender(uint32_t ssrc) = 0;
+    virtual void registerVideoSender(uint32_t ssrc,
+                                     const BandwidthAllocator::SenderConfig& config) = 0;
+    virtual void setVideoSenderLayers(uint32_t ssrc,
+                                      const std::vector<uint32_t>& bitrates) = 0;
     virtual void deregisterVideoSender(uint32_t ssrc) = 0;
 };
 
@@ -0,0 +1,244 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BandwidthAllocator.h"
+
+#include <algorithm>
+
+#include <rtc_base/logging.h>
+
+namespace rtc_adapter {
+
+std::unique_ptr<BandwidthAllocator> BandwidthAllocator::CreateDefault()
+{
+    return std::unique_ptr<BandwidthAllocator>(new WeightedBandwidthAllocator());
+}
+
+WeightedBandwidthAllocator::WeightedBandwidthAllocator()
+    : m_estimatedBandwidth(0)
+    , m_fixedBitrate(0)
+    , m_adjustableMin(0)
+    , m_adjustablePriority(0)
+    , m_orderDirty(false)
+    , m_dirty(false)
+{
+}
+
+WeightedBandwidthAllocator::~WeightedBandwidthAllocator()
+{
+}
+
+void WeightedBandwidthAllocator::addAdjustable(const Sender& sender)
+{
+    m_adjustableMin += sender.config.min_bitrate_bps;
+    m_adjustablePriority += sender.config.priority;
+    m_orderDirty = true;
+}
+
+void WeightedBandwidthAllocator::removeAdjustable(const Sender& sender)
+{
+    m_adjustableMin -= sender.config.min_bitrate_bps;
+    m_adjustablePriority -= sender.config.priority;
+    m_orderDirty = true;
+}
+
+void WeightedBandwidthAllocator::addSender(uint32_t ssrc, const SenderConfig& config)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    Sender& sender = m_senders[ssrc];
+    if (sender.adjustable) {
+        removeAdjustable(sender);
+    }
+    sender.config = config;
+    if (sender.config.priority <= 0) {
+        sender.config.priority = 1;
+    }
+    if (sender.adjustable) {
+        addAdjustable(sender);
+    }
+    m_dirty = true;
+}
+
+void WeightedBandwidthAllocator::removeSender(uint32_t ssrc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_senders.find(ssrc);
+    if (it == m_senders.end()) {
+        return;
+    }
+    if (it->second.adjustable) {
+        removeAdjustable(it->second);
+    } else {
+        m_fixedBitrate -= it->second.bitrate;
+    }
+    m_senders.erase(it);
+    m_dirty = true;
+}
+
+void WeightedBandwidthAllocator::updateSender(uint32_t ssrc, uint32_t bitrate_bps, bool adjustable)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_senders.find(ssrc);
+    if (it == m_senders.end()) {
+        return;
+    }
+    Sender& sender = it->second;
+    if (sender.adjustable != adjustable) {
+        if (adjustable) {
+            m_fixedBitrate -= sender.bitrate;
+            addAdjustable(sender);
+        } else {
+            removeAdjustable(sender);
+            m_fixedBitrate += bitrate_bps;
+        }
+        m_dirty = true;
+    } else if (!adjustable) {
+        m_fixedBitrate += bitrate_bps;
+        m_fixedBitrate -= sender.bitrate;
+        m_dirty = true;
+    }
+    // Bitrate of an adjustable sender does not change the split
+    sender.bitrate = bitrate_bps;
+    sender.adjustable = adjustable;
+    if (!adjustable) {
+        sender.allocation = bitrate_bps;
+    }
+}
+
+void WeightedBandwidthAllocator::setLayerBitrates(uint32_t ssrc, const std::vector<uint32_t>& bitrates)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_senders.find(ssrc);
+    if (it == m_senders.end()) {
+        return;
+    }
+    it->second.layers = bitrates;
+    std::sort(it->second.layers.begin(), it->second.layers.end());
+    m_dirty = true;
+}
+
+void WeightedBandwidthAllocator::setEstimatedBandwidth(uint32_t bitrate_bps)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_estimatedBandwidth != bitrate_bps) {
+        m_estimatedBandwidth = bitrate_bps;
+        m_dirty = true;
+    }
+}
+
+uint32_t WeightedBandwidthAllocator::allocation(uint32_t ssrc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_dirty) {
+        allocate();
+        m_dirty = false;
+    }
+    auto it = m_senders.find(ssrc);
+    return (it != m_senders.end()) ? it->second.allocation : 0;
+}
+
+void WeightedBandwidthAllocator::allocate()
+{
+    if (m_orderDirty) {
+        m_adjustable.clear();
+        for (auto& p : m_senders) {
+            if (p.second.adjustable) {
+                m_adjustable.push_back(&p.second);
+            }
+        }
+        std::stable_sort(m_adjustable.begin(), m_adjustable.end(),
+            [](const Sender* a, const Sender* b) {
+                return a->config.priority > b->config.priority;
+            });
+        m_orderDirty = false;
+    }
+    if (m_adjustable.empty()) {
+        return;
+    }
+
+    uint64_t available = (m_estimatedBandwidth > m_fixedBitrate) ?
+        (m_estimatedBandwidth - m_fixedBitrate) : 0;
+
+    // Minimum bitrates come first, scaled down if they do not fit
+    if (m_adjustableMin >= available) {
+        for (Sender* sender : m_adjustable) {
+            sender->allocation = m_adjustableMin ?
+                available * sender->config.min_bitrate_bps / m_adjustableMin : 0;
+        }
+        return;
+    }
+
+    // Share the rest by priority, capping at max bitrate
+    uint64_t remaining = available - m_adjustableMin;
+    uint64_t uncappedPriority = m_adjustablePriority;
+    for (Sender* sender : m_adjustable) {
+        sender->allocation = sender->config.min_bitrate_bps;
+        sender->capped = false;
+    }
+    bool capped = true;
+    while (capped && uncappedPriority > 0 && remaining > 0) {
+        capped = false;
+        uint64_t totalPriority = uncappedPriority;
+        for (Sender* sender : m_adjustable) {
+            if (sender->capped) {
+                continue;
+            }
+            uint64_t share = remaining * sender->config.priority / totalPriority;
+            uint32_t maxBitrate = sender->config.max_bitrate_bps;
+            if (maxBitrate && sender->allocation + share >= maxBitrate) {
+                remaining -= maxBitrate - sender->allocation;
+                sender->allocation = maxBitrate;
+                sender->capped = true;
+                uncappedPriority -= sender->config.priority;
+                capped = true;
+            }
+        }
+    }
+    if (uncappedPriority > 0 && remaining > 0) {
+        uint64_t shared = remaining;
+        for (Sender* sender : m_adjustable) {
+            if (sender->capped) {
+                continue;
+            }
+            uint64_t share = shared * sender->config.priority / uncappedPriority;
+            sender->allocation += share;
+            remaining -= share;
+        }
+    }
+
+    // Snap to layers, leftover lets higher priority senders step up
+    for (Sender* sender : m_adjustable) {
+        if (sender->layers.empty()) {
+            continue;
+        }
+        auto layer = std::upper_bound(
+            sender->layers.begin(), sender->layers.end(), sender->allocation);
+        uint32_t snapped = (layer == sender->layers.begin()) ?
+            sender->layers.front() : *(layer - 1);
+        if (snapped < sender->allocation) {
+            remaining += sender->allocation - snapped;
+        } else if (snapped > sender->allocation) {
+            // Lowest layer is sent anyway, take it from the leftover
+            remaining -= std::min<uint64_t>(snapped - sender->allocation, remaining);
+        }
+        sender->allocation = snapped;
+    }
+    for (Sender* sender : m_adjustable) {
+        if (sender->layers.empty()) {
+            continue;
+        }
+        auto next = std::upper_bound(
+            sender->layers.begin(), sender->layers.end(), sender->allocation);
+        if (next != sender->layers.end() &&
+            *next - sender->allocation <= remaining &&
+            (!sender->config.max_bitrate_bps || *next <= sender->config.max_bitrate_bps)) {
+            remaining -= *next - sender->allocation;
+            sender->allocation = *next;
+        }
+    }
+    RTC_LOG(LS_VERBOSE) << "Allocated " << available << " bps among "
+                        << m_adjustable.size() << " senders";
+}
+
+} // namespace rtc_adapter
@@ -0,0 +1,87 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_BANDWIDTH_ALLOCATOR_
+#define RTC_ADAPTER_BANDWIDTH_ALLOCATOR_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rtc_adapter {
+
+// Splits the estimated bandwidth of a connection among its video senders.
+class BandwidthAllocator {
+public:
+    struct SenderConfig {
+        // Weight when sharing bandwidth among adjustable senders
+        int priority = 1;
+        uint32_t min_bitrate_bps = 0;
+        // 0 for no limit
+        uint32_t max_bitrate_bps = 0;
+    };
+
+    virtual ~BandwidthAllocator() {}
+
+    virtual void addSender(uint32_t ssrc, const SenderConfig& config) = 0;
+    virtual void removeSender(uint32_t ssrc) = 0;
+    // Called on every send bitrate notification of one sender
+    virtual void updateSender(uint32_t ssrc, uint32_t bitrate_bps, bool adjustable) = 0;
+    // Ascending bitrates of the simulcast/SVC layers the sender can switch
+    // among, allocations are snapped to one of them
+    virtual void setLayerBitrates(uint32_t ssrc, const std::vector<uint32_t>& bitrates) = 0;
+    virtual void setEstimatedBandwidth(uint32_t bitrate_bps) = 0;
+    virtual uint32_t allocation(uint32_t ssrc) = 0;
+
+    // Priority weighted allocator with min/max bitrate and layer awareness
+    static std::unique_ptr<BandwidthAllocator> CreateDefault();
+};
+
+class WeightedBandwidthAllocator : public BandwidthAllocator {
+public:
+    WeightedBandwidthAllocator();
+    ~WeightedBandwidthAllocator();
+
+    void addSender(uint32_t ssrc, const SenderConfig& config) override;
+    void removeSender(uint32_t ssrc) override;
+    void updateSender(uint32_t ssrc, uint32_t bitrate_bps, bool adjustable) override;
+    void setLayerBitrates(uint32_t ssrc, const std::vector<uint32_t>& bitrates) override;
+    void setEstimatedBandwidth(uint32_t bitrate_bps) override;
+    uint32_t allocation(uint32_t ssrc) override;
+
+private:
+    struct Sender {
+        SenderConfig config;
+        uint32_t bitrate = 0;
+        bool adjustable = false;
+        std::vector<uint32_t> layers;
+        uint32_t allocation = 0;
+        // Reached max bitrate in the current allocation
+        bool capped = false;
+    };
+
+    // Recomputes the split among adjustable senders, only done when marked dirty
+    void allocate();
+    // Keeps the sums of adjustable senders in step with a sender change
+    void addAdjustable(const Sender& sender);
+    void removeAdjustable(const Sender& sender);
+
+    std::mutex m_mutex;
+    std::map<uint32_t, Sender> m_senders;
+    uint32_t m_estimatedBandwidth;
+    // Sum of bitrates of the senders that can not be adjusted
+    uint64_t m_fixedBitrate;
+    // Sums of min bitrates and priorities of the adjustable senders
+    uint64_t m_adjustableMin;
+    uint64_t m_adjustablePriority;
+    // Adjustable senders by descending priority, rebuilt when the set changes
+    std::vector<Sender*> m_adjustable;
+    bool m_orderDirty;
+    bool m_dirty;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_BANDWIDTH_ALLOCATOR_ */
@@ -0,0 +1,246 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_MULTI_FLOW_PACER_
+#define RTC_ADAPTER_MULTI_FLOW_PACER_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace rtc_adapter {
+
+// Paces the packets of many flows from one periodic loop, instead of one
+// pacer and timer per flow. Each flow keeps its own pacing rate and media
+// budget, following the periodic mode of the webrtc PacingController:
+// the budget grows with the rate every process interval, unused budget
+// is not carried over, overuse is paid back. Flows with nothing queued are
+// skipped and credited when they have packets again, as a pacer of their
+// own would be when woken up. Packets due in one interval are handed to
+// the flow's sender as one batch.
+//
+// process() is called by a single thread. enqueue() may be called from
+// any thread; it returns true when the pacer went idle and process()
+// has to be scheduled again.
+template <typename Packet>
+class MultiFlowPacer {
+public:
+    static constexpr int64_t kProcessIntervalMs = 5;
+    // The rate is raised to drain the queue within this time
+    static constexpr int64_t kMaxQueueTimeMs = 2000;
+    // Budget window and longest interval credited at once, same as the
+    // webrtc pacer
+    static constexpr int64_t kWindowMs = 500;
+    static constexpr int64_t kMaxElapsedMs = 30;
+
+    typedef std::function<void(std::vector<std::unique_ptr<Packet>>&)> Sender;
+
+    class Flow {
+    public:
+        explicit Flow(Sender sender)
+            : m_sender(std::move(sender))
+            , m_queuedPackets(0)
+        {
+        }
+
+        void setPacingRate(uint32_t bps)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rateBps = bps;
+        }
+        uint32_t pacingRate()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_rateBps;
+        }
+        size_t queuedPackets() { return m_queuedPackets; }
+
+    private:
+        friend class MultiFlowPacer;
+
+        struct Queued {
+            std::unique_ptr<Packet> packet;
+            size_t size;
+        };
+
+        bool push(std::unique_ptr<Packet> packet, size_t size, bool priority)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_removed) {
+                return false;
+            }
+            (priority ? m_priority : m_normal).push_back({ std::move(packet), size });
+            m_queuedBytes += size;
+            m_queuedPackets++;
+            return true;
+        }
+
+        size_t remove()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_removed = true;
+            size_t count = m_priority.size() + m_normal.size();
+            m_priority.clear();
+            m_normal.clear();
+            m_queuedBytes = 0;
+            m_queuedPackets = 0;
+            return count;
+        }
+
+        // Moves the packets due within the budget into batch
+        size_t collect(int64_t nowMs, std::vector<std::unique_ptr<Packet>>& batch)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int64_t elapsedMs = m_lastProcessMs >= 0 ? std::min(nowMs - m_lastProcessMs, kMaxElapsedMs) : kProcessIntervalMs;
+            m_lastProcessMs = nowMs;
+
+            if (!m_rateBps) {
+                // No rate yet, not paced
+                m_budget = 0;
+                return drain(batch);
+            }
+
+            int64_t rateBps = m_rateBps;
+            int64_t queueRateBps = static_cast<int64_t>(m_queuedBytes) * 8 * 1000 / kMaxQueueTimeMs;
+            rateBps = std::max(rateBps, queueRateBps);
+
+            int64_t maxBudget = rateBps * kWindowMs / 8000;
+            int64_t bytes = rateBps * elapsedMs / 8000;
+            m_budget = m_budget < 0 ? std::min(m_budget + bytes, maxBudget) : std::min(bytes, maxBudget);
+
+            size_t sent = drain(batch);
+            m_budget = std::max(m_budget, -maxBudget);
+            return sent;
+        }
+
+        size_t drain(std::vector<std::unique_ptr<Packet>>& batch)
+        {
+            size_t count = 0;
+            while (m_rateBps == 0 || m_budget > 0) {
+                std::deque<Queued>& queue = m_priority.empty() ? m_normal : m_priority;
+                if (queue.empty()) {
+                    break;
+                }
+                m_budget -= queue.front().size;
+                m_queuedBytes -= queue.front().size;
+                batch.push_back(std::move(queue.front().packet));
+                queue.pop_front();
+                count++;
+            }
+            m_queuedPackets -= count;
+            return count;
+        }
+
+        Sender m_sender;
+        std::mutex m_mutex;
+        uint32_t m_rateBps = 0;
+        int64_t m_budget = 0;
+        int64_t m_lastProcessMs = -1;
+        bool m_removed = false;
+        size_t m_queuedBytes = 0;
+        std::atomic<size_t> m_queuedPackets;
+        std::deque<Queued> m_priority;
+        std::deque<Queued> m_normal;
+    };
+
+    struct Stats {
+        uint64_t wakeups = 0;
+        uint64_t packets = 0;
+        uint64_t batches = 0;
+        size_t flows = 0;
+    };
+
+    MultiFlowPacer()
+        : m_queuedPackets(0)
+        , m_idle(true)
+    {
+    }
+
+    std::shared_ptr<Flow> addFlow(Sender sender)
+    {
+        std::shared_ptr<Flow> flow = std::make_shared<Flow>(std::move(sender));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flows.push_back(flow);
+        return flow;
+    }
+
+    // Queued packets of the flow are dropped, its sender is not called
+    // after this returns
+    void removeFlow(const std::shared_ptr<Flow>& flow)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find(m_flows.begin(), m_flows.end(), flow);
+        if (it != m_flows.end()) {
+            m_queuedPackets -= flow->remove();
+            m_flows.erase(it);
+        }
+    }
+
+    // Retransmissions go with priority
+    bool enqueue(Flow* flow, std::unique_ptr<Packet> packet, size_t size, bool priority)
+    {
+        if (!flow->push(std::move(packet), size, priority)) {
+            return false;
+        }
+        m_queuedPackets++;
+        return m_idle.exchange(false);
+    }
+
+    // Returns the delay until the next call, -1 if the pacer is idle
+    int64_t process(int64_t nowMs)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.wakeups++;
+        for (auto& flow : m_flows) {
+            if (!flow->m_queuedPackets) {
+                continue;
+            }
+            m_batch.clear();
+            size_t count = flow->collect(nowMs, m_batch);
+            if (!count) {
+                continue;
+            }
+            m_queuedPackets -= count;
+            m_stats.packets += count;
+            m_stats.batches++;
+            flow->m_sender(m_batch);
+        }
+
+        if (m_queuedPackets > 0) {
+            return kProcessIntervalMs;
+        }
+        m_idle = true;
+        // Packets enqueued while going idle did not get a wakeup
+        if (m_queuedPackets > 0 && m_idle.exchange(false)) {
+            return kProcessIntervalMs;
+        }
+        return -1;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        stats.flows = m_flows.size();
+        return stats;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::list<std::shared_ptr<Flow>> m_flows;
+    std::vector<std::unique_ptr<Packet>> m_batch;
+    std::atomic<int64_t> m_queuedPackets;
+    std::atomic<bool> m_idle;
+    Stats m_stats;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_MULTI_FLOW_PACER_ */
@@ -5,6 +5,8 @@
 #include <AdapterInternalDefinitions.h>
 #include <AudioSendAdapter.h>
 #include <RtcAdapter.h>
+#include <SharedPacer.h>
+#include <VideoFrameAssembler.h>
 #include <VideoReceiveAdapter.h>
 #include <VideoSendAdapter.h>
 #include <thread/ProcessThreadProxy.h>
@@ -44,6 +46,8 @@ static std::shared_ptr<rtc::TaskQueue> g_taskQueue =
         webrtc::TaskQueueFactory::Priority::NORMAL));
 
 static constexpr int kStartBitrateBps = 800000;
+// Same as the default pacing factor of webrtc
+static constexpr double kPacingFactor = 2.5;
 
 class RtcAdapterImpl : public RtcAdapter,
                        public CallOwner,
@@ -63,7 +67,6 @@ public:
     AudioSendAdapter* createAudioSender(const Config&) override;
     void destoryAudioSender(AudioSendAdapter*) override;
 
-
     typedef std::shared_ptr<webrtc::Call> CallPtr;
     typedef std::shared_ptr<webrtc::RtpTransportControllerSendInterface> ControllerSendPtr;
 
@@ -83,9 +86,17 @@ public:
     {
         return m_transportControllerSend;
     }
+    webrtc::RtpPacketSender* pacedSender() override { return m_pacedFlow.get(); }
+    size_t queuedPackets() override
+    {
+        return m_pacedFlow ? m_pacedFlow->queuedPackets() : 0;
+    }
     uint32_t estimatedBandwidth(uint32_t ssrc) override;
-    void registerVideoSender(uint32_t ssrc) override;
+    void registerVideoSender(uint32_t ssrc,
+                             const BandwidthAllocator::SenderConfig& config) override;
     void deregisterVideoSender(uint32_t ssrc) override;
+    void setVideoSenderLayers(uint32_t ssrc,
+                              const std::vector<uint32_t>& bitrates) override;
 
     //Implements webrtc::TargetTransferRateObjserver
     void OnTargetTransferRate(webrtc::TargetTransferRate) override;
@@ -103,14 +114,14 @@ private:
 
     // For sender
     ControllerSendPtr m_transportControllerSend = nullptr;
-    std::mutex m_bitrateMutex;
-    std::map<uint32_t, uint32_t> m_sendBitrate;
-    std::map<uint32_t, bool> m_adjustBitrate;
-    std::map<uint32_t, uint32_t> m_allocBitrate;
-    uint32_t m_estimatedBandwidth = 0;
+    // Destroyed before the controller owning its packet router
+    std::unique_ptr<SharedPacer::PacedFlow> m_pacedFlow;
+    // Thread safe by itself, set once for the adapter
+    const std::unique_ptr<BandwidthAllocator> m_allocator;
 };
 
 RtcAdapterImpl::RtcAdapterImpl()
+    : m_allocator(BandwidthAllocator::CreateDefault())
 {
 }
 
@@ -174,6 +185,10 @@ void RtcAdapterImpl::initRtpTransportController()
             nullptr/*network_state_predicator_factory*/,
             nullptr/*network_controller_factory*/, bitrateConstraints,
             std::move(pacerThreadProxy)/*pacer_thread*/, g_taskQueueFactory.get(), g_fieldTrial.get());
+        // Paced on the shared pacer instead of the pacer of the controller
+        m_pacedFlow = SharedPacer::GetSharedPacer()->createFlow(
+            m_transportControllerSend->packet_router());
+        m_pacedFlow->setPacingRate(kStartBitrateBps * kPacingFactor);
         m_transportControllerSend->RegisterTargetTransferRateObserver(this);
     }
 }
@@ -182,23 +197,27 @@ void RtcAdapterImpl::OnTargetTransferRate(webrtc::TargetTransferRate msg)
 {
     uint32_t target_bitrate_bps = msg.target_rate.bps();
     RTC_LOG(LS_INFO) << "OnTargetTransferRate(bps): " << target_bitrate_bps;
-    m_estimatedBandwidth = target_bitrate_bps;
+    m_allocator->setEstimatedBandwidth(target_bitrate_bps);
+    if (m_pacedFlow) {
+        m_pacedFlow->setPacingRate(target_bitrate_bps * kPacingFactor);
+    }
 }
 
-void RtcAdapterImpl::registerVideoSender(uint32_t ssrc)
+void RtcAdapterImpl::registerVideoSender(uint32_t ssrc,
+                                         const BandwidthAllocator::SenderConfig& config)
 {
-    std::lock_guard<std::mutex> guard(m_bitrateMutex);
-    m_sendBitrate[ssrc] = 0;
-    m_adjustBitrate[ssrc] = false;
-    m_allocBitrate[ssrc] = 0;
+    m_allocator->addSender(ssrc, config);
 }
 
 void RtcAdapterImpl::deregisterVideoSender(uint32_t ssrc)
 {
-    std::lock_guard<std::mutex> guard(m_bitrateMutex);
-    m_sendBitrate.erase(ssrc);
-    m_adjustBitrate.erase(ssrc);
-    m_allocBitrate.erase(ssrc);
+    m_allocator->removeSender(ssrc);
+}
+
+void RtcAdapterImpl::setVideoSenderLayers(uint32_t ssrc,
+                                          const std::vector<uint32_t>& bitrates)
+{
+    m_allocator->setLayerBitrates(ssrc, bitrates);
 }
 
 void RtcAdapterImpl::notifyBitrate(uint32_t total_bitrate_bps,
@@ -206,64 +225,26 @@ void RtcAdapterImpl::notifyBitrate(uint32_t total_bitrate_bps,
                                    bool adjustable,
                                    uint32_t ssrc)
 {
-    std::lock_guard<std::mutex> guard(m_bitrateMutex);
-    if (m_sendBitrate.count(ssrc) > 0) {
-        m_sendBitrate[ssrc] = total_bitrate_bps;
-        m_adjustBitrate[ssrc] = adjustable;
-    } else {
-        return;
-    }
-    uint32_t total = 0;
-    for (auto const& p : m_sendBitrate) {
-        total += p.second;
-    }
-    if (total >= m_estimatedBandwidth) {
-        for (auto const& p : m_sendBitrate) {
-            m_allocBitrate[p.first] = m_estimatedBandwidth;
-        }
-    } else {
-        uint32_t remaining = m_estimatedBandwidth;
-        uint32_t adjustNum = 0;
-        for (auto const& p : m_sendBitrate) {
-            if (!m_adjustBitrate[p.first]) {
-                m_allocBitrate[p.first] = p.second;
-                if (remaining >= p.second) {
-                    remaining -= p.second;
-                } else {
-                    remaining = 0;
-                }
-            } else {
-                adjustNum++;
-            }
-        }
-        uint32_t adjustBitrate = (double) remaining / adjustNum;
-        for (auto const& p : m_sendBitrate) {
-            if (m_adjustBitrate[p.first]) {
-                m_allocBitrate[p.first] = adjustBitrate;
-            }
-        }
-    }
+    m_allocator->updateSender(ssrc, total_bitrate_bps, adjustable);
 }
 
 uint32_t RtcAdapterImpl::estimatedBandwidth(uint32_t ssrc)
 {
-    std::lock_guard<std::mutex> guard(m_bitrateMutex);
-    if (m_allocBitrate.count(ssrc) > 0) {
-        return m_allocBitrate[ssrc];
-    }
-    return 0;
+    return m_allocator->allocation(ssrc);
 }
 
 VideoReceiveAdapter* RtcAdapterImpl::createVideoReceiver(const Config& config)
 {
+    if (config.frame_assembler) {
+        return new VideoFrameAssembler(config);
+    }
     initCall();
     return new VideoReceiveAdapterImpl(this, config);
 }
 
 void RtcAdapterImpl::destoryVideoReceiver(VideoReceiveAdapter* video_recv_adapter)
 {
-    VideoReceiveAdapterImpl* impl = static_cast<VideoReceiveAdapterImpl*>(video_recv_adapter);
-    delete impl;
+    delete video_recv_adapter;
 }
 
 VideoSendAdapter* RtcAdapterImpl::createVideoSender(const Config& config)
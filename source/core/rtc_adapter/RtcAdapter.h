@@ -7,6 +7,8 @@
 
 #include <MediaFramePipeline.h>
 
+#include <vector>
+
 namespace rtc_adapter {
 
 class AdapterDataListener {
@@ -37,6 +39,7 @@ public:
 
 class VideoReceiveAdapter {
 public:
+    virtual ~VideoReceiveAdapter() {}
     virtual int onRtpData(char* data, int len) = 0;
     virtual void requestKeyFrame() = 0;
     virtual void setPreferredLayers(int spatialId, int temporalId) = 0;
@@ -48,12 +51,22 @@ public:
         uint32_t total_bitrate_bps = 0;
         uint32_t retransmit_bitrate_bps = 0;
         uint32_t estimated_bandwidth = 0;
+        // From the latest RTCP report block, fraction lost is in 1/256
+        uint32_t fraction_lost = 0;
+        uint32_t rtt_ms = 0;
+        // NACKed packets found in or missing from the history
+        uint64_t nack_hits = 0;
+        uint64_t nack_misses = 0;
+        // Packets of the connection waiting in the pacer
+        uint32_t queued_packets = 0;
     };
     virtual void onFrame(const owt_base::Frame&) = 0;
     virtual int onRtcpData(const char* data, int len) = 0;
     virtual uint32_t ssrc() = 0;
     virtual void reset() = 0;
     virtual Stats getStats() = 0;
+    // Ascending bitrates of the layers the source of this sender switches among
+    virtual void setLayerBitrates(const std::vector<uint32_t>& bitrates) = 0;
 };
 
 class AudioReceiveAdapter {
@@ -83,6 +96,12 @@ public:
         int mid_ext = 0;
         // Bandwidth estimation
         bool bandwidth_estimation = false;
+        // Bandwidth allocation among the video senders of one adapter
+        int priority = 1;
+        uint32_t min_bitrate_bps = 0;
+        uint32_t max_bitrate_bps = 0;
+        // Assemble received video frames without webrtc::VideoReceiveStream
+        bool frame_assembler = false;
         AdapterDataListener* rtp_listener = nullptr;
         AdapterStatsListener* stats_listener = nullptr;
         AdapterFrameListener* frame_listener = nullptr;
@@ -0,0 +1,94 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SharedPacer.h"
+#include "thread/StaticTaskQueueFactory.h"
+
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+
+namespace rtc_adapter {
+
+std::shared_ptr<SharedPacer> SharedPacer::GetSharedPacer()
+{
+    static std::shared_ptr<SharedPacer> s_pacer = std::make_shared<SharedPacer>();
+    return s_pacer;
+}
+
+SharedPacer::SharedPacer()
+{
+    // Same queue as the per connection pacers of webrtc
+    std::unique_ptr<webrtc::TaskQueueFactory> factory = createStaticTaskQueueFactory();
+    m_taskQueue.reset(new rtc::TaskQueue(factory->CreateTaskQueue(
+        "TaskQueuePacedSender", webrtc::TaskQueueFactory::Priority::NORMAL)));
+    RTC_LOG(LS_INFO) << "Create SharedPacer";
+}
+
+SharedPacer::~SharedPacer()
+{
+    // Pending tasks are dropped with the queue
+    m_taskQueue.reset();
+    Pacer::Stats stats = m_pacer.stats();
+    RTC_LOG(LS_INFO) << "Destroy SharedPacer wakeups: " << stats.wakeups
+                     << ", packets: " << stats.packets
+                     << ", batches: " << stats.batches;
+}
+
+std::unique_ptr<SharedPacer::PacedFlow> SharedPacer::createFlow(webrtc::PacketRouter* router)
+{
+    return std::unique_ptr<PacedFlow>(new PacedFlow(GetSharedPacer(), router));
+}
+
+void SharedPacer::wakeUp()
+{
+    m_taskQueue->PostTask([this]() { process(); });
+}
+
+void SharedPacer::process()
+{
+    int64_t delayMs = m_pacer.process(rtc::TimeMillis());
+    if (delayMs >= 0) {
+        m_taskQueue->PostDelayedTask([this]() { process(); }, delayMs);
+    }
+}
+
+SharedPacer::PacedFlow::PacedFlow(std::shared_ptr<SharedPacer> pacer, webrtc::PacketRouter* router)
+    : m_pacer(pacer)
+{
+    m_flow = m_pacer->m_pacer.addFlow(
+        [router](std::vector<std::unique_ptr<webrtc::RtpPacketToSend>>& batch) {
+            webrtc::PacedPacketInfo info;
+            for (auto& packet : batch) {
+                router->SendPacket(std::move(packet), info);
+            }
+        });
+}
+
+SharedPacer::PacedFlow::~PacedFlow()
+{
+    m_pacer->m_pacer.removeFlow(m_flow);
+}
+
+void SharedPacer::PacedFlow::setPacingRate(uint32_t bps)
+{
+    m_flow->setPacingRate(bps);
+}
+
+void SharedPacer::PacedFlow::EnqueuePackets(
+    std::vector<std::unique_ptr<webrtc::RtpPacketToSend>> packets)
+{
+    bool wakeUp = false;
+    for (auto& packet : packets) {
+        // Only video is paced, AudioSendAdapter sends without a pacer
+        auto type = packet->packet_type();
+        bool priority = type && *type == webrtc::RtpPacketMediaType::kRetransmission;
+        size_t size = packet->size();
+        wakeUp |= m_pacer->m_pacer.enqueue(m_flow.get(), std::move(packet), size, priority);
+    }
+    if (wakeUp) {
+        m_pacer->wakeUp();
+    }
+}
+
+} // namespace rtc_adapter
@@ -0,0 +1,65 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_SHARED_PACER_
+#define RTC_ADAPTER_SHARED_PACER_
+
+#include <memory>
+
+#include "MultiFlowPacer.h"
+
+#include <modules/pacing/packet_router.h>
+#include <modules/rtp_rtcp/include/rtp_packet_sender.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
+#include <rtc_base/task_queue.h>
+
+namespace rtc_adapter {
+
+// One pacer for all the connections of the process, driven by a single
+// timer on the pacer task queue. Each connection gets a PacedFlow as the
+// paced sender of its video RTP modules, audio is sent unpaced by
+// AudioSendAdapter. Bandwidth estimation stays with the
+// RtpTransportControllerSend of the connection, which only sets the
+// pacing rate of its flow. The pacer lives as long as the process.
+class SharedPacer {
+public:
+    typedef MultiFlowPacer<webrtc::RtpPacketToSend> Pacer;
+
+    class PacedFlow : public webrtc::RtpPacketSender {
+    public:
+        PacedFlow(std::shared_ptr<SharedPacer> pacer, webrtc::PacketRouter* router);
+        ~PacedFlow() override;
+
+        void setPacingRate(uint32_t bps);
+        size_t queuedPackets() { return m_flow->queuedPackets(); }
+
+        // Implements webrtc::RtpPacketSender
+        void EnqueuePackets(
+            std::vector<std::unique_ptr<webrtc::RtpPacketToSend>> packets) override;
+
+    private:
+        std::shared_ptr<SharedPacer> m_pacer;
+        std::shared_ptr<Pacer::Flow> m_flow;
+    };
+
+    static std::shared_ptr<SharedPacer> GetSharedPacer();
+
+    SharedPacer();
+    ~SharedPacer();
+
+    // Packets are sent to the router until the flow is destroyed
+    std::unique_ptr<PacedFlow> createFlow(webrtc::PacketRouter* router);
+    Pacer::Stats stats() { return m_pacer.stats(); }
+
+private:
+    void wakeUp();
+    void process();
+
+    Pacer m_pacer;
+    std::unique_ptr<rtc::TaskQueue> m_taskQueue;
+};
+
+} // namespace rtc_adapter
+
+#endif
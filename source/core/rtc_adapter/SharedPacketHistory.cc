@@ -0,0 +1,69 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SharedPacketHistory.h"
+
+namespace rtc_adapter {
+
+SharedPacketHistory::SharedPacketHistory(std::shared_ptr<SharedVideoPacketizer> packetizer,
+    int64_t historyMs, size_t maxPackets)
+    : m_packetizer(packetizer)
+    , m_historyMs(historyMs)
+    , m_maxPackets(maxPackets)
+{
+}
+
+SharedPacketHistory::~SharedPacketHistory()
+{
+}
+
+void SharedPacketHistory::put(uint16_t seq, const SharedVideoPacketizer::PacketizedFrame& frame,
+    uint32_t index, uint32_t timestamp, int64_t nowMs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_entries[m_unwrapper.Unwrap(seq)] =
+        Translation { frame.firstSequence + index, frame.stream, timestamp, nowMs, -1 };
+    m_stats.packets++;
+    cull(nowMs);
+}
+
+bool SharedPacketHistory::getForResend(uint16_t seq, int64_t nowMs,
+    int64_t minIntervalMs, Entry* entry)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_entries.find(m_unwrapper.UnwrapWithoutUpdate(seq));
+    if (it == m_entries.end()) {
+        // Charged to the stream currently sent
+        m_packetizer->addHistoryMiss(m_entries.empty() ? nullptr : m_entries.rbegin()->second.stream);
+        return false;
+    }
+    entry->frame = m_packetizer->getPacket(it->second.sequence, it->second.stream, &entry->index);
+    if (!entry->frame) {
+        return false;
+    }
+    if (it->second.resendTimeMs >= 0 &&
+        nowMs - it->second.resendTimeMs < minIntervalMs) {
+        return false;
+    }
+    it->second.resendTimeMs = nowMs;
+    entry->timestamp = it->second.timestamp;
+    return true;
+}
+
+SharedPacketHistory::Stats SharedPacketHistory::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_stats;
+}
+
+void SharedPacketHistory::cull(int64_t nowMs)
+{
+    while (!m_entries.empty() &&
+           (m_entries.size() > m_maxPackets ||
+            nowMs - m_entries.begin()->second.sendTimeMs > m_historyMs)) {
+        m_entries.erase(m_entries.begin());
+    }
+}
+
+} // namespace rtc_adapter
@@ -0,0 +1,68 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_SHARED_PACKET_HISTORY_
+#define RTC_ADAPTER_SHARED_PACKET_HISTORY_
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "SharedVideoPacketizer.h"
+
+#include <modules/include/module_common_types_public.h>
+
+namespace rtc_adapter {
+
+// Retransmission history of one subscriber. It holds no packets: each
+// entry translates the subscriber sequence number to the original sequence
+// number of the SharedVideoPacketizer, whose history keeps the packets
+// once for all subscribers, and keeps the rewritten RTP timestamp.
+// Retransmission hits and misses are counted by the packetizer per source
+// stream.
+class SharedPacketHistory {
+public:
+    struct Entry {
+        std::shared_ptr<const SharedVideoPacketizer::PacketizedFrame> frame;
+        uint32_t index = 0;
+        uint32_t timestamp = 0;
+    };
+    struct Stats {
+        uint64_t packets = 0;
+    };
+
+    SharedPacketHistory(std::shared_ptr<SharedVideoPacketizer> packetizer,
+                        int64_t historyMs, size_t maxPackets);
+    ~SharedPacketHistory();
+
+    void put(uint16_t seq, const SharedVideoPacketizer::PacketizedFrame& frame,
+             uint32_t index, uint32_t timestamp, int64_t nowMs);
+    // Returns false if the packet is gone or was resent within minIntervalMs
+    bool getForResend(uint16_t seq, int64_t nowMs, int64_t minIntervalMs, Entry* entry);
+    Stats getStats();
+
+private:
+    struct Translation {
+        uint64_t sequence;
+        const void* stream;
+        uint32_t timestamp;
+        int64_t sendTimeMs;
+        int64_t resendTimeMs;
+    };
+
+    void cull(int64_t nowMs);
+
+    const std::shared_ptr<SharedVideoPacketizer> m_packetizer;
+    const int64_t m_historyMs;
+    const size_t m_maxPackets;
+
+    std::mutex m_mutex;
+    webrtc::SequenceNumberUnwrapper m_unwrapper;
+    std::map<int64_t, Translation> m_entries;
+    Stats m_stats;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_SHARED_PACKET_HISTORY_ */
@@ -0,0 +1,393 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SharedVideoPacketizer.h"
+#include "MediaUtilities.h"
+
+#include <tuple>
+
+#include <modules/rtp_rtcp/source/rtp_format.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
+#include <modules/rtp_rtcp/source/rtp_video_header.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+#include <rtputils.h>
+
+using namespace owt_base;
+
+namespace rtc_adapter {
+
+static const size_t kMaxCachedFrames = 16;
+static const uint64_t kStatsInterval = 3000;
+static const int64_t kStreamStatsIdleMs = 60000;
+
+const int64_t SharedVideoPacketizer::kHistoryMs;
+
+static int getNextNaluPosition(uint8_t* buffer, int buffer_size, bool& is_aud_or_sei, int& sc_len)
+{
+    if (buffer_size < 3) {
+        return -1;
+    }
+    is_aud_or_sei = false;
+    uint8_t* head = buffer;
+    uint8_t* end = buffer + buffer_size - 3;
+    while (head < end) {
+        if (head[0]) {
+            head++;
+            continue;
+        }
+        if (head[1]) {
+            head += 2;
+            continue;
+        }
+        if (head[2]) {
+            if (head[2] == 0x01) {
+                if (((head[3] & 0x1F) == 9) || ((head[3] & 0x1F) == 6)) {
+                    is_aud_or_sei = true;
+                }
+                sc_len = 3;
+                return static_cast<int>(head - buffer);
+            }
+            head += 3;
+            continue;
+        }
+        if (head[3] != 0x01) {
+            head++;
+            continue;
+        }
+        if (head + 1 == end) {
+            break;
+        }
+        if (((head[4] & 0x1F) == 9) || ((head[4] & 0x1F) == 6)) {
+            is_aud_or_sei = true;
+        }
+        sc_len = 4;
+        return static_cast<int>(head - buffer);
+    }
+    return -1;
+}
+
+#define MAX_NALS_PER_FRAME 128
+static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
+{
+    uint8_t* origin_pkt_data = framePayload;
+    int origin_pkt_length = frameLength;
+    uint8_t* head = origin_pkt_data;
+
+    std::vector<int> nal_offset;
+    std::vector<bool> nal_type_is_aud_or_sei;
+    std::vector<int> nal_size;
+    bool is_aud_or_sei = false, has_aud_or_sei = false;
+
+    int sc_positions_length = 0;
+    int sc_position = 0;
+    int sc_len = 4;
+    while (sc_positions_length < MAX_NALS_PER_FRAME) {
+        int nalu_position = getNextNaluPosition(origin_pkt_data + sc_position,
+            origin_pkt_length - sc_position, is_aud_or_sei, sc_len);
+        if (nalu_position < 0) {
+            break;
+        }
+        sc_position += nalu_position;
+        nal_offset.push_back(sc_position); //include start code.
+        sc_position += sc_len;
+        sc_positions_length++;
+        if (is_aud_or_sei) {
+            has_aud_or_sei = true;
+            nal_type_is_aud_or_sei.push_back(true);
+        } else {
+            nal_type_is_aud_or_sei.push_back(false);
+        }
+    }
+    if (sc_positions_length == 0 || !has_aud_or_sei)
+        return frameLength;
+    // Calculate size of each NALs
+    for (unsigned int count = 0; count < nal_offset.size(); count++) {
+        if (count + 1 == nal_offset.size()) {
+            nal_size.push_back(origin_pkt_length - nal_offset[count]);
+        } else {
+            nal_size.push_back(nal_offset[count + 1] - nal_offset[count]);
+        }
+    }
+    // remove in place the AUD NALs
+    int new_size = 0;
+    for (unsigned int i = 0; i < nal_offset.size(); i++) {
+        if (!nal_type_is_aud_or_sei[i]) {
+            memmove(head + new_size, head + nal_offset[i], nal_size[i]);
+            new_size += nal_size[i];
+        }
+    }
+    return new_size;
+}
+
+static void dump(void* index, FrameFormat format, uint8_t* buf, int len)
+{
+    char dumpFileName[128];
+
+    snprintf(dumpFileName, 128, "/tmp/prePacketizer-%p.%s", index, getFormatStr(format));
+    FILE* bsDumpfp = fopen(dumpFileName, "ab");
+    if (bsDumpfp) {
+        fwrite(buf, 1, len, bsDumpfp);
+        fclose(bsDumpfp);
+    }
+}
+
+std::shared_ptr<SharedVideoPacketizer> SharedVideoPacketizer::GetSharedPacketizer(
+    int redPayload, int ulpfecPayload, int maxPacketSize)
+{
+    static std::mutex s_mutex;
+    static std::map<std::tuple<int, int, int>, std::weak_ptr<SharedVideoPacketizer>> s_packetizers;
+
+    std::lock_guard<std::mutex> guard(s_mutex);
+    auto key = std::make_tuple(redPayload, ulpfecPayload, maxPacketSize);
+    std::shared_ptr<SharedVideoPacketizer> packetizer = s_packetizers[key].lock();
+    if (!packetizer) {
+        packetizer = std::make_shared<SharedVideoPacketizer>(
+            redPayload, ulpfecPayload, maxPacketSize);
+        s_packetizers[key] = packetizer;
+    }
+    // Clean up expired packetizers
+    for (auto it = s_packetizers.begin(); it != s_packetizers.end();) {
+        if (it->second.expired()) {
+            it = s_packetizers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return packetizer;
+}
+
+SharedVideoPacketizer::SharedVideoPacketizer(int redPayload, int ulpfecPayload, int maxPacketSize)
+    : m_redPayload(redPayload)
+    , m_ulpfecPayload(ulpfecPayload)
+    , m_maxPacketSize(maxPacketSize)
+    , m_enableDump(false)
+    , m_hitCount(0)
+    , m_missCount(0)
+    , m_nextSequence(0)
+{
+    RTC_LOG(LS_INFO) << "Create SharedVideoPacketizer red: " << m_redPayload
+                     << ", ulpfec: " << m_ulpfecPayload;
+}
+
+SharedVideoPacketizer::~SharedVideoPacketizer()
+{
+    RTC_LOG(LS_INFO) << "Destroy SharedVideoPacketizer red: " << m_redPayload
+                     << ", ulpfec: " << m_ulpfecPayload
+                     << ", hit: " << m_hitCount << ", miss: " << m_missCount;
+}
+
+std::shared_ptr<const SharedVideoPacketizer::PacketizedFrame>
+SharedVideoPacketizer::packetize(const Frame& frame)
+{
+    uint64_t frameId = FrameSource::deliveringFrameId();
+    const void* stream = FrameSource::deliveringSource();
+    if (!frameId) {
+        std::shared_ptr<PacketizedFrame> packetized = doPacketize(frame);
+        if (packetized) {
+            addToHistory(packetized);
+        }
+        return packetized;
+    }
+
+    std::shared_ptr<CacheEntry> entry;
+    {
+        std::unique_lock<std::mutex> lock(m_cacheMutex);
+        for (auto it = m_cache.rbegin(); it != m_cache.rend(); ++it) {
+            if ((*it)->frameId == frameId) {
+                entry = *it;
+                break;
+            }
+        }
+        if (entry) {
+            m_cacheCond.wait(lock, [&entry]() { return !entry->inProgress; });
+            m_hitCount++;
+            return entry->packetized;
+        }
+        entry = std::make_shared<CacheEntry>();
+        entry->frameId = frameId;
+        m_cache.push_back(entry);
+        while (m_cache.size() > kMaxCachedFrames) {
+            m_cache.pop_front();
+        }
+    }
+
+    // Packetize outside the lock, other subscribers of this frame wait on
+    // the entry, subscribers of other frames go on
+    std::shared_ptr<PacketizedFrame> packetized = doPacketize(frame);
+    if (packetized) {
+        packetized->stream = stream;
+        addToHistory(packetized);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_cacheMutex);
+        entry->packetized = packetized;
+        entry->inProgress = false;
+        m_missCount++;
+        if (m_missCount % kStatsInterval == 0) {
+            RTC_LOG(LS_INFO) << "SharedVideoPacketizer red: " << m_redPayload
+                             << ", packetized: " << m_missCount
+                             << ", reused: " << m_hitCount;
+        }
+    }
+    m_cacheCond.notify_all();
+    return packetized;
+}
+
+std::shared_ptr<const SharedVideoPacketizer::PacketizedFrame>
+SharedVideoPacketizer::getPacket(uint64_t sequence, const void* stream, uint32_t* index)
+{
+    std::lock_guard<std::mutex> guard(m_historyMutex);
+    // Last frame starting at or before the sequence
+    auto it = m_history.upper_bound(sequence);
+    if (it != m_history.begin()) {
+        --it;
+        const PacketizedFrame& packetized = *it->second.packetized;
+        if (sequence < packetized.firstSequence + packetized.packets.size()) {
+            m_historyStats[stream].stats.hits++;
+            *index = static_cast<uint32_t>(sequence - packetized.firstSequence);
+            return it->second.packetized;
+        }
+    }
+    m_historyStats[stream].stats.misses++;
+    return nullptr;
+}
+
+void SharedVideoPacketizer::addHistoryMiss(const void* stream)
+{
+    std::lock_guard<std::mutex> guard(m_historyMutex);
+    m_historyStats[stream].stats.misses++;
+}
+
+SharedVideoPacketizer::HistoryStats SharedVideoPacketizer::getHistoryStats(const void* stream)
+{
+    std::lock_guard<std::mutex> guard(m_historyMutex);
+    auto it = m_historyStats.find(stream);
+    return it != m_historyStats.end() ? it->second.stats : HistoryStats();
+}
+
+void SharedVideoPacketizer::addToHistory(const std::shared_ptr<PacketizedFrame>& packetized)
+{
+    int64_t nowMs = rtc::TimeMillis();
+    std::lock_guard<std::mutex> guard(m_historyMutex);
+    packetized->firstSequence = m_nextSequence;
+    m_nextSequence += packetized->packets.size();
+    if (packetized->packets.empty()) {
+        return;
+    }
+    m_history[packetized->firstSequence] = HistoryEntry { packetized, nowMs };
+    while (!m_history.empty() && nowMs - m_history.begin()->second.timeMs > kHistoryMs) {
+        m_history.erase(m_history.begin());
+    }
+    StreamHistoryStats& streamStats = m_historyStats[packetized->stream];
+    if (nowMs - streamStats.lastFrameMs > kStreamStatsIdleMs) {
+        for (auto it = m_historyStats.begin(); it != m_historyStats.end();) {
+            if (nowMs - it->second.lastFrameMs > kStreamStatsIdleMs && &it->second != &streamStats) {
+                it = m_historyStats.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    streamStats.lastFrameMs = nowMs;
+}
+
+std::shared_ptr<SharedVideoPacketizer::PacketizedFrame>
+SharedVideoPacketizer::doPacketize(const Frame& frame)
+{
+    using namespace webrtc;
+
+    RTPVideoHeader h;
+    h.frame_type = frame.additionalInfo.video.isKeyFrame ?
+        VideoFrameType::kVideoFrameKey : VideoFrameType::kVideoFrameDelta;
+    h.width = frame.additionalInfo.video.width;
+    h.height = frame.additionalInfo.video.height;
+    // Same values as the zeroed header given to RTPSenderVideo before
+    h.playout_delay = { 0, 0 };
+    h.video_timing.flags = VideoSendTiming::kNotTriggered;
+
+    int payloadType = 0;
+    const uint8_t* payload = frame.payload;
+    size_t length = frame.length;
+    // Frame is shared by all subscribers, filter on a private copy
+    std::vector<uint8_t> filtered;
+
+    switch (frame.format) {
+    case FRAME_FORMAT_VP8: {
+        payloadType = VP8_90000_PT;
+        h.codec = kVideoCodecVP8;
+        auto& vp8_header = h.video_type_header.emplace<RTPVideoHeaderVP8>();
+        vp8_header.InitRTPVideoHeaderVP8();
+        break;
+    }
+    case FRAME_FORMAT_VP9: {
+        payloadType = VP9_90000_PT;
+        h.codec = kVideoCodecVP9;
+        auto& vp9_header = h.video_type_header.emplace<RTPVideoHeaderVP9>();
+        vp9_header.InitRTPVideoHeaderVP9();
+        vp9_header.inter_pic_predicted = !frame.additionalInfo.video.isKeyFrame;
+        break;
+    }
+    case FRAME_FORMAT_H264:
+        payloadType = H264_90000_PT;
+        h.codec = kVideoCodecH264;
+        h.video_type_header.emplace<RTPVideoHeaderH264>();
+        //FIXME: temporarily filter out AUD because chrome M59 could NOT handle it correctly.
+        //FIXME: temporarily filter out SEI because safari could NOT handle it correctly.
+        filtered.assign(frame.payload, frame.payload + frame.length);
+        length = dropAUDandSEI(filtered.data(), filtered.size());
+        payload = filtered.data();
+        break;
+    case FRAME_FORMAT_H265:
+        payloadType = H265_90000_PT;
+        h.codec = kVideoCodecH265;
+        h.video_type_header.emplace<RTPVideoHeaderH265>();
+        break;
+    case FRAME_FORMAT_AV1:
+        payloadType = AV1_90000_PT;
+        h.codec = kVideoCodecAV1;
+        break;
+    default:
+        return nullptr;
+    }
+
+    if (m_enableDump && (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265)) {
+        dump(this, frame.format, const_cast<uint8_t*>(payload), length);
+    }
+
+    const int redOverhead = m_redPayload ? 1 : 0;
+    RtpPacketizer::PayloadSizeLimits limits;
+    limits.max_payload_len = m_maxPacketSize - kRtpHeaderReserve - redOverhead;
+    std::unique_ptr<RtpPacketizer> packetizer = RtpPacketizer::Create(
+        h.codec, rtc::ArrayView<const uint8_t>(payload, length), limits, h);
+    if (!packetizer) {
+        return nullptr;
+    }
+
+    auto packetized = std::make_shared<PacketizedFrame>();
+    packetized->payloadType = m_redPayload ? m_redPayload : payloadType;
+    packetized->keyFrame = frame.additionalInfo.video.isKeyFrame;
+    packetized->playoutDelay = h.playout_delay;
+    packetized->timing = h.video_timing;
+    packetized->packets.reserve(packetizer->NumPackets());
+
+    RtpPacketToSend rtpPacket(nullptr, m_maxPacketSize);
+    while (packetizer->NextPacket(&rtpPacket)) {
+        rtc::ArrayView<const uint8_t> rtpPayload = rtpPacket.payload();
+        Packet packet;
+        packet.marker = rtpPacket.Marker();
+        packet.payload.EnsureCapacity(rtpPayload.size() + redOverhead);
+        if (m_redPayload) {
+            // RFC 2198 primary encoding header
+            uint8_t redHeader = static_cast<uint8_t>(payloadType & 0x7f);
+            packet.payload.AppendData(&redHeader, 1);
+        }
+        packet.payload.AppendData(rtpPayload.data(), rtpPayload.size());
+        packetized->packets.push_back(std::move(packet));
+    }
+    return packetized;
+}
+
+} // namespace rtc_adapter
@@ -0,0 +1,124 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_SHARED_VIDEO_PACKETIZER_
+#define RTC_ADAPTER_SHARED_VIDEO_PACKETIZER_
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MediaFramePipeline.h"
+
+#include <api/rtp_headers.h>
+#include <api/video/video_timing.h>
+#include <rtc_base/copy_on_write_buffer.h>
+
+namespace rtc_adapter {
+
+// Packetizes an encoded frame into RTP payloads once for all the send
+// adapters sharing the same RED/FEC configuration. A FrameSource delivers
+// a frame to every subscriber with the same FrameSource::deliveringFrameId,
+// so the packet set built for the first subscriber is reused by the
+// others; each adapter only writes its own SSRC, sequence number,
+// timestamp and header extensions. The packet sets of the last second are
+// kept once for all subscribers to serve retransmissions.
+class SharedVideoPacketizer {
+public:
+    struct Packet {
+        rtc::CopyOnWriteBuffer payload;
+        bool marker = false;
+    };
+    struct PacketizedFrame {
+        // Payload type on the wire, RED if enabled
+        int payloadType = 0;
+        // Original sequence number of the first packet, counted per
+        // packetizer and independent of subscriber sequence numbers
+        uint64_t firstSequence = 0;
+        // Source stream the frame was delivered from, nullptr if unknown
+        const void* stream = nullptr;
+        bool keyFrame = false;
+        // Header extension values of the frame, written by each subscriber
+        // if it has the extension registered
+        webrtc::PlayoutDelay playoutDelay = { -1, -1 };
+        webrtc::VideoSendTiming timing;
+        std::vector<Packet> packets;
+    };
+
+    struct HistoryStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    // Payload size left for RTP header and extensions of each subscriber
+    static const int kRtpHeaderReserve = 60;
+    static const int64_t kHistoryMs = 1000;
+
+    static std::shared_ptr<SharedVideoPacketizer> GetSharedPacketizer(
+        int redPayload, int ulpfecPayload, int maxPacketSize);
+
+    SharedVideoPacketizer(int redPayload, int ulpfecPayload, int maxPacketSize);
+    ~SharedVideoPacketizer();
+
+    // Returns the cached packet set if this frame has been packetized for
+    // another subscriber, nullptr if the frame can not be packetized.
+    // Frames not delivered by a FrameSource are packetized every time.
+    std::shared_ptr<const PacketizedFrame> packetize(const owt_base::Frame& frame);
+
+    // Returns the frame holding the packet of original sequence number
+    // |sequence| and its |index| in the frame, nullptr if the packet has
+    // left the history. Counted as a hit or miss of |stream|.
+    std::shared_ptr<const PacketizedFrame> getPacket(
+        uint64_t sequence, const void* stream, uint32_t* index);
+    // Counts a request for a packet already unknown to the subscriber
+    void addHistoryMiss(const void* stream);
+    // Retransmission requests of all the subscribers of |stream|
+    HistoryStats getHistoryStats(const void* stream);
+
+private:
+    struct CacheEntry {
+        uint64_t frameId = 0;
+        // Set while the first subscriber packetizes, others wait for it
+        bool inProgress = true;
+        std::shared_ptr<const PacketizedFrame> packetized;
+    };
+
+    std::shared_ptr<PacketizedFrame> doPacketize(const owt_base::Frame& frame);
+    // Numbers the packets and keeps them for retransmission
+    void addToHistory(const std::shared_ptr<PacketizedFrame>& packetized);
+
+    int m_redPayload;
+    int m_ulpfecPayload;
+    int m_maxPacketSize;
+    bool m_enableDump;
+
+    std::mutex m_cacheMutex;
+    std::condition_variable m_cacheCond;
+    // Most recent frames of all sources using this configuration
+    std::deque<std::shared_ptr<CacheEntry>> m_cache;
+    uint64_t m_hitCount;
+    uint64_t m_missCount;
+
+    struct HistoryEntry {
+        std::shared_ptr<const PacketizedFrame> packetized;
+        int64_t timeMs;
+    };
+    std::mutex m_historyMutex;
+    // Packetized frames by their first original sequence number
+    std::map<uint64_t, HistoryEntry> m_history;
+    uint64_t m_nextSequence;
+    struct StreamHistoryStats {
+        HistoryStats stats;
+        int64_t lastFrameMs;
+    };
+    // Kept a while after the last frame of the stream
+    std::map<const void*, StreamHistoryStats> m_historyStats;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_SHARED_VIDEO_PACKETIZER_ */
@@ -0,0 +1,637 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoFrameAssembler.h"
+#include "PipelineTracer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <common_video/h264/h264_common.h>
+#include <modules/rtp_rtcp/source/create_video_rtp_depacketizer.h>
+#include <modules/rtp_rtcp/source/rtcp_packet/nack.h>
+#include <modules/rtp_rtcp/source/rtcp_packet/pli.h>
+#include <modules/rtp_rtcp/source/rtcp_packet/transport_feedback.h>
+#include <modules/rtp_rtcp/source/rtp_header_extensions.h>
+#include <modules/rtp_rtcp/source/rtp_packet_received.h>
+#include <rtc_base/logging.h>
+#include <rtc_base/time_utils.h>
+#include <rtputils.h>
+
+using namespace owt_base;
+
+namespace rtc_adapter {
+
+// Local SSRC has no meaning for receive stream here
+const uint32_t kLocalSsrc = 1;
+
+const uint32_t kMaxSpatialLayers = 5;
+const uint32_t kMaxTemporalLayers = 4;
+
+// Packets kept while waiting for missing ones
+const size_t kMaxBufferedPackets = 2048;
+// Time an incomplete frame waits for retransmission before giving up
+const int64_t kMaxFrameWaitMs = 500;
+
+const size_t kMaxNackListSize = 1000;
+const int64_t kNackIntervalMs = 50;
+const int kMaxNackRetries = 10;
+const int64_t kMinPliIntervalMs = 300;
+const int64_t kTransportFeedbackIntervalMs = 100;
+const size_t kMaxTransportArrivals = 2048;
+const int64_t kStatsIntervalMs = 10000;
+
+static const uint8_t kStartCode[] = { 0, 0, 0, 1 };
+
+VideoFrameAssembler::VideoFrameAssembler(const RtcAdapter::Config& config)
+    : m_config(config)
+    , m_frameListener(config.frame_listener)
+    , m_rtcpListener(config.rtp_listener)
+    , m_statsListener(config.stats_listener)
+    , m_payloadType(-1)
+    , m_codec(webrtc::kVideoCodecGeneric)
+    , m_format(FRAME_FORMAT_UNKNOWN)
+    , m_width(0)
+    , m_height(0)
+    , m_nextSeq(-1)
+    , m_highestSeq(-1)
+    , m_waitingKeyFrame(true)
+    , m_pliPending(true)
+    , m_lastPliMs(-kMinPliIntervalMs)
+    , m_transportNextSeq(-1)
+    , m_transportFeedbackCount(0)
+    , m_lastTransportFeedbackMs(0)
+    , m_preferredSpatialId(-1)
+    , m_preferredTemporalId(-1)
+    , m_statsStartMs(rtc::TimeMillis())
+    , m_costUs(0)
+    , m_packetCount(0)
+    , m_frameCount(0)
+    , m_droppedFrameCount(0)
+    , m_nackCount(0)
+    , m_pliCount(0)
+{
+    if (m_config.transport_cc > 0) {
+        RTC_LOG(LS_INFO) << "TransportSequenceNumber Extension Enabled";
+        m_extensions.Register<webrtc::TransportSequenceNumber>(m_config.transport_cc);
+    }
+    RTC_LOG(LS_INFO) << "Create VideoFrameAssembler with SSRC: " << m_config.ssrc;
+}
+
+VideoFrameAssembler::~VideoFrameAssembler()
+{
+    RTC_LOG(LS_INFO) << "Destroy VideoFrameAssembler with SSRC: " << m_config.ssrc;
+}
+
+void VideoFrameAssembler::requestKeyFrame()
+{
+    // Served on the packet thread
+    m_pliPending = true;
+}
+
+void VideoFrameAssembler::setPreferredLayers(int spatialId, int temporalId)
+{
+    m_preferredSpatialId = spatialId;
+    m_preferredTemporalId = temporalId;
+}
+
+int VideoFrameAssembler::onRtpData(char* data, int len)
+{
+    auto start = std::chrono::steady_clock::now();
+    int64_t nowMs = rtc::TimeMillis();
+
+    webrtc::RtpPacketReceived rtpPacket(&m_extensions);
+    if (!rtpPacket.Parse(reinterpret_cast<const uint8_t*>(data), len)) {
+        return len;
+    }
+    if (m_config.ssrc && rtpPacket.Ssrc() != m_config.ssrc) {
+        return len;
+    }
+
+    uint16_t transportSeq = 0;
+    if (m_config.transport_cc > 0 &&
+        rtpPacket.GetExtension<webrtc::TransportSequenceNumber>(&transportSeq)) {
+        onTransportSequence(transportSeq, rtc::TimeMicros());
+    }
+
+    int64_t seq = m_seqUnwrapper.Unwrap(rtpPacket.SequenceNumber());
+    if ((m_nextSeq >= 0 && seq < m_nextSeq) || m_packets.count(seq)) {
+        // Duplicated or late retransmission
+        sendFeedback(nowMs);
+        return len;
+    }
+
+    Packet packet;
+    packet.timestamp = rtpPacket.Timestamp();
+    packet.endOfFrame = rtpPacket.Marker();
+    packet.arrivalMs = nowMs;
+    packet.skipped = true;
+
+    int payloadType = rtpPacket.PayloadType();
+    rtc::CopyOnWriteBuffer payload = rtpPacket.PayloadBuffer();
+    if (payloadType == RED_90000_PT && !decapsulateRed(&payloadType, &payload)) {
+        payload.Clear();
+    }
+    if (payload.size() > 0 && setCodec(payloadType)) {
+        absl::optional<webrtc::VideoRtpDepacketizer::ParsedRtpPayload> parsed =
+            m_depacketizer->Parse(std::move(payload));
+        if (parsed) {
+            bool endOfLayer = false;
+            if (!filterLayer(parsed->video_header, &endOfLayer)) {
+                packet.skipped = false;
+                packet.endOfFrame |= endOfLayer;
+                packet.isKeyFrameStart = isKeyFrameStart(parsed->video_header);
+                packet.videoHeader = std::move(parsed->video_header);
+                packet.payload = std::move(parsed->video_payload);
+            }
+        } else {
+            RTC_LOG(LS_WARNING) << "Failed to depacketize, seq: " << rtpPacket.SequenceNumber();
+        }
+    }
+
+    updateNackList(seq);
+    m_packets.emplace(seq, std::move(packet));
+    m_packetCount++;
+    assembleFrames(nowMs);
+    sendFeedback(nowMs);
+
+    m_costUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    reportCost(nowMs);
+    return len;
+}
+
+bool VideoFrameAssembler::setCodec(int payloadType)
+{
+    if (payloadType == m_payloadType) {
+        return m_depacketizer != nullptr;
+    }
+
+    webrtc::VideoCodecType codec = webrtc::kVideoCodecGeneric;
+    FrameFormat format = FRAME_FORMAT_UNKNOWN;
+    switch (payloadType) {
+    case VP8_90000_PT:
+        codec = webrtc::kVideoCodecVP8;
+        format = FRAME_FORMAT_VP8;
+        break;
+    case VP9_90000_PT:
+        codec = webrtc::kVideoCodecVP9;
+        format = FRAME_FORMAT_VP9;
+        break;
+    case H264_90000_PT:
+        codec = webrtc::kVideoCodecH264;
+        format = FRAME_FORMAT_H264;
+        break;
+    case AV1_90000_PT:
+        codec = webrtc::kVideoCodecAV1;
+        format = FRAME_FORMAT_AV1;
+        break;
+    default:
+        // FEC and unsupported codecs are only used for sequence continuity
+        return false;
+    }
+
+    RTC_LOG(LS_INFO) << "VideoFrameAssembler payload type " << payloadType
+                     << ", SSRC: " << m_config.ssrc;
+    m_payloadType = payloadType;
+    m_codec = codec;
+    m_format = format;
+    m_depacketizer = webrtc::CreateVideoRtpDepacketizer(codec);
+    // Packets of previous codec can not be assembled anymore
+    for (auto& p : m_packets) {
+        p.second.skipped = true;
+    }
+    m_waitingKeyFrame = true;
+    m_pliPending = true;
+    return m_depacketizer != nullptr;
+}
+
+bool VideoFrameAssembler::decapsulateRed(int* payloadType, rtc::CopyOnWriteBuffer* payload)
+{
+    // RFC 2198, only the primary encoding is used
+    const uint8_t* data = payload->cdata();
+    size_t size = payload->size();
+    size_t offset = 0;
+    size_t redundantSize = 0;
+    while (offset < size) {
+        if (data[offset] & 0x80) {
+            if (offset + 4 > size) {
+                return false;
+            }
+            redundantSize += ((data[offset + 2] & 0x03) << 8) | data[offset + 3];
+            offset += 4;
+        } else {
+            *payloadType = data[offset] & 0x7f;
+            offset += 1;
+            if (offset + redundantSize > size) {
+                return false;
+            }
+            offset += redundantSize;
+            *payload = payload->Slice(offset, size - offset);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VideoFrameAssembler::filterLayer(const webrtc::RTPVideoHeader& header, bool* endOfFrame)
+{
+    int spatialId = m_preferredSpatialId;
+    int temporalId = m_preferredTemporalId;
+    if (m_codec != webrtc::kVideoCodecVP9 || (spatialId < 0 && temporalId < 0)) {
+        return false;
+    }
+    const webrtc::RTPVideoHeaderVP9* vp9_header =
+        absl::get_if<webrtc::RTPVideoHeaderVP9>(&header.video_type_header);
+    if (!vp9_header) {
+        return false;
+    }
+    if ((spatialId >= 0 &&
+        vp9_header->spatial_idx <= kMaxSpatialLayers &&
+        vp9_header->spatial_idx > spatialId) ||
+        (temporalId >= 0 &&
+        vp9_header->temporal_idx <= kMaxTemporalLayers &&
+        vp9_header->temporal_idx > temporalId)) {
+        return true;
+    }
+    if (vp9_header->spatial_idx == spatialId && vp9_header->end_of_frame) {
+        // Superframe ends at the preferred spatial layer
+        *endOfFrame = true;
+    }
+    return false;
+}
+
+bool VideoFrameAssembler::isKeyFrameStart(const webrtc::RTPVideoHeader& header)
+{
+    if (!header.is_first_packet_in_frame) {
+        return false;
+    }
+    if (m_codec == webrtc::kVideoCodecH264) {
+        // A key frame starts with parameter sets or the IDR slice
+        const webrtc::RTPVideoHeaderH264* h264_header =
+            absl::get_if<webrtc::RTPVideoHeaderH264>(&header.video_type_header);
+        if (!h264_header) {
+            return false;
+        }
+        for (size_t i = 0; i < h264_header->nalus_length; i++) {
+            if (h264_header->nalus[i].type == webrtc::H264::kSps ||
+                h264_header->nalus[i].type == webrtc::H264::kIdr) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return header.frame_type == webrtc::VideoFrameType::kVideoFrameKey;
+}
+
+void VideoFrameAssembler::updateNackList(int64_t seq)
+{
+    if (m_highestSeq < 0) {
+        m_highestSeq = seq;
+        return;
+    }
+    if (seq <= m_highestSeq) {
+        // Retransmitted or reordered
+        m_nackList.erase(seq);
+        return;
+    }
+    if (seq - m_highestSeq > static_cast<int64_t>(kMaxNackListSize)) {
+        RTC_LOG(LS_WARNING) << "Sequence jump " << m_highestSeq << " -> " << seq
+                            << ", SSRC: " << m_config.ssrc;
+        m_nackList.clear();
+        m_nextSeq = -1;
+        m_waitingKeyFrame = true;
+        m_pliPending = true;
+    } else {
+        for (int64_t missing = m_highestSeq + 1; missing < seq; missing++) {
+            m_nackList.emplace(missing, NackInfo());
+        }
+        while (m_nackList.size() > kMaxNackListSize) {
+            m_nackList.erase(m_nackList.begin());
+        }
+    }
+    m_highestSeq = seq;
+}
+
+void VideoFrameAssembler::assembleFrames(int64_t nowMs)
+{
+    while (!m_packets.empty()) {
+        if (m_nextSeq < 0 && !resyncToKeyFrame(nowMs)) {
+            break;
+        }
+
+        // Consume packets carrying no media between frames
+        auto it = m_packets.begin();
+        if (it->first == m_nextSeq && it->second.skipped) {
+            m_packets.erase(it);
+            m_nextSeq++;
+            continue;
+        }
+
+        int64_t expected = m_nextSeq;
+        bool complete = false;
+        for (; it != m_packets.end() && it->first == expected; ++it, ++expected) {
+            if (!it->second.skipped && it->second.endOfFrame) {
+                complete = true;
+                break;
+            }
+        }
+
+        if (complete) {
+            auto end = std::next(it);
+            std::vector<const Packet*> framePackets;
+            for (auto p = m_packets.begin(); p != end; ++p) {
+                if (!p->second.skipped) {
+                    framePackets.push_back(&p->second);
+                }
+            }
+            deliverFrame(framePackets);
+            m_nextSeq = it->first + 1;
+            m_packets.erase(m_packets.begin(), end);
+            continue;
+        }
+
+        const Packet& oldest = m_packets.begin()->second;
+        if (nowMs - oldest.arrivalMs > kMaxFrameWaitMs ||
+            m_packets.size() > kMaxBufferedPackets) {
+            RTC_LOG(LS_WARNING) << "Incomplete frame " << oldest.timestamp
+                                << " dropped, SSRC: " << m_config.ssrc;
+            m_droppedFrameCount++;
+            m_nextSeq = -1;
+            m_waitingKeyFrame = true;
+            m_pliPending = true;
+            // Drop the stalled packet so that resync looks further
+            m_packets.erase(m_packets.begin());
+            continue;
+        }
+        break;
+    }
+}
+
+bool VideoFrameAssembler::resyncToKeyFrame(int64_t nowMs)
+{
+    auto it = m_packets.begin();
+    while (it != m_packets.end() && (it->second.skipped || !it->second.isKeyFrameStart)) {
+        ++it;
+    }
+    if (it != m_packets.end()) {
+        m_packets.erase(m_packets.begin(), it);
+        m_nextSeq = it->first;
+        return true;
+    }
+    // Keep recent packets in case the key frame start is retransmitted
+    while (!m_packets.empty() &&
+           (nowMs - m_packets.begin()->second.arrivalMs > kMaxFrameWaitMs ||
+            m_packets.size() > kMaxBufferedPackets)) {
+        m_packets.erase(m_packets.begin());
+    }
+    return false;
+}
+
+void VideoFrameAssembler::appendH264Payload(const Packet& packet)
+{
+    // Convert to Annex B, as webrtc::H264SpsPpsTracker does
+    const webrtc::RTPVideoHeaderH264* h264_header =
+        absl::get_if<webrtc::RTPVideoHeaderH264>(&packet.videoHeader.video_type_header);
+    const uint8_t* data = packet.payload.cdata();
+    size_t size = packet.payload.size();
+    if (!h264_header) {
+        return;
+    }
+    switch (h264_header->packetization_type) {
+    case webrtc::kH264StapA: {
+        size_t offset = webrtc::H264::kNaluTypeSize;
+        while (offset + webrtc::H264::kLengthFieldSize <= size) {
+            size_t naluSize = (data[offset] << 8) | data[offset + 1];
+            offset += webrtc::H264::kLengthFieldSize;
+            if (offset + naluSize > size) {
+                break;
+            }
+            m_frameBuffer.AppendData(kStartCode, sizeof(kStartCode));
+            m_frameBuffer.AppendData(data + offset, naluSize);
+            offset += naluSize;
+        }
+        break;
+    }
+    case webrtc::kH264FuA:
+        if (h264_header->nalus_length > 0) {
+            // First fragment
+            m_frameBuffer.AppendData(kStartCode, sizeof(kStartCode));
+        }
+        m_frameBuffer.AppendData(data, size);
+        break;
+    default:
+        m_frameBuffer.AppendData(kStartCode, sizeof(kStartCode));
+        m_frameBuffer.AppendData(data, size);
+        break;
+    }
+}
+
+void VideoFrameAssembler::deliverFrame(const std::vector<const Packet*>& packets)
+{
+    if (packets.empty()) {
+        return;
+    }
+    bool isKeyFrame = packets.front()->isKeyFrameStart;
+    if (m_waitingKeyFrame && !isKeyFrame) {
+        m_droppedFrameCount++;
+        return;
+    }
+    m_waitingKeyFrame = false;
+
+    for (const Packet* packet : packets) {
+        if (packet->videoHeader.width > 0 && packet->videoHeader.height > 0) {
+            m_width = packet->videoHeader.width;
+            m_height = packet->videoHeader.height;
+            break;
+        }
+    }
+
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = m_format;
+    frame.timeStamp = packets.front()->timestamp;
+    frame.additionalInfo.video.width = m_width;
+    frame.additionalInfo.video.height = m_height;
+    frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+
+    if (m_codec == webrtc::kVideoCodecH264) {
+        m_frameBuffer.SetSize(0);
+        for (const Packet* packet : packets) {
+            appendH264Payload(*packet);
+        }
+        frame.payload = m_frameBuffer.data();
+        frame.length = m_frameBuffer.size();
+    } else if (packets.size() == 1 && m_codec != webrtc::kVideoCodecAV1) {
+        // Zero copy view on the packet
+        frame.payload = const_cast<uint8_t*>(packets.front()->payload.cdata());
+        frame.length = packets.front()->payload.size();
+    } else if (m_codec == webrtc::kVideoCodecVP8 || m_codec == webrtc::kVideoCodecVP9) {
+        // Plain concatenation of the payloads, as AssembleFrame would do
+        m_frameBuffer.SetSize(0);
+        for (const Packet* packet : packets) {
+            m_frameBuffer.AppendData(packet->payload.cdata(), packet->payload.size());
+        }
+        frame.payload = m_frameBuffer.data();
+        frame.length = m_frameBuffer.size();
+    } else {
+        std::vector<rtc::ArrayView<const uint8_t>> payloads;
+        payloads.reserve(packets.size());
+        for (const Packet* packet : packets) {
+            payloads.emplace_back(packet->payload.cdata(), packet->payload.size());
+        }
+        m_assembledFrame = m_depacketizer->AssembleFrame(payloads);
+        if (!m_assembledFrame) {
+            RTC_LOG(LS_WARNING) << "Failed to assemble frame " << frame.timeStamp;
+            m_droppedFrameCount++;
+            m_waitingKeyFrame = true;
+            m_pliPending = true;
+            return;
+        }
+        frame.payload = m_assembledFrame->data();
+        frame.length = m_assembledFrame->size();
+    }
+
+    m_frameCount++;
+    if (m_frameListener) {
+        int64_t arrivalUs = 0;
+        if (PipelineTracer::enabled()) {
+            // First packet arrival on the wall clock of the tracer
+            int64_t arrivalMs = packets.front()->arrivalMs;
+            for (const Packet* packet : packets) {
+                arrivalMs = std::min(arrivalMs, packet->arrivalMs);
+            }
+            arrivalUs = PipelineTracer::nowUs() - (rtc::TimeMicros() - arrivalMs * 1000);
+        }
+        PipelineTracer::CaptureScope scope(arrivalUs);
+        m_frameListener->onAdapterFrame(frame);
+    }
+    if (m_statsListener) {
+        AdapterStats stats = { m_width, m_height, m_format };
+        if (m_reportedStats.width != stats.width ||
+            m_reportedStats.height != stats.height ||
+            m_reportedStats.format != stats.format) {
+            m_reportedStats = stats;
+            m_statsListener->onAdapterStats(stats);
+        }
+    }
+}
+
+void VideoFrameAssembler::onTransportSequence(uint16_t transportSeq, int64_t arrivalUs)
+{
+    int64_t seq = m_transportSeqUnwrapper.Unwrap(transportSeq);
+    if (m_transportNextSeq >= 0 && seq < m_transportNextSeq) {
+        // Already reported
+        return;
+    }
+    m_transportArrivals.emplace(seq, arrivalUs);
+    while (m_transportArrivals.size() > kMaxTransportArrivals) {
+        m_transportArrivals.erase(m_transportArrivals.begin());
+    }
+}
+
+void VideoFrameAssembler::sendFeedback(int64_t nowMs)
+{
+    if (m_pliPending && nowMs - m_lastPliMs >= kMinPliIntervalMs) {
+        webrtc::rtcp::Pli pli;
+        pli.SetSenderSsrc(kLocalSsrc);
+        pli.SetMediaSsrc(m_config.ssrc);
+        sendRtcp(pli.Build());
+        m_pliPending = false;
+        m_lastPliMs = nowMs;
+        m_pliCount++;
+    }
+    sendNack(nowMs);
+    if (nowMs - m_lastTransportFeedbackMs >= kTransportFeedbackIntervalMs) {
+        sendTransportFeedback(nowMs);
+    }
+}
+
+void VideoFrameAssembler::sendNack(int64_t nowMs)
+{
+    std::vector<uint16_t> packetIds;
+    for (auto it = m_nackList.begin(); it != m_nackList.end();) {
+        NackInfo& info = it->second;
+        if (info.sentAtMs >= 0 && nowMs - info.sentAtMs < kNackIntervalMs) {
+            ++it;
+            continue;
+        }
+        if (info.retries >= kMaxNackRetries) {
+            it = m_nackList.erase(it);
+            continue;
+        }
+        info.sentAtMs = nowMs;
+        info.retries++;
+        packetIds.push_back(static_cast<uint16_t>(it->first));
+        ++it;
+    }
+    if (!packetIds.empty()) {
+        webrtc::rtcp::Nack nack;
+        nack.SetSenderSsrc(kLocalSsrc);
+        nack.SetMediaSsrc(m_config.ssrc);
+        nack.SetPacketIds(std::move(packetIds));
+        sendRtcp(nack.Build());
+        m_nackCount++;
+    }
+}
+
+void VideoFrameAssembler::sendTransportFeedback(int64_t nowMs)
+{
+    m_lastTransportFeedbackMs = nowMs;
+    while (!m_transportArrivals.empty()) {
+        webrtc::rtcp::TransportFeedback feedback;
+        feedback.SetSenderSsrc(kLocalSsrc);
+        feedback.SetMediaSsrc(m_config.ssrc);
+        auto it = m_transportArrivals.begin();
+        feedback.SetBase(static_cast<uint16_t>(it->first), it->second);
+        feedback.SetFeedbackSequenceNumber(m_transportFeedbackCount++);
+        for (; it != m_transportArrivals.end(); ++it) {
+            if (!feedback.AddReceivedPacket(static_cast<uint16_t>(it->first), it->second)) {
+                break;
+            }
+        }
+        if (it == m_transportArrivals.begin()) {
+            // Can not be represented, skip it
+            m_transportArrivals.erase(it);
+            continue;
+        }
+        m_transportNextSeq = std::prev(it)->first + 1;
+        m_transportArrivals.erase(m_transportArrivals.begin(), it);
+        sendRtcp(feedback.Build());
+    }
+}
+
+void VideoFrameAssembler::sendRtcp(const rtc::Buffer& packet)
+{
+    if (m_rtcpListener && packet.size() > 0) {
+        m_rtcpListener->onAdapterData(
+            reinterpret_cast<char*>(const_cast<uint8_t*>(packet.data())), packet.size());
+    }
+}
+
+void VideoFrameAssembler::reportCost(int64_t nowMs)
+{
+    int64_t elapsedMs = nowMs - m_statsStartMs;
+    if (elapsedMs < kStatsIntervalMs) {
+        return;
+    }
+    RTC_LOG(LS_INFO) << "VideoFrameAssembler SSRC: " << m_config.ssrc
+                     << ", packets: " << m_packetCount
+                     << ", frames: " << m_frameCount
+                     << ", dropped: " << m_droppedFrameCount
+                     << ", nack: " << m_nackCount
+                     << ", pli: " << m_pliCount
+                     << ", cpu(us/s): " << m_costUs * 1000 / elapsedMs
+                     << ", cpu(us/packet): "
+                     << (m_packetCount ? m_costUs / m_packetCount : 0);
+    m_statsStartMs = nowMs;
+    m_costUs = 0;
+    m_packetCount = 0;
+    m_frameCount = 0;
+    m_droppedFrameCount = 0;
+    m_nackCount = 0;
+    m_pliCount = 0;
+}
+
+} // namespace rtc_adapter
@@ -0,0 +1,129 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef RTC_ADAPTER_VIDEO_FRAME_ASSEMBLER_
+#define RTC_ADAPTER_VIDEO_FRAME_ASSEMBLER_
+
+#include <RtcAdapter.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <api/video/encoded_image.h>
+#include <modules/rtp_rtcp/include/rtp_header_extension_map.h>
+#include <modules/rtp_rtcp/source/rtp_video_header.h>
+#include <modules/rtp_rtcp/source/video_rtp_depacketizer.h>
+#include <rtc_base/buffer.h>
+#include <rtc_base/copy_on_write_buffer.h>
+#include <rtc_base/numerics/sequence_number_util.h>
+
+namespace rtc_adapter {
+
+// Lightweight alternative to VideoReceiveAdapterImpl for the forwarding path.
+// It depacketizes VP8/VP9/H264/AV1 RTP packets into encoded frames without a
+// webrtc::VideoReceiveStream, and generates NACK, PLI and transport-cc
+// feedback itself. Frames are delivered synchronously on the thread calling
+// onRtpData; the frame payload points into the received packet buffers and is
+// only valid during the onAdapterFrame callback.
+class VideoFrameAssembler : public VideoReceiveAdapter {
+public:
+    VideoFrameAssembler(const RtcAdapter::Config& config);
+    virtual ~VideoFrameAssembler();
+    // Implement VideoReceiveAdapter
+    int onRtpData(char* data, int len) override;
+    void requestKeyFrame() override;
+    void setPreferredLayers(int spatialId, int temporalId) override;
+
+private:
+    struct Packet {
+        // Depacketized payload, shares memory with the received RTP packet
+        rtc::CopyOnWriteBuffer payload;
+        webrtc::RTPVideoHeader videoHeader;
+        uint32_t timestamp = 0;
+        bool endOfFrame = false;
+        bool isKeyFrameStart = false;
+        // Padding, FEC or filtered layer, only kept for sequence continuity
+        bool skipped = false;
+        int64_t arrivalMs = 0;
+    };
+
+    struct NackInfo {
+        int64_t sentAtMs = -1;
+        int retries = 0;
+    };
+
+    bool setCodec(int payloadType);
+    bool decapsulateRed(int* payloadType, rtc::CopyOnWriteBuffer* payload);
+    bool filterLayer(const webrtc::RTPVideoHeader& header, bool* endOfFrame);
+    bool isKeyFrameStart(const webrtc::RTPVideoHeader& header);
+
+    void updateNackList(int64_t seq);
+    void assembleFrames(int64_t nowMs);
+    bool resyncToKeyFrame(int64_t nowMs);
+    void deliverFrame(const std::vector<const Packet*>& packets);
+    void appendH264Payload(const Packet& packet);
+
+    void onTransportSequence(uint16_t transportSeq, int64_t arrivalUs);
+    void sendFeedback(int64_t nowMs);
+    void sendNack(int64_t nowMs);
+    void sendTransportFeedback(int64_t nowMs);
+    void sendRtcp(const rtc::Buffer& packet);
+    void reportCost(int64_t nowMs);
+
+    RtcAdapter::Config m_config;
+    // Listeners
+    AdapterFrameListener* m_frameListener;
+    AdapterDataListener* m_rtcpListener;
+    AdapterStatsListener* m_statsListener;
+
+    webrtc::RtpHeaderExtensionMap m_extensions;
+    int m_payloadType;
+    webrtc::VideoCodecType m_codec;
+    owt_base::FrameFormat m_format;
+    std::unique_ptr<webrtc::VideoRtpDepacketizer> m_depacketizer;
+    uint16_t m_width;
+    uint16_t m_height;
+    AdapterStats m_reportedStats;
+
+    // Received packets keyed by unwrapped sequence number
+    webrtc::SeqNumUnwrapper<uint16_t> m_seqUnwrapper;
+    std::map<int64_t, Packet> m_packets;
+    // Sequence number of the first packet of next frame, -1 if unknown
+    int64_t m_nextSeq;
+    int64_t m_highestSeq;
+    bool m_waitingKeyFrame;
+
+    // Output of H264, VP8 and VP9 frames, reused across frames
+    rtc::Buffer m_frameBuffer;
+    // Output of the depacketizer for other codecs, allocated per frame
+    rtc::scoped_refptr<webrtc::EncodedImageBuffer> m_assembledFrame;
+
+    std::map<int64_t, NackInfo> m_nackList;
+    std::atomic<bool> m_pliPending;
+    int64_t m_lastPliMs;
+
+    webrtc::SeqNumUnwrapper<uint16_t> m_transportSeqUnwrapper;
+    std::map<int64_t, int64_t> m_transportArrivals;
+    int64_t m_transportNextSeq;
+    uint8_t m_transportFeedbackCount;
+    int64_t m_lastTransportFeedbackMs;
+
+    std::atomic<int> m_preferredSpatialId;
+    std::atomic<int> m_preferredTemporalId;
+
+    // Processing cost statistics
+    int64_t m_statsStartMs;
+    int64_t m_costUs;
+    uint32_t m_packetCount;
+    uint32_t m_frameCount;
+    uint32_t m_droppedFrameCount;
+    uint32_t m_nackCount;
+    uint32_t m_pliCount;
+};
+
+} // namespace rtc_adapter
+
+#endif /* RTC_ADAPTER_VIDEO_FRAME_ASSEMBLER_ */
@@ -3,7 +3,9 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "VideoReceiveAdapter.h"
+#include "PipelineTracer.h"
 
+#include <algorithm>
 #include <future>
 #include <modules/rtp_rtcp/source/video_rtp_depacketizer_vp9.h>
 #include <modules/video_coding/include/video_error_codes.h>
@@ -99,9 +101,22 @@ int32_t VideoReceiveAdapterImpl::AdapterDecoder::Decode(const webrtc::EncodedIma
     frame.additionalInfo.video.height = m_height;
     frame.additionalInfo.video.isKeyFrame =
         (encodedImage._frameType == webrtc::VideoFrameType::kVideoFrameKey);
+    if (m_parent && format == FRAME_FORMAT_VP9) {
+        frame.additionalInfo.video.temporalId = m_parent->temporalId(encodedImage.Timestamp());
+    }
 
     if (m_parent) {
         if (m_parent->m_frameListener) {
+            int64_t arrivalUs = 0;
+            if (PipelineTracer::enabled() && !encodedImage.PacketInfos().empty()) {
+                // First packet arrival on the wall clock of the tracer
+                int64_t arrivalMs = encodedImage.PacketInfos().begin()->receive_time_ms();
+                for (const webrtc::RtpPacketInfo& packetInfo : encodedImage.PacketInfos()) {
+                    arrivalMs = std::min(arrivalMs, packetInfo.receive_time_ms());
+                }
+                arrivalUs = PipelineTracer::nowUs() - (rtc::TimeMicros() - arrivalMs * 1000);
+            }
+            PipelineTracer::CaptureScope scope(arrivalUs);
             m_parent->m_frameListener->onAdapterFrame(frame);
         }
         // Check video update
@@ -287,11 +302,25 @@ std::unique_ptr<webrtc::VideoDecoder> VideoReceiveAdapterImpl::CreateVideoDecode
     return std::make_unique<AdapterDecoder>(this);
 }
 
+void VideoReceiveAdapterImpl::saveTemporalId(uint32_t timestamp, uint8_t temporalId)
+{
+    uint64_t value = (1ULL << 40) | (static_cast<uint64_t>(timestamp) << 8) | temporalId;
+    m_temporalIds[timestamp % kTemporalIdSlots].store(value, std::memory_order_relaxed);
+}
+
+uint8_t VideoReceiveAdapterImpl::temporalId(uint32_t timestamp)
+{
+    uint64_t value = m_temporalIds[timestamp % kTemporalIdSlots].load(std::memory_order_relaxed);
+    if (!(value >> 40) || static_cast<uint32_t>(value >> 8) != timestamp) {
+        return 0;
+    }
+    return value & 0xff;
+}
+
 int VideoReceiveAdapterImpl::onRtpData(char* data, int len)
 {
     rtc::CopyOnWriteBuffer buffer(data, len);
-    if (m_format == FRAME_FORMAT_VP9 &&
-        (m_preferredTemporalId >= 0 || m_preferredSpatialId >= 0)) {
+    if (m_format == FRAME_FORMAT_VP9) {
         webrtc::RtpPacket rtpPacket;
         webrtc::RTPVideoHeader video_header;
         if (rtpPacket.Parse((const uint8_t*) data, len)) {
@@ -302,6 +331,9 @@ int VideoReceiveAdapterImpl::onRtpData(char* data, int len)
                     absl::get_if<webrtc::RTPVideoHeaderVP9>(
                         &(video_header.video_type_header));
                 if (vp9_header) {
+                    if (vp9_header->temporal_idx <= kMaxTemporalLayers) {
+                        saveTemporalId(rtpPacket.Timestamp(), vp9_header->temporal_idx);
+                    }
                     if ((m_preferredSpatialId >= 0 &&
                         vp9_header->spatial_idx <= kMaxSpatialLayers &&
                         vp9_header->spatial_idx > m_preferredSpatialId) ||
@@ -72,6 +72,10 @@ private:
 
     void CreateReceiveVideo();
 
+    // VP9 temporal layer of the frame with the RTP timestamp, 0 if unknown
+    void saveTemporalId(uint32_t timestamp, uint8_t temporalId);
+    uint8_t temporalId(uint32_t timestamp);
+
     std::shared_ptr<webrtc::Call> call()
     {
         return m_owner ? m_owner->call() : nullptr;
@@ -98,6 +102,10 @@ private:
     webrtc::VideoReceiveStream* m_videoRecvStream = nullptr;
     int m_preferredSpatialId = -1;
     int m_preferredTemporalId = -1;
+    // Valid bit, RTP timestamp and temporal id of recent frames, written
+    // from onRtpData and read in the decoder thread
+    static const int kTemporalIdSlots = 16;
+    std::atomic<uint64_t> m_temporalIds[kTemporalIdSlots] = {};
 };
 
 } // namespace rtc_adapter
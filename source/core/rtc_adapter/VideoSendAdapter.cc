@@ -12,7 +12,11 @@
 #include <api/task_queue/default_task_queue_factory.h>
 #include <modules/include/module_common_types.h>
 #include <modules/pacing/packet_router.h>
-#include <modules/rtp_rtcp/source/rtp_video_header.h>
+#include <modules/rtp_rtcp/source/rtcp_packet/common_header.h>
+#include <modules/rtp_rtcp/source/rtcp_packet/nack.h>
+#include <modules/rtp_rtcp/source/rtp_header_extensions.h>
+#include <modules/rtp_rtcp/source/rtp_packet_to_send.h>
+#include <modules/rtp_rtcp/source/rtp_sender.h>
 #include <rtc_base/logging.h>
 #include <rtputils.h>
 
@@ -25,115 +29,12 @@ namespace rtc_adapter {
 static const int TRANSMISSION_MAXBITRATE_MULTIPLIER = 2;
 static const int kMaxRtpPacketSize = 1200;
 static const double kBitrateNotifyDiffer = 0.2;
-
-static int getNextNaluPosition(uint8_t* buffer, int buffer_size, bool& is_aud_or_sei, int& sc_len)
-{
-    if (buffer_size < 3) {
-        return -1;
-    }
-    is_aud_or_sei = false;
-    uint8_t* head = buffer;
-    uint8_t* end = buffer + buffer_size - 3;
-    while (head < end) {
-        if (head[0]) {
-            head++;
-            continue;
-        }
-        if (head[1]) {
-            head += 2;
-            continue;
-        }
-        if (head[2]) {
-            if (head[2] == 0x01) {
-                if (((head[3] & 0x1F) == 9) || ((head[3] & 0x1F) == 6)) {
-                    is_aud_or_sei = true;
-                }
-                sc_len = 3;
-                return static_cast<int>(head - buffer);
-            }
-            head += 3;
-            continue;
-        }
-        if (head[3] != 0x01) {
-            head++;
-            continue;
-        }
-        if (head + 1 == end) {
-            break;
-        }
-        if (((head[4] & 0x1F) == 9) || ((head[4] & 0x1F) == 6)) {
-            is_aud_or_sei = true;
-        }
-        sc_len = 4;
-        return static_cast<int>(head - buffer);
-    }
-    return -1;
-}
-
-#define MAX_NALS_PER_FRAME 128
-static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
-{
-    uint8_t* origin_pkt_data = framePayload;
-    int origin_pkt_length = frameLength;
-    uint8_t* head = origin_pkt_data;
-
-    std::vector<int> nal_offset;
-    std::vector<bool> nal_type_is_aud_or_sei;
-    std::vector<int> nal_size;
-    bool is_aud_or_sei = false, has_aud_or_sei = false;
-
-    int sc_positions_length = 0;
-    int sc_position = 0;
-    int sc_len = 4;
-    while (sc_positions_length < MAX_NALS_PER_FRAME) {
-        int nalu_position = getNextNaluPosition(origin_pkt_data + sc_position,
-            origin_pkt_length - sc_position, is_aud_or_sei, sc_len);
-        if (nalu_position < 0) {
-            break;
-        }
-        sc_position += nalu_position;
-        nal_offset.push_back(sc_position); //include start code.
-        sc_position += sc_len;
-        sc_positions_length++;
-        if (is_aud_or_sei) {
-            has_aud_or_sei = true;
-            nal_type_is_aud_or_sei.push_back(true);
-        } else {
-            nal_type_is_aud_or_sei.push_back(false);
-        }
-    }
-    if (sc_positions_length == 0 || !has_aud_or_sei)
-        return frameLength;
-    // Calculate size of each NALs
-    for (unsigned int count = 0; count < nal_offset.size(); count++) {
-        if (count + 1 == nal_offset.size()) {
-            nal_size.push_back(origin_pkt_length - nal_offset[count]);
-        } else {
-            nal_size.push_back(nal_offset[count + 1] - nal_offset[count]);
-        }
-    }
-    // remove in place the AUD NALs
-    int new_size = 0;
-    for (unsigned int i = 0; i < nal_offset.size(); i++) {
-        if (!nal_type_is_aud_or_sei[i]) {
-            memmove(head + new_size, head + nal_offset[i], nal_size[i]);
-            new_size += nal_size[i];
-        }
-    }
-    return new_size;
-}
-
-static void dump(void* index, FrameFormat format, uint8_t* buf, int len)
-{
-    char dumpFileName[128];
-
-    snprintf(dumpFileName, 128, "/tmp/prePacketizer-%p.%s", index, getFormatStr(format));
-    FILE* bsDumpfp = fopen(dumpFileName, "ab");
-    if (bsDumpfp) {
-        fwrite(buf, 1, len, bsDumpfp);
-        fclose(bsDumpfp);
-    }
-}
+// Retransmission history, same depth as the former RtpRtcp packet store
+static const int64_t kPacketHistoryMs = 1000;
+static const size_t kPacketHistorySize = 600;
+static const int64_t kMinResendIntervalMs = 10;
+// Picture loss reported for this long is no longer left to a refresh
+static const int64_t kRefreshEscalationMs = 3000;
 
 // PacedSender without pacing
 class NonPacedSender : public webrtc::RtpPacketSender {
@@ -160,9 +61,10 @@ VideoSendAdapterImpl::VideoSendAdapterImpl(
     CallOwner* owner,
     const RtcAdapter::Config& config,
     VideoSendAdapterImpl::SendBitrateObserver* ob)
-    : m_enableDump(false)
-    , m_config(config)
+    : m_config(config)
     , m_keyFrameArrived(false)
+    , m_refreshSinceMs(0)
+    , m_lastRefreshMs(0)
     , m_frameFormat(FRAME_FORMAT_UNKNOWN)
     , m_frameWidth(0)
     , m_frameHeight(0)
@@ -171,6 +73,7 @@ VideoSendAdapterImpl::VideoSendAdapterImpl(
     , m_ssrcGenerator(SsrcGenerator::GetSsrcGenerator())
     , m_clock(nullptr)
     , m_timeStampOffset(0)
+    , m_stream(nullptr)
     , m_owner(owner)
     , m_bitrateObserver(ob)
     , m_feedbackListener(config.feedback_listener)
@@ -196,6 +99,8 @@ VideoSendAdapterImpl::~VideoSendAdapterImpl()
     m_taskRunner->DeRegisterModule(m_rtpRtcp.get());
     m_ssrcGenerator->ReturnSsrc(m_ssrc);
     boost::unique_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    RTC_LOG(LS_INFO) << "VideoSendAdapter SSRC: " << m_ssrc
+                     << ", packets: " << m_packetHistory->getStats().packets;
 }
 
 bool VideoSendAdapterImpl::init()
@@ -232,10 +137,7 @@ bool VideoSendAdapterImpl::init()
         configuration.transport_feedback_callback =
           m_transportControllerSend->transport_feedback_observer();
 
-        // m_pacedSender = std::make_shared<NonPacedSender>(
-        //     m_transportControllerSend->packet_router());
-        // configuration.paced_sender = m_pacedSender.get();
-        configuration.paced_sender = m_transportControllerSend->packet_sender();
+        configuration.paced_sender = m_owner->pacedSender();
         configuration.send_bitrate_observer = this;
     }
 
@@ -243,8 +145,8 @@ bool VideoSendAdapterImpl::init()
     m_rtpRtcp->SetSendingStatus(true);
     m_rtpRtcp->SetSendingMediaStatus(true);
     m_rtpRtcp->SetRTCPStatus(webrtc::RtcpMode::kReducedSize);
-    // Set NACK.
-    m_rtpRtcp->SetStorePacketsStatus(true, 600);
+    // NACK is served from the shared packet history
+    m_rtpRtcp->SetStorePacketsStatus(false, 0);
     if (m_config.transport_cc) {
         m_rtpRtcp->RegisterRtpHeaderExtension(
             webrtc::RtpExtension::kTransportSequenceNumberUri, m_config.transport_cc);
@@ -263,18 +165,16 @@ bool VideoSendAdapterImpl::init()
     if (m_transportControllerSend) {
         m_transportControllerSend->packet_router()
             ->AddSendRtpModule(m_rtpRtcp.get(), true);
-        m_owner->registerVideoSender(m_ssrc);
+        BandwidthAllocator::SenderConfig senderConfig;
+        senderConfig.priority = m_config.priority;
+        senderConfig.min_bitrate_bps = m_config.min_bitrate_bps;
+        senderConfig.max_bitrate_bps = m_config.max_bitrate_bps;
+        m_owner->registerVideoSender(m_ssrc, senderConfig);
     }
 
-    webrtc::RTPSenderVideo::Config video_config;
-    video_config.clock = configuration.clock;
-    video_config.rtp_sender = m_rtpRtcp->RtpSender();
-    video_config.field_trials = m_owner->trial();
-    if (m_config.red_payload) {
-        video_config.red_payload_type = m_config.red_payload;
-    }
-
-    m_senderVideo = std::make_unique<webrtc::RTPSenderVideo>(video_config);
+    m_packetizer = SharedVideoPacketizer::GetSharedPacketizer(
+        m_config.red_payload, m_config.ulpfec_payload, kMaxRtpPacketSize);
+    m_packetHistory.reset(new SharedPacketHistory(m_packetizer, kPacketHistoryMs, kPacketHistorySize));
     m_taskRunner->RegisterModule(m_rtpRtcp.get());
 
     return true;
@@ -305,11 +205,12 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
             m_keyFrameArrived = true;
         }
     }
+    if (frame.additionalInfo.video.isKeyFrame) {
+        m_refreshSinceMs = 0;
+    }
 
     // Recalculate timestamp for stream substitution
     uint32_t timeStamp = frame.timeStamp + m_timeStampOffset; //kMsToRtpTimestamp * m_clock->TimeInMilliseconds();
-    webrtc::RTPVideoHeader h;
-    memset(&h, 0, sizeof(webrtc::RTPVideoHeader));
 
     if (frame.format != m_frameFormat
         || frame.additionalInfo.video.width != m_frameWidth
@@ -319,107 +220,119 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
         m_frameHeight = frame.additionalInfo.video.height;
     }
 
-    h.frame_type = frame.additionalInfo.video.isKeyFrame ? VideoFrameType::kVideoFrameKey : VideoFrameType::kVideoFrameDelta;
-    // h.rotation = image.rotation_;
-    // h.content_type = image.content_type_;
-    // h.playout_delay = image.playout_delay_;
-    h.width = m_frameWidth;
-    h.height = m_frameHeight;
-
-    if (frame.format == FRAME_FORMAT_VP8) {
-        h.codec = webrtc::VideoCodecType::kVideoCodecVP8;
-        auto& vp8_header = h.video_type_header.emplace<RTPVideoHeaderVP8>();
-        vp8_header.InitRTPVideoHeaderVP8();
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        m_senderVideo->SendVideo(
-            VP8_90000_PT,
-            webrtc::kVideoCodecVP8,
-            timeStamp,
-            timeStamp,
-            rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-            h,
-            m_rtpRtcp->ExpectedRetransmissionTimeMs(),
-            0);
-    } else if (frame.format == FRAME_FORMAT_VP9) {
-        h.codec = webrtc::VideoCodecType::kVideoCodecVP9;
-        auto& vp9_header = h.video_type_header.emplace<RTPVideoHeaderVP9>();
-        vp9_header.InitRTPVideoHeaderVP9();
-        vp9_header.inter_pic_predicted = !frame.additionalInfo.video.isKeyFrame;
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        m_senderVideo->SendVideo(
-            VP9_90000_PT,
-            webrtc::kVideoCodecVP9,
-            timeStamp,
-            timeStamp,
-            rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-            h,
-            m_rtpRtcp->ExpectedRetransmissionTimeMs(),
-            0);
-
-    } else if (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265) {
-        int frame_length = frame.length;
-        if (m_enableDump) {
-            dump(this, frame.format, frame.payload, frame_length);
-        }
+    // Packetized once for all subscribers of this frame
+    std::shared_ptr<const SharedVideoPacketizer::PacketizedFrame> packetized =
+        m_packetizer->packetize(frame);
+    if (!packetized || packetized->packets.empty()) {
+        return;
+    }
 
-        //FIXME: temporarily filter out AUD because chrome M59 could NOT handle it correctly.
-        //FIXME: temporarily filter out SEI because safari could NOT handle it correctly.
-        if (frame.format == FRAME_FORMAT_H264) {
-            frame_length = dropAUDandSEI(frame.payload, frame_length);
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    RTPSender* rtpSender = m_rtpRtcp->RtpSender();
+    int64_t nowMs = m_clock->TimeInMilliseconds();
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+    packets.reserve(packetized->packets.size());
+    // Build the whole frame before reserving sequence numbers, a frame
+    // dropped halfway would leave a gap the receiver never recovers
+    for (uint32_t i = 0; i < packetized->packets.size(); i++) {
+        std::unique_ptr<RtpPacketToSend> packet = buildPacket(*packetized, i, timeStamp);
+        if (!packet) {
+            RTC_LOG(LS_WARNING) << "Packet exceeds capacity, drop frame " << frame.timeStamp;
+            return;
+        }
+        packet->set_packet_type(RtpPacketMediaType::kVideo);
+        packets.push_back(std::move(packet));
+    }
+    for (uint32_t i = 0; i < packets.size(); i++) {
+        if (!rtpSender->AssignSequenceNumber(packets[i].get())) {
+            return;
         }
+        m_packetHistory->put(packets[i]->SequenceNumber(), *packetized, i, timeStamp, nowMs);
+    }
+    m_stream = packetized->stream;
+    rtpSender->EnqueuePackets(std::move(packets));
+}
 
-        int nalu_found_length = 0;
-        uint8_t* buffer_start = frame.payload;
-        int buffer_length = frame_length;
-        int nalu_start_offset = 0;
-        int nalu_end_offset = 0;
-        int sc_len = 0;
+std::unique_ptr<webrtc::RtpPacketToSend> VideoSendAdapterImpl::buildPacket(
+    const SharedVideoPacketizer::PacketizedFrame& frame,
+    uint32_t index, uint32_t timestamp)
+{
+    const SharedVideoPacketizer::Packet& shared = frame.packets[index];
+    // SSRC and registered extensions come with the allocated packet
+    std::unique_ptr<webrtc::RtpPacketToSend> packet = m_rtpRtcp->RtpSender()->AllocatePacket();
+    packet->SetPayloadType(frame.payloadType);
+    packet->SetTimestamp(timestamp);
+    packet->SetMarker(shared.marker);
+    packet->set_capture_time_ms(m_clock->TimeInMilliseconds());
+    packet->set_allow_retransmission(true);
+    // Extensions not registered for this subscriber are skipped
+    if (frame.keyFrame) {
+        packet->SetExtension<webrtc::PlayoutDelayLimits>(frame.playoutDelay);
+    }
+    if (shared.marker && frame.timing.flags != webrtc::VideoSendTiming::kInvalid) {
+        packet->SetExtension<webrtc::VideoTimingExtension>(frame.timing);
+        packet->set_packetization_finish_time_ms(m_clock->TimeInMilliseconds());
+    }
+    uint8_t* payload = packet->SetPayloadSize(shared.payload.size());
+    if (!payload) {
+        return nullptr;
+    }
+    memcpy(payload, shared.payload.cdata(), shared.payload.size());
+    return packet;
+}
 
-        h.codec = (frame.format == FRAME_FORMAT_H264) ?
-            webrtc::VideoCodecType::kVideoCodecH264 :
-            webrtc::VideoCodecType::kVideoCodecH265;
+void VideoSendAdapterImpl::resendPackets(const std::vector<uint16_t>& seqs)
+{
+    using namespace webrtc;
 
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        if (frame.format == FRAME_FORMAT_H264) {
-            h.video_type_header.emplace<RTPVideoHeaderH264>();
-            m_senderVideo->SendVideo(
-                H264_90000_PT,
-                webrtc::kVideoCodecH264,
-                timeStamp,
-                timeStamp,
-                rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-                h,
-                m_rtpRtcp->ExpectedRetransmissionTimeMs(),
-                0);
-        } else {
-            h.video_type_header.emplace<RTPVideoHeaderH265>();
-            m_senderVideo->SendVideo(
-                H265_90000_PT,
-                webrtc::kVideoCodecH265,
-                timeStamp,
-                timeStamp,
-                rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-                h,
-                m_rtpRtcp->ExpectedRetransmissionTimeMs(),
-                0);
+    boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+    if (!m_rtpRtcp) {
+        return;
+    }
+    int64_t nowMs = m_clock->TimeInMilliseconds();
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+    for (uint16_t seq : seqs) {
+        SharedPacketHistory::Entry entry;
+        if (!m_packetHistory->getForResend(seq, nowMs, kMinResendIntervalMs, &entry)) {
+            continue;
         }
-    } else if (frame.format == FRAME_FORMAT_AV1) {
-        h.codec = webrtc::VideoCodecType::kVideoCodecAV1;
-        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
-        m_senderVideo->SendVideo(
-            AV1_90000_PT,
-            webrtc::kVideoCodecAV1,
-            timeStamp,
-            timeStamp,
-            rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
-            h,
-            m_rtpRtcp->ExpectedRetransmissionTimeMs(),
-            0);
+        std::unique_ptr<RtpPacketToSend> packet =
+            buildPacket(*entry.frame, entry.index, entry.timestamp);
+        if (!packet) {
+            continue;
+        }
+        if (!m_retransmissionRateLimiter->TryUseRate(packet->size())) {
+            break;
+        }
+        // No RTX, retransmit with the original sequence number
+        packet->SetSequenceNumber(seq);
+        packet->set_packet_type(RtpPacketMediaType::kRetransmission);
+        packets.push_back(std::move(packet));
+    }
+    if (!packets.empty()) {
+        m_rtpRtcp->RtpSender()->EnqueuePackets(std::move(packets));
     }
 }
 
 int VideoSendAdapterImpl::onRtcpData(const char* data, int len)
 {
+    // Serve NACK from the shared history, RtpRtcp stores no packets
+    const uint8_t* packetBegin = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* packetEnd = packetBegin + len;
+    webrtc::rtcp::CommonHeader header;
+    for (const uint8_t* next = packetBegin; next < packetEnd; next = header.NextPacket()) {
+        if (!header.Parse(next, packetEnd - next)) {
+            break;
+        }
+        if (header.type() == webrtc::rtcp::Rtpfb::kPacketType &&
+            header.fmt() == webrtc::rtcp::Nack::kFeedbackMessageType) {
+            webrtc::rtcp::Nack nack;
+            if (nack.Parse(header) && nack.media_ssrc() == m_ssrc) {
+                resendPackets(nack.packet_ids());
+            }
+        }
+    }
+
     boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
     if (m_rtpRtcp) {
         m_rtpRtcp->IncomingRtcpPacket(reinterpret_cast<const uint8_t*>(data), len);
@@ -469,6 +382,22 @@ void VideoSendAdapterImpl::OnReceivedIntraFrameRequest(uint32_t ssrc)
     RTC_DLOG(LS_INFO) << "onReceivedIntraFrameRequest.";
     if (m_feedbackListener) {
         FeedbackMsg feedback = {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME };
+        if (m_keyFrameArrived) {
+            // The receiver decoded the stream before, the encoder may
+            // recover it gradually unless the loss persists
+            int64_t nowMs = rtc::TimeMillis();
+            int64_t sinceMs = m_refreshSinceMs;
+            if (!sinceMs || nowMs - m_lastRefreshMs > kRefreshEscalationMs) {
+                sinceMs = nowMs;
+            }
+            m_lastRefreshMs = nowMs;
+            if (nowMs - sinceMs < kRefreshEscalationMs) {
+                feedback.cmd = REQUEST_REFRESH;
+                m_refreshSinceMs = sinceMs;
+            } else {
+                m_refreshSinceMs = 0;
+            }
+        }
         m_feedbackListener->onFeedback(feedback);
     }
 }
@@ -504,8 +433,30 @@ VideoSendAdapter::Stats VideoSendAdapterImpl::getStats()
 {
     if (m_owner) {
         m_stats.estimated_bandwidth = m_owner->estimatedBandwidth(m_ssrc);
+        m_stats.queued_packets = m_owner->queuedPackets();
+    }
+    // Of all the subscribers of the stream currently sent
+    SharedVideoPacketizer::HistoryStats historyStats = m_packetizer->getHistoryStats(m_stream);
+    m_stats.nack_hits = historyStats.hits;
+    m_stats.nack_misses = historyStats.misses;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_rtpRtcpMutex);
+        if (m_rtpRtcp) {
+            std::vector<webrtc::ReportBlockData> reportBlocks = m_rtpRtcp->GetLatestReportBlockData();
+            if (!reportBlocks.empty()) {
+                m_stats.fraction_lost = reportBlocks.front().report_block().fraction_lost;
+                m_stats.rtt_ms = reportBlocks.front().last_rtt_ms();
+            }
+        }
     }
     return m_stats;
 }
 
+void VideoSendAdapterImpl::setLayerBitrates(const std::vector<uint32_t>& bitrates)
+{
+    if (m_owner && m_transportControllerSend) {
+        m_owner->setVideoSenderLayers(m_ssrc, bitrates);
+    }
+}
+
 } // namespace rtc_adapter
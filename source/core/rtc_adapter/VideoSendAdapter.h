@@ -8,18 +8,20 @@
 #include <AdapterInternalDefinitions.h>
 #include <RtcAdapter.h>
 
+#include <atomic>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include "MediaFramePipeline.h"
+#include "SharedPacketHistory.h"
+#include "SharedVideoPacketizer.h"
 #include "SsrcGenerator.h"
 #include "WebRTCTaskRunner.h"
 
 #include <api/transport/network_control.h>
 #include <modules/rtp_rtcp/include/rtp_rtcp.h>
 #include <modules/rtp_rtcp/include/rtp_rtcp_defines.h>
-#include <modules/rtp_rtcp/source/rtp_sender_video.h>
 
 #include <rtc_base/random.h>
 #include <rtc_base/rate_limiter.h>
@@ -49,6 +51,7 @@ public:
     void reset() override;
     uint32_t ssrc() { return m_ssrc; }
     VideoSendAdapter::Stats getStats() override;
+    void setLayerBitrates(const std::vector<uint32_t>& bitrates) override;
 
     // Implement webrtc::Transport
     bool SendRtp(const uint8_t* packet,
@@ -69,11 +72,17 @@ public:
 
 private:
     bool init();
+    std::unique_ptr<webrtc::RtpPacketToSend> buildPacket(
+        const SharedVideoPacketizer::PacketizedFrame& frame,
+        uint32_t index, uint32_t timestamp);
+    void resendPackets(const std::vector<uint16_t>& seqs);
 
-    bool m_enableDump;
     RtcAdapter::Config m_config;
 
     bool m_keyFrameArrived;
+    // Loss episode answered by refresh requests, 0 if none
+    std::atomic<int64_t> m_refreshSinceMs;
+    std::atomic<int64_t> m_lastRefreshMs;
     std::unique_ptr<webrtc::RateLimiter> m_retransmissionRateLimiter;
     // boost::scoped_ptr<webrtc::BitrateController> m_bitrateController;
     boost::scoped_ptr<webrtc::RtcpBandwidthObserver> m_bandwidthObserver;
@@ -94,7 +103,10 @@ private:
     webrtc::Clock* m_clock;
     int64_t m_timeStampOffset;
 
-    std::unique_ptr<webrtc::RTPSenderVideo> m_senderVideo;
+    std::shared_ptr<SharedVideoPacketizer> m_packetizer;
+    std::unique_ptr<SharedPacketHistory> m_packetHistory;
+    // Source stream of the last frame sent, for its history stats
+    std::atomic<const void*> m_stream;
     CallOwner* m_owner;
     std::shared_ptr<webrtc::RtpTransportControllerSendInterface> m_transportControllerSend;
     VideoSendAdapter::Stats m_stats;
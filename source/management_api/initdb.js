@@ -73,6 +73,10 @@ async function initConfig() {
       },
       mix: {
         top_k: 0,
+        // Decode opus/pcmu/pcma inputs from mixers and transcoders without NetEQ
+        fast_decode: false,
+        // Decode only the loudest N inputs by RTP audio level, 0 to decode all
+        decode_on_demand: 0,
       },
     },
   };
@@ -272,6 +276,11 @@ async function initConfig() {
         hardwareAccelerated: true,
         enableBetterHEVCQuality: false,
         MFE_timeout: 0,
+        intra_refresh_frames: 0,
+        transcode_ladder: {
+          bitrate_step: 0.1,
+          rungs: [],
+        },
       },
       // avatar: {
       //   location: 'avatars/avatar_blue.180x180.yuv',
@@ -313,6 +322,7 @@ async function initConfig() {
         stunport: 0,
         stunserver: '',
         num_workers: 24,
+        keyframe_min_interval: 1000,
       },
     },
   };
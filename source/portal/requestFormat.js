@@ -50,6 +50,7 @@ const PublicationRequest = {
               'type': { enum: ["audio", "video"] },
               'mid': { type: 'string' },
               'source': { enum: ["mic", "camera", "screen-cast", "raw-file", "encoded-file"] },
+              'frameAssembler': { type: 'boolean' },
             }
           }
         }
@@ -147,6 +148,7 @@ const SubscriptionRequest = {
                 ]
               },
               'parameters': { $ref: '#/definitions/VideoParametersSpecification' },
+              'bandwidth': { $ref: '#/definitions/BandwidthAllocation' },
             }
           }
         }
@@ -194,6 +196,16 @@ const SubscriptionRequest = {
         'keyFrameInterval': { type: 'number' }
       },
       additionalProperties: false
+    },
+
+    'BandwidthAllocation': {
+      type: 'object',
+      properties: {
+        'priority': { type: 'integer', minimum: 1 },
+        'minBitrate': { type: 'number', minimum: 0 },
+        'maxBitrate': { type: 'number', minimum: 0 }
+      },
+      additionalProperties: false
     }
   }
 };